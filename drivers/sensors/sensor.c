@@ -36,10 +36,15 @@
 
 #include <poll.h>
 #include <fcntl.h>
+#include <strings.h>
+#include <nuttx/nuttx.h>
 #include <nuttx/list.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/circbuf.h>
 #include <nuttx/mutex.h>
+#include <nuttx/atomic.h>
+#include <nuttx/mm/map.h>
+#include <nuttx/sched.h>
 #include <nuttx/sensors/sensor.h>
 #include <nuttx/lib/lib.h>
 
@@ -102,6 +107,9 @@ struct sensor_user_s
   bool             flushing;   /* The is used to indicate user is flushing */
   sem_t            buffersem;  /* Wakeup user waiting for data in circular buffer */
   size_t           bufferpos;  /* The index of user generation in buffer */
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  int              cursor;     /* The index of ring cursor, -1 if not mapped */
+#endif
 
   /* The subscriber info
    * Support multi advertisers to subscribe their own data when they
@@ -111,6 +119,19 @@ struct sensor_user_s
   struct sensor_ustate_s state;
 };
 
+#ifdef CONFIG_SENSORS_ZEROCOPY
+/* The ring is freed once the sensor is unregistered and the last mapping
+ * of it is gone.
+ */
+
+struct sensor_ringref_s
+{
+  atomic_t refs;                         /* One for the sensor, one per map */
+  FAR struct sensor_ring_s *ring;        /* The ring, in the user heap */
+};
+
+#endif
+
 /* This structure describes the state of the upper half driver */
 
 struct sensor_upperhalf_s
@@ -121,6 +142,11 @@ struct sensor_upperhalf_s
   struct circbuf_s   buffer;             /* The circular buffer of data */
   rmutex_t           lock;               /* Manages exclusive access to file operations */
   struct list_node   userlist;           /* List of users */
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  FAR struct sensor_ring_s *ring;        /* The ring of zero-copy subscribers */
+  FAR struct sensor_ringref_s *ringref;  /* The references to the ring */
+  uint32_t           cursors;            /* Bitmap of ring cursors in use */
+#endif
 };
 
 /****************************************************************************
@@ -139,6 +165,13 @@ static int     sensor_ioctl(FAR struct file *filep, int cmd,
                             unsigned long arg);
 static int     sensor_poll(FAR struct file *filep, FAR struct pollfd *fds,
                            bool setup);
+#ifdef CONFIG_SENSORS_ZEROCOPY
+static int     sensor_mmap(FAR struct file *filep,
+                           FAR struct mm_map_entry_s *map);
+static int     sensor_munmap(FAR struct task_group_s *group,
+                             FAR struct mm_map_entry_s *map,
+                             FAR void *start, size_t length);
+#endif
 static ssize_t sensor_push_event(FAR void *priv, FAR const void *data,
                                  size_t bytes);
 
@@ -228,7 +261,11 @@ static const struct file_operations g_sensor_fops =
   sensor_write,   /* write */
   NULL,           /* seek  */
   sensor_ioctl,   /* ioctl */
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  sensor_mmap,    /* mmap */
+#else
   NULL,           /* mmap */
+#endif
   NULL,           /* truncate */
   sensor_poll     /* poll  */
 };
@@ -455,6 +492,114 @@ static void sensor_catch_up(FAR struct sensor_upperhalf_s *upper,
     }
 }
 
+#ifdef CONFIG_SENSORS_ZEROCOPY
+static FAR struct sensor_ring_s *
+sensor_ring_alloc(FAR struct sensor_upperhalf_s *upper)
+{
+  FAR struct sensor_ringref_s *ref;
+  FAR struct sensor_ring_s *ring;
+  uint32_t nbuffer = 1;
+  size_t offset;
+
+  ref = kmm_malloc(sizeof(*ref));
+  if (ref == NULL)
+    {
+      return NULL;
+    }
+
+  /* Round the depth up to a power of two, so that the positions keep
+   * mapping to the same slots when they wrap around.
+   */
+
+  while (nbuffer < upper->lower->nbuffer)
+    {
+      nbuffer <<= 1;
+    }
+
+  /* The ring is mapped by the subscribers, allocate it from user heap */
+
+  offset = ALIGN_UP(sizeof(struct sensor_ring_s), sizeof(uint64_t));
+  ring   = kumm_zalloc(offset + nbuffer * upper->state.esize);
+  if (ring == NULL)
+    {
+      kmm_free(ref);
+      return NULL;
+    }
+
+  ring->esize   = upper->state.esize;
+  ring->nbuffer = nbuffer;
+  ring->offset  = offset;
+
+  atomic_set(&ref->refs, 1);
+  ref->ring      = ring;
+  upper->ringref = ref;
+  return ring;
+}
+
+static void sensor_ring_put(FAR struct sensor_ringref_s *ref)
+{
+  if (atomic_fetch_sub_release(&ref->refs, 1) == 1)
+    {
+      kumm_free(ref->ring);
+      kmm_free(ref);
+    }
+}
+
+static void sensor_ring_push(FAR struct sensor_ring_s *ring,
+                             FAR const void *data, uint32_t nums)
+{
+  FAR const char *src = data;
+  uint32_t head = atomic_read(&ring->head);
+  uint32_t mask = ring->nbuffer - 1;
+
+  /* Only the most recent samples fit, the others are published as
+   * already overwritten.
+   */
+
+  if (nums > ring->nbuffer)
+    {
+      src  += (nums - ring->nbuffer) * ring->esize;
+      head += nums - ring->nbuffer;
+      nums  = ring->nbuffer;
+    }
+
+  /* Announce the slots going to be overwritten before touching them, so
+   * that the subscribers can detect the samples torn under their feet.
+   */
+
+  atomic_set(&ring->reserve, head + nums);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  while (nums-- > 0)
+    {
+      memcpy((FAR char *)ring + ring->offset + (head & mask) * ring->esize,
+             src, ring->esize);
+      src += ring->esize;
+      head++;
+    }
+
+  atomic_set_release(&ring->head, head);
+}
+#endif
+
+static bool sensor_is_ready(FAR struct sensor_upperhalf_s *upper,
+                            FAR struct sensor_user_s *user)
+{
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  /* The mapped subscribers consume every sample and track their position
+   * by the cursor in the shared ring.
+   */
+
+  if (user->cursor >= 0)
+    {
+      return atomic_read(&upper->ring->head) !=
+             atomic_read(&upper->ring->cursor[user->cursor]);
+    }
+#endif
+
+  return sensor_is_updated(upper, user);
+}
+
 static ssize_t sensor_do_samples(FAR struct sensor_upperhalf_s *upper,
                                  FAR struct sensor_user_s *user,
                                  FAR char *buffer, size_t len)
@@ -663,6 +808,9 @@ static int sensor_open(FAR struct file *filep)
 
   user->state.interval = UINT32_MAX;
   user->state.esize = upper->state.esize;
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  user->cursor = -1;
+#endif
   nxsem_init(&user->buffersem, 0, 0);
   list_add_tail(&upper->userlist, &user->node);
 
@@ -723,6 +871,13 @@ static int sensor_close(FAR struct file *filep)
     }
 
   list_delete(&user->node);
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  if (user->cursor >= 0)
+    {
+      upper->cursors &= ~(1u << user->cursor);
+    }
+
+#endif
   sensor_update_latency(filep, upper, user, UINT32_MAX);
   sensor_update_interval(filep, upper, user, UINT32_MAX);
   nxsem_destroy(&user->buffersem);
@@ -914,6 +1069,25 @@ static int sensor_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       case SNIOC_SET_BUFFER_NUMBER:
         {
           nxrmutex_lock(&upper->lock);
+#ifdef CONFIG_SENSORS_ZEROCOPY
+          /* A ring which is no longer mapped is allocated again with the
+           * new depth by the next mmap(), a mapped one cannot be resized.
+           */
+
+          if (upper->ring != NULL &&
+              atomic_read_acquire(&upper->ringref->refs) == 1)
+            {
+              sensor_ring_put(upper->ringref);
+              upper->ring    = NULL;
+              upper->ringref = NULL;
+            }
+
+          if (upper->ring != NULL)
+            {
+              ret = -EBUSY;
+            }
+          else
+#endif
           if (!circbuf_is_init(&upper->buffer))
             {
               if (arg1 >= lower->nbuffer)
@@ -966,6 +1140,24 @@ static int sensor_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
         }
         break;
 
+#ifdef CONFIG_SENSORS_ZEROCOPY
+     case SNIOC_GET_CURSOR:
+        {
+          nxrmutex_lock(&upper->lock);
+          if (arg != 0 && user->cursor >= 0)
+            {
+              *(FAR unsigned int *)(uintptr_t)arg = user->cursor;
+            }
+          else
+            {
+              ret = -EINVAL;
+            }
+
+          nxrmutex_unlock(&upper->lock);
+        }
+        break;
+
+#endif
      case SNIOC_FLUSH:
         {
           nxrmutex_lock(&upper->lock);
@@ -1063,7 +1255,7 @@ static int sensor_poll(FAR struct file *filep,
                 }
             }
         }
-      else if (sensor_is_updated(upper, user))
+      else if (sensor_is_ready(upper, user))
         {
           eventset |= POLLIN;
         }
@@ -1086,6 +1278,97 @@ errout:
   return ret;
 }
 
+#ifdef CONFIG_SENSORS_ZEROCOPY
+static int sensor_mmap(FAR struct file *filep,
+                       FAR struct mm_map_entry_s *map)
+{
+  FAR struct inode *inode = filep->f_inode;
+  FAR struct sensor_upperhalf_s *upper = inode->i_private;
+  FAR struct sensor_lowerhalf_s *lower = upper->lower;
+  FAR struct sensor_user_s *user = filep->f_priv;
+  FAR struct sensor_ring_s *ring;
+  int cursor;
+  int ret = OK;
+
+  /* Only the subscribers of buffered topics can map the ring */
+
+  if (lower->ops->fetch || !(user->role & SENSOR_ROLE_RD))
+    {
+      return -ENOTSUP;
+    }
+
+  nxrmutex_lock(&upper->lock);
+  ring = upper->ring;
+  if (ring == NULL)
+    {
+      ring = sensor_ring_alloc(upper);
+      if (ring == NULL)
+        {
+          ret = -ENOMEM;
+          goto errout;
+        }
+
+      upper->ring = ring;
+    }
+
+  if (map->offset != 0 ||
+      map->length > ring->offset + ring->nbuffer * ring->esize)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  /* Take a cursor on the first mapping, start from the newest sample */
+
+  if (user->cursor < 0)
+    {
+      cursor = ffs(~upper->cursors) - 1;
+      if (cursor < 0 || cursor >= CONFIG_SENSORS_ZEROCOPY_NCURSORS)
+        {
+          ret = -EBUSY;
+          goto errout;
+        }
+
+      upper->cursors |= 1u << cursor;
+      user->cursor    = cursor;
+      atomic_set(&ring->cursor[cursor], atomic_read(&ring->head));
+    }
+
+  /* Every mapping keeps the ring alive until it is unmapped */
+
+  map->vaddr  = ring;
+  map->munmap = sensor_munmap;
+  map->priv.p = upper->ringref;
+
+  atomic_fetch_add_relaxed(&upper->ringref->refs, 1);
+  ret = mm_map_add(get_current_mm(), map);
+  if (ret < 0)
+    {
+      atomic_fetch_sub_relaxed(&upper->ringref->refs, 1);
+    }
+
+errout:
+  nxrmutex_unlock(&upper->lock);
+  return ret;
+}
+
+static int sensor_munmap(FAR struct task_group_s *group,
+                         FAR struct mm_map_entry_s *map,
+                         FAR void *start, size_t length)
+{
+  FAR struct sensor_ringref_s *ref = map->priv.p;
+  int ret;
+
+  ret = mm_map_remove(get_group_mm(group), map);
+  if (ret >= 0)
+    {
+      sensor_ring_put(ref);
+    }
+
+  return ret;
+}
+#endif
+
 static ssize_t sensor_push_event(FAR void *priv, FAR const void *data,
                                  size_t bytes)
 {
@@ -1145,9 +1428,16 @@ static ssize_t sensor_push_event(FAR void *priv, FAR const void *data,
 
   circbuf_overwrite(&upper->buffer, data, bytes);
   sensor_generate_timing(upper, envcount);
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  if (upper->ring != NULL)
+    {
+      sensor_ring_push(upper->ring, data, envcount);
+    }
+
+#endif
   list_for_every_entry(&upper->userlist, user, struct sensor_user_s, node)
     {
-      if (sensor_is_updated(upper, user))
+      if (sensor_is_ready(upper, user))
         {
           nxsem_get_value(&user->buffersem, &semcount);
           if (semcount < 1)
@@ -1449,5 +1739,12 @@ void sensor_custom_unregister(FAR struct sensor_lowerhalf_s *lower,
       circbuf_uninit(&upper->timing);
     }
 
+#ifdef CONFIG_SENSORS_ZEROCOPY
+  if (upper->ring != NULL)
+    {
+      sensor_ring_put(upper->ringref);
+    }
+
+#endif
   kmm_free(upper);
 }
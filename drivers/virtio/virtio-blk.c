@@ -27,6 +27,8 @@
 #include <debug.h>
 #include <errno.h>
 #include <stdio.h>
+#include <sys/param.h>
+#include <sys/uio.h>
 
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
@@ -45,6 +47,7 @@
 
 /* Block feature bits */
 
+#define VIRTIO_BLK_F_SEG_MAX        2  /* Max segments in a request */
 #define VIRTIO_BLK_F_RO             5  /* Disk is read-only */
 #define VIRTIO_BLK_F_BLK_SIZE       6  /* Block size of disk is available */
 #define VIRTIO_BLK_F_FLUSH          9  /* Cache flush command support */
@@ -66,6 +69,13 @@
 #define VIRTIO_BLK_SECTOR_BITS      9
 #define VIRTIO_BLK_SECTOR_SIZE      (1UL << VIRTIO_BLK_SECTOR_BITS)
 
+/* Scatter-gather limits: data segments per request, and requests queued
+ * before a single kick.
+ */
+
+#define VIRTIO_BLK_MAX_SEGS         16
+#define VIRTIO_BLK_MAX_REQS         4
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -86,6 +96,16 @@ begin_packed_struct struct virtio_blk_resp_s
   uint8_t status;
 } end_packed_struct;
 
+/* One request of a batch queued before a kick */
+
+struct virtio_blk_batch_s
+{
+  struct virtio_blk_req_s  req;
+  struct virtio_blk_resp_s resp;
+  sem_t                    respsem;
+  unsigned int             nsectors;
+};
+
 begin_packed_struct struct virtio_blk_config_s
 {
   uint64_t capacity;
@@ -120,6 +140,7 @@ struct virtio_blk_priv_s
   spinlock_t                    lock;           /* Lock */
   uint64_t                      nsectors;       /* Sectore numbers */
   uint32_t                      block_size;     /* Block size */
+  uint32_t                      seg_max;        /* Data segments per request */
   char                          name[NAME_MAX]; /* Device name */
 };
 
@@ -130,8 +151,8 @@ struct virtio_blk_priv_s
 /* BLK block_operations functions and they helper function */
 
 static ssize_t virtio_blk_rdwr(FAR struct virtio_blk_priv_s *priv,
-                               FAR void *buffer, blkcnt_t startsector,
-                               unsigned int nsectors, bool write);
+                               FAR const struct iovec *iov, int iovcnt,
+                               blkcnt_t startsector, bool write);
 static int     virtio_blk_open(FAR struct inode *inode);
 static int     virtio_blk_close(FAR struct inode *inode);
 static ssize_t virtio_blk_read(FAR struct inode *inode,
@@ -144,6 +165,12 @@ static int     virtio_blk_geometry(FAR struct inode *inode,
                                    FAR struct geometry *geometry);
 static int     virtio_blk_ioctl(FAR struct inode *inode, int cmd,
                                 unsigned long arg);
+static ssize_t virtio_blk_readv(FAR struct inode *inode,
+                                FAR const struct iovec *iov, int iovcnt,
+                                blkcnt_t startsector);
+static ssize_t virtio_blk_writev(FAR struct inode *inode,
+                                 FAR const struct iovec *iov, int iovcnt,
+                                 blkcnt_t startsector);
 static int     virtio_blk_flush(FAR struct virtio_blk_priv_s *priv);
 
 /* Other functions */
@@ -174,7 +201,12 @@ static const struct block_operations g_virtio_blk_bops =
   virtio_blk_read,     /* read     */
   virtio_blk_write,    /* write    */
   virtio_blk_geometry, /* geometry */
-  virtio_blk_ioctl     /* ioctl    */
+  virtio_blk_ioctl,    /* ioctl    */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  NULL,                /* unlink   */
+#endif
+  virtio_blk_readv,    /* readv    */
+  virtio_blk_writev    /* writev   */
 };
 
 static int g_virtio_blk_idx = 0;
@@ -222,81 +254,135 @@ static void virtio_blk_wait_complete(FAR struct virtqueue *vq,
  * Name: virtio_blk_rdwr
  *
  * Description:
- *   Common function for read and write
+ *   Common function for read and write.  The buffers are split into
+ *   requests of at most seg_max data segments each, and up to
+ *   VIRTIO_BLK_MAX_REQS requests are queued before a single kick.
  *
  ****************************************************************************/
 
 static ssize_t virtio_blk_rdwr(FAR struct virtio_blk_priv_s *priv,
-                               FAR void *buffer, blkcnt_t startsector,
-                               unsigned int nsectors, bool write)
+                               FAR const struct iovec *iov, int iovcnt,
+                               blkcnt_t startsector, bool write)
 {
   FAR struct virtio_device *vdev = priv->vdev;
   FAR struct virtqueue *vq = vdev->vrings_info[0].vq;
-  FAR struct virtqueue_buf vb[3];
-  struct virtio_blk_resp_s resp;
-  struct virtio_blk_req_s req;
+  struct virtio_blk_batch_s batch[VIRTIO_BLK_MAX_REQS];
+  struct virtqueue_buf vb[VIRTIO_BLK_MAX_SEGS + 2];
+  FAR struct virtio_blk_batch_s *b;
   irqstate_t flags;
-  sem_t respsem;
-  ssize_t ret;
-  int readnum;
-
-  nxsem_init(&respsem, 0, 0);
-
-  /* Build the block request */
-
-  req.type     = write ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
-  req.reserved = 0;
-  req.sector   = startsector * priv->block_size >> VIRTIO_BLK_SECTOR_BITS;
-  resp.status  = VIRTIO_BLK_S_IOERR;
-
-  /* Fill the virtqueue buffer:
-   * Buffer 0: the block out header;
-   * Buffer 1: the read/write buffer;
-   * Buffer 2: the block in header, return the status.
+  ssize_t total = 0;
+  ssize_t ret = OK;
+  int maxreqs;
+  int nreqs;
+  int nsegs;
+  int i;
+
+  /* Polling for completions in interrupt context can only track one
+   * request at a time.
    */
 
-  vb[0].buf = &req;
-  vb[0].len = VIRTIO_BLK_REQ_HEADER_SIZE;
-  vb[1].buf = buffer;
-  vb[1].len = nsectors * priv->block_size;
-  vb[2].buf = &resp;
-  vb[2].len = VIRTIO_BLK_RESP_HEADER_SIZE;
-  readnum = write ? 2 : 1;
-
+  maxreqs = up_interrupt_context() ? 1 : VIRTIO_BLK_MAX_REQS;
   if (up_interrupt_context())
     {
       virtqueue_disable_cb_lock(vq, &priv->lock);
     }
 
-  flags = spin_lock_irqsave(&priv->lock);
-  ret = virtqueue_add_buffer(vq, vb, readnum, 3 - readnum, &respsem);
-  if (ret < 0)
+  while (iovcnt > 0 && ret >= 0)
     {
-      spin_unlock_irqrestore(&priv->lock, flags);
-      vrterr("virtqueue_add_buffer failed, ret=%zd\n", ret);
-      goto err;
-    }
+      flags = spin_lock_irqsave(&priv->lock);
 
-  virtqueue_kick(vq);
-  spin_unlock_irqrestore(&priv->lock, flags);
+      for (nreqs = 0; nreqs < maxreqs && iovcnt > 0; nreqs++)
+        {
+          b = &batch[nreqs];
+
+          /* Build the block request:
+           * Buffer 0: the block out header;
+           * Buffer 1..n: the read/write buffers;
+           * Buffer n + 1: the block in header, return the status.
+           */
+
+          b->req.type      = write ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_IN;
+          b->req.reserved  = 0;
+          b->req.sector    = (startsector + total) * priv->block_size >>
+                             VIRTIO_BLK_SECTOR_BITS;
+          b->resp.status   = VIRTIO_BLK_S_IOERR;
+          b->nsectors      = 0;
+
+          vb[0].buf = &b->req;
+          vb[0].len = VIRTIO_BLK_REQ_HEADER_SIZE;
+
+          nsegs = MIN(iovcnt, (int)priv->seg_max);
+          for (i = 0; i < nsegs; i++)
+            {
+              vb[i + 1].buf = iov[i].iov_base;
+              vb[i + 1].len = iov[i].iov_len;
+              b->nsectors  += iov[i].iov_len / priv->block_size;
+            }
 
-  /* Wait for the request completion */
+          vb[nsegs + 1].buf = &b->resp;
+          vb[nsegs + 1].len = VIRTIO_BLK_RESP_HEADER_SIZE;
+
+          nxsem_init(&b->respsem, 0, 0);
+          if (write)
+            {
+              ret = virtqueue_add_buffer(vq, vb, nsegs + 1, 1, &b->respsem);
+            }
+          else
+            {
+              ret = virtqueue_add_buffer(vq, vb, 1, nsegs + 1, &b->respsem);
+            }
 
-  virtio_blk_wait_complete(vq, &respsem);
+          if (ret < 0)
+            {
+              /* Queue full: send what was queued and retry the rest */
+
+              nxsem_destroy(&b->respsem);
+              if (nreqs > 0)
+                {
+                  ret = OK;
+                }
+              else
+                {
+                  vrterr("virtqueue_add_buffer failed, ret=%zd\n", ret);
+                }
 
-  if (resp.status != VIRTIO_BLK_S_OK)
-    {
-      vrterr("%s Error\n", write ? "Write" : "Read");
-      ret = -EIO;
+              break;
+            }
+
+          iov    += nsegs;
+          iovcnt -= nsegs;
+          total  += b->nsectors;
+        }
+
+      if (nreqs > 0)
+        {
+          virtqueue_kick(vq);
+        }
+
+      spin_unlock_irqrestore(&priv->lock, flags);
+
+      /* Wait for the requests completion */
+
+      for (i = 0; i < nreqs; i++)
+        {
+          b = &batch[i];
+          virtio_blk_wait_complete(vq, &b->respsem);
+          nxsem_destroy(&b->respsem);
+
+          if (b->resp.status != VIRTIO_BLK_S_OK)
+            {
+              vrterr("%s Error\n", write ? "Write" : "Read");
+              ret = -EIO;
+            }
+        }
     }
 
-err:
   if (up_interrupt_context())
     {
       virtqueue_enable_cb_lock(vq, &priv->lock);
     }
 
-  return ret >= 0 ? nsectors : ret;
+  return ret >= 0 ? total : ret;
 }
 
 /****************************************************************************
@@ -339,10 +425,14 @@ static ssize_t virtio_blk_read(FAR struct inode *inode,
                                blkcnt_t startsector, unsigned int nsectors)
 {
   FAR struct virtio_blk_priv_s *priv;
+  struct iovec iov;
 
   DEBUGASSERT(inode->i_private);
   priv = inode->i_private;
-  return virtio_blk_rdwr(priv, buffer, startsector, nsectors, false);
+
+  iov.iov_base = buffer;
+  iov.iov_len  = nsectors * priv->block_size;
+  return virtio_blk_rdwr(priv, &iov, 1, startsector, false);
 }
 
 /****************************************************************************
@@ -359,6 +449,7 @@ static ssize_t virtio_blk_write(FAR struct inode *inode,
                                 blkcnt_t startsector, unsigned int nsectors)
 {
   FAR struct virtio_blk_priv_s *priv;
+  struct iovec iov;
 
   DEBUGASSERT(inode->i_private);
   priv = inode->i_private;
@@ -367,8 +458,50 @@ static ssize_t virtio_blk_write(FAR struct inode *inode,
       return -EPERM;
     }
 
-  return virtio_blk_rdwr(priv, (FAR void *)buffer, startsector, nsectors,
-                         true);
+  iov.iov_base = (FAR void *)buffer;
+  iov.iov_len  = nsectors * priv->block_size;
+  return virtio_blk_rdwr(priv, &iov, 1, startsector, true);
+}
+
+/****************************************************************************
+ * Name: virtio_blk_readv
+ *
+ * Description:
+ *   Read a run of sectors into several buffers.
+ *
+ ****************************************************************************/
+
+static ssize_t virtio_blk_readv(FAR struct inode *inode,
+                                FAR const struct iovec *iov, int iovcnt,
+                                blkcnt_t startsector)
+{
+  DEBUGASSERT(inode->i_private);
+  return virtio_blk_rdwr(inode->i_private, iov, iovcnt, startsector,
+                         false);
+}
+
+/****************************************************************************
+ * Name: virtio_blk_writev
+ *
+ * Description:
+ *   Write a run of sectors from several buffers.
+ *
+ ****************************************************************************/
+
+static ssize_t virtio_blk_writev(FAR struct inode *inode,
+                                 FAR const struct iovec *iov, int iovcnt,
+                                 blkcnt_t startsector)
+{
+  FAR struct virtio_blk_priv_s *priv;
+
+  DEBUGASSERT(inode->i_private);
+  priv = inode->i_private;
+  if (virtio_has_feature(priv->vdev, VIRTIO_BLK_F_RO))
+    {
+      return -EPERM;
+    }
+
+  return virtio_blk_rdwr(priv, iov, iovcnt, startsector, true);
 }
 
 /****************************************************************************
@@ -517,7 +650,8 @@ static int virtio_blk_init(FAR struct virtio_blk_priv_s *priv,
   /* Initialize the virtio device */
 
   virtio_set_status(vdev, VIRTIO_CONFIG_STATUS_DRIVER);
-  virtio_negotiate_features(vdev, (1UL << VIRTIO_BLK_F_RO) |
+  virtio_negotiate_features(vdev, (1UL << VIRTIO_BLK_F_SEG_MAX) |
+                                  (1UL << VIRTIO_BLK_F_RO) |
                                   (1UL << VIRTIO_BLK_F_BLK_SIZE) |
                                   (1UL << VIRTIO_BLK_F_FLUSH), NULL);
   virtio_set_status(vdev, VIRTIO_CONFIG_FEATURES_OK);
@@ -592,6 +726,16 @@ static int virtio_blk_probe(FAR struct virtio_device *vdev)
       priv->block_size = VIRTIO_BLK_SECTOR_SIZE;
     }
 
+  /* Limit the data segments of a request to what the device accepts */
+
+  priv->seg_max = VIRTIO_BLK_MAX_SEGS;
+  if (virtio_has_feature(vdev, VIRTIO_BLK_F_SEG_MAX))
+    {
+      virtio_read_config_member(priv->vdev, struct virtio_blk_config_s,
+                                seg_max, &priv->seg_max);
+      priv->seg_max = MAX(MIN(priv->seg_max, VIRTIO_BLK_MAX_SEGS), 1);
+    }
+
   /* Register block driver */
 
   snprintf(priv->name, NAME_MAX, "/dev/virtblk%d", g_virtio_blk_idx);
@@ -28,6 +28,8 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <stdbool.h>
 #include <string.h>
 #include <aio.h>
 
@@ -48,6 +50,37 @@
 #  define CONFIG_FS_NAIOC 8
 #endif
 
+/* Number of dedicated AIO worker threads, 0 to use the low priority work
+ * queue.
+ */
+
+#ifndef CONFIG_FS_AIO_NTHREADS
+#  define CONFIG_FS_AIO_NTHREADS 0
+#endif
+
+/* Maximum number of requests performed in one merged transfer */
+
+#if !defined(CONFIG_FS_AIO_MERGE) || CONFIG_FS_AIO_MERGE < 1
+#  undef CONFIG_FS_AIO_MERGE
+#  define CONFIG_FS_AIO_MERGE 1
+#endif
+
+/* Only the shared low priority work queue has its priority boosted to that
+ * of the waiting task; a dedicated pool runs at its configured priority.
+ */
+
+#if defined(CONFIG_PRIORITY_INHERITANCE) && CONFIG_FS_AIO_NTHREADS == 0
+#  define AIO_PRIORITY_INHERITANCE 1
+#endif
+
+/* lio_listio() points aio_priv of each request of its list but the last
+ * one back at the control block.  Such a request is held, not queued,
+ * until the last one has been submitted, so that the whole list is queued
+ * before any of it starts.
+ */
+
+#define AIO_BATCHED(aiocbp) ((aiocbp)->aio_priv == (FAR void *)(aiocbp))
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -58,14 +91,30 @@
  */
 
 struct file;
+
+/* The pending requests on one open file.  There are no more of them in use
+ * than there are containers.
+ */
+
+struct aio_file_s
+{
+  FAR struct file *af_filep;       /* The open file, NULL if not in use */
+  dq_queue_t af_pending;           /* Its pending requests, in order */
+};
+
 struct aio_container_s
 {
   dq_entry_t aioc_link;            /* Supports a doubly linked list */
+  dq_entry_t aioc_flink;           /* Links the requests on the same file */
   FAR struct aiocb *aioc_aiocbp;   /* The contained AIO control block */
   FAR struct file *aioc_filep;     /* File structure to use with the I/O */
+  FAR struct aio_file_s *aioc_af;  /* The requests on the same file */
   struct work_s aioc_work;         /* Used to defer I/O to the work thread */
+  worker_t aioc_held;              /* Worker of a held request, else NULL */
   pid_t aioc_pid;                  /* ID of the waiting task */
-#ifdef CONFIG_PRIORITY_INHERITANCE
+  uint8_t aioc_opcode;             /* LIO_READ, LIO_WRITE or LIO_NOP */
+  bool aioc_batched;               /* Hold until the list is submitted */
+#ifdef AIO_PRIORITY_INHERITANCE
   uint8_t aioc_prio;               /* Priority of the waiting task */
 #endif
 };
@@ -206,7 +255,9 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the AIO worker threads, or on the low
+ *   priority work queue if there are none.  A request that is not the last
+ *   of a lio_listio() list is only held until aio_release().
  *
  * Input Parameters:
  *   arg - Worker argument.  In this case, a pointer to an instance of
@@ -220,6 +271,92 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc);
 
 int aio_queue(FAR struct aio_container_s *aioc, worker_t worker);
 
+/****************************************************************************
+ * Name: aio_release
+ *
+ * Description:
+ *   Queue the requests of the calling task held by aio_queue(), once the
+ *   last request of its lio_listio() list has been submitted.
+ *
+ ****************************************************************************/
+
+void aio_release(void);
+
+/****************************************************************************
+ * Name: aio_cancel_work
+ *
+ * Description:
+ *   Remove the queued work of a container before it starts.
+ *
+ * Returned Value:
+ *   Zero (OK) if the work was still queued or held and has been removed; a
+ *   negated errno value if it has already started.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+int aio_cancel_work(FAR struct aio_container_s *aioc);
+
+/****************************************************************************
+ * Name: aio_gather
+ *
+ * Description:
+ *   Collect the requests that can be performed together with list[0]: the
+ *   queued or held requests of the same kind on the same open file that
+ *   continue where the previous one ends.  Their work is removed from the
+ *   queue, so they are now owned by the caller.  iov[] is set up to
+ *   describe the buffers of all collected requests, in file order.
+ *
+ *   Appending writes ignore the file offset; the writes queued after
+ *   list[0] on the same file are collected in the order they were made.
+ *
+ * Input Parameters:
+ *   list   - Array of CONFIG_FS_AIO_MERGE entries; list[0] is the request
+ *            being started.
+ *   iov    - Array of CONFIG_FS_AIO_MERGE entries to receive the buffers.
+ *   append - True if the file was opened with O_APPEND.
+ *
+ * Returned Value:
+ *   The number of requests now in list[], at least one.
+ *
+ ****************************************************************************/
+
+int aio_gather(FAR struct aio_container_s **list, FAR struct iovec *iov,
+               bool append);
+
+/****************************************************************************
+ * Name: aio_transfer
+ *
+ * Description:
+ *   Perform the read or write of the requests collected by aio_gather()
+ *   at the file offset of the first one, or at the end of the file for
+ *   appending writes.
+ *
+ * Returned Value:
+ *   The number of bytes transferred on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t aio_transfer(FAR struct aio_container_s **list,
+                     FAR const struct iovec *iov, int nlist, bool write,
+                     bool append);
+
+/****************************************************************************
+ * Name: aio_finish
+ *
+ * Description:
+ *   Complete the requests collected by aio_gather(): distribute the result
+ *   of their transfer among them in file order, release their containers
+ *   and notify their clients.
+ *
+ ****************************************************************************/
+
+void aio_finish(FAR struct aio_container_s **list, int nlist,
+                ssize_t result);
+
 /****************************************************************************
  * Name: aio_signal
  *
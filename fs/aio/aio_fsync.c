@@ -62,47 +62,20 @@
 static void aio_fsync_worker(FAR void *arg)
 {
   FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
-  FAR struct aiocb *aiocbp;
-  pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t prio;
-#endif
   int ret;
 
-  /* Get the information from the container, decant the AIO control block,
-   * and free the container before starting any I/O.  That will minimize
-   * the delays by any other threads waiting for a pre-allocated container.
-   */
-
-  DEBUGASSERT(aioc && aioc->aioc_aiocbp);
-  pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  prio   = aioc->aioc_prio;
-#endif
-  aiocbp = aioc_decant(aioc);
-
   /* Perform the fsync using aioc_filep */
 
+  DEBUGASSERT(aioc && aioc->aioc_aiocbp);
   ret = file_fsync(aioc->aioc_filep);
   if (ret < 0)
     {
       ferr("ERROR: file_fsync failed: %d\n", ret);
-      aiocbp->aio_result = ret;
     }
-  else
-    {
-      aiocbp->aio_result = OK;
-    }
-
-  /* Signal the client */
-
-  aio_signal(pid, aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
+  /* Set the result, free the container and signal the client */
 
-  lpwork_restorepriority(prio);
-#endif
+  aio_finish(&aioc, 1, ret);
 }
 
 /****************************************************************************
@@ -222,6 +195,7 @@ int aio_fsync(int op, FAR struct aiocb *aiocbp)
 
   /* Defer the work to the worker thread */
 
+  aioc->aioc_opcode = LIO_NOP;
   ret = aio_queue(aioc, aio_fsync_worker);
   if (ret < 0)
     {
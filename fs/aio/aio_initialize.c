@@ -151,13 +151,19 @@ FAR struct aio_container_s *aioc_alloc(void)
   int ret;
 
   /* Take a count from semaphore, thus guaranteeing that we have an AIO
-   * container set aside for us.
+   * container set aside for us.  The requests held for the rest of a
+   * lio_listio() list are queued first, the containers might all be
+   * theirs.
    */
 
-  ret = nxsem_wait_uninterruptible(&g_aioc_freesem);
-  if (ret < 0)
+  if (nxsem_trywait(&g_aioc_freesem) < 0)
     {
-      return NULL;
+      aio_release();
+      ret = nxsem_wait_uninterruptible(&g_aioc_freesem);
+      if (ret < 0)
+        {
+          return NULL;
+        }
     }
 
   /* Get our AIO container */
@@ -26,12 +26,16 @@
 
 #include <nuttx/config.h>
 
+#include <sys/param.h>
 #include <sched.h>
 #include <aio.h>
 #include <assert.h>
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/fs/fs.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/sched.h>
 #include <nuttx/wqueue.h>
 
 #include "aio/aio.h"
@@ -39,14 +43,30 @@
 #ifdef CONFIG_FS_AIO
 
 /****************************************************************************
- * Private Functions
+ * Private Data
+ ****************************************************************************/
+
+#if CONFIG_FS_AIO_NTHREADS > 0
+/* The dedicated AIO worker threads, started on first use */
+
+static FAR struct kwork_wqueue_s *g_aio_wqueue;
+#endif
+
+/* The number of requests held by aio_queue() */
+
+static int g_aio_nheld;
+
+/****************************************************************************
+ * Public Functions
  ****************************************************************************/
 
 /****************************************************************************
  * Name: aio_queue
  *
  * Description:
- *   Schedule the asynchronous I/O on the low priority work queue
+ *   Schedule the asynchronous I/O on the AIO worker threads, or on the low
+ *   priority work queue if there are none.  A request that is not the last
+ *   of a lio_listio() list is only held until aio_release().
  *
  * Input Parameters:
  *   arg - Worker argument.  In this case, a pointer to an instance of
@@ -62,7 +82,46 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
 {
   int ret;
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+  if (aioc->aioc_batched && aio_lock() >= 0)
+    {
+      aioc->aioc_held = worker;
+      g_aio_nheld++;
+      aio_unlock();
+      return OK;
+    }
+
+#if CONFIG_FS_AIO_NTHREADS > 0
+  ret = aio_lock();
+  if (ret >= 0)
+    {
+      if (g_aio_wqueue == NULL)
+        {
+          g_aio_wqueue = work_queue_create("aio", CONFIG_FS_AIO_PRIORITY,
+                                           NULL, CONFIG_FS_AIO_STACKSIZE,
+                                           CONFIG_FS_AIO_NTHREADS);
+        }
+
+      ret = -ENOMEM;
+      if (g_aio_wqueue != NULL)
+        {
+          ret = work_queue_wq(g_aio_wqueue, &aioc->aioc_work, worker,
+                              aioc, 0);
+        }
+
+      aio_unlock();
+    }
+
+  if (ret < 0)
+    {
+      FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
+      DEBUGASSERT(aiocbp);
+
+      aiocbp->aio_result = ret;
+      set_errno(-ret);
+      ret = ERROR;
+    }
+#else
+#ifdef AIO_PRIORITY_INHERITANCE
   /* Prohibit context switches until we complete the queuing */
 
   sched_lock();
@@ -82,7 +141,7 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
       FAR struct aiocb *aiocbp = aioc->aioc_aiocbp;
       DEBUGASSERT(aiocbp);
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_PRIORITY_INHERITANCE
       lpwork_restorepriority(aioc->aioc_prio);
 #endif
       aiocbp->aio_result = ret;
@@ -90,12 +149,312 @@ int aio_queue(FAR struct aio_container_s *aioc, worker_t worker)
       ret = ERROR;
     }
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_PRIORITY_INHERITANCE
   /* Now the low-priority work queue might run at its new priority */
 
   sched_unlock();
 #endif
+#endif
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: aio_release
+ *
+ * Description:
+ *   Queue the requests of the calling task held by aio_queue(), once the
+ *   last request of its lio_listio() list has been submitted.
+ *
+ ****************************************************************************/
+
+void aio_release(void)
+{
+  FAR struct aio_container_s *aioc;
+  FAR struct aio_container_s *next;
+  FAR struct aiocb *aiocbp;
+  worker_t worker;
+  pid_t pid;
+
+  if (g_aio_nheld == 0 || aio_lock() < 0)
+    {
+      return;
+    }
+
+  /* The workers cannot collect any of the list before it is all queued,
+   * as aio_gather() needs the lock held here.
+   */
+
+  pid = nxsched_getpid();
+  for (aioc = (FAR struct aio_container_s *)g_aio_pending.head;
+       aioc != NULL && g_aio_nheld > 0; aioc = next)
+    {
+      next = (FAR struct aio_container_s *)aioc->aioc_link.flink;
+      if (aioc->aioc_held == NULL || aioc->aioc_pid != pid)
+        {
+          continue;
+        }
+
+      worker              = aioc->aioc_held;
+      aioc->aioc_held     = NULL;
+      aioc->aioc_batched  = false;
+      g_aio_nheld--;
+
+      if (aio_queue(aioc, worker) < 0)
+        {
+          /* The submission has already succeeded, so report the failure
+           * like that of the transfer.
+           */
+
+          aiocbp = aioc_decant(aioc);
+          aio_signal(pid, aiocbp);
+        }
+    }
+
+  aio_unlock();
+}
+
+/****************************************************************************
+ * Name: aio_cancel_work
+ *
+ * Description:
+ *   Remove the queued work of a container before it starts.
+ *
+ * Returned Value:
+ *   Zero (OK) if the work was still queued or held and has been removed; a
+ *   negated errno value if it has already started.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+int aio_cancel_work(FAR struct aio_container_s *aioc)
+{
+  if (aioc->aioc_held != NULL)
+    {
+      aioc->aioc_held = NULL;
+      g_aio_nheld--;
+      return OK;
+    }
+
+#if CONFIG_FS_AIO_NTHREADS > 0
+  if (g_aio_wqueue == NULL)
+    {
+      return -ENOENT;
+    }
+
+  return work_cancel_wq(g_aio_wqueue, &aioc->aioc_work);
+#else
+  return work_cancel(LPWORK, &aioc->aioc_work);
+#endif
+}
+
+/****************************************************************************
+ * Name: aio_gather
+ *
+ * Description:
+ *   Collect the requests that can be performed together with list[0]: the
+ *   queued or held requests of the same kind on the same open file that
+ *   continue where the previous one ends.  Their work is removed from the
+ *   queue, so they are now owned by the caller.  iov[] is set up to
+ *   describe the buffers of all collected requests, in file order.
+ *
+ *   Appending writes ignore the file offset; the writes queued after
+ *   list[0] on the same file are collected in the order they were made.
+ *
+ * Input Parameters:
+ *   list   - Array of CONFIG_FS_AIO_MERGE entries; list[0] is the request
+ *            being started.
+ *   iov    - Array of CONFIG_FS_AIO_MERGE entries to receive the buffers.
+ *   append - True if the file was opened with O_APPEND.
+ *
+ * Returned Value:
+ *   The number of requests now in list[], at least one.
+ *
+ ****************************************************************************/
+
+int aio_gather(FAR struct aio_container_s **list, FAR struct iovec *iov,
+               bool append)
+{
+  FAR struct aio_container_s *aioc = list[0];
+  int nlist = 1;
+#if CONFIG_FS_AIO_MERGE > 1
+  FAR struct aio_container_s *next;
+  FAR dq_entry_t *entry;
+  off_t end;
+#endif
+
+  iov[0].iov_base = (FAR void *)aioc->aioc_aiocbp->aio_buf;
+  iov[0].iov_len  = aioc->aioc_aiocbp->aio_nbytes;
+
+#if CONFIG_FS_AIO_MERGE > 1
+  if (aio_lock() < 0)
+    {
+      return nlist;
+    }
+
+  /* Only the requests on the same file are looked at */
+
+  end   = aioc->aioc_aiocbp->aio_offset + aioc->aioc_aiocbp->aio_nbytes;
+  entry = dq_peek(&aioc->aioc_af->af_pending);
+
+  if (append)
+    {
+      entry = dq_next(&aioc->aioc_flink);
+    }
+
+  while (entry != NULL && nlist < CONFIG_FS_AIO_MERGE)
+    {
+      FAR struct aiocb *aiocbp;
+
+      next   = container_of(entry, struct aio_container_s, aioc_flink);
+      aiocbp = next->aioc_aiocbp;
+
+      /* Only requests whose work has not started yet can be taken over */
+
+      if (next != aioc && next->aioc_opcode == aioc->aioc_opcode &&
+          (append || aiocbp->aio_offset == end) &&
+          aiocbp->aio_nbytes > 0 && aio_cancel_work(next) >= 0)
+        {
+          list[nlist]          = next;
+          iov[nlist].iov_base  = (FAR void *)aiocbp->aio_buf;
+          iov[nlist].iov_len   = aiocbp->aio_nbytes;
+          nlist++;
+
+          /* Start over, the new end may be continued by a request that was
+           * passed over already.
+           */
+
+          if (!append)
+            {
+              end  += aiocbp->aio_nbytes;
+              entry = dq_peek(&aioc->aioc_af->af_pending);
+              continue;
+            }
+        }
+
+      entry = dq_next(entry);
+    }
+
+  aio_unlock();
+#endif
+
+  return nlist;
+}
+
+/****************************************************************************
+ * Name: aio_transfer
+ *
+ * Description:
+ *   Perform the read or write of the requests collected by aio_gather()
+ *   at the file offset of the first one, or at the end of the file for
+ *   appending writes.
+ *
+ * Returned Value:
+ *   The number of bytes transferred on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t aio_transfer(FAR struct aio_container_s **list,
+                     FAR const struct iovec *iov, int nlist, bool write,
+                     bool append)
+{
+  FAR struct file *filep = list[0]->aioc_filep;
+  off_t offset = list[0]->aioc_aiocbp->aio_offset;
+  off_t savepos;
+  off_t pos;
+  ssize_t ret;
+
+  if (append)
+    {
+      return file_writev(filep, iov, nlist);
+    }
+
+  if (nlist == 1)
+    {
+      return write ? file_pwrite(filep, iov[0].iov_base, iov[0].iov_len,
+                                 offset)
+                   : file_pread(filep, iov[0].iov_base, iov[0].iov_len,
+                                offset);
+    }
+
+  /* There is no positioned vectored I/O, do what file_pread() does */
+
+  savepos = file_seek(filep, 0, SEEK_CUR);
+  if (savepos < 0)
+    {
+      return savepos;
+    }
+
+  pos = file_seek(filep, offset, SEEK_SET);
+  if (pos < 0)
+    {
+      return pos;
+    }
+
+  ret = write ? file_writev(filep, iov, nlist)
+              : file_readv(filep, iov, nlist);
+
+  pos = file_seek(filep, savepos, SEEK_SET);
+  if (pos < 0 && ret >= 0)
+    {
+      ret = pos;
+    }
+
   return ret;
 }
 
+/****************************************************************************
+ * Name: aio_finish
+ *
+ * Description:
+ *   Complete the requests collected by aio_gather(): distribute the result
+ *   of their transfer among them in file order, release their containers
+ *   and notify their clients.
+ *
+ ****************************************************************************/
+
+void aio_finish(FAR struct aio_container_s **list, int nlist,
+                ssize_t result)
+{
+  FAR struct aiocb *aiocbp;
+  pid_t pid;
+#ifdef AIO_PRIORITY_INHERITANCE
+  uint8_t prio;
+#endif
+  int i;
+
+  for (i = 0; i < nlist; i++)
+    {
+      pid    = list[i]->aioc_pid;
+#ifdef AIO_PRIORITY_INHERITANCE
+      prio   = list[i]->aioc_prio;
+#endif
+      aiocbp = aioc_decant(list[i]);
+      DEBUGASSERT(aiocbp);
+
+      if (result < 0)
+        {
+          aiocbp->aio_result = result;
+        }
+      else
+        {
+          aiocbp->aio_result = MIN((size_t)result, aiocbp->aio_nbytes);
+          result -= aiocbp->aio_result;
+        }
+
+      /* Signal the client */
+
+      aio_signal(pid, aiocbp);
+
+#ifdef AIO_PRIORITY_INHERITANCE
+      /* Restore the low priority worker thread default priority */
+
+      lpwork_restorepriority(prio);
+#endif
+    }
+}
+
 #endif /* CONFIG_FS_AIO */
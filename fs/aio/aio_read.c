@@ -61,27 +61,13 @@
 
 static void aio_read_worker(FAR void *arg)
 {
-  FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
-  FAR struct aiocb *aiocbp;
-  pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t prio;
-#endif
-  ssize_t nread = 0;
-
-  /* Get the information from the container, decant the AIO control block,
-   * and free the container before starting any I/O.  That will minimize
-   * the delays by any other threads waiting for a pre-allocated container.
-   */
-
-  DEBUGASSERT(aioc && aioc->aioc_aiocbp);
-  pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  prio   = aioc->aioc_prio;
-#endif
-  aiocbp = aioc_decant(aioc);
+  FAR struct aio_container_s *list[CONFIG_FS_AIO_MERGE];
+  struct iovec iov[CONFIG_FS_AIO_MERGE];
+  ssize_t nread;
+  int nlist;
 
-  /* Perform the file read using:
+  /* Take over any queued reads that continue this one and perform them
+   * all in a single transfer using:
    *
    *   aioc_filep   - File structure pointer
    *   aio_buf      - Location of buffer
@@ -89,10 +75,10 @@ static void aio_read_worker(FAR void *arg)
    *   aio_offset   - File offset
    */
 
-  nread = file_pread(aioc->aioc_filep, (FAR void *)aiocbp->aio_buf,
-                     aiocbp->aio_nbytes, aiocbp->aio_offset);
-
-  /* Set the result of the read operation. */
+  DEBUGASSERT(arg != NULL);
+  list[0] = (FAR struct aio_container_s *)arg;
+  nlist   = aio_gather(list, iov, false);
+  nread   = aio_transfer(list, iov, nlist, false, false);
 
 #ifdef CONFIG_DEBUG_FS_ERROR
   if (nread < 0)
@@ -101,17 +87,9 @@ static void aio_read_worker(FAR void *arg)
     }
 #endif
 
-  aiocbp->aio_result = nread;
-
-  /* Signal the client */
-
-  aio_signal(pid, aiocbp);
+  /* Set the results, free the containers and signal the clients */
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
-
-  lpwork_restorepriority(prio);
-#endif
+  aio_finish(list, nlist, nread);
 }
 
 /****************************************************************************
@@ -217,14 +195,23 @@ static void aio_read_worker(FAR void *arg)
 int aio_read(FAR struct aiocb *aiocbp)
 {
   FAR struct aio_container_s *aioc;
-  int ret;
+  bool batched;
+  int ret = OK;
 
   DEBUGASSERT(aiocbp);
 
+  /* A request which is not part of a lio_listio() list, or which ends it,
+   * releases the requests held for the list, even if it fails itself.
+   */
+
+  batched = AIO_BATCHED(aiocbp);
+  aiocbp->aio_priv = NULL;
+
   if (aiocbp->aio_reqprio < 0)
     {
       set_errno(EINVAL);
-      return ERROR;
+      ret = ERROR;
+      goto out;
     }
 
   if (aiocbp->aio_fildes < 0)
@@ -234,7 +221,7 @@ int aio_read(FAR struct aiocb *aiocbp)
        */
 
       aiocbp->aio_result = -EBADF;
-      return OK;
+      goto out;
     }
 
   /* for aio_read, the aio_offset should be large or equal than 0 */
@@ -246,14 +233,13 @@ int aio_read(FAR struct aiocb *aiocbp)
        */
 
       aiocbp->aio_result = -EINVAL;
-      return OK;
+      goto out;
     }
 
   /* The result -EINPROGRESS means that the transfer has not yet completed */
 
   sigwork_init(&aiocbp->aio_sigwork);
   aiocbp->aio_result = -EINPROGRESS;
-  aiocbp->aio_priv   = NULL;
 
   /* Create a container for the AIO control block.  This may cause us to
    * block if there are insufficient resources to satisfy the request.
@@ -265,21 +251,29 @@ int aio_read(FAR struct aiocb *aiocbp)
       /* The errno has already been set (probably EBADF) */
 
       aiocbp->aio_result = -get_errno();
-      return ERROR;
+      ret = ERROR;
+      goto out;
     }
 
   /* Defer the work to the worker thread */
 
+  aioc->aioc_batched = batched;
+  aioc->aioc_opcode  = LIO_READ;
   ret = aio_queue(aioc, aio_read_worker);
   if (ret < 0)
     {
       /* The result and the errno have already been set */
 
       aioc_decant(aioc);
-      return ERROR;
     }
 
-  return OK;
+out:
+  if (!batched)
+    {
+      aio_release();
+    }
+
+  return ret;
 }
 
 #endif /* CONFIG_FS_AIO */
@@ -35,11 +35,68 @@
 #include <debug.h>
 
 #include <nuttx/signal.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/semaphore.h>
 
 #include "aio/aio.h"
 
 #ifdef CONFIG_FS_AIO
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_AIO_RING
+/* Serializes the AIO worker threads posting to the completion rings */
+
+static spinlock_t g_aio_ring_lock = SP_UNLOCKED;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_AIO_RING
+/****************************************************************************
+ * Name: aio_ring_post
+ *
+ * Description:
+ *   Post a completed AIO control block to the completion ring of the
+ *   client.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOSPC if the ring is full.
+ *
+ ****************************************************************************/
+
+static int aio_ring_post(FAR struct aio_ring_s *ring,
+                         FAR struct aiocb *aiocbp)
+{
+  irqstate_t flags;
+  unsigned int head;
+
+  flags = spin_lock_irqsave(&g_aio_ring_lock);
+
+  head = atomic_read(&ring->head);
+  if (head - atomic_read_acquire(&ring->tail) >= ring->nentries)
+    {
+      spin_unlock_irqrestore(&g_aio_ring_lock, flags);
+      atomic_fetch_add_relaxed(&ring->overflow, 1);
+      return -ENOSPC;
+    }
+
+  ring->entries[head & (ring->nentries - 1)] = aiocbp;
+  atomic_set_release(&ring->head, head + 1);
+
+  spin_unlock_irqrestore(&g_aio_ring_lock, flags);
+
+  /* One count per entry, so the reaper never misses a wake-up */
+
+  nxsem_post(&ring->avail);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -74,13 +131,30 @@ int aio_signal(pid_t pid, FAR struct aiocb *aiocbp)
 
   ret = OK; /* Assume success */
 
-  /* Signal the client */
+#ifdef CONFIG_FS_AIO_RING
+  /* Completions posted to a ring are not signalled at all, unless the
+   * ring is full.
+   */
 
-  ret = nxsig_notification(pid, &aiocbp->aio_sigevent,
-                           SI_ASYNCIO, &aiocbp->aio_sigwork);
-  if (ret < 0)
+  if (aiocbp->aio_sigevent.sigev_notify == SIGEV_AIORING)
     {
-      ferr("ERROR: nxsig_notification failed: %d\n", ret);
+      if (aio_ring_post(aiocbp->aio_sigevent.sigev_value.sival_ptr,
+                        aiocbp) >= 0)
+        {
+          return OK;
+        }
+    }
+  else
+#endif
+    {
+      /* Signal the client */
+
+      ret = nxsig_notification(pid, &aiocbp->aio_sigevent,
+                               SI_ASYNCIO, &aiocbp->aio_sigwork);
+      if (ret < 0)
+        {
+          ferr("ERROR: nxsig_notification failed: %d\n", ret);
+        }
     }
 
   /* Send the poll signal in any event in case the caller is waiting
@@ -63,83 +63,47 @@
 
 static void aio_write_worker(FAR void *arg)
 {
-  FAR struct aio_container_s *aioc = (FAR struct aio_container_s *)arg;
-  FAR struct aiocb *aiocbp;
-  pid_t pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  uint8_t prio;
-#endif
-  ssize_t nwritten = 0;
+  FAR struct aio_container_s *list[CONFIG_FS_AIO_MERGE];
+  struct iovec iov[CONFIG_FS_AIO_MERGE];
+  ssize_t nwritten;
+  bool append;
   int oflags;
+  int nlist;
 
-  /* Get the information from the container, decant the AIO control block,
-   * and free the container before starting any I/O.  That will minimize
-   * the delays by any other threads waiting for a pre-allocated container.
-   */
-
-  DEBUGASSERT(aioc && aioc->aioc_aiocbp);
-  pid    = aioc->aioc_pid;
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  prio   = aioc->aioc_prio;
-#endif
-  aiocbp = aioc_decant(aioc);
+  DEBUGASSERT(arg != NULL);
+  list[0] = (FAR struct aio_container_s *)arg;
 
   /* Call fcntl(F_GETFL) to get the file open mode. */
 
-  oflags = file_fcntl(aioc->aioc_filep, F_GETFL);
+  oflags = file_fcntl(list[0]->aioc_filep, F_GETFL);
   if (oflags < 0)
     {
       ferr("ERROR: file_fcntl failed: %d\n", oflags);
-      aiocbp->aio_result = oflags;
-      goto errout;
+      aio_finish(list, 1, oflags);
+      return;
     }
 
-  /* Perform the write using:
+  /* Take over any queued writes that continue this one and perform them
+   * all in a single transfer using:
    *
    *   aioc_filep   - File structure pointer
    *   aio_buf      - Location of buffer
    *   aio_nbytes   - Length of transfer
-   *   aio_offset   - File offset
+   *   aio_offset   - File offset, unless O_APPEND is set in the file open
+   *                  flags
    */
 
-  /* Check if O_APPEND is set in the file open flags */
-
-  if ((oflags & O_APPEND) != 0)
-    {
-      /* Append to the current file position */
-
-      nwritten = file_write(aioc->aioc_filep,
-                            (FAR const void *)aiocbp->aio_buf,
-                            aiocbp->aio_nbytes);
-    }
-  else
-    {
-      nwritten = file_pwrite(aioc->aioc_filep,
-                             (FAR const void *)aiocbp->aio_buf,
-                             aiocbp->aio_nbytes,
-                             aiocbp->aio_offset);
-    }
-
+  append   = (oflags & O_APPEND) != 0;
+  nlist    = aio_gather(list, iov, append);
+  nwritten = aio_transfer(list, iov, nlist, true, append);
   if (nwritten < 0)
     {
       ferr("ERROR: write/pwrite/send failed: %zd\n", nwritten);
     }
 
-  /* Save the result of the write */
-
-  aiocbp->aio_result = nwritten;
+  /* Set the results, free the containers and signal the clients */
 
-errout:
-
-  /* Signal the client */
-
-  aio_signal(pid, aiocbp);
-
-#ifdef CONFIG_PRIORITY_INHERITANCE
-  /* Restore the low priority worker thread default priority */
-
-  lpwork_restorepriority(prio);
-#endif
+  aio_finish(list, nlist, nwritten);
 }
 
 /****************************************************************************
@@ -247,21 +211,30 @@ errout:
 int aio_write(FAR struct aiocb *aiocbp)
 {
   FAR struct aio_container_s *aioc;
-  int ret;
+  bool batched;
+  int ret = OK;
   int flags;
 
   DEBUGASSERT(aiocbp);
 
+  /* A request which is not part of a lio_listio() list, or which ends it,
+   * releases the requests held for the list, even if it fails itself.
+   */
+
+  batched = AIO_BATCHED(aiocbp);
+  aiocbp->aio_priv = NULL;
+
   if (aiocbp->aio_reqprio < 0)
     {
       set_errno(EINVAL);
-      return ERROR;
+      ret = ERROR;
+      goto out;
     }
 
   if (aiocbp->aio_offset < 0)
     {
       aiocbp->aio_result = -EINVAL;
-      return OK;
+      goto out;
     }
 
   if (aiocbp->aio_fildes < 0)
@@ -271,7 +244,7 @@ int aio_write(FAR struct aiocb *aiocbp)
        */
 
       aiocbp->aio_result = -EBADF;
-      return OK;
+      goto out;
     }
 
   /* the aio_fildes that transferred in may be opened with O_RDONLY, for this
@@ -283,14 +256,13 @@ int aio_write(FAR struct aiocb *aiocbp)
   if ((flags & O_WRONLY) == 0)
     {
       aiocbp->aio_result = -EBADF;
-      return OK;
+      goto out;
     }
 
   /* The result -EINPROGRESS means that the transfer has not yet completed */
 
   sigwork_init(&aiocbp->aio_sigwork);
   aiocbp->aio_result = -EINPROGRESS;
-  aiocbp->aio_priv   = NULL;
 
   /* Create a container for the AIO control block.  This may cause us to
    * block if there are insufficient resources to satisfy the request.
@@ -302,21 +274,29 @@ int aio_write(FAR struct aiocb *aiocbp)
       /* The errno has already been set (probably EBADF) */
 
       aiocbp->aio_result = -get_errno();
-      return ERROR;
+      ret = ERROR;
+      goto out;
     }
 
   /* Defer the work to the worker thread */
 
+  aioc->aioc_batched = batched;
+  aioc->aioc_opcode  = LIO_WRITE;
   ret = aio_queue(aioc, aio_write_worker);
   if (ret < 0)
     {
       /* The result and the errno have already been set */
 
       aioc_decant(aioc);
-      return ERROR;
     }
 
-  return OK;
+out:
+  if (!batched)
+    {
+      aio_release();
+    }
+
+  return ret;
 }
 
 #endif /* CONFIG_FS_AIO */
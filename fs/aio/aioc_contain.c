@@ -37,6 +37,52 @@
 
 #ifdef CONFIG_FS_AIO
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The pending requests of each open file with requests pending */
+
+static struct aio_file_s g_aio_files[CONFIG_FS_NAIOC];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_file
+ *
+ * Description:
+ *   Find the pending requests on an open file, or an unused entry for
+ *   them.  As each container pending is on one file, there is always one.
+ *
+ * Assumptions:
+ *   The caller holds the AIO lock.
+ *
+ ****************************************************************************/
+
+static FAR struct aio_file_s *aio_file(FAR struct file *filep)
+{
+  FAR struct aio_file_s *unused = NULL;
+  int i;
+
+  for (i = 0; i < CONFIG_FS_NAIOC; i++)
+    {
+      if (g_aio_files[i].af_filep == filep)
+        {
+          return &g_aio_files[i];
+        }
+      else if (g_aio_files[i].af_filep == NULL && unused == NULL)
+        {
+          unused = &g_aio_files[i];
+        }
+    }
+
+  DEBUGASSERT(unused != NULL);
+  unused->af_filep = filep;
+  return unused;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -63,7 +109,7 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
   FAR struct aio_container_s *aioc;
   FAR struct file *filep;
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_PRIORITY_INHERITANCE
   struct sched_param param;
 #endif
   int ret;
@@ -95,7 +141,7 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
   aioc->aioc_filep  = filep;
   aioc->aioc_pid    = nxsched_getpid();
 
-#ifdef CONFIG_PRIORITY_INHERITANCE
+#ifdef AIO_PRIORITY_INHERITANCE
   DEBUGVERIFY(nxsched_get_param(aioc->aioc_pid, &param));
   aioc->aioc_prio   = param.sched_priority;
 #endif
@@ -109,7 +155,9 @@ FAR struct aio_container_s *aio_contain(FAR struct aiocb *aiocbp)
       goto err_putfilep;
     }
 
+  aioc->aioc_af = aio_file(filep);
   dq_addlast(&aioc->aioc_link, &g_aio_pending);
+  dq_addlast(&aioc->aioc_flink, &aioc->aioc_af->af_pending);
   aio_unlock();
 
   return aioc;
@@ -149,6 +197,11 @@ FAR struct aiocb *aioc_decant(FAR struct aio_container_s *aioc)
   if (ret >= 0)
     {
       dq_rem(&aioc->aioc_link, &g_aio_pending);
+      dq_rem(&aioc->aioc_flink, &aioc->aioc_af->af_pending);
+      if (dq_empty(&aioc->aioc_af->af_pending))
+        {
+          aioc->aioc_af->af_filep = NULL;
+        }
 
       /* De-cant the AIO control block and return the container to the
        * free list.
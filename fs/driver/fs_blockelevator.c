@@ -0,0 +1,518 @@
+/****************************************************************************
+ * fs/driver/fs_blockelevator.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Block request elevator.
+ *
+ * Requests are not delayed to give them a chance to merge.  A thread that
+ * finds the device idle issues its request at once; requests arriving
+ * while the device is busy queue up.  When the busy thread is done, it
+ * hands the device over to the first queued thread, which takes the whole
+ * queue, sorts it by direction and sector, and issues each run of
+ * adjacent requests as a single scatter-gather transfer.  So merging
+ * happens only under contention, which is where it pays off.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <sys/mount.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/list.h>
+#include <nuttx/mutex.h>
+#include <nuttx/semaphore.h>
+
+#include "inode/inode.h"
+#include "fs_heap.h"
+
+#ifdef CONFIG_FS_BLOCK_ELEVATOR
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct elv_req_s
+{
+  struct list_node node;     /* Link in the queue or in a batch */
+  FAR void *buffer;          /* Data to read or write */
+  blkcnt_t start;            /* First sector */
+  unsigned int nsectors;     /* Number of sectors */
+  bool write;                /* True for a write request */
+  bool dispatch;             /* Woken up to dispatch the queue */
+  ssize_t result;            /* Sectors transferred or negated errno */
+  sem_t done;                /* Posted on completion or hand-over */
+};
+
+struct elv_dev_s
+{
+  FAR struct inode *parent;  /* The underlying block driver */
+  size_t sectorsize;         /* Sector size of the parent */
+  mutex_t lock;              /* Protects the fields below */
+  struct list_node queue;    /* Requests waiting for the device */
+  bool busy;                 /* A thread is dispatching requests */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     elv_open(FAR struct inode *inode);
+static int     elv_close(FAR struct inode *inode);
+static ssize_t elv_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                        blkcnt_t start_sector, unsigned int nsectors);
+static ssize_t elv_write(FAR struct inode *inode,
+                         FAR const unsigned char *buffer,
+                         blkcnt_t start_sector, unsigned int nsectors);
+static int     elv_geometry(FAR struct inode *inode,
+                            FAR struct geometry *geometry);
+static int     elv_ioctl(FAR struct inode *inode, int cmd,
+                         unsigned long arg);
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int     elv_unlink(FAR struct inode *inode);
+#endif
+static ssize_t elv_readv(FAR struct inode *inode,
+                         FAR const struct iovec *iov, int iovcnt,
+                         blkcnt_t start_sector);
+static ssize_t elv_writev(FAR struct inode *inode,
+                          FAR const struct iovec *iov, int iovcnt,
+                          blkcnt_t start_sector);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_elv_bops =
+{
+  elv_open,      /* open     */
+  elv_close,     /* close    */
+  elv_read,      /* read     */
+  elv_write,     /* write    */
+  elv_geometry,  /* geometry */
+  elv_ioctl,     /* ioctl    */
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+  elv_unlink,    /* unlink   */
+#endif
+  elv_readv,     /* readv    */
+  elv_writev     /* writev   */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: elv_insert
+ *
+ * Description:
+ *   Insert a request in a batch, sorted by direction, then by sector.
+ *
+ ****************************************************************************/
+
+static void elv_insert(FAR struct list_node *batch,
+                       FAR struct elv_req_s *req)
+{
+  FAR struct elv_req_s *pos;
+
+  list_for_every_entry(batch, pos, struct elv_req_s, node)
+    {
+      if (pos->write > req->write ||
+          (pos->write == req->write && pos->start > req->start))
+        {
+          list_add_before(&pos->node, &req->node);
+          return;
+        }
+    }
+
+  list_add_tail(batch, &req->node);
+}
+
+/****************************************************************************
+ * Name: elv_dispatch
+ *
+ * Description:
+ *   Issue a sorted batch of requests, merging runs of adjacent ones, and
+ *   complete them.  The request of the calling thread, 'self', is
+ *   completed without waking anybody.
+ *
+ ****************************************************************************/
+
+static void elv_dispatch(FAR struct elv_dev_s *dev,
+                         FAR struct list_node *batch,
+                         FAR struct elv_req_s *self)
+{
+  struct iovec iov[CONFIG_FS_BLOCK_ELEVATOR_NIOV];
+  FAR struct elv_req_s *first;
+  FAR struct elv_req_s *req;
+  blkcnt_t next;
+  ssize_t ret;
+  int n;
+
+  while (!list_is_empty(batch))
+    {
+      /* Collect the run of adjacent requests at the head of the batch */
+
+      first = list_first_entry(batch, struct elv_req_s, node);
+      next  = first->start;
+      n     = 0;
+
+      list_for_every_entry(batch, req, struct elv_req_s, node)
+        {
+          if (n >= CONFIG_FS_BLOCK_ELEVATOR_NIOV ||
+              req->write != first->write || req->start != next)
+            {
+              break;
+            }
+
+          iov[n].iov_base = req->buffer;
+          iov[n].iov_len  = req->nsectors * dev->sectorsize;
+          next += req->nsectors;
+          n++;
+        }
+
+      if (first->write)
+        {
+          ret = block_writev(dev->parent, iov, n, first->start,
+                             dev->sectorsize);
+        }
+      else
+        {
+          ret = block_readv(dev->parent, iov, n, first->start,
+                            dev->sectorsize);
+        }
+
+      /* Complete the requests of the run, splitting a short transfer */
+
+      while (n-- > 0)
+        {
+          req = list_remove_head_type(batch, struct elv_req_s, node);
+          if (ret < 0)
+            {
+              req->result = ret;
+            }
+          else
+            {
+              req->result = MIN(ret, (ssize_t)req->nsectors);
+              ret        -= req->result;
+            }
+
+          if (req != self)
+            {
+              nxsem_post(&req->done);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: elv_submit
+ *
+ * Description:
+ *   Queue a request and wait for its completion, dispatching the queue if
+ *   the device is idle or if handed over by the previous dispatcher.
+ *
+ ****************************************************************************/
+
+static ssize_t elv_submit(FAR struct elv_dev_s *dev,
+                          FAR struct elv_req_s *req)
+{
+  FAR struct elv_req_s *next;
+  struct list_node batch;
+
+  nxsem_init(&req->done, 0, 0);
+  req->dispatch = false;
+
+  nxmutex_lock(&dev->lock);
+  list_add_tail(&dev->queue, &req->node);
+
+  if (dev->busy)
+    {
+      nxmutex_unlock(&dev->lock);
+      nxsem_wait_uninterruptible(&req->done);
+      if (!req->dispatch)
+        {
+          goto out;
+        }
+
+      nxmutex_lock(&dev->lock);
+    }
+
+  /* Take the whole queue, our own request included */
+
+  dev->busy = true;
+  list_initialize(&batch);
+  while ((next = list_remove_head_type(&dev->queue, struct elv_req_s,
+                                       node)) != NULL)
+    {
+      elv_insert(&batch, next);
+    }
+
+  nxmutex_unlock(&dev->lock);
+
+  elv_dispatch(dev, &batch, req);
+
+  /* Hand the device over to the first request queued meanwhile */
+
+  nxmutex_lock(&dev->lock);
+  next = list_peek_head_type(&dev->queue, struct elv_req_s, node);
+  if (next != NULL)
+    {
+      next->dispatch = true;
+      nxsem_post(&next->done);
+    }
+  else
+    {
+      dev->busy = false;
+    }
+
+  nxmutex_unlock(&dev->lock);
+
+out:
+  nxsem_destroy(&req->done);
+  return req->result;
+}
+
+/****************************************************************************
+ * Name: elv_open
+ ****************************************************************************/
+
+static int elv_open(FAR struct inode *inode)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+
+  if (parent->u.i_bops->open)
+    {
+      return parent->u.i_bops->open(parent);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: elv_close
+ ****************************************************************************/
+
+static int elv_close(FAR struct inode *inode)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+
+  if (parent->u.i_bops->close)
+    {
+      return parent->u.i_bops->close(parent);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: elv_read
+ ****************************************************************************/
+
+static ssize_t elv_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                        blkcnt_t start_sector, unsigned int nsectors)
+{
+  struct elv_req_s req;
+
+  req.buffer   = buffer;
+  req.start    = start_sector;
+  req.nsectors = nsectors;
+  req.write    = false;
+
+  return elv_submit(inode->i_private, &req);
+}
+
+/****************************************************************************
+ * Name: elv_write
+ ****************************************************************************/
+
+static ssize_t elv_write(FAR struct inode *inode,
+                         FAR const unsigned char *buffer,
+                         blkcnt_t start_sector, unsigned int nsectors)
+{
+  struct elv_req_s req;
+
+  req.buffer   = (FAR void *)buffer;
+  req.start    = start_sector;
+  req.nsectors = nsectors;
+  req.write    = true;
+
+  return elv_submit(inode->i_private, &req);
+}
+
+/****************************************************************************
+ * Name: elv_readv/elv_writev
+ *
+ * Description:
+ *   Scatter-gather requests are already merged by the caller, and go
+ *   straight to the parent.
+ *
+ ****************************************************************************/
+
+static ssize_t elv_readv(FAR struct inode *inode,
+                         FAR const struct iovec *iov, int iovcnt,
+                         blkcnt_t start_sector)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+
+  return block_readv(dev->parent, iov, iovcnt, start_sector,
+                     dev->sectorsize);
+}
+
+static ssize_t elv_writev(FAR struct inode *inode,
+                          FAR const struct iovec *iov, int iovcnt,
+                          blkcnt_t start_sector)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+
+  return block_writev(dev->parent, iov, iovcnt, start_sector,
+                      dev->sectorsize);
+}
+
+/****************************************************************************
+ * Name: elv_geometry
+ ****************************************************************************/
+
+static int elv_geometry(FAR struct inode *inode,
+                        FAR struct geometry *geometry)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+
+  return parent->u.i_bops->geometry(parent, geometry);
+}
+
+/****************************************************************************
+ * Name: elv_ioctl
+ ****************************************************************************/
+
+static int elv_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+  FAR struct inode *parent = dev->parent;
+
+  if (parent->u.i_bops->ioctl)
+    {
+      return parent->u.i_bops->ioctl(parent, cmd, arg);
+    }
+
+  return -ENOTTY;
+}
+
+/****************************************************************************
+ * Name: elv_unlink
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
+static int elv_unlink(FAR struct inode *inode)
+{
+  FAR struct elv_dev_s *dev = inode->i_private;
+
+  inode_release(dev->parent);
+  nxmutex_destroy(&dev->lock);
+  fs_heap_free(dev);
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: register_blockelevator
+ *
+ * Description:
+ *   Register a block driver at 'path' that forwards to the block driver
+ *   'parent', merging requests to adjacent sectors issued concurrently by
+ *   different threads into single scatter-gather requests.
+ *
+ ****************************************************************************/
+
+int register_blockelevator(FAR const char *path, mode_t mode,
+                           FAR const char *parent)
+{
+  FAR struct elv_dev_s *dev;
+  FAR struct inode *inode;
+  struct geometry geo;
+  int ret;
+
+  if (mode & (S_IWOTH | S_IWGRP | S_IWUSR))
+    {
+      ret = find_blockdriver(parent, 0, &inode);
+    }
+  else
+    {
+      ret = find_blockdriver(parent, MS_RDONLY, &inode);
+    }
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = inode->u.i_bops->geometry ?
+        inode->u.i_bops->geometry(inode, &geo) : -ENOTTY;
+  if (ret < 0 || geo.geo_sectorsize == 0)
+    {
+      ret = ret < 0 ? ret : -EINVAL;
+      goto errout_with_inode;
+    }
+
+  dev = fs_heap_zalloc(sizeof(*dev));
+  if (dev == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_inode;
+    }
+
+  dev->parent     = inode;
+  dev->sectorsize = geo.geo_sectorsize;
+  nxmutex_init(&dev->lock);
+  list_initialize(&dev->queue);
+
+  /* The reference taken by find_blockdriver() is kept until unlink */
+
+  ret = register_blockdriver(path, &g_elv_bops, mode, dev);
+  if (ret < 0)
+    {
+      nxmutex_destroy(&dev->lock);
+      fs_heap_free(dev);
+      goto errout_with_inode;
+    }
+
+  return OK;
+
+errout_with_inode:
+  inode_release(inode);
+  return ret;
+}
+
+#endif /* CONFIG_FS_BLOCK_ELEVATOR */
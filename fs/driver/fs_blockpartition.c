@@ -69,6 +69,12 @@ static int     part_ioctl(FAR struct inode *inode, int cmd,
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
 static int     part_unlink(FAR struct inode *inode);
 #endif
+static ssize_t part_readv(FAR struct inode *inode,
+                          FAR const struct iovec *iov, int iovcnt,
+                          blkcnt_t start_sector);
+static ssize_t part_writev(FAR struct inode *inode,
+                           FAR const struct iovec *iov, int iovcnt,
+                           blkcnt_t start_sector);
 
 /****************************************************************************
  * Private Data
@@ -81,10 +87,12 @@ static const struct block_operations g_part_bops =
   part_read,     /* read     */
   part_write,    /* write    */
   part_geometry, /* geometry */
-  part_ioctl     /* ioctl    */
+  part_ioctl,    /* ioctl    */
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
-  , part_unlink  /* unlink   */
+  part_unlink,   /* unlink   */
 #endif
+  part_readv,    /* readv    */
+  part_writev    /* writev   */
 };
 
 /****************************************************************************
@@ -182,6 +190,77 @@ static ssize_t part_write(FAR struct inode *inode,
   return parent->u.i_bops->write(parent, buffer, start_sector, nsectors);
 }
 
+/****************************************************************************
+ * Name: part_check_iov
+ *
+ * Description:
+ *   Check that a scatter-gather request lies within the partition.
+ *
+ ****************************************************************************/
+
+static int part_check_iov(FAR struct part_struct_s *dev,
+                          FAR const struct iovec *iov, int iovcnt,
+                          blkcnt_t start_sector)
+{
+  blkcnt_t nsectors = 0;
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      nsectors += iov[i].iov_len / dev->sectorsize;
+    }
+
+  return start_sector + nsectors > dev->nsectors ? -EINVAL : OK;
+}
+
+/****************************************************************************
+ * Name: part_readv
+ *
+ * Description:  Read a run of sectors into several buffers
+ *
+ ****************************************************************************/
+
+static ssize_t part_readv(FAR struct inode *inode,
+                          FAR const struct iovec *iov, int iovcnt,
+                          blkcnt_t start_sector)
+{
+  FAR struct part_struct_s *dev = inode->i_private;
+  int ret;
+
+  ret = part_check_iov(dev, iov, iovcnt, start_sector);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return block_readv(dev->parent, iov, iovcnt,
+                     start_sector + dev->firstsector, dev->sectorsize);
+}
+
+/****************************************************************************
+ * Name: part_writev
+ *
+ * Description:  Write a run of sectors from several buffers
+ *
+ ****************************************************************************/
+
+static ssize_t part_writev(FAR struct inode *inode,
+                           FAR const struct iovec *iov, int iovcnt,
+                           blkcnt_t start_sector)
+{
+  FAR struct part_struct_s *dev = inode->i_private;
+  int ret;
+
+  ret = part_check_iov(dev, iov, iovcnt, start_sector);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return block_writev(dev->parent, iov, iovcnt,
+                      start_sector + dev->firstsector, dev->sectorsize);
+}
+
 /****************************************************************************
  * Name: part_geometry
  *
@@ -0,0 +1,138 @@
+/****************************************************************************
+ * fs/driver/fs_blockvector.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <sys/uio.h>
+
+#include <nuttx/fs/fs.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: block_rwv
+ *
+ * Description:
+ *   Transfer each buffer with the driver read/write method.
+ *
+ ****************************************************************************/
+
+static ssize_t block_rwv(FAR struct inode *inode,
+                         FAR const struct iovec *iov, int iovcnt,
+                         blkcnt_t start_sector, size_t sectorsize,
+                         bool write)
+{
+  FAR const struct block_operations *bops = inode->u.i_bops;
+  ssize_t total = 0;
+  ssize_t ret;
+  int i;
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      unsigned int nsectors = iov[i].iov_len / sectorsize;
+
+      if (write)
+        {
+          ret = bops->write(inode, iov[i].iov_base, start_sector + total,
+                            nsectors);
+        }
+      else
+        {
+          ret = bops->read(inode, iov[i].iov_base, start_sector + total,
+                           nsectors);
+        }
+
+      if (ret < 0)
+        {
+          return total > 0 ? total : ret;
+        }
+
+      total += ret;
+      if (ret < (ssize_t)nsectors)
+        {
+          break;
+        }
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: block_readv
+ *
+ * Description:
+ *   Read a run of sectors into several buffers, each a whole number of
+ *   sectors long.
+ *
+ ****************************************************************************/
+
+ssize_t block_readv(FAR struct inode *inode, FAR const struct iovec *iov,
+                    int iovcnt, blkcnt_t start_sector, size_t sectorsize)
+{
+  if (inode->u.i_bops->readv != NULL)
+    {
+      return inode->u.i_bops->readv(inode, iov, iovcnt, start_sector);
+    }
+
+  if (inode->u.i_bops->read == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return block_rwv(inode, iov, iovcnt, start_sector, sectorsize, false);
+}
+
+/****************************************************************************
+ * Name: block_writev
+ *
+ * Description:
+ *   Write a run of sectors from several buffers, each a whole number of
+ *   sectors long.
+ *
+ ****************************************************************************/
+
+ssize_t block_writev(FAR struct inode *inode, FAR const struct iovec *iov,
+                     int iovcnt, blkcnt_t start_sector, size_t sectorsize)
+{
+  if (inode->u.i_bops->writev != NULL)
+    {
+      return inode->u.i_bops->writev(inode, iov, iovcnt, start_sector);
+    }
+
+  if (inode->u.i_bops->write == NULL)
+    {
+      return -EACCES;
+    }
+
+  return block_rwv(inode, iov, iovcnt, start_sector, sectorsize, true);
+}
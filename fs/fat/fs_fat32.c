@@ -30,6 +30,7 @@
 #include <sys/stat.h>
 #include <sys/statfs.h>
 #include <sys/mount.h>
+#include <sys/param.h>
 
 #include <stdlib.h>
 #include <unistd.h>
@@ -42,6 +43,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/fat.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "inode/inode.h"
 #include "fs_fat32.h"
@@ -389,6 +391,19 @@ static int fat_open(FAR struct file *filep, FAR const char *relpath,
         }
     }
 
+#ifdef CONFIG_FS_PAGECACHE
+  /* Serve the file data through the VFS page cache */
+
+  ret = pagecache_attach(filep, FAT_CACHEKEY(fs, ff->ff_dirsector,
+                                             ff->ff_dirindex),
+                         NULL, ff->ff_size);
+  if (ret < 0)
+    {
+      fat_close(filep);
+      return ret;
+    }
+#endif
+
   return OK;
 
   /* Error exits -- goto's are nasty things, but they sure can make error
@@ -622,6 +637,25 @@ static int fat_get_sectors(FAR struct file *filep, bool read)
 
   /* Traverse the existing chain */
 
+#ifdef CONFIG_FAT_EXTENTMAP
+  i = MIN(num_clu, new_num_clu);
+  if (num_traversed < i)
+    {
+      /* Look the cluster up in the extent map of the file, or continue
+       * from the cluster already reached beyond it.
+       */
+
+      cluster = fat_ffcluster(fs, ff, i - 1, num_traversed - 1, cluster);
+      if (cluster < 0)
+        {
+          return cluster;
+        }
+    }
+  else
+    {
+      i = num_traversed;
+    }
+#else
   for (i = num_traversed; i < num_clu && i < new_num_clu; i++)
     {
       cluster = fat_getcluster(fs, cluster);
@@ -633,6 +667,7 @@ static int fat_get_sectors(FAR struct file *filep, bool read)
           return -EIO;
         }
     }
+#endif
 
   if (read)
     {
@@ -1599,6 +1634,9 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
   newff->ff_startcluster     = oldff->ff_startcluster;     /* Start cluster of file on media */
   newff->ff_currentsector    = oldff->ff_currentsector;    /* Current sector */
   newff->ff_cachesector      = 0;                          /* Sector in file buffer */
+#ifdef CONFIG_FAT_EXTENTMAP
+  newff->ff_nextents         = 0;                          /* Extent map is rebuilt */
+#endif
 
   /* Attach the private date to the struct file instance */
 
@@ -2326,6 +2364,10 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
         }
     }
 
+  /* Write back any FAT sectors still cached */
+
+  fat_fatcacheflush(fs);
+
   /* Unmount ... close the block driver */
 
   if (fs->fs_blkdriver)
@@ -2353,6 +2395,7 @@ static int fat_unbind(FAR void *handle, FAR struct inode **blkdriver,
 
   /* Release the mountpoint private data */
 
+  fat_fatcachefree(fs);
   if (fs->fs_buffer)
     {
       fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
@@ -2438,6 +2481,9 @@ errout_with_lock:
 static int fat_unlink(FAR struct inode *mountpt, FAR const char *relpath)
 {
   FAR struct fat_mountpt_s *fs;
+#ifdef CONFIG_FS_PAGECACHE
+  struct fat_dirinfo_s dirinfo;
+#endif
   int ret;
 
   /* Sanity checks */
@@ -2464,6 +2510,19 @@ static int fat_unlink(FAR struct inode *mountpt, FAR const char *relpath)
        * open reference to the file is closed.
        */
 
+#ifdef CONFIG_FS_PAGECACHE
+      /* The directory entry may be reused by another file, forget the
+       * pages cached under its location.
+       */
+
+      if (fat_finddirentry(fs, &dirinfo, relpath) == OK)
+        {
+          pagecache_invalidate(mountpt,
+                               FAT_CACHEKEY(fs, fs->fs_currentsector,
+                                            dirinfo.dir.fd_index), NULL);
+        }
+#endif
+
       /* Remove the file
        *
        * TODO: Need to defer deleting cluster chain if the file is open.
@@ -2811,6 +2870,13 @@ static int fat_rename(FAR struct inode *mountpt, FAR const char *oldrelpath,
       goto errout_with_lock;
     }
 
+#ifdef CONFIG_FS_PAGECACHE
+  /* The file moves to a new directory entry and the old one is freed */
+
+  pagecache_invalidate(mountpt, FAT_CACHEKEY(fs, fs->fs_currentsector,
+                                             dirinfo.dir.fd_index), NULL);
+#endif
+
   /* Save the information that will need to recover the directory sector and
    * directory entry offset to the old directory.
    *
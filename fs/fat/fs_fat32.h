@@ -267,6 +267,10 @@
 #define DIRSEC_NDIRS(f)     (((f)->fs_hwsectorsize) >> 5)
 #define DIRSEC_BYTENDX(f,i) (((i) & DIRSEC_NDXMASK(f)) << 5)
 
+/* The page cache identifies a file by the location of its directory entry */
+
+#define FAT_CACHEKEY(f,s,i) (((uint64_t)(s) << 16) | ((i) & DIRSEC_NDXMASK(f)))
+
 #define SEC_NDXMASK(f)      ((f)->fs_hwsectorsize - 1)
 #define SEC_NSECTORS(f,n)   ((n) / (f)->fs_hwsectorsize)
 
@@ -891,7 +895,36 @@ struct fat_mountpt_s
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
   uint8_t *fs_buffer;              /* This is an allocated buffer to hold one
                                     * sector from the device */
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+
+  /* Dedicated cache of FAT sectors: the sector held by each entry (0 if
+   * none) and the time of its last use, for LRU replacement.
+   */
+
+  uint8_t *fs_fatbuffer;
+  off_t    fs_fatsector[CONFIG_FAT_FATCACHE_NSECTORS];
+  uint32_t fs_fatstamp[CONFIG_FAT_FATCACHE_NSECTORS];
+  uint32_t fs_fatclock;            /* Use counter for LRU replacement */
+  uint32_t fs_fatdirty;            /* Bitset of dirty FAT cache sectors */
+#endif
+#ifdef CONFIG_FAT_EXTENTMAP
+  uint32_t fs_chaingen;            /* Incremented whenever clusters are freed */
+#endif
+#ifdef CONFIG_FAT_FREEMAP
+  uint32_t *fs_freemap;            /* Bitmap of allocated clusters */
+#endif
+};
+
+#ifdef CONFIG_FAT_EXTENTMAP
+/* One run of physically contiguous clusters of a file */
+
+struct fat_extent_s
+{
+  uint32_t fe_fileclus;            /* Index of the first cluster in the file */
+  uint32_t fe_cluster;             /* First cluster of the run on the volume */
+  uint32_t fe_count;               /* Number of clusters in the run */
 };
+#endif
 
 /* This structure represents on open file under the mountpoint.  An instance
  * of this structure is retained as struct file specific information on each
@@ -913,6 +946,11 @@ struct fat_file_s
   off_t    ff_cachesector;         /* Current sector in the file buffer */
   off_t    ff_pos;                 /* Current position in the file */
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
+#ifdef CONFIG_FAT_EXTENTMAP
+  uint32_t ff_extentgen;           /* fs_chaingen when the map was built */
+  uint16_t ff_nextents;            /* Number of valid entries in ff_extents */
+  struct fat_extent_s ff_extents[CONFIG_FAT_EXTENTMAP_NEXTENTS];
+#endif
 };
 
 /* This structure holds the sequence of directory entries used by one
@@ -1055,6 +1093,12 @@ EXTERN int32_t fat_extendchain(FAR struct fat_mountpt_s *fs,
 
 #define fat_createchain(fs) fat_extendchain(fs, 0)
 
+#ifdef CONFIG_FAT_EXTENTMAP
+EXTERN int32_t fat_ffcluster(FAR struct fat_mountpt_s *fs,
+                             FAR struct fat_file_s *ff, uint32_t index,
+                             uint32_t hintindex, uint32_t hint);
+#endif
+
 /* Help for traversing directory trees and accessing directory entries */
 
 EXTERN int    fat_nextdirentry(FAR struct fat_mountpt_s *fs,
@@ -1100,6 +1144,11 @@ EXTERN int    fat_ffcacheread(FAR struct fat_mountpt_s *fs,
 EXTERN int    fat_ffcacheinvalidate(FAR struct fat_mountpt_s *fs,
                                     FAR struct fat_file_s *ff);
 
+/* FAT sector cache and free cluster bitmap */
+
+EXTERN int    fat_fatcacheflush(FAR struct fat_mountpt_s *fs);
+EXTERN void   fat_fatcachefree(FAR struct fat_mountpt_s *fs);
+
 /* FSINFO sector support */
 
 EXTERN int    fat_updatefsinfo(FAR struct fat_mountpt_s *fs);
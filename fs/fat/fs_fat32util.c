@@ -27,11 +27,13 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <sys/param.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <time.h>
 #include <assert.h>
 #include <errno.h>
@@ -270,6 +272,275 @@ static int fat_checkbootrecord(struct fat_mountpt_s *fs)
   return OK;
 }
 
+/****************************************************************************
+ * Name: fat_fatcachewrite
+ *
+ * Description:
+ *   Write back one FAT cache sector, if dirty, to every copy of the FAT.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+static int fat_fatcachewrite(FAR struct fat_mountpt_s *fs, int index)
+{
+  FAR uint8_t *buffer;
+  off_t sector;
+  int ret;
+  int i;
+
+  if ((fs->fs_fatdirty & (UINT32_C(1) << index)) == 0)
+    {
+      return OK;
+    }
+
+  buffer = fs->fs_fatbuffer + index * fs->fs_hwsectorsize;
+  sector = fs->fs_fatsector[index];
+
+  for (i = 0; i < fs->fs_fatnumfats; i++)
+    {
+      ret = fat_hwwrite(fs, buffer, sector, 1);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      sector += fs->fs_nfatsects;
+    }
+
+  fs->fs_fatdirty &= ~(UINT32_C(1) << index);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_fatsector
+ *
+ * Description:
+ *   Return a buffer holding the FAT sector 'sector', reading it first if
+ *   necessary.  If 'dirty' is true, the caller is about to modify the
+ *   sector, which will then be written to every copy of the FAT when it is
+ *   flushed.
+ *
+ *   FAT sectors are kept in the dedicated FAT cache so that walking a
+ *   cluster chain does not evict the directory sector in fs_buffer.  If
+ *   there is no FAT cache, fs_buffer is used.
+ *
+ ****************************************************************************/
+
+static int fat_fatsector(FAR struct fat_mountpt_s *fs, off_t sector,
+                         bool dirty, FAR uint8_t **buffer)
+{
+  int ret;
+
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  if (fs->fs_fatbuffer != NULL)
+    {
+      int victim = 0;
+      int i;
+
+      /* Look for the sector, remembering the least recently used one */
+
+      for (i = 0; i < CONFIG_FAT_FATCACHE_NSECTORS; i++)
+        {
+          if (fs->fs_fatsector[i] == sector)
+            {
+              break;
+            }
+
+          if (fs->fs_fatstamp[i] < fs->fs_fatstamp[victim])
+            {
+              victim = i;
+            }
+        }
+
+      if (i >= CONFIG_FAT_FATCACHE_NSECTORS)
+        {
+          /* Not cached.  Replace the least recently used sector */
+
+          i   = victim;
+          ret = fat_fatcachewrite(fs, i);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          fs->fs_fatsector[i] = 0;
+          ret = fat_hwread(fs, fs->fs_fatbuffer + i * fs->fs_hwsectorsize,
+                           sector, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          fs->fs_fatsector[i] = sector;
+        }
+
+      fs->fs_fatstamp[i] = ++fs->fs_fatclock;
+      if (dirty)
+        {
+          fs->fs_fatdirty |= UINT32_C(1) << i;
+        }
+
+      *buffer = fs->fs_fatbuffer + i * fs->fs_hwsectorsize;
+      return OK;
+    }
+#endif
+
+  ret = fat_fscacheread(fs, sector);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (dirty)
+    {
+      fs->fs_dirty = true;
+    }
+
+  *buffer = fs->fs_buffer;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freemapset
+ *
+ * Description:
+ *   Record whether a cluster is allocated in the free cluster bitmap.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FAT_FREEMAP
+static void fat_freemapset(FAR struct fat_mountpt_s *fs, uint32_t cluster,
+                           bool used)
+{
+  if (used)
+    {
+      fs->fs_freemap[cluster >> 5] |= UINT32_C(1) << (cluster & 31);
+    }
+  else
+    {
+      fs->fs_freemap[cluster >> 5] &= ~(UINT32_C(1) << (cluster & 31));
+    }
+}
+
+/****************************************************************************
+ * Name: fat_freemapbuild
+ *
+ * Description:
+ *   Build the free cluster bitmap with one pass over the FAT.  The exact
+ *   count of free clusters comes for free and refreshes the FSINFO value.
+ *
+ ****************************************************************************/
+
+static int fat_freemapbuild(FAR struct fat_mountpt_s *fs)
+{
+  FAR uint32_t *map;
+  uint32_t nfreeclusters = 0;
+  uint32_t nwords;
+  uint32_t cluster;
+  off_t next;
+
+  nwords = (fs->fs_nclusters + 2 + 31) / 32;
+  map    = fs_heap_zalloc(nwords * sizeof(uint32_t));
+  if (map == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* Clusters 0 and 1 and the padding past the last cluster never exist */
+
+  fs->fs_freemap = map;
+  fat_freemapset(fs, 0, true);
+  fat_freemapset(fs, 1, true);
+  for (cluster = fs->fs_nclusters + 2; cluster < nwords * 32; cluster++)
+    {
+      fat_freemapset(fs, cluster, true);
+    }
+
+  for (cluster = 2; cluster < fs->fs_nclusters + 2; cluster++)
+    {
+      next = fat_getcluster(fs, cluster);
+      if (next < 0)
+        {
+          fs->fs_freemap = NULL;
+          fs_heap_free(map);
+          return (int)next;
+        }
+
+      if (next != 0)
+        {
+          fat_freemapset(fs, cluster, true);
+        }
+      else
+        {
+          nfreeclusters++;
+        }
+    }
+
+  if (fs->fs_fsifreecount != nfreeclusters)
+    {
+      fs->fs_fsifreecount = nfreeclusters;
+      if (fs->fs_type == FSTYPE_FAT32)
+        {
+          fs->fs_fsidirty = true;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freemapfind
+ *
+ * Description:
+ *   Find a free cluster in the bitmap, searching upward from the cluster
+ *   after 'start' and then wrapping around up to 'start'.
+ *
+ * Returned Value:
+ *   The free cluster number, or 0 if there is none.
+ *
+ ****************************************************************************/
+
+static uint32_t fat_freemapfind(FAR struct fat_mountpt_s *fs,
+                                uint32_t start)
+{
+  uint32_t end = fs->fs_nclusters + 2;
+  uint32_t cluster = start + 1;
+  int pass;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      while (cluster < end)
+        {
+          /* Treat the bits below 'cluster' in this word as allocated */
+
+          uint32_t word = fs->fs_freemap[cluster >> 5] |
+                          ((UINT32_C(1) << (cluster & 31)) - 1);
+
+          if (word != UINT32_MAX)
+            {
+              cluster = (cluster & ~UINT32_C(31)) + ffs((int)~word) - 1;
+              if (cluster < end)
+                {
+                  return cluster;
+                }
+
+              break;
+            }
+
+          cluster = (cluster & ~UINT32_C(31)) + 32;
+        }
+
+      /* Wrap around to the first cluster */
+
+      cluster = 2;
+      end     = MIN(start + 1, fs->fs_nclusters + 2);
+    }
+
+  return 0;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -520,6 +791,19 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
       goto errout;
     }
 
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  /* Allocate the FAT sector cache.  Without it FAT sectors simply share
+   * fs_buffer, so this is not fatal.
+   */
+
+  fs->fs_fatbuffer = (FAR uint8_t *)
+    fat_io_alloc(CONFIG_FAT_FATCACHE_NSECTORS * fs->fs_hwsectorsize);
+  memset(fs->fs_fatsector, 0, sizeof(fs->fs_fatsector));
+  memset(fs->fs_fatstamp, 0, sizeof(fs->fs_fatstamp));
+  fs->fs_fatclock = 0;
+  fs->fs_fatdirty = 0;
+#endif
+
   /* Search FAT boot record on the drive.  First check the MBR at sector
    * zero.  This could be either the boot record or a partition that refers
    * to the boot record.
@@ -658,6 +942,7 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   return OK;
 
 errout_with_buffer:
+  fat_fatcachefree(fs);
   fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
   fs->fs_buffer = NULL;
 
@@ -822,6 +1107,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
         {
           case FSTYPE_FAT12 :
             {
+              FAR uint8_t  *buffer;
               off_t        fatsector;
               unsigned int fatoffset;
               unsigned int cluster;
@@ -836,7 +1122,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
 
               /* Read the sector at this offset */
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatsector(fs, fatsector, false, &buffer) < 0)
                 {
                   /* Read error */
 
@@ -846,7 +1132,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
               /* Get the first, LS byte of the cluster from the FAT */
 
               fatindex = fatoffset & SEC_NDXMASK(fs);
-              cluster  = fs->fs_buffer[fatindex];
+              cluster  = buffer[fatindex];
 
               /* With FAT12, the second byte of the cluster number may lie in
                * a different sector than the first byte.
@@ -858,7 +1144,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
                   fatsector++;
                   fatindex = 0;
 
-                  if (fat_fscacheread(fs, fatsector) < 0)
+                  if (fat_fatsector(fs, fatsector, false, &buffer) < 0)
                     {
                       /* Read error */
 
@@ -871,7 +1157,7 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
                * on the fact that the byte stream is little-endian.
                */
 
-              cluster |= (unsigned int)fs->fs_buffer[fatindex] << 8;
+              cluster |= (unsigned int)buffer[fatindex] << 8;
 
               /* Now, pick out the correct 12 bit cluster start sector
                * value.
@@ -901,15 +1187,16 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
               off_t        fatsector = fs->fs_fatbase +
                                        SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
+              FAR uint8_t  *buffer;
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatsector(fs, fatsector, false, &buffer) < 0)
                 {
                   /* Read error */
 
                   break;
                 }
 
-              return FAT_GETFAT16(fs->fs_buffer, fatindex);
+              return FAT_GETFAT16(buffer, fatindex);
             }
 
           case FSTYPE_FAT32 :
@@ -920,15 +1207,16 @@ off_t fat_getcluster(struct fat_mountpt_s *fs, uint32_t clusterno)
               off_t        fatsector = fs->fs_fatbase +
                                        SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
+              FAR uint8_t  *buffer;
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatsector(fs, fatsector, false, &buffer) < 0)
                 {
                   /* Read error */
 
                   break;
                 }
 
-              return FAT_GETFAT32(fs->fs_buffer, fatindex) & 0x0fffffff;
+              return FAT_GETFAT32(buffer, fatindex) & 0x0fffffff;
             }
 
           default:
@@ -966,6 +1254,7 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
         {
           case FSTYPE_FAT12 :
             {
+              FAR uint8_t  *buffer;
               off_t        fatsector;
               unsigned int fatoffset;
               unsigned int fatindex;
@@ -980,7 +1269,7 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
 
               /* Make sure that the sector at this offset is in the cache */
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatsector(fs, fatsector, true, &buffer) < 0)
                 {
                   /* Read error */
 
@@ -996,7 +1285,7 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                 {
                   /* Save the LS four bits of the next cluster */
 
-                  value = (fs->fs_buffer[fatindex] & 0x0f) |
+                  value = (buffer[fatindex] & 0x0f) |
                            (uint8_t)nextcluster << 4;
                 }
               else
@@ -1006,7 +1295,7 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                   value = (uint8_t)nextcluster;
                 }
 
-              fs->fs_buffer[fatindex] = value;
+              buffer[fatindex] = value;
 
               /* With FAT12, the second byte of the cluster number may lie in
                * a different sector than the first byte.
@@ -1015,17 +1304,14 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
               fatindex++;
               if (fatindex >= fs->fs_hwsectorsize)
                 {
-                  /* Read the next sector */
+                  /* Read the next sector.  The sector that we just
+                   * modified was marked dirty above.
+                   */
 
                   fatsector++;
                   fatindex = 0;
 
-                  /* Set the dirty flag to make sure the sector that we
-                   * just modified is written out.
-                   */
-
-                  fs->fs_dirty = true;
-                  if (fat_fscacheread(fs, fatsector) < 0)
+                  if (fat_fatsector(fs, fatsector, true, &buffer) < 0)
                     {
                       /* Read error */
 
@@ -1047,11 +1333,11 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                 {
                   /* Save the MS four bits of the next cluster */
 
-                  value = (fs->fs_buffer[fatindex] & 0xf0) |
+                  value = (buffer[fatindex] & 0xf0) |
                           ((nextcluster >> 8) & 0x0f);
                 }
 
-              fs->fs_buffer[fatindex] = value;
+              buffer[fatindex] = value;
             }
           break;
 
@@ -1061,15 +1347,16 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
               off_t        fatsector = fs->fs_fatbase +
                                        SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
+              FAR uint8_t  *buffer;
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatsector(fs, fatsector, true, &buffer) < 0)
                 {
                   /* Read error */
 
                   break;
                 }
 
-              FAT_PUTFAT16(fs->fs_buffer, fatindex, nextcluster & 0xffff);
+              FAT_PUTFAT16(buffer, fatindex, nextcluster & 0xffff);
             }
           break;
 
@@ -1079,9 +1366,10 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
               off_t        fatsector = fs->fs_fatbase +
                                        SEC_NSECTORS(fs, fatoffset);
               unsigned int fatindex  = fatoffset & SEC_NDXMASK(fs);
+              FAR uint8_t  *buffer;
               uint32_t     val;
 
-              if (fat_fscacheread(fs, fatsector) < 0)
+              if (fat_fatsector(fs, fatsector, true, &buffer) < 0)
                 {
                   /* Read error */
 
@@ -1090,8 +1378,8 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
 
               /* Keep the top 4 bits */
 
-              val = FAT_GETFAT32(fs->fs_buffer, fatindex) & 0xf0000000;
-              FAT_PUTFAT32(fs->fs_buffer, fatindex,
+              val = FAT_GETFAT32(buffer, fatindex) & 0xf0000000;
+              FAT_PUTFAT32(buffer, fatindex,
                            val | (nextcluster & 0x0fffffff));
             }
           break;
@@ -1100,9 +1388,15 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
             return -EINVAL;
         }
 
-      /* Mark the modified sector as "dirty" and return success */
+      /* The modified sector was marked "dirty" when it was looked up */
+
+#ifdef CONFIG_FAT_FREEMAP
+      if (fs->fs_freemap != NULL && clusterno >= 2)
+        {
+          fat_freemapset(fs, clusterno, nextcluster != 0);
+        }
+#endif
 
-      fs->fs_dirty = true;
       return OK;
     }
 
@@ -1122,6 +1416,14 @@ int fat_removechain(struct fat_mountpt_s *fs, uint32_t cluster)
   int32_t nextcluster;
   int    ret;
 
+#ifdef CONFIG_FAT_EXTENTMAP
+  /* Freed clusters may be reused by any file, so every extent map built
+   * so far is now suspect.
+   */
+
+  fs->fs_chaingen++;
+#endif
+
   /* Loop while there are clusters in the chain */
 
   while (cluster >= 2 && cluster < fs->fs_nclusters + 2)
@@ -1226,6 +1528,21 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
       startcluster = cluster;
     }
 
+#ifdef CONFIG_FAT_FREEMAP
+  /* Find a free cluster in the bitmap, building it on first use */
+
+  if (fs->fs_freemap != NULL || fat_freemapbuild(fs) == OK)
+    {
+      newcluster = fat_freemapfind(fs, startcluster);
+      if (newcluster == 0)
+        {
+          return 0;
+        }
+
+      goto found;
+    }
+#endif
+
   /* Loop until (1) we discover that there are not free clusters
    * (return 0), an errors occurs (return -errno), or (3) we find
    * the next cluster (return the new cluster number).
@@ -1288,6 +1605,9 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
    * number in 'newcluster'  Now mark that cluster as in-use.
    */
 
+#ifdef CONFIG_FAT_FREEMAP
+found:
+#endif
   ret = fat_putcluster(fs, newcluster, 0x0fffffff);
   if (ret < 0)
     {
@@ -1323,6 +1643,138 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
   return newcluster;
 }
 
+/****************************************************************************
+ * Name: fat_ffcluster
+ *
+ * Description:
+ *   Return the cluster number of the cluster 'index' (counting from zero)
+ *   of an open file.  The chain is walked only once: the runs of
+ *   contiguous clusters found on the way are remembered in the extent map
+ *   of the file, so that seeking backward and forward costs O(extents)
+ *   rather than O(clusters).  Once the map is full, the part of the chain
+ *   beyond the last extent is walked as before, starting from 'hint', the
+ *   cluster the caller already reached at position 'hintindex', if that is
+ *   further along.  Pass a hint of zero if there is none.
+ *
+ * Returned Value:
+ *   <0: error, >=2: cluster number
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FAT_EXTENTMAP
+int32_t fat_ffcluster(FAR struct fat_mountpt_s *fs,
+                      FAR struct fat_file_s *ff, uint32_t index,
+                      uint32_t hintindex, uint32_t hint)
+{
+  FAR struct fat_extent_s *ext;
+  uint32_t cluster;
+  uint32_t pos;
+  int lo;
+  int hi;
+
+  /* Start over if the file was truncated or any chain was freed */
+
+  if (ff->ff_nextents == 0 || ff->ff_extentgen != fs->fs_chaingen ||
+      ff->ff_extents[0].fe_cluster != ff->ff_startcluster)
+    {
+      if (ff->ff_startcluster < 2 ||
+          ff->ff_startcluster >= fs->fs_nclusters + 2)
+        {
+          return -EIO;
+        }
+
+      ff->ff_extents[0].fe_fileclus = 0;
+      ff->ff_extents[0].fe_cluster  = ff->ff_startcluster;
+      ff->ff_extents[0].fe_count    = 1;
+      ff->ff_nextents               = 1;
+      ff->ff_extentgen              = fs->fs_chaingen;
+    }
+
+  /* The extents cover the beginning of the file without gaps.  Find the
+   * one holding 'index' with a binary search.
+   */
+
+  lo = 0;
+  hi = ff->ff_nextents - 1;
+  while (lo < hi)
+    {
+      int mid = (lo + hi + 1) / 2;
+
+      if (ff->ff_extents[mid].fe_fileclus <= index)
+        {
+          lo = mid;
+        }
+      else
+        {
+          hi = mid - 1;
+        }
+    }
+
+  ext = &ff->ff_extents[lo];
+  if (index < ext->fe_fileclus + ext->fe_count)
+    {
+      return ext->fe_cluster + (index - ext->fe_fileclus);
+    }
+
+  /* Beyond the mapped part: continue walking the chain from the end of
+   * the last extent, extending the map as we go.
+   */
+
+  pos     = ext->fe_fileclus + ext->fe_count - 1;
+  cluster = ext->fe_cluster + ext->fe_count - 1;
+
+  /* With the map full, nothing is learned by walking from its end again:
+   * resume from the caller's position so that a sequential pass over the
+   * unmapped part stays linear.
+   */
+
+  if (ff->ff_nextents == CONFIG_FAT_EXTENTMAP_NEXTENTS &&
+      hint >= 2 && hintindex > pos && hintindex <= index)
+    {
+      pos     = hintindex;
+      cluster = hint;
+      ext     = NULL;
+    }
+
+  while (pos < index)
+    {
+      off_t next = fat_getcluster(fs, cluster);
+
+      /* The chain is broken */
+
+      if (next < 2 || next >= fs->fs_nclusters + 2)
+        {
+          return -EIO;
+        }
+
+      pos++;
+      if (ext != NULL && next == cluster + 1 &&
+          pos == ext->fe_fileclus + ext->fe_count)
+        {
+          ext->fe_count++;
+        }
+      else if (ext != NULL &&
+               ff->ff_nextents < CONFIG_FAT_EXTENTMAP_NEXTENTS)
+        {
+          ext = &ff->ff_extents[ff->ff_nextents++];
+          ext->fe_fileclus = pos;
+          ext->fe_cluster  = next;
+          ext->fe_count    = 1;
+        }
+      else
+        {
+          /* The map is full, just keep walking */
+
+          ext = NULL;
+        }
+
+      cluster = next;
+    }
+
+  return cluster;
+}
+#endif
+
 /****************************************************************************
  * Name: fat_nextdirentry
  *
@@ -1975,6 +2427,61 @@ int fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff)
   return OK;
 }
 
+/****************************************************************************
+ * Name: fat_fatcacheflush
+ *
+ * Description:
+ *   Write back all dirty sectors of the FAT cache
+ *
+ ****************************************************************************/
+
+int fat_fatcacheflush(FAR struct fat_mountpt_s *fs)
+{
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  int ret;
+  int i;
+
+  for (i = 0; fs->fs_fatdirty != 0 && i < CONFIG_FAT_FATCACHE_NSECTORS; i++)
+    {
+      ret = fat_fatcachewrite(fs, i);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fatcachefree
+ *
+ * Description:
+ *   Release the FAT cache and the free cluster bitmap of a mountpoint
+ *
+ ****************************************************************************/
+
+void fat_fatcachefree(FAR struct fat_mountpt_s *fs)
+{
+#if CONFIG_FAT_FATCACHE_NSECTORS > 0
+  if (fs->fs_fatbuffer != NULL)
+    {
+      fat_io_free(fs->fs_fatbuffer,
+                  CONFIG_FAT_FATCACHE_NSECTORS * fs->fs_hwsectorsize);
+      fs->fs_fatbuffer = NULL;
+    }
+#endif
+
+#ifdef CONFIG_FAT_FREEMAP
+  if (fs->fs_freemap != NULL)
+    {
+      fs_heap_free(fs->fs_freemap);
+      fs->fs_freemap = NULL;
+    }
+#endif
+}
+
 /****************************************************************************
  * Name: fat_updatefsinfo
  *
@@ -1988,9 +2495,14 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 {
   int ret;
 
-  /* Flush the fs_buffer if it is dirty */
+  /* Flush the FAT cache and the fs_buffer if they are dirty */
+
+  ret = fat_fatcacheflush(fs);
+  if (ret == OK)
+    {
+      ret = fat_fscacheflush(fs);
+    }
 
-  ret = fat_fscacheflush(fs);
   if (ret == OK)
     {
       /* The FSINFO sector only has to be update for the case of a FAT32 file
@@ -2058,6 +2570,7 @@ int fat_computefreeclusters(struct fat_mountpt_s *fs)
     }
   else
     {
+      FAR uint8_t  *buffer = NULL;
       unsigned int cluster;
       off_t        fatsector;
       unsigned int offset;
@@ -2070,13 +2583,11 @@ int fat_computefreeclusters(struct fat_mountpt_s *fs)
 
       for (cluster = fs->fs_nclusters; cluster > 0; cluster--)
         {
-          /* If we are starting a new sector, then read the new sector in
-           * fs_buffer
-           */
+          /* If we are starting a new sector, then read the new sector */
 
           if (offset >= fs->fs_hwsectorsize)
             {
-              ret = fat_fscacheread(fs, fatsector);
+              ret = fat_fatsector(fs, fatsector, false, &buffer);
               if (ret < 0)
                 {
                   return ret;
@@ -2096,7 +2607,7 @@ int fat_computefreeclusters(struct fat_mountpt_s *fs)
 
           if (fs->fs_type == FSTYPE_FAT16)
             {
-              if (FAT_GETFAT16(fs->fs_buffer, offset) == 0)
+              if (FAT_GETFAT16(buffer, offset) == 0)
                 {
                   nfreeclusters++;
                 }
@@ -2105,7 +2616,7 @@ int fat_computefreeclusters(struct fat_mountpt_s *fs)
             }
           else
             {
-              if (FAT_GETFAT32(fs->fs_buffer, offset) == 0)
+              if (FAT_GETFAT32(buffer, offset) == 0)
                 {
                   nfreeclusters++;
                 }
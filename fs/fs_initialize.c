@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 #include <nuttx/reboot_notifier.h>
 #include <nuttx/trace.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "notify/notify.h"
 #include "rpmsgfs/rpmsgfs.h"
@@ -107,6 +108,10 @@ void fs_initialize(void)
   notify_initialize();
 #endif
 
+#ifdef CONFIG_FS_PAGECACHE
+  pagecache_initialize();
+#endif
+
   register_reboot_notifier(&g_sync_nb);
   fs_trace_end();
 }
@@ -36,6 +36,7 @@
 #include <debug.h>
 #include <stdio.h>
 
+#include <nuttx/nuttx.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/cancelpt.h>
@@ -58,6 +59,21 @@
 #include "inode/inode.h"
 #include "fs_heap.h"
 
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Row table allocated by files_extend().  fl_files points to 'rows'; once
+ * replaced, the table is linked on fl_retired, as lock-free readers may
+ * still be indexing it.
+ */
+
+struct files_table_s
+{
+  FAR struct files_table_s *next;
+  FAR struct file *rows[1];
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -70,11 +86,13 @@ static FAR struct file *files_fget_by_index(FAR struct filelist *list,
                                             int l1, int l2, FAR bool *new)
 {
   FAR struct file *filep;
-  irqstate_t flags;
 
-  flags = raw_spin_lock_irqsave(&list->fl_lock);
+  /* No lock is needed: the caller has seen at least l1 + 1 rows, so
+   * whichever row table is read here has row l1, and the rows themselves
+   * never move.
+   */
+
   filep = &list->fl_files[l1][l2];
-  raw_spin_unlock_irqrestore(&list->fl_lock, flags);
 
 #ifdef CONFIG_FS_REFCOUNT
   if (filep->f_inode != NULL)
@@ -120,15 +138,17 @@ static FAR struct file *files_fget_by_index(FAR struct filelist *list,
 
 static int files_extend(FAR struct filelist *list, size_t row)
 {
+  FAR struct files_table_s *table;
   FAR struct file **files;
-  uint8_t orig_rows;
-  FAR void *tmp;
-  int flags;
+  FAR struct file **tmp;
+  irqstate_t flags;
+  int orig_rows;
+  int rows;
   int i;
   int j;
 
-  orig_rows = list->fl_rows;
-  if (row <= orig_rows)
+  orig_rows = atomic_read_acquire(&list->fl_rows);
+  if ((int)row <= orig_rows)
     {
       return 0;
     }
@@ -139,13 +159,16 @@ static int files_extend(FAR struct filelist *list, size_t row)
       return -EMFILE;
     }
 
-  files = fs_heap_malloc(sizeof(FAR struct file *) * row);
-  DEBUGASSERT(files);
-  if (files == NULL)
+  table = fs_heap_malloc(sizeof(struct files_table_s) +
+                         sizeof(FAR struct file *) * (row - 1));
+  DEBUGASSERT(table);
+  if (table == NULL)
     {
       return -ENFILE;
     }
 
+  files = table->rows;
+
   i = orig_rows;
   do
     {
@@ -158,7 +181,7 @@ static int files_extend(FAR struct filelist *list, size_t row)
               fs_heap_free(files[i]);
             }
 
-          fs_heap_free(files);
+          fs_heap_free(table);
           return -ENFILE;
         }
     }
@@ -171,7 +194,8 @@ static int files_extend(FAR struct filelist *list, size_t row)
    * release the obsolete buffers
    */
 
-  if (orig_rows != list->fl_rows && list->fl_rows >= row)
+  rows = atomic_read(&list->fl_rows);
+  if (rows >= (int)row)
     {
       raw_spin_unlock_irqrestore(&list->fl_lock, flags);
 
@@ -180,28 +204,39 @@ static int files_extend(FAR struct filelist *list, size_t row)
           fs_heap_free(files[j]);
         }
 
-      fs_heap_free(files);
+      fs_heap_free(table);
 
       return OK;
     }
 
-  if (list->fl_files != NULL)
+  /* Rows added by other threads meanwhile are kept, ours are dropped */
+
+  for (j = orig_rows; j < rows; j++)
     {
-      memcpy(files, list->fl_files,
-             list->fl_rows * sizeof(FAR struct file *));
+      fs_heap_free(files[j]);
     }
 
+  memcpy(files, list->fl_files, rows * sizeof(FAR struct file *));
+
+  /* Publish the new table before the new row count, so that a reader
+   * seeing the row count also sees a table that large.  The old table
+   * may still be in use by readers and is only retired.
+   */
+
   tmp = list->fl_files;
   list->fl_files = files;
-  list->fl_rows = row;
+  atomic_set_release(&list->fl_rows, row);
 
-  raw_spin_unlock_irqrestore(&list->fl_lock, flags);
-
-  if (tmp != NULL && tmp != &list->fl_prefile)
+  if (tmp != &list->fl_prefile)
     {
-      fs_heap_free(tmp);
+      FAR struct files_table_s *old =
+        container_of(tmp, struct files_table_s, rows);
+
+      old->next = list->fl_retired;
+      list->fl_retired = old;
     }
 
+  raw_spin_unlock_irqrestore(&list->fl_lock, flags);
   return OK;
 }
 
@@ -219,7 +254,7 @@ static void task_fssync(FAR struct tcb_s *tcb, FAR void *arg)
       return;
     }
 
-  rows = tcb->group->tg_filelist.fl_rows;
+  rows = atomic_read_acquire(&tcb->group->tg_filelist.fl_rows);
 
   for (i = 0; i < rows; i++)
     {
@@ -377,9 +412,10 @@ void files_initlist(FAR struct filelist *list)
    * unnecessary allocator accesses during file initialization.
    */
 
-  list->fl_rows = 1;
+  atomic_set(&list->fl_rows, 1);
   list->fl_files = &list->fl_prefile;
   list->fl_prefile = list->fl_prefiles;
+  list->fl_retired = NULL;
   spin_lock_init(&list->fl_lock);
 }
 
@@ -468,6 +504,7 @@ void files_dumplist(FAR struct filelist *list)
 
 void files_putlist(FAR struct filelist *list)
 {
+  FAR struct files_table_s *table;
   int i;
   int j;
 
@@ -476,7 +513,7 @@ void files_putlist(FAR struct filelist *list)
    * because there should not be any references in this context.
    */
 
-  for (i = list->fl_rows - 1; i >= 0; i--)
+  for (i = atomic_read(&list->fl_rows) - 1; i >= 0; i--)
     {
       for (j = CONFIG_NFILE_DESCRIPTORS_PER_BLOCK - 1; j >= 0; j--)
         {
@@ -491,7 +528,14 @@ void files_putlist(FAR struct filelist *list)
 
   if (list->fl_files != &list->fl_prefile)
     {
-      fs_heap_free(list->fl_files);
+      fs_heap_free(container_of(list->fl_files, struct files_table_s,
+                                rows));
+    }
+
+  while ((table = list->fl_retired) != NULL)
+    {
+      list->fl_retired = table->next;
+      fs_heap_free(table);
     }
 }
 
@@ -511,7 +555,8 @@ void files_putlist(FAR struct filelist *list)
 
 int files_countlist(FAR struct filelist *list)
 {
-  return list->fl_rows * CONFIG_NFILE_DESCRIPTORS_PER_BLOCK;
+  return atomic_read_acquire(&list->fl_rows) *
+         CONFIG_NFILE_DESCRIPTORS_PER_BLOCK;
 }
 
 /****************************************************************************
@@ -540,7 +585,8 @@ FAR struct file *files_fget(FAR struct filelist *list, int fd)
  *
  * Description:
  *   Allocate a struct files instance and associate it with an inode
- *   instance.
+ *   instance.  cache is the page cache state attached to the file by the
+ *   open, if any; the new descriptor takes it over.
  *
  * Returned Value:
  *     Returns the file descriptor == index into the files array on success;
@@ -549,7 +595,8 @@ FAR struct file *files_fget(FAR struct filelist *list, int fd)
  ****************************************************************************/
 
 int file_allocate_from_tcb(FAR struct tcb_s *tcb, FAR struct inode *inode,
-                           int oflags, off_t pos, FAR void *priv, int minfd,
+                           int oflags, off_t pos, FAR void *priv,
+                           FAR struct pagecache_file_s *cache, int minfd,
                            bool addref)
 {
   int i = minfd / CONFIG_NFILE_DESCRIPTORS_PER_BLOCK;
@@ -569,7 +616,7 @@ int file_allocate_from_tcb(FAR struct tcb_s *tcb, FAR struct inode *inode,
 
   for (; ; i++, j = 0)
     {
-      if (i >= list->fl_rows)
+      if (i >= atomic_read(&list->fl_rows))
         {
           raw_spin_unlock_irqrestore(&list->fl_lock, flags);
 
@@ -591,8 +638,15 @@ int file_allocate_from_tcb(FAR struct tcb_s *tcb, FAR struct inode *inode,
               filep->f_pos         = pos;
               filep->f_inode       = inode;
               filep->f_priv        = priv;
+#ifdef CONFIG_FS_PAGECACHE
+              filep->f_cache       = cache;
+#endif
 #ifdef CONFIG_FS_REFCOUNT
-              atomic_set(&filep->f_refs, 1);
+              /* Lookups are lock-free and only take references once this
+               * is non-zero, so it is set last.
+               */
+
+              atomic_set_release(&filep->f_refs, 1);
 #endif
 #ifdef CONFIG_FDSAN
               filep->f_tag_fdsan   = 0;
@@ -641,7 +695,7 @@ int file_allocate(FAR struct inode *inode, int oflags, off_t pos,
                   FAR void *priv, int minfd, bool addref)
 {
   return file_allocate_from_tcb(this_task(), inode, oflags,
-                                pos, priv, minfd, addref);
+                                pos, priv, NULL, minfd, addref);
 }
 
 /****************************************************************************
@@ -662,7 +716,7 @@ int files_duplist(FAR struct filelist *plist, FAR struct filelist *clist,
   int i;
   int j;
 
-  for (i = 0; i < plist->fl_rows; i++)
+  for (i = 0; i < atomic_read_acquire(&plist->fl_rows); i++)
     {
       for (j = 0; j < CONFIG_NFILE_DESCRIPTORS_PER_BLOCK; j++)
         {
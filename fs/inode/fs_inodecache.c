@@ -0,0 +1,290 @@
+/****************************************************************************
+ * fs/inode/fs_inodecache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/spinlock.h>
+#include <nuttx/fs/fs.h>
+
+#include "inode/inode.h"
+
+#ifdef CONFIG_FS_INODE_CACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if (CONFIG_FS_INODE_CACHE_NENTRIES & (CONFIG_FS_INODE_CACHE_NENTRIES - 1))
+#  error CONFIG_FS_INODE_CACHE_NENTRIES must be a power of two
+#endif
+
+#define INODE_CACHE_MASK (CONFIG_FS_INODE_CACHE_NENTRIES - 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One slot of the direct-mapped lookup cache.  A slot maps the pair
+ * (parent, name) to the child inode of that name, or to NULL if parent has
+ * no such child (a negative entry).  Positive entries are verified against
+ * the name of the child itself; negative entries keep a copy of the name.
+ */
+
+struct inode_cache_s
+{
+  FAR struct inode *parent;  /* Directory searched, NULL if slot is free */
+  FAR struct inode *node;    /* Child found, NULL for a negative entry */
+  uint32_t hash;             /* Hash of the name */
+  char name[CONFIG_FS_INODE_CACHE_NAMELEN + 1];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct inode_cache_s g_inode_cache[CONFIG_FS_INODE_CACHE_NENTRIES];
+
+/* Lookups run concurrently under the inode read lock but still fill the
+ * cache, so the slots need their own lock.
+ */
+
+static spinlock_t g_inode_cache_lock = SP_UNLOCKED;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cache_hash
+ *
+ * Description:
+ *   Hash one path segment (FNV-1a), returning its length in *len.
+ *
+ ****************************************************************************/
+
+static uint32_t inode_cache_hash(FAR const char *name, FAR size_t *len)
+{
+  uint32_t hash = 2166136261u;
+  size_t i;
+
+  for (i = 0; name[i] != '\0' && name[i] != '/'; i++)
+    {
+      hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+
+  *len = i;
+  return hash;
+}
+
+/****************************************************************************
+ * Name: inode_cache_slot
+ ****************************************************************************/
+
+static FAR struct inode_cache_s *
+inode_cache_slot(FAR struct inode *parent, uint32_t hash)
+{
+  uintptr_t key = (uintptr_t)parent;
+
+  key ^= key >> 7;
+  return &g_inode_cache[(hash ^ key) & INODE_CACHE_MASK];
+}
+
+/****************************************************************************
+ * Name: inode_cache_match
+ *
+ * Description:
+ *   Return true if the slot holds the path segment 'name' of 'parent'.
+ *
+ ****************************************************************************/
+
+static bool inode_cache_match(FAR struct inode_cache_s *slot,
+                              FAR struct inode *parent,
+                              FAR const char *name, size_t len,
+                              uint32_t hash)
+{
+  FAR const char *sname;
+
+  if (slot->parent != parent || slot->hash != hash)
+    {
+      return false;
+    }
+
+  sname = slot->node != NULL ? slot->node->i_name : slot->name;
+  return strncmp(sname, name, len) == 0 && sname[len] == '\0';
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cache_lookup
+ *
+ * Description:
+ *   Look up the path segment at the beginning of 'name' among the children
+ *   of 'parent'.
+ *
+ * Returned Value:
+ *   True if the cache knows the answer, in which case the child (or NULL if
+ *   there is no such child) is returned in 'node'.
+ *
+ ****************************************************************************/
+
+bool inode_cache_lookup(FAR struct inode *parent, FAR const char *name,
+                        FAR struct inode **node)
+{
+  FAR struct inode_cache_s *slot;
+  irqstate_t flags;
+  uint32_t hash;
+  size_t len;
+  bool found;
+
+  hash  = inode_cache_hash(name, &len);
+  slot  = inode_cache_slot(parent, hash);
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+
+  found = inode_cache_match(slot, parent, name, len, hash);
+  if (found)
+    {
+      *node = slot->node;
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+  return found;
+}
+
+/****************************************************************************
+ * Name: inode_cache_add
+ *
+ * Description:
+ *   Remember the result of looking up the path segment at the beginning of
+ *   'name' among the children of 'parent'.  'node' is NULL if the search
+ *   failed.  Negative results for names longer than
+ *   CONFIG_FS_INODE_CACHE_NAMELEN are not cached.
+ *
+ * Assumptions:
+ *   The caller holds the inode tree lock, for reading at least.
+ *
+ ****************************************************************************/
+
+void inode_cache_add(FAR struct inode *parent, FAR const char *name,
+                     FAR struct inode *node)
+{
+  FAR struct inode_cache_s *slot;
+  irqstate_t flags;
+  uint32_t hash;
+  size_t len;
+
+  DEBUGASSERT(parent != NULL);
+
+  hash = inode_cache_hash(name, &len);
+  if (node == NULL && len > CONFIG_FS_INODE_CACHE_NAMELEN)
+    {
+      return;
+    }
+
+  slot  = inode_cache_slot(parent, hash);
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+
+  slot->parent = parent;
+  slot->node   = node;
+  slot->hash   = hash;
+
+  if (node == NULL)
+    {
+      memcpy(slot->name, name, len);
+      slot->name[len] = '\0';
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
+
+/****************************************************************************
+ * Name: inode_cache_invalidate
+ *
+ * Description:
+ *   Forget any lookup result for the path segment 'name' of 'parent'.
+ *   Called whenever a child is added to or unlinked from 'parent'.
+ *
+ ****************************************************************************/
+
+void inode_cache_invalidate(FAR struct inode *parent, FAR const char *name)
+{
+  FAR struct inode_cache_s *slot;
+  irqstate_t flags;
+  uint32_t hash;
+  size_t len;
+
+  hash  = inode_cache_hash(name, &len);
+  slot  = inode_cache_slot(parent, hash);
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+
+  if (inode_cache_match(slot, parent, name, len, hash))
+    {
+      slot->parent = NULL;
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
+
+/****************************************************************************
+ * Name: inode_cache_purge
+ *
+ * Description:
+ *   Forget every entry referring to 'inode', either as the directory
+ *   searched or as the result.  Called before the inode memory is freed so
+ *   that a new inode allocated at the same address cannot hit stale
+ *   entries.
+ *
+ ****************************************************************************/
+
+void inode_cache_purge(FAR struct inode *inode)
+{
+  irqstate_t flags;
+  int i;
+
+  flags = spin_lock_irqsave(&g_inode_cache_lock);
+
+  for (i = 0; i < CONFIG_FS_INODE_CACHE_NENTRIES; i++)
+    {
+      FAR struct inode_cache_s *slot = &g_inode_cache[i];
+
+      if (slot->parent == inode || slot->node == inode)
+        {
+          slot->parent = NULL;
+          slot->node   = NULL;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_inode_cache_lock, flags);
+}
+
+#endif /* CONFIG_FS_INODE_CACHE */
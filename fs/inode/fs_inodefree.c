@@ -65,6 +65,10 @@ void inode_free(FAR struct inode *inode)
       inode_free(inode->i_peer);
       inode_free(inode->i_child);
 
+#ifdef CONFIG_FS_INODE_CACHE
+      inode_cache_purge(inode);
+#endif
+
 #ifdef CONFIG_PSEUDOFS_SOFTLINKS
       /* If the inode is a symbolic link, the free the path to the linked
        * entity.
@@ -72,6 +72,7 @@ static FAR struct inode *inode_unlink(FAR const char *path)
   /* Find the node to unlink */
 
   SETUP_SEARCH(&desc, path, true);
+  desc.nocache = true;
 
   ret = inode_search(&desc);
   if (ret >= 0)
@@ -96,6 +97,10 @@ static FAR struct inode *inode_unlink(FAR const char *path)
           desc.parent->i_child = inode->i_peer;
         }
 
+#ifdef CONFIG_FS_INODE_CACHE
+      inode_cache_invalidate(desc.parent, inode->i_name);
+#endif
+
       inode->i_peer   = NULL;
       inode->i_parent = NULL;
       atomic_fetch_sub(&inode->i_crefs, 1);
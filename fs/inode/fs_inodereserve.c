@@ -129,6 +129,12 @@ static void inode_insert(FAR struct inode *inode,
       inode->i_parent = parent;
       parent->i_child = inode;
     }
+
+#ifdef CONFIG_FS_INODE_CACHE
+  /* Drop a cached negative lookup of the new name */
+
+  inode_cache_invalidate(parent, inode->i_name);
+#endif
 }
 
 /****************************************************************************
@@ -195,6 +201,7 @@ int inode_reserve(FAR const char *path,
   /* Find the location to insert the new subtree */
 
   SETUP_SEARCH(&desc, path, false);
+  desc.nocache = true;
 
   ret = inode_search(&desc);
   if (ret >= 0)
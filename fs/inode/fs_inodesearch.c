@@ -149,6 +149,7 @@ static int _inode_linktarget(FAR struct inode *inode,
                              FAR struct inode_search_s *desc)
 {
   unsigned int count = 0;
+  bool nocache;
   bool save;
   int ret = -ENOENT;
 
@@ -156,7 +157,8 @@ static int _inode_linktarget(FAR struct inode *inode,
 
   /* An infinite loop is avoided only by the loop count. */
 
-  save = desc->nofollow;
+  save    = desc->nofollow;
+  nocache = desc->nocache;
   while (INODE_IS_SOFTLINK(inode))
     {
       FAR const char *link = (FAR const char *)inode->u.i_link;
@@ -165,6 +167,7 @@ static int _inode_linktarget(FAR struct inode *inode,
 
       RELEASE_SEARCH(desc);
       SETUP_SEARCH(desc, link, true);
+      desc->nocache = nocache;
 
       /* Look up inode associated with the target of the symbolic link */
 
@@ -221,6 +224,9 @@ static int _inode_search(FAR struct inode_search_s *desc)
   FAR struct inode *left    = NULL;
   FAR struct inode *above   = NULL;
   FAR const char   *relpath = NULL;
+#ifdef CONFIG_FS_INODE_CACHE
+  bool cached = false;
+#endif
   int ret = -ENOENT;
 
   /* Get the search path, skipping over the leading '/'.  The leading '/' is
@@ -242,7 +248,35 @@ static int _inode_search(FAR struct inode_search_s *desc)
 
   while (inode != NULL)
     {
-      int result = _inode_compare(name, inode);
+      int result;
+
+#ifdef CONFIG_FS_INODE_CACHE
+      /* At the head of a list of children, try the lookup cache before
+       * walking the peers.
+       */
+
+      cached = false;
+      if (left == NULL && above != NULL && !desc->nocache)
+        {
+          FAR struct inode *child;
+
+          if (inode_cache_lookup(above, name, &child))
+            {
+              cached = true;
+              if (child == NULL)
+                {
+                  inode = NULL;
+                  break;
+                }
+
+              inode = child;
+            }
+        }
+
+      result = cached ? 0 : _inode_compare(name, inode);
+#else
+      result = _inode_compare(name, inode);
+#endif
 
       /* Case 1:  The name is less than the name of the node.
        * Since the names are ordered, these means that there
@@ -280,6 +314,13 @@ static int _inode_search(FAR struct inode_search_s *desc)
            *       below this one
            */
 
+#ifdef CONFIG_FS_INODE_CACHE
+          if (!cached && above != NULL)
+            {
+              inode_cache_add(above, name, inode);
+            }
+#endif
+
           name = inode_nextname(name);
           if (*name == '\0' || INODE_IS_MOUNTPT(inode))
             {
@@ -407,6 +448,15 @@ static int _inode_search(FAR struct inode_search_s *desc)
    *   (4) When the node matching the full path is found
    */
 
+#ifdef CONFIG_FS_INODE_CACHE
+  /* Remember that the name does not exist below its parent */
+
+  if (inode == NULL && !cached && above != NULL)
+    {
+      inode_cache_add(above, name, NULL);
+    }
+#endif
+
   desc->path    = name;
   desc->node    = inode;
   desc->peer    = left;
@@ -57,6 +57,7 @@
       (d)->relpath  = NULL; \
       (d)->buffer   = NULL; \
       (d)->nofollow = (n); \
+      (d)->nocache  = false; \
     } \
   while (0)
 
@@ -100,7 +101,8 @@
  *  node     - INPUT:  (not used)
  *             OUTPUT: On success, holds the pointer to the inode found.
  *  peer     - INPUT:  (not used)
- *             OUTPUT: The inode to the "left" of the inode found.
+ *             OUTPUT: The inode to the "left" of the inode found.  Only
+ *                     valid if nocache is true.
  *  parent   - INPUT:  (not used)
  *             OUTPUT: The inode to the "above" of the inode found.
  *  relpath  - INPUT:  (not used)
@@ -116,6 +118,9 @@
  *                     terminal is a soft link, then return the inode of
  *                     the link target.
  *           - OUTPUT: (not used)
+ *  nocache  - INPUT:  true: bypass the lookup cache.  Must be set by
+ *                     callers that modify the tree at the position found.
+ *           - OUTPUT: (not used)
  *  buffer   - INPUT:  Not used
  *           - OUTPUT: May hold an allocated intermediate path which is
  *                     probably of no interest to the caller unless it holds
@@ -131,6 +136,7 @@ struct inode_search_s
   FAR const char *relpath;   /* Relative path into the mountpoint */
   FAR char *buffer;          /* Path expansion buffer */
   bool nofollow;             /* true: Don't follow terminal soft link */
+  bool nocache;              /* true: Bypass the lookup cache */
 };
 
 /* Callback used by foreach_inode to traverse all inodes in the pseudo-
@@ -237,6 +243,26 @@ void inode_runlock(void);
 
 int inode_search(FAR struct inode_search_s *desc);
 
+/****************************************************************************
+ * Name: inode_cache_lookup, inode_cache_add, inode_cache_invalidate and
+ *      inode_cache_purge
+ *
+ * Description:
+ *   Hashed cache of (parent inode, name) -> child inode lookups used by
+ *   inode_search(), including negative results.  inode_reserve() and
+ *   inode_remove() keep it coherent with the inode tree.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODE_CACHE
+bool inode_cache_lookup(FAR struct inode *parent, FAR const char *name,
+                        FAR struct inode **node);
+void inode_cache_add(FAR struct inode *parent, FAR const char *name,
+                     FAR struct inode *node);
+void inode_cache_invalidate(FAR struct inode *parent, FAR const char *name);
+void inode_cache_purge(FAR struct inode *inode);
+#endif
+
 /****************************************************************************
  * Name: inode_find
  *
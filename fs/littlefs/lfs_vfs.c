@@ -28,10 +28,12 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/pagecache.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/mutex.h>
@@ -68,6 +70,44 @@ struct littlefs_file_s
   int                   refs;
 };
 
+/* One line of the read cache shared by all users of a mountpoint.  A line
+ * holds read_size bytes of a block.
+ */
+
+struct littlefs_rline_s
+{
+  lfs_block_t           block;  /* Block cached, or LFS_BLOCK_NULL */
+  lfs_off_t             off;    /* Offset in block, read_size aligned */
+  uint32_t              stamp;  /* Last use, for LRU replacement */
+  FAR uint8_t          *data;
+};
+
+/* One slot of the stat cache, mapping a path to the result of stat() on
+ * it, including -ENOENT.  Slots are valid only for the generation they
+ * were filled in: any program or erase of the flash starts a new one.
+ */
+
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+struct littlefs_statcache_s
+{
+  uint32_t              gen;    /* Generation of the result, 0 if unused */
+  uint32_t              hash;   /* Hash of the path */
+  int                   result; /* 0 or negated errno */
+  struct stat           st;
+  char                  path[CONFIG_FS_LITTLEFS_STAT_CACHE_PATHLEN + 1];
+};
+#endif
+
+/* Options given to mount() */
+
+struct littlefs_options_s
+{
+  bool                  autoformat;  /* Format if the mount fails */
+  bool                  forceformat; /* Format before mounting */
+  lfs_size_t            cache_size;  /* littlefs cache size, 0 for default */
+  size_t                rcache_size; /* Shared read cache budget */
+};
+
 /* This structure represents the overall mountpoint state. An instance of
  * this structure is retained as inode private data on each mountpoint that
  * is mounted with a littlefs filesystem.
@@ -80,6 +120,17 @@ struct littlefs_mountpt_s
   struct mtd_geometry_s geo;
   struct lfs_config     cfg;
   struct lfs            lfs;
+
+  /* Read cache shared by all open files and metadata lookups */
+
+  FAR struct littlefs_rline_s *rlines;
+  size_t                nrlines;
+  uint32_t              rstamp;
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+  uint32_t              statgen;
+  struct littlefs_statcache_s
+                        statcache[CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES];
+#endif
 };
 
 struct littlefs_attr_s
@@ -326,6 +377,120 @@ static FAR const char *littlefs_convert_path(FAR const char *path)
   return path;
 }
 
+/****************************************************************************
+ * Name: littlefs_stat_slot
+ *
+ * Description:
+ *   Hash a path (FNV-1a) and return its stat cache slot.
+ *
+ ****************************************************************************/
+
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+static FAR struct littlefs_statcache_s *
+littlefs_stat_slot(FAR struct littlefs_mountpt_s *fs, FAR const char *path,
+                   FAR uint32_t *hash)
+{
+  uint32_t h = 2166136261u;
+
+  while (*path != '\0')
+    {
+      h = (h ^ (uint8_t)*path++) * 16777619u;
+    }
+
+  *hash = h;
+  return &fs->statcache[h % CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES];
+}
+
+/****************************************************************************
+ * Name: littlefs_stat_lookup
+ *
+ * Description:
+ *   Look up the result of stat() on path since the last flash update.
+ *
+ * Returned Value:
+ *   True if found, with the result in 'result' and, if it is zero, the
+ *   file status in 'buf' (when not NULL).
+ *
+ ****************************************************************************/
+
+static bool littlefs_stat_lookup(FAR struct littlefs_mountpt_s *fs,
+                                 FAR const char *path,
+                                 FAR struct stat *buf, FAR int *result)
+{
+  FAR struct littlefs_statcache_s *slot;
+  uint32_t hash;
+
+  slot = littlefs_stat_slot(fs, path, &hash);
+  if (slot->gen != fs->statgen || slot->hash != hash ||
+      strcmp(slot->path, path) != 0)
+    {
+      return false;
+    }
+
+  if (buf != NULL)
+    {
+      *buf = slot->st;
+    }
+
+  *result = slot->result;
+  return true;
+}
+
+/****************************************************************************
+ * Name: littlefs_stat_add
+ *
+ * Description:
+ *   Remember the result of stat() on path: zero with the status in 'buf',
+ *   or -ENOENT.  Paths longer than CONFIG_FS_LITTLEFS_STAT_CACHE_PATHLEN
+ *   are not cached.
+ *
+ ****************************************************************************/
+
+static void littlefs_stat_add(FAR struct littlefs_mountpt_s *fs,
+                              FAR const char *path,
+                              FAR const struct stat *buf, int result)
+{
+  FAR struct littlefs_statcache_s *slot;
+  uint32_t hash;
+
+  if (strlen(path) > CONFIG_FS_LITTLEFS_STAT_CACHE_PATHLEN)
+    {
+      return;
+    }
+
+  slot = littlefs_stat_slot(fs, path, &hash);
+  slot->gen    = fs->statgen;
+  slot->hash   = hash;
+  slot->result = result;
+  if (buf != NULL)
+    {
+      slot->st = *buf;
+    }
+
+  strcpy(slot->path, path);
+}
+
+/****************************************************************************
+ * Name: littlefs_stat_invalidate
+ *
+ * Description:
+ *   Forget every stat() result.  Called on each program or erase, i.e. on
+ *   every commit.
+ *
+ ****************************************************************************/
+
+static void littlefs_stat_invalidate(FAR struct littlefs_mountpt_s *fs)
+{
+  /* Generation 0 marks unused slots and is skipped on wrap around */
+
+  if (++fs->statgen == 0)
+    {
+      memset(fs->statcache, 0, sizeof(fs->statcache));
+      fs->statgen = 1;
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: littlefs_open
  ****************************************************************************/
@@ -336,6 +501,9 @@ static int littlefs_open(FAR struct file *filep, FAR const char *relpath,
   FAR struct littlefs_mountpt_s *fs;
   FAR struct littlefs_file_s *priv;
   FAR struct inode *inode;
+#ifdef CONFIG_FS_PAGECACHE
+  lfs_soff_t size;
+#endif
   int ret;
 
   /* Get the mountpoint inode reference from the file structure and the
@@ -367,12 +535,30 @@ static int littlefs_open(FAR struct file *filep, FAR const char *relpath,
 
   relpath = littlefs_convert_path(relpath);
   oflags = littlefs_convert_oflags(oflags);
+
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+  /* Fail early on files known not to exist */
+
+  if ((oflags & LFS_O_CREAT) == 0 &&
+      littlefs_stat_lookup(fs, relpath, NULL, &ret) && ret == -ENOENT)
+    {
+      goto errout;
+    }
+#endif
+
   ret = littlefs_convert_result(lfs_file_open(&fs->lfs, &priv->file,
                                               relpath, oflags));
   if (ret < 0)
     {
       /* Error opening file */
 
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+      if (ret == -ENOENT && (oflags & LFS_O_CREAT) == 0)
+        {
+          littlefs_stat_add(fs, relpath, NULL, ret);
+        }
+#endif
+
       goto errout;
     }
 
@@ -421,11 +607,29 @@ static int littlefs_open(FAR struct file *filep, FAR const char *relpath,
    */
 
   lfs_file_sync(&fs->lfs, &priv->file);
+#ifdef CONFIG_FS_PAGECACHE
+  size = lfs_file_size(&fs->lfs, &priv->file);
+#endif
   nxmutex_unlock(&fs->lock);
 
   /* Attach the private date to the struct file instance */
 
   filep->f_priv = priv;
+
+#ifdef CONFIG_FS_PAGECACHE
+  /* littlefs has no stable on-media identity for a file (its metadata
+   * pair moves on every commit), so the cache keys it by path.
+   */
+
+  ret = size < 0 ? littlefs_convert_result(size) :
+        pagecache_attach(filep, 0, relpath, size);
+  if (ret < 0)
+    {
+      littlefs_close(filep);
+      return ret;
+    }
+#endif
+
   return OK;
 
 errout_with_file:
@@ -1120,6 +1324,224 @@ static int littlefs_rewinddir(FAR struct inode *mountpt,
   return ret;
 }
 
+/****************************************************************************
+ * Name: littlefs_rcache_find
+ ****************************************************************************/
+
+static FAR struct littlefs_rline_s *
+littlefs_rcache_find(FAR struct littlefs_mountpt_s *fs, lfs_block_t block,
+                     lfs_off_t off)
+{
+  size_t i;
+
+  for (i = 0; i < fs->nrlines; i++)
+    {
+      if (fs->rlines[i].block == block && fs->rlines[i].off == off)
+        {
+          return &fs->rlines[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: littlefs_rcache_read
+ *
+ * Description:
+ *   Serve a read from the shared read cache if all of it is cached.
+ *
+ ****************************************************************************/
+
+static bool littlefs_rcache_read(FAR struct littlefs_mountpt_s *fs,
+                                 lfs_block_t block, lfs_off_t off,
+                                 FAR uint8_t *buffer, lfs_size_t size)
+{
+  FAR struct littlefs_rline_s *line;
+  lfs_size_t rsize = fs->cfg.read_size;
+  lfs_size_t pos;
+
+  for (pos = 0; pos < size; pos += rsize)
+    {
+      line = littlefs_rcache_find(fs, block, off + pos);
+      if (line == NULL)
+        {
+          return false;
+        }
+
+      memcpy(buffer + pos, line->data, rsize);
+      line->stamp = ++fs->rstamp;
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: littlefs_rcache_fill
+ *
+ * Description:
+ *   Copy data just read from the device into the shared read cache,
+ *   replacing the least recently used lines.
+ *
+ ****************************************************************************/
+
+static void littlefs_rcache_fill(FAR struct littlefs_mountpt_s *fs,
+                                 lfs_block_t block, lfs_off_t off,
+                                 FAR const uint8_t *buffer, lfs_size_t size)
+{
+  FAR struct littlefs_rline_s *line;
+  lfs_size_t rsize = fs->cfg.read_size;
+  lfs_size_t pos;
+  size_t i;
+
+  for (pos = 0; pos < size; pos += rsize)
+    {
+      line = littlefs_rcache_find(fs, block, off + pos);
+      if (line == NULL)
+        {
+          line = &fs->rlines[0];
+          for (i = 1; i < fs->nrlines; i++)
+            {
+              if ((int32_t)(fs->rlines[i].stamp - line->stamp) < 0)
+                {
+                  line = &fs->rlines[i];
+                }
+            }
+        }
+
+      memcpy(line->data, buffer + pos, rsize);
+      line->block = block;
+      line->off   = off + pos;
+      line->stamp = ++fs->rstamp;
+    }
+}
+
+/****************************************************************************
+ * Name: littlefs_rcache_invalidate
+ *
+ * Description:
+ *   Drop the cached lines overlapping [off, off + size) of a block.  This
+ *   is called on every program and erase, which also invalidates the stat
+ *   cache.
+ *
+ ****************************************************************************/
+
+static void littlefs_rcache_invalidate(FAR struct littlefs_mountpt_s *fs,
+                                       lfs_block_t block, lfs_off_t off,
+                                       lfs_size_t size)
+{
+  FAR struct littlefs_rline_s *line;
+  size_t i;
+
+  for (i = 0; i < fs->nrlines; i++)
+    {
+      line = &fs->rlines[i];
+      if (line->block == block && line->off < off + size &&
+          line->off + fs->cfg.read_size > off)
+        {
+          line->block = LFS_BLOCK_NULL;
+          line->stamp = 0;
+        }
+    }
+
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+  littlefs_stat_invalidate(fs);
+#endif
+}
+
+/****************************************************************************
+ * Name: littlefs_rcache_init
+ *
+ * Description:
+ *   Allocate the shared read cache: as many read_size lines as fit in
+ *   'budget' bytes.
+ *
+ ****************************************************************************/
+
+static int littlefs_rcache_init(FAR struct littlefs_mountpt_s *fs,
+                                size_t budget)
+{
+  lfs_size_t rsize = fs->cfg.read_size;
+  FAR uint8_t *data;
+  size_t i;
+
+  fs->nrlines = budget / (rsize + sizeof(struct littlefs_rline_s));
+  if (fs->nrlines == 0)
+    {
+      return OK;
+    }
+
+  fs->rlines = fs_heap_malloc(fs->nrlines *
+                              (sizeof(struct littlefs_rline_s) + rsize));
+  if (fs->rlines == NULL)
+    {
+      fs->nrlines = 0;
+      return -ENOMEM;
+    }
+
+  data = (FAR uint8_t *)&fs->rlines[fs->nrlines];
+  for (i = 0; i < fs->nrlines; i++)
+    {
+      fs->rlines[i].block = LFS_BLOCK_NULL;
+      fs->rlines[i].stamp = 0;
+      fs->rlines[i].data  = data + i * rsize;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: littlefs_parse_options
+ *
+ * Description:
+ *   Parse the comma separated mount options:
+ *
+ *     autoformat    - Format the device if it cannot be mounted
+ *     forceformat   - Format the device before mounting it
+ *     cachesize=<n> - Size of each littlefs cache (one per open file plus
+ *                     the read and program caches)
+ *     rcache=<n>    - Memory for the read cache shared by all open files
+ *                     and metadata lookups
+ *
+ *   Unknown options are ignored.
+ *
+ ****************************************************************************/
+
+static void littlefs_parse_options(FAR const char *data,
+                                   FAR struct littlefs_options_s *opts)
+{
+  FAR const char *end;
+  size_t len;
+
+  memset(opts, 0, sizeof(*opts));
+  opts->rcache_size = CONFIG_FS_LITTLEFS_RCACHE_SIZE;
+
+  while (data != NULL && *data != '\0')
+    {
+      end = strchr(data, ',');
+      len = end != NULL ? end - data : strlen(data);
+
+      if (len == 10 && strncmp(data, "autoformat", len) == 0)
+        {
+          opts->autoformat = true;
+        }
+      else if (len == 11 && strncmp(data, "forceformat", len) == 0)
+        {
+          opts->forceformat = true;
+        }
+      else if (strncmp(data, "cachesize=", 10) == 0)
+        {
+          opts->cache_size = strtoul(data + 10, NULL, 0);
+        }
+      else if (strncmp(data, "rcache=", 7) == 0)
+        {
+          opts->rcache_size = strtoul(data + 7, NULL, 0);
+        }
+
+      data = end != NULL ? end + 1 : NULL;
+    }
+}
+
 /****************************************************************************
  * Name: littlefs_bind
  *
@@ -1140,19 +1562,34 @@ static int littlefs_read_block(FAR const struct lfs_config *c,
   FAR struct inode *drv = fs->drv;
   int ret;
 
-  block = (block * c->block_size + off) / geo->blocksize;
-  size  = size / geo->blocksize;
+  if (fs->nrlines > 0 &&
+      littlefs_rcache_read(fs, block, off, buffer, size))
+    {
+      return OK;
+    }
 
   if (INODE_IS_MTD(drv))
     {
-      ret = MTD_BREAD(drv->u.i_mtd, block, size, buffer);
+      ret = MTD_BREAD(drv->u.i_mtd, (block * c->block_size + off) /
+                      geo->blocksize, size / geo->blocksize, buffer);
     }
   else
     {
-      ret = drv->u.i_bops->read(drv, buffer, block, size);
+      ret = drv->u.i_bops->read(drv, buffer, (block * c->block_size + off) /
+                                geo->blocksize, size / geo->blocksize);
     }
 
-  return ret >= 0 ? OK : ret;
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (fs->nrlines > 0)
+    {
+      littlefs_rcache_fill(fs, block, off, buffer, size);
+    }
+
+  return OK;
 }
 
 /****************************************************************************
@@ -1168,6 +1605,8 @@ static int littlefs_write_block(FAR const struct lfs_config *c,
   FAR struct inode *drv = fs->drv;
   int ret;
 
+  littlefs_rcache_invalidate(fs, block, off, size);
+
   block = (block * c->block_size + off) / geo->blocksize;
   size  = size / geo->blocksize;
 
@@ -1194,6 +1633,8 @@ static int littlefs_erase_block(FAR const struct lfs_config *c,
   FAR struct inode *drv = fs->drv;
   int ret = OK;
 
+  littlefs_rcache_invalidate(fs, block, 0, c->block_size);
+
   if (INODE_IS_MTD(drv))
     {
       FAR struct mtd_geometry_s *geo = &fs->geo;
@@ -1243,8 +1684,11 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
                          FAR void **handle)
 {
   FAR struct littlefs_mountpt_s *fs;
+  struct littlefs_options_s opts;
   int ret;
 
+  littlefs_parse_options(data, &opts);
+
   /* Open the block driver */
 
   if (INODE_IS_BLOCK(driver) && driver->u.i_bops->open)
@@ -1272,6 +1716,9 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
 
   fs->drv = driver;        /* Save the driver reference */
   nxmutex_init(&fs->lock); /* Initialize the access control mutex */
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+  fs->statgen = 1;
+#endif
 
   if (INODE_IS_MTD(driver))
     {
@@ -1347,13 +1794,36 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
   fs->cfg.disk_version   = CONFIG_FS_LITTLEFS_DISK_VERSION;
 #endif
 
+  /* Override the cache size if -o cachesize=<n>.  It must be a multiple
+   * of the read and program sizes and a factor of the block size.
+   */
+
+  if (opts.cache_size != 0)
+    {
+      if (opts.cache_size % fs->cfg.read_size != 0 ||
+          opts.cache_size % fs->cfg.prog_size != 0 ||
+          fs->cfg.block_size % opts.cache_size != 0)
+        {
+          ret = -EINVAL;
+          goto errout_with_fs;
+        }
+
+      fs->cfg.cache_size = opts.cache_size;
+    }
+
+  ret = littlefs_rcache_init(fs, opts.rcache_size);
+  if (ret < 0)
+    {
+      goto errout_with_fs;
+    }
+
   /* Then get information about the littlefs filesystem on the devices
    * managed by this driver.
    */
 
   /* Force format the device if -o forceformat */
 
-  if (data && strcmp(data, "forceformat") == 0)
+  if (opts.forceformat)
     {
       ret = littlefs_convert_result(lfs_format(&fs->lfs, &fs->cfg));
       if (ret < 0)
@@ -1367,7 +1837,7 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
     {
       /* Auto format the device if -o autoformat */
 
-      if (ret != -EFAULT || !data || strcmp(data, "autoformat"))
+      if (ret != -EFAULT || !opts.autoformat)
         {
           goto errout_with_fs;
         }
@@ -1391,6 +1861,7 @@ static int littlefs_bind(FAR struct inode *driver, FAR const void *data,
   return OK;
 
 errout_with_fs:
+  fs_heap_free(fs->rlines);
   nxmutex_destroy(&fs->lock);
   fs_heap_free(fs);
 errout_with_block:
@@ -1450,6 +1921,7 @@ static int littlefs_unbind(FAR void *handle, FAR struct inode **driver,
 
       /* Release the mountpoint private data */
 
+      fs_heap_free(fs->rlines);
       nxmutex_destroy(&fs->lock);
       fs_heap_free(fs);
     }
@@ -1528,6 +2000,13 @@ static int littlefs_unlink(FAR struct inode *mountpt,
 
   relpath = littlefs_convert_path(relpath);
   ret = littlefs_convert_result(lfs_remove(&fs->lfs, relpath));
+#ifdef CONFIG_FS_PAGECACHE
+  if (ret >= 0)
+    {
+      pagecache_invalidate(mountpt, 0, relpath);
+    }
+#endif
+
   nxmutex_unlock(&fs->lock);
 
   return ret;
@@ -1672,6 +2151,16 @@ static int littlefs_rename(FAR struct inode *mountpt,
   newrelpath = littlefs_convert_path(newrelpath);
   ret = littlefs_convert_result(lfs_rename(&fs->lfs, oldrelpath,
                                            newrelpath));
+#ifdef CONFIG_FS_PAGECACHE
+  if (ret >= 0)
+    {
+      /* Both names now refer to different contents */
+
+      pagecache_invalidate(mountpt, 0, oldrelpath);
+      pagecache_invalidate(mountpt, 0, newrelpath);
+    }
+#endif
+
   nxmutex_unlock(&fs->lock);
 
   return ret;
@@ -1707,9 +2196,24 @@ static int littlefs_stat(FAR struct inode *mountpt, FAR const char *relpath,
     }
 
   relpath = littlefs_convert_path(relpath);
+
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+  if (littlefs_stat_lookup(fs, relpath, buf, &ret))
+    {
+      goto errout;
+    }
+#endif
+
   ret = lfs_stat(&fs->lfs, relpath, &info);
   if (ret < 0)
     {
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+      if (ret == -ENOENT)
+        {
+          littlefs_stat_add(fs, relpath, NULL, ret);
+        }
+#endif
+
       goto errout;
     }
 
@@ -1751,6 +2255,10 @@ static int littlefs_stat(FAR struct inode *mountpt, FAR const char *relpath,
       buf->st_size = 0;
     }
 
+#if CONFIG_FS_LITTLEFS_STAT_CACHE_NENTRIES > 0
+  littlefs_stat_add(fs, relpath, buf, 0);
+#endif
+
 errout:
   nxmutex_unlock(&fs->lock);
   return ret;
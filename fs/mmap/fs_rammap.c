@@ -27,6 +27,9 @@
 #include <nuttx/config.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
 
 #include <assert.h>
 #include <debug.h>
@@ -36,6 +39,7 @@
 #include <unistd.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/sched.h>
 
@@ -44,50 +48,72 @@
 #include "fs_heap.h"
 
 /****************************************************************************
- * Public Data
+ * Pre-processor Definitions
  ****************************************************************************/
 
+#define RAMMAP_BLOCKSIZE CONFIG_FS_RAMMAP_DIRTY_BLOCKSIZE
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* State of one mapping, hung off the priv.p field of the map entry.  For
+ * shared copies, a second copy of the contents as last read from or
+ * written to the file is kept, so that msync() and munmap() write back
+ * only the blocks that were modified through the mapping.
+ */
+
+struct rammap_s
+{
+  FAR struct file *filep;   /* The mapped file */
+  enum mm_map_type_e type;  /* Where the mapping memory came from */
+  FAR uint8_t *shadow;      /* The contents in the file, NULL if untracked */
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Name: msync_rammap
+ * Name: rammap_free
  ****************************************************************************/
 
-static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
-                        size_t length, int flags)
+static void rammap_free(FAR struct mm_map_entry_s *entry)
 {
-  FAR struct file *filep = (FAR void *)((uintptr_t)entry->priv.p & ~3);
-  FAR uint8_t *wrbuffer = start;
-  ssize_t nwrite = 0;
-  off_t offset;
-  off_t fpos;
-  off_t opos;
+  FAR struct rammap_s *rm = entry->priv.p;
 
-  offset = (uintptr_t)start - (uintptr_t)entry->vaddr;
-  if (length > entry->length - offset)
+  if (rm->type == MAP_KERNEL)
     {
-      length = entry->length - offset;
+      fs_heap_free(entry->vaddr);
     }
-
-  opos = file_seek(filep, 0, SEEK_CUR);
-  if (opos < 0)
+  else if (rm->type == MAP_USER)
     {
-      ferr("ERROR: Get current position failed\n");
-      return opos;
+      kumm_free(entry->vaddr);
     }
 
-  fpos = file_seek(filep, entry->offset + offset, SEEK_SET);
-  if (fpos < 0)
-    {
-      ferr("ERROR: Seek to position %"PRIdOFF" failed\n", fpos);
-      return fpos;
-    }
+  fs_heap_free(rm->shadow);
+  fs_heap_free(rm);
+}
 
-  while (length > 0)
+/****************************************************************************
+ * Name: rammap_write
+ *
+ * Description:
+ *   Write the range [start, end) of the mapping back to the file.
+ *
+ ****************************************************************************/
+
+static int rammap_write(FAR struct mm_map_entry_s *entry,
+                        size_t start, size_t end)
+{
+  FAR struct rammap_s *rm = entry->priv.p;
+  FAR uint8_t *base = entry->vaddr;
+  ssize_t nwrite;
+
+  while (start < end)
     {
-      nwrite = file_write(filep, wrbuffer, length);
+      nwrite = file_pwrite(rm->filep, base + start, end - start,
+                           entry->offset + start);
       if (nwrite < 0)
         {
           /* Handle the special case where the write was interrupted by a
@@ -96,32 +122,119 @@ static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
 
           if (nwrite != -EINTR)
             {
-              /* All other write errors are bad. */
+              ferr("ERROR: Write failed: offset=%" PRIdOFF " nwrite=%zd\n",
+                   entry->offset + (off_t)start, nwrite);
+              return nwrite;
+            }
 
-              ferr("ERROR: Write failed: offset=%"PRIdOFF" nwrite=%zd\n",
-                   entry->offset, nwrite);
+          continue;
+        }
+
+      start += nwrite;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rammap_writeback
+ *
+ * Description:
+ *   Write the range [offset, offset + length) of the mapping back to the
+ *   file.  With dirty tracking, only the blocks whose contents differ from
+ *   the shadow copy are written, consecutive dirty blocks in a single
+ *   write.
+ *
+ ****************************************************************************/
+
+static int rammap_writeback(FAR struct mm_map_entry_s *entry,
+                            size_t offset, size_t length)
+{
+  FAR struct rammap_s *rm = entry->priv.p;
+  FAR uint8_t *base = entry->vaddr;
+  size_t first;
+  size_t last;
+  size_t run;
+  size_t i;
+  int ret;
+
+  if (length == 0)
+    {
+      return OK;
+    }
+
+  if (rm->shadow == NULL)
+    {
+      return rammap_write(entry, offset, offset + length);
+    }
+
+  first = offset / RAMMAP_BLOCKSIZE;
+  last  = (offset + length - 1) / RAMMAP_BLOCKSIZE;
+
+  for (i = first; i <= last; )
+    {
+      /* Find the next run of modified blocks */
+
+      for (run = i; run <= last; run++)
+        {
+          size_t n = MIN(RAMMAP_BLOCKSIZE,
+                         entry->length - run * RAMMAP_BLOCKSIZE);
+
+          if (memcmp(base + run * RAMMAP_BLOCKSIZE,
+                     rm->shadow + run * RAMMAP_BLOCKSIZE, n) == 0)
+            {
               break;
             }
         }
 
-      /* Increment number of bytes written */
+      if (run > i)
+        {
+          size_t start = i * RAMMAP_BLOCKSIZE;
+          size_t end = MIN(run * RAMMAP_BLOCKSIZE, entry->length);
+
+          ret = rammap_write(entry, start, end);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          /* The blocks are clean now */
+
+          memcpy(rm->shadow + start, base + start, end - start);
+        }
 
-      wrbuffer += nwrite;
-      length   -= nwrite;
+      i = run + 1;
     }
 
-  /* Restore file pos */
+  return OK;
+}
+
+/****************************************************************************
+ * Name: msync_rammap
+ ****************************************************************************/
+
+static int msync_rammap(FAR struct mm_map_entry_s *entry, FAR void *start,
+                        size_t length, int flags)
+{
+  FAR struct rammap_s *rm = entry->priv.p;
+  off_t offset;
+
+  /* Private mappings are never written back, and direct mappings are the
+   * file itself.
+   */
 
-  fpos = file_seek(filep, opos, SEEK_SET);
-  if (fpos < 0)
+  if (rm->type == MAP_XIP || (entry->flags & MAP_SHARED) == 0)
     {
-      /* Ensure that we finally seek back to the current file pos */
+      return OK;
+    }
 
-      ferr("ERROR: Seek back to position %"PRIdOFF" failed\n", fpos);
-      return fpos;
+  offset = (uintptr_t)start - (uintptr_t)entry->vaddr;
+  if (length > entry->length - offset)
+    {
+      length = entry->length - offset;
     }
 
-  return nwrite >= 0 ? 0 : nwrite;
+  return rammap_writeback(entry, offset, length);
 }
 
 /****************************************************************************
@@ -133,12 +246,11 @@ static int unmap_rammap(FAR struct task_group_s *group,
                         FAR void *start,
                         size_t length)
 {
-  FAR struct file *filep = (FAR void *)((uintptr_t)entry->priv.p & ~3);
-  enum mm_map_type_e type =
-                    (enum mm_map_type_e)((uintptr_t)entry->priv.p & 3);
+  FAR struct rammap_s *rm = entry->priv.p;
   FAR void *newaddr = NULL;
   off_t offset;
   int ret = OK;
+  int err;
 
   /* Get the offset from the beginning of the region and the actual number
    * of bytes to "unmap".  All mappings must extend to the end of the region.
@@ -160,26 +272,40 @@ static int unmap_rammap(FAR struct task_group_s *group,
 
   length = entry->length - offset;
 
+  /* Modifications to a shared mapping must reach the file before the copy
+   * goes away.  If they cannot, keep the mapping so that munmap() can be
+   * retried, unless the whole address space is being torn down.
+   */
+
+  if (rm->type != MAP_XIP && (entry->flags & MAP_SHARED) != 0)
+    {
+      ret = rammap_writeback(entry, offset, length);
+      if (ret < 0)
+        {
+          ferr("ERROR: Failed to write back the mapping: %d\n", ret);
+          if (group != NULL)
+            {
+              return ret;
+            }
+        }
+    }
+
   /* Are we unmapping the entire region (offset == 0)? */
 
   if (length >= entry->length)
     {
       /* Free the region */
 
-      if (type == MAP_KERNEL)
-        {
-          fs_heap_free(entry->vaddr);
-        }
-      else if (type == MAP_USER)
-        {
-          kumm_free(entry->vaddr);
-        }
-
-      fs_putfilep(filep);
+      fs_putfilep(rm->filep);
+      rammap_free(entry);
 
       /* Then remove the mapping from the list */
 
-      ret = mm_map_remove(get_group_mm(group), entry);
+      err = mm_map_remove(get_group_mm(group), entry);
+      if (ret >= 0)
+        {
+          ret = err;
+        }
     }
 
   /* No.. We have been asked to "unmap' only a portion of the memory
@@ -188,23 +314,71 @@ static int unmap_rammap(FAR struct task_group_s *group,
 
   else
     {
-      if (type == MAP_KERNEL)
+      if (rm->type == MAP_KERNEL)
         {
-          newaddr = fs_heap_realloc(entry->vaddr, length);
+          newaddr = fs_heap_realloc(entry->vaddr, offset);
         }
-      else if (type == MAP_USER)
+      else if (rm->type == MAP_USER)
         {
-          newaddr = kumm_realloc(entry->vaddr, length);
+          newaddr = kumm_realloc(entry->vaddr, offset);
+        }
+      else
+        {
+          newaddr = entry->vaddr;
         }
 
       DEBUGASSERT(newaddr == entry->vaddr);
-      entry->vaddr = newaddr;
-      entry->length = length;
+      entry->vaddr  = newaddr;
+      entry->length = offset;
     }
 
   return ret;
 }
 
+/****************************************************************************
+ * Name: rammap_direct
+ *
+ * Description:
+ *   Map the file in place if its file system can provide the address of
+ *   the file contents (FIOC_XIPBASE), as romfs on XIP media and tmpfs
+ *   can.  Since the file data itself is mapped, this is not possible for
+ *   private mappings that may be written.
+ *
+ ****************************************************************************/
+
+static int rammap_direct(FAR struct file *filep,
+                         FAR struct mm_map_entry_s *entry)
+{
+  struct stat st;
+  uintptr_t base;
+  int ret;
+
+  if ((entry->flags & MAP_SHARED) == 0 && (entry->prot & PROT_WRITE) != 0)
+    {
+      return -EACCES;
+    }
+
+  ret = file_fstat(filep, &st);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (entry->offset < 0 || entry->offset + entry->length > st.st_size)
+    {
+      return -EINVAL;
+    }
+
+  ret = file_ioctl(filep, FIOC_XIPBASE, (unsigned long)&base);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  entry->vaddr = (FAR void *)(base + entry->offset);
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -214,6 +388,8 @@ static int unmap_rammap(FAR struct task_group_s *group,
  *
  * Description:
  *   Support simulation of memory mapped files by copying files into RAM.
+ *   Files whose contents are directly addressable are mapped in place
+ *   instead.
  *
  * Input Parameters:
  *   filep   file descriptor of the backing file -- required.
@@ -237,16 +413,31 @@ static int unmap_rammap(FAR struct task_group_s *group,
 int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
            enum mm_map_type_e type)
 {
+  FAR struct rammap_s *rm;
   FAR uint8_t *rdbuffer;
   ssize_t nread;
+  size_t length = entry->length;
   off_t fpos;
   int ret;
-  size_t length = entry->length;
 
   ret = file_ioctl(filep, BIOC_XIPBASE, (unsigned long)&entry->vaddr);
-  if (ret == OK)
+  if (ret == OK || rammap_direct(filep, entry) == OK)
     {
       type = MAP_XIP;
+    }
+
+  rm = fs_heap_malloc(sizeof(struct rammap_s));
+  if (rm == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  rm->filep  = filep;
+  rm->type   = type;
+  rm->shadow = NULL;
+
+  if (type == MAP_XIP)
+    {
       goto out;
     }
 
@@ -270,30 +461,21 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
   if (!rdbuffer)
     {
       ferr("ERROR: Region allocation failed, length: %zu\n", length);
+      fs_heap_free(rm);
       return -ENOMEM;
     }
 
   entry->vaddr = rdbuffer; /* save the buffer firstly */
+  entry->priv.p = rm;
 
-  /* Seek to the specified file offset */
-
-  fpos = file_seek(filep, entry->offset, SEEK_SET);
-  if (fpos < 0)
-    {
-      /* Seek failed... errno has already been set, but EINVAL is probably
-       * the correct response.
-       */
-
-      ferr("ERROR: Seek to position %zu failed\n", (size_t)entry->offset);
-      ret = fpos;
-      goto errout_with_region;
-    }
-
-  /* Read the file data into the memory region */
+  /* Read the file data into the memory region, leaving the file position
+   * alone.
+   */
 
+  fpos = entry->offset;
   while (length > 0)
     {
-      nread = file_read(filep, rdbuffer, length);
+      nread = file_pread(filep, rdbuffer, length, fpos);
       if (nread < 0)
         {
           /* Handle the special case where the read was interrupted by a
@@ -310,6 +492,8 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
               ret = nread;
               goto errout_with_region;
             }
+
+          continue;
         }
 
       /* Check for end of file. */
@@ -323,37 +507,44 @@ int rammap(FAR struct file *filep, FAR struct mm_map_entry_s *entry,
 
       rdbuffer += nread;
       length   -= nread;
+      fpos     += nread;
     }
 
   /* Zero any memory beyond the amount read from the file */
 
   memset(rdbuffer, 0, length);
 
+  /* Record the clean contents of a shared copy.  Without the memory for
+   * that, the whole range is written back instead.
+   */
+
+  if ((entry->flags & MAP_SHARED) != 0 && RAMMAP_BLOCKSIZE > 0)
+    {
+      rm->shadow = fs_heap_malloc(entry->length);
+      if (rm->shadow != NULL)
+        {
+          memcpy(rm->shadow, entry->vaddr, entry->length);
+        }
+    }
+
   /* Add the buffer to the list of regions */
 
 out:
   fs_reffilep(filep);
-  entry->priv.p = (FAR void *)((uintptr_t)filep | type);
+  entry->priv.p = rm;
   entry->munmap = unmap_rammap;
   entry->msync = msync_rammap;
 
   ret = mm_map_add(get_current_mm(), entry);
   if (ret < 0)
     {
+      fs_putfilep(filep);
       goto errout_with_region;
     }
 
   return OK;
 
 errout_with_region:
-  if (type == MAP_KERNEL)
-    {
-      fs_heap_free(entry->vaddr);
-    }
-  else if (type == MAP_USER)
-    {
-      kumm_free(entry->vaddr);
-    }
-
+  rammap_free(entry);
   return ret;
 }
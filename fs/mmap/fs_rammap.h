@@ -26,14 +26,19 @@
  * that do not have MMUs and, hence, cannot support on demand paging of
  * blocks of a file.
  *
+ * Files whose contents are directly addressable (the file system supports
+ * FIOC_XIPBASE) are mapped in place instead, unless the mapping is private
+ * and writable.
+ *
  * This copied file has many of the properties of a standard memory mapped
  * file except:
  *
- * - All of the file must be present in memory.  This limits the size of
- *   files that may be memory mapped (especially on MCUs with no significant
- *   RAM resources).
- * - All mapped files are read-only.  You can write to the in-memory image,
- *   but the file contents will not change.
+ * - All of the mapped range must be present in memory.  This limits the
+ *   size of files that may be memory mapped (especially on MCUs with no
+ *   significant RAM resources).
+ * - Changes to a shared mapping reach the file only on msync() or
+ *   munmap().  Only the blocks modified since they were last read or
+ *   written back are written.
  * - There are not access privileges.
  */
 
@@ -32,6 +32,7 @@
 #include <assert.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "inode/inode.h"
 #include "notify/notify.h"
@@ -127,6 +128,12 @@ int nx_umount2(FAR const char *target, unsigned int flags)
       goto errout_with_lock;
     }
 
+#ifdef CONFIG_FS_PAGECACHE
+  /* Successfully unbound.  Forget the pages cached for the mountpoint. */
+
+  pagecache_umount(mountpt_inode);
+#endif
+
   /* Successfully unbound.  Convert the mountpoint inode to regular
    * pseudo-file inode.
    */
@@ -0,0 +1,350 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsheapprof.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/mm/heapprof.h>
+
+#include "fs_heap.h"
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#ifdef CONFIG_MM_HEAPPROF
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct heapprof_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  struct heapprof_info_s info;       /* Sampler state of the snapshot */
+  int nstacks;                       /* Valid entries in stacks[] */
+  struct heapprof_stack_s stacks[CONFIG_MM_HEAPPROF_NSTACKS];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     hprof_open(FAR struct file *filep,
+                 FAR const char *relpath, int oflags, mode_t mode);
+static int     hprof_close(FAR struct file *filep);
+static ssize_t hprof_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t hprof_write(FAR struct file *filep,
+                 FAR const char *buffer, size_t buflen);
+
+static int     hprof_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     hprof_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations g_heapprof_operations =
+{
+  hprof_open,        /* open */
+  hprof_close,       /* close */
+  hprof_read,        /* read */
+  hprof_write,       /* write */
+  NULL,              /* poll */
+
+  hprof_dup,         /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  hprof_stat         /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hprof_open
+ ****************************************************************************/
+
+static int hprof_open(FAR struct file *filep, FAR const char *relpath,
+                      int oflags, mode_t mode)
+{
+  FAR struct heapprof_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = fs_heap_zalloc(sizeof(struct heapprof_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hprof_close
+ ****************************************************************************/
+
+static int hprof_close(FAR struct file *filep)
+{
+  FAR struct heapprof_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct heapprof_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  fs_heap_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hprof_read
+ *
+ * Description:
+ *   Format the profile in the legacy text heap profile format read by
+ *   pprof: a header line with the totals and the sampling rate, then one
+ *   line per call stack, "inuse_objs: inuse_bytes [alloc_objs:
+ *   alloc_bytes] @ pc...".  The values are the raw sampled ones; pprof
+ *   scales them by the rate given in the header.
+ *
+ ****************************************************************************/
+
+static ssize_t hprof_read(FAR struct file *filep, FAR char *buffer,
+                          size_t buflen)
+{
+  FAR struct heapprof_file_s *attr;
+  FAR struct heapprof_stack_s *stack;
+  unsigned long inuse_objs = 0;
+  unsigned long alloc_objs = 0;
+  uint64_t alloc_bytes = 0;
+  size_t inuse_bytes = 0;
+  off_t offset;
+  int i;
+  int j;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct heapprof_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Take the snapshot only at the start of the file, so that the profile
+   * remains consistent if the user reads the file a few bytes at a time.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      attr->nstacks = heapprof_snapshot(&attr->info, attr->stacks,
+                                        CONFIG_MM_HEAPPROF_NSTACKS);
+    }
+
+  for (i = 0; i < attr->nstacks; i++)
+    {
+      stack        = &attr->stacks[i];
+      inuse_objs  += stack->inuse_objs;
+      inuse_bytes += stack->inuse_bytes;
+      alloc_objs  += stack->alloc_objs;
+      alloc_bytes += stack->alloc_bytes;
+    }
+
+  offset = filep->f_pos;
+  procfs_sprintf(buffer, buflen, &offset,
+                 "heap profile: %lu: %zu [%lu: %" PRIu64 "] @ heap_v2/%zu\n",
+                 inuse_objs, inuse_bytes, alloc_objs, alloc_bytes,
+                 MAX(attr->info.rate, 1));
+
+  for (i = 0; i < attr->nstacks; i++)
+    {
+      stack = &attr->stacks[i];
+      procfs_sprintf(buffer, buflen, &offset,
+                     "%lu: %zu [%lu: %" PRIu64 "] @",
+                     stack->inuse_objs, stack->inuse_bytes,
+                     stack->alloc_objs, stack->alloc_bytes);
+
+      for (j = 0; j < stack->depth; j++)
+        {
+          procfs_sprintf(buffer, buflen, &offset, " %p", stack->pc[j]);
+        }
+
+      procfs_sprintf(buffer, buflen, &offset, "\n");
+    }
+
+  procfs_sprintf(buffer, buflen, &offset,
+                 "# live samples: %u\n"
+                 "# dropped samples: %lu\n",
+                 attr->info.nlive, attr->info.dropped);
+
+  /* Update the file offset */
+
+  if (offset < 0)
+    {
+      filep->f_pos += -offset;
+      return -offset;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: hprof_write
+ *
+ * Description:
+ *   "reset" discards the profile, a number sets the sampling rate in bytes
+ *   (0 stops sampling).
+ *
+ ****************************************************************************/
+
+static ssize_t hprof_write(FAR struct file *filep,
+                           FAR const char *buffer, size_t buflen)
+{
+  char cmd[16];
+  FAR char *end;
+  size_t rate;
+
+  DEBUGASSERT(buffer != NULL);
+
+  /* The whole write is consumed, so it must hold the whole command */
+
+  if (buflen >= sizeof(cmd))
+    {
+      return -EINVAL;
+    }
+
+  memcpy(cmd, buffer, buflen);
+  cmd[buflen] = '\0';
+
+  if (strncmp(cmd, "reset", 5) == 0)
+    {
+      heapprof_reset();
+      return buflen;
+    }
+
+  rate = strtoul(cmd, &end, 0);
+  if (end == cmd || (*end != '\0' && *end != '\n'))
+    {
+      return -EINVAL;
+    }
+
+  heapprof_setrate(rate);
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: hprof_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int hprof_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct heapprof_file_s *oldattr;
+  FAR struct heapprof_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct heapprof_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = fs_heap_malloc(sizeof(struct heapprof_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct heapprof_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: hprof_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int hprof_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "heapprof" is the name for a read/write file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+
+#endif /* CONFIG_MM_HEAPPROF */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
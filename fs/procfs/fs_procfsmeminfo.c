@@ -403,6 +403,46 @@ static ssize_t meminfo_read(FAR struct file *filep, FAR char *buffer,
     }
 #endif
 
+#ifdef CONFIG_MM_IDLE_WORKER
+  /* Then the work done on each heap by the idle workers */
+
+  if (buflen > 0)
+    {
+      buffer    += copysize;
+      buflen    -= copysize;
+
+      linesize   = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                                   "%11s%11s%11s%s\n",
+                                   "idlefreed", "scrubbed", "nzeroed",
+                                   " name");
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                                 &offset);
+      totalsize += copysize;
+    }
+
+  for (entry = g_procfs_meminfo; entry != NULL; entry = entry->next)
+    {
+      if (buflen > 0)
+        {
+          struct mm_idleinfo_s idle;
+
+          buffer    += copysize;
+          buflen    -= copysize;
+
+          mm_idleinfo(entry->heap, &idle);
+          linesize   = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                                       "%11lu%11lu%11lu %s\n",
+                                       (unsigned long)idle.nfreed,
+                                       (unsigned long)idle.scrubbed,
+                                       (unsigned long)idle.nzeroed,
+                                       entry->name);
+          copysize   = procfs_memcpy(procfile->line, linesize, buffer,
+                                     buflen, &offset);
+          totalsize += copysize;
+        }
+    }
+#endif
+
   /* Update the file offset */
 
   filep->f_pos += totalsize;
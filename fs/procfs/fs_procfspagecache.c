@@ -0,0 +1,300 @@
+/****************************************************************************
+ * fs/procfs/fs_procfspagecache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/pagecache.h>
+#include <nuttx/fs/procfs.h>
+
+#include "fs_heap.h"
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#ifdef CONFIG_FS_PAGECACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Determines the size of an intermediate buffer that must be large enough
+ * to hold all of the statistics generated by this logic.
+ */
+
+#define PAGECACHE_BUFLEN 192
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct pgcache_file_s
+{
+  struct procfs_file_s  base;        /* Base open file structure */
+  unsigned int bufsize;              /* Number of valid characters in buf[] */
+  char buf[PAGECACHE_BUFLEN];        /* Pre-allocated buffer for the report */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     pgcache_open(FAR struct file *filep,
+                 FAR const char *relpath, int oflags, mode_t mode);
+static int     pgcache_close(FAR struct file *filep);
+static ssize_t pgcache_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     pgcache_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     pgcache_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations g_pagecache_operations =
+{
+  pgcache_open,      /* open */
+  pgcache_close,     /* close */
+  pgcache_read,      /* read */
+  NULL,              /* write */
+  NULL,              /* poll */
+
+  pgcache_dup,       /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  pgcache_stat       /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pgcache_open
+ ****************************************************************************/
+
+static int pgcache_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+  FAR struct pgcache_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      ferr("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = fs_heap_zalloc(sizeof(struct pgcache_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pgcache_close
+ ****************************************************************************/
+
+static int pgcache_close(FAR struct file *filep)
+{
+  FAR struct pgcache_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct pgcache_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  fs_heap_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pgcache_read
+ ****************************************************************************/
+
+static ssize_t pgcache_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct pgcache_file_s *attr;
+  struct pagecache_stats_s stats;
+  unsigned long lookups;
+  unsigned long hitrate;
+  off_t offset;
+  ssize_t ret;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct pgcache_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Sample the statistics only at the start of the file, so that they
+   * remain consistent if the user reads the file a few bytes at a time.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      pagecache_stats(&stats);
+
+      lookups = stats.hits + stats.misses;
+      hitrate = lookups > 0 ? stats.hits * 100 / lookups : 0;
+      attr->bufsize = procfs_snprintf(attr->buf, PAGECACHE_BUFLEN,
+                                      "Pages:      %u/%d\n"
+                                      "Dirty:      %u\n"
+                                      "Hits:       %lu\n"
+                                      "Misses:     %lu\n"
+                                      "HitRate:    %lu%%\n"
+                                      "Readahead:  %lu\n"
+                                      "Evictions:  %lu\n"
+                                      "Writebacks: %lu\n",
+                                      stats.npages,
+                                      CONFIG_FS_PAGECACHE_NPAGES,
+                                      stats.ndirty, stats.hits,
+                                      stats.misses, hitrate,
+                                      stats.readahead, stats.evictions,
+                                      stats.writebacks);
+    }
+
+  /* Transfer the statistics to user receive buffer */
+
+  offset = filep->f_pos;
+  ret = procfs_memcpy(attr->buf, attr->bufsize, buffer, buflen, &offset);
+
+  /* Update the file offset */
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pgcache_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int pgcache_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct pgcache_file_s *oldattr;
+  FAR struct pgcache_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct pgcache_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = fs_heap_malloc(sizeof(struct pgcache_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct pgcache_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pgcache_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int pgcache_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "pagecache" is the name for a read-only file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#endif /* CONFIG_FS_PAGECACHE */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
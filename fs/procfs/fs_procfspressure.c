@@ -34,6 +34,7 @@
 #include <nuttx/fs/procfs.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/nuttx.h>
 #include <nuttx/queue.h>
 #include <nuttx/spinlock.h>
@@ -425,6 +426,15 @@ void mm_notify_pressure(size_t remaining, size_t largest)
   FAR dq_entry_t *tmp;
   uint32_t flags;
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Ask the kernel caches for memory before allocations start to fail */
+
+  if (remaining < CONFIG_MM_SHRINKER_WATERMARK)
+    {
+      mm_shrink(CONFIG_MM_SHRINKER_WATERMARK - remaining);
+    }
+#endif
+
   flags       = spin_lock_irqsave(&g_pressure_lock);
   g_remaining = remaining;
   g_largest   = largest;
@@ -99,6 +99,9 @@ enum proc_node_e
 #ifdef CONFIG_SCHED_CRITMONITOR
   PROC_CRITMON,                       /* Critical section monitor */
 #endif
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  PROC_LATENCY,                       /* Run-queue latency statistics */
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
   PROC_HEAP,                          /* Task heap info */
 #endif
@@ -190,6 +193,11 @@ static ssize_t proc_critmon(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
 #endif
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+static ssize_t proc_latency(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
 static ssize_t proc_heap(FAR struct proc_file_s *procfile,
                          FAR struct tcb_s *tcb, FAR char *buffer,
@@ -302,6 +310,13 @@ static const struct proc_node_s g_critmon =
 };
 #endif
 
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+static const struct proc_node_s g_latency =
+{
+  "latency",       "latency", (uint8_t)PROC_LATENCY,     DTYPE_FILE        /* Run-queue latency statistics */
+};
+#endif
+
 #if CONFIG_MM_BACKTRACE >= 0
 static const struct proc_node_s g_heap =
 {
@@ -356,6 +371,9 @@ static FAR const struct proc_node_s * const g_nodeinfo[] =
 #ifdef CONFIG_SCHED_CRITMONITOR
   &g_critmon,      /* Critical section Monitor */
 #endif
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  &g_latency,      /* Run-queue latency statistics */
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
   &g_heap,         /* Task heap info */
 #endif
@@ -385,6 +403,9 @@ static const struct proc_node_s * const g_level0info[] =
 #ifdef CONFIG_SCHED_CRITMONITOR
   &g_critmon,      /* Critical section monitor */
 #endif
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  &g_latency,      /* Run-queue latency statistics */
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
   &g_heap,         /* Task heap info */
 #endif
@@ -880,6 +901,90 @@ static ssize_t proc_critmon(FAR struct proc_file_s *procfile,
 }
 #endif
 
+/****************************************************************************
+ * Name: proc_latency
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+static ssize_t proc_latency(FAR struct proc_file_s *procfile,
+                            FAR struct tcb_s *tcb, FAR char *buffer,
+                            size_t buflen, off_t offset)
+{
+  struct timespec runtime;
+  struct timespec waittime;
+  struct timespec maxtime;
+  struct timespec bound;
+  size_t remaining;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  int i;
+
+  perf_convert(tcb->run_time, &runtime);
+  perf_convert(tcb->wait_time, &waittime);
+  perf_convert(tcb->wait_max, &maxtime);
+
+  /* Output the total time run, the total and the maximum time spent
+   * waiting for the CPU.
+   */
+
+  linesize  = procfs_snprintf(procfile->line, STATUS_LINELEN,
+                              "%-12s%lu.%09lu\n"
+                              "%-12s%lu.%09lu\n"
+                              "%-12s%lu.%09lu\n",
+                              "RunTime:",
+                              (unsigned long)runtime.tv_sec,
+                              (unsigned long)runtime.tv_nsec,
+                              "WaitTime:",
+                              (unsigned long)waittime.tv_sec,
+                              (unsigned long)waittime.tv_nsec,
+                              "WaitMax:",
+                              (unsigned long)maxtime.tv_sec,
+                              (unsigned long)maxtime.tv_nsec);
+  copysize  = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                            &offset);
+
+  totalsize = copysize;
+  buffer   += copysize;
+  remaining = buflen - copysize;
+
+  /* Then one line per histogram bucket: the lower bound of the bucket in
+   * nanoseconds followed by the number of latencies that fell into it.
+   */
+
+  for (i = 0; i < CONFIG_SCHED_CRITMONITOR_LATENCY_NBUCKETS; i++)
+    {
+      if (totalsize >= buflen)
+        {
+          break;
+        }
+
+      if (i > 0)
+        {
+          perf_convert((clock_t)1 << (i - 1), &bound);
+        }
+      else
+        {
+          bound.tv_sec  = 0;
+          bound.tv_nsec = 0;
+        }
+
+      linesize   = procfs_snprintf(procfile->line, STATUS_LINELEN,
+                                   ">=%12" PRIu64 "ns %10" PRIu32 "\n",
+                                   (uint64_t)bound.tv_sec * NSEC_PER_SEC +
+                                   bound.tv_nsec, tcb->wait_hist[i]);
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer,
+                                 remaining, &offset);
+
+      totalsize += copysize;
+      buffer    += copysize;
+      remaining -= copysize;
+    }
+
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: proc_heap
  ****************************************************************************/
@@ -1626,6 +1731,11 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer,
       ret = proc_critmon(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
 #endif
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+    case PROC_LATENCY: /* Run-queue latency statistics */
+      ret = proc_latency(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
     case PROC_HEAP: /* Task heap info */
       ret = proc_heap(procfile, tcb, buffer, buflen, filep->f_pos);
@@ -0,0 +1,304 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsshrinker.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/mm/shrinker.h>
+
+#include "fs_heap.h"
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#ifdef CONFIG_MM_SHRINKER
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct shrinker_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+};
+
+/* State of the formatting of one read */
+
+struct shrinker_read_s
+{
+  FAR char *buffer;                  /* User buffer */
+  size_t buflen;                     /* Size of the user buffer */
+  off_t offset;                      /* procfs_sprintf() offset */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     shrinker_open(FAR struct file *filep,
+                 FAR const char *relpath, int oflags, mode_t mode);
+static int     shrinker_close(FAR struct file *filep);
+static ssize_t shrinker_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t shrinker_write(FAR struct file *filep,
+                 FAR const char *buffer, size_t buflen);
+
+static int     shrinker_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     shrinker_stat(FAR const char *relpath,
+                 FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations g_shrinker_operations =
+{
+  shrinker_open,     /* open */
+  shrinker_close,    /* close */
+  shrinker_read,     /* read */
+  shrinker_write,    /* write */
+  NULL,              /* poll */
+
+  shrinker_dup,      /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  shrinker_stat      /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: shrinker_open
+ ****************************************************************************/
+
+static int shrinker_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct shrinker_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = fs_heap_zalloc(sizeof(struct shrinker_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: shrinker_close
+ ****************************************************************************/
+
+static int shrinker_close(FAR struct file *filep)
+{
+  FAR struct shrinker_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct shrinker_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  fs_heap_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: shrinker_line
+ ****************************************************************************/
+
+static void shrinker_line(FAR struct shrinker_s *shrinker, FAR void *arg)
+{
+  FAR struct shrinker_read_s *rd = arg;
+
+  procfs_sprintf(rd->buffer, rd->buflen, &rd->offset,
+                 "%-16s %10zu %10lu %10zu %10zu\n",
+                 shrinker->name, shrinker->count(shrinker),
+                 shrinker->nscan, shrinker->scanned, shrinker->freed);
+}
+
+/****************************************************************************
+ * Name: shrinker_read
+ *
+ * Description:
+ *   One line per shrinker: the bytes it could release now, the number of
+ *   times it was asked for memory, the bytes asked and the bytes it
+ *   released.
+ *
+ ****************************************************************************/
+
+static ssize_t shrinker_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  struct shrinker_read_s rd;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  rd.buffer = buffer;
+  rd.buflen = buflen;
+  rd.offset = filep->f_pos;
+
+  procfs_sprintf(buffer, buflen, &rd.offset,
+                 "%-16s %10s %10s %10s %10s\n",
+                 "name", "count", "nscan", "scanned", "freed");
+  mm_shrinker_foreach(shrinker_line, &rd);
+
+  /* Update the file offset */
+
+  if (rd.offset < 0)
+    {
+      filep->f_pos += -rd.offset;
+      return -rd.offset;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: shrinker_write
+ *
+ * Description:
+ *   Writing a number of bytes asks the caches to release that much memory.
+ *
+ ****************************************************************************/
+
+static ssize_t shrinker_write(FAR struct file *filep,
+                              FAR const char *buffer, size_t buflen)
+{
+  char cmd[16];
+  FAR char *end;
+  size_t size;
+
+  DEBUGASSERT(buffer != NULL);
+
+  buflen = MIN(buflen, sizeof(cmd) - 1);
+  memcpy(cmd, buffer, buflen);
+  cmd[buflen] = '\0';
+
+  size = strtoul(cmd, &end, 0);
+  if (end == cmd || (*end != '\0' && *end != '\n'))
+    {
+      return -EINVAL;
+    }
+
+  mm_shrink(size);
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: shrinker_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int shrinker_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct shrinker_file_s *oldattr;
+  FAR struct shrinker_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct shrinker_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = fs_heap_malloc(sizeof(struct shrinker_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct shrinker_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: shrinker_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int shrinker_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "shrinker" is the name for a read/write file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return OK;
+}
+
+#endif /* CONFIG_MM_SHRINKER */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -42,6 +42,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "fs_romfs.h"
 #include "fs_heap.h"
@@ -324,6 +325,22 @@ static int romfs_open(FAR struct file *filep, FAR const char *relpath,
 #endif
 
   nxrmutex_unlock(&rm->rm_lock);
+
+#if defined(CONFIG_FS_PAGECACHE) && !defined(CONFIG_FS_ROMFS_WRITEABLE)
+  /* XIP images are already memory mapped, everything else is served
+   * through the page cache.  The data offset identifies the file.
+   */
+
+  if (rm->rm_xipbase == NULL)
+    {
+      ret = pagecache_attach(filep, rf->rf_startoffset, NULL, rf->rf_size);
+      if (ret < 0)
+        {
+          romfs_close(filep);
+        }
+    }
+#endif
+
   return ret;
 
 errout_with_sem:
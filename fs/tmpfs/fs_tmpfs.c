@@ -28,6 +28,7 @@
 
 #include <sys/stat.h>
 #include <sys/statfs.h>
+#include <sys/param.h>
 #include <stdint.h>
 #include <string.h>
 #include <fcntl.h>
@@ -54,10 +55,6 @@
 #  warning CONFIG_FS_TMPFS_DIRECTORY_FREEGUARD needs to be > ALLOCGUARD
 #endif
 
-#if CONFIG_FS_TMPFS_FILE_FREEGUARD <= CONFIG_FS_TMPFS_FILE_ALLOCGUARD
-#  warning CONFIG_FS_TMPFS_FILE_FREEGUARD needs to be > ALLOCGUARD
-#endif
-
 #define tmpfs_lock(fs) \
            nxrmutex_lock(&fs->tfs_lock)
 #define tmpfs_lock_object(to) \
@@ -94,8 +91,15 @@ struct tmpfs_dir_s
 
 static int  tmpfs_realloc_directory(FAR struct tmpfs_directory_s *tdo,
               unsigned int nentries);
-static int  tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
+static int  tmpfs_grow_pagetable(FAR struct tmpfs_file_s *tfo,
+              size_t npages);
+static FAR uint8_t *tmpfs_get_page(FAR struct tmpfs_file_s *tfo,
+              size_t index, bool alloc);
+static void tmpfs_free_pages(FAR struct tmpfs_file_s *tfo, size_t first);
+static void tmpfs_free_data(FAR struct tmpfs_file_s *tfo);
+static void tmpfs_resize_file(FAR struct tmpfs_file_s *tfo,
               size_t newsize);
+static int  tmpfs_linearize_file(FAR struct tmpfs_file_s *tfo);
 static void tmpfs_release_lockedobject(FAR struct tmpfs_object_s *to);
 static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo);
 static int  tmpfs_release_file(FAR struct tmpfs_file_s *tfo);
@@ -269,80 +273,244 @@ static int tmpfs_realloc_directory(FAR struct tmpfs_directory_s *tdo,
 }
 
 /****************************************************************************
- * Name: tmpfs_realloc_file
+ * Name: tmpfs_grow_pagetable
  ****************************************************************************/
 
-static int tmpfs_realloc_file(FAR struct tmpfs_file_s *tfo,
-                              size_t newsize)
+static int tmpfs_grow_pagetable(FAR struct tmpfs_file_s *tfo,
+                                size_t npages)
 {
-  FAR uint8_t *newdata;
-  size_t allocsize;
-  size_t delta;
+  FAR uint8_t **pages;
+  size_t newsize;
 
-  /* Are we growing or shrinking the object? */
+  if (npages <= tfo->tfo_npages)
+    {
+      return OK;
+    }
+
+  /* Double the table so that appending costs O(1) amortized */
 
-  if (newsize <= tfo->tfo_alloc)
+  newsize = MAX(npages, 2 * tfo->tfo_npages);
+  pages   = fs_heap_realloc(tfo->tfo_pages, newsize * sizeof(*pages));
+  if (pages == NULL)
     {
-      /* Shrinking ... Shrink unconditionally if the size is shrinking to
-       * zero.
-       */
+      return -ENOMEM;
+    }
+
+  memset(&pages[tfo->tfo_npages], 0,
+         (newsize - tfo->tfo_npages) * sizeof(*pages));
+
+  tfo->tfo_pages  = pages;
+  tfo->tfo_npages = newsize;
+  return OK;
+}
 
-      if (newsize == 0)
+/****************************************************************************
+ * Name: tmpfs_get_page
+ *
+ * Description:
+ *   Return the page holding the file data at page index 'index'.  If the
+ *   page was never written, NULL is returned unless 'alloc' is true, in
+ *   which case a zeroed page is allocated (NULL then means out of memory).
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *tmpfs_get_page(FAR struct tmpfs_file_s *tfo,
+                                   size_t index, bool alloc)
+{
+  FAR uint8_t *page = NULL;
+
+  if (index < tfo->tfo_npages)
+    {
+      page = tfo->tfo_pages[index];
+    }
+
+  if (page == NULL && alloc)
+    {
+      if (tmpfs_grow_pagetable(tfo, index + 1) < 0)
         {
-          /* Free the file object */
+          return NULL;
+        }
 
-          fs_heap_free(tfo->tfo_data);
-          tfo->tfo_data = NULL;
-          tfo->tfo_alloc = 0;
-          tfo->tfo_size = 0;
-          return OK;
+      page = fs_heap_zalloc(TMPFS_PAGESIZE);
+      if (page != NULL)
+        {
+          tfo->tfo_pages[index] = page;
+          tfo->tfo_alloc       += TMPFS_PAGESIZE;
         }
-      else if (newsize > 0)
+    }
+
+  return page;
+}
+
+/****************************************************************************
+ * Name: tmpfs_free_pages
+ *
+ * Description:
+ *   Release the pages of a file from page index 'first' on.  Pages that
+ *   may be mapped (part of the contiguous copy or while the file has any
+ *   mapping) are zeroed instead.
+ *
+ ****************************************************************************/
+
+static void tmpfs_free_pages(FAR struct tmpfs_file_s *tfo, size_t first)
+{
+  size_t i;
+
+  for (i = first; i < tfo->tfo_npages; i++)
+    {
+      FAR uint8_t *page = tfo->tfo_pages[i];
+
+      if (page == NULL)
         {
-          /* Otherwise, don't realloc unless the object has shrunk by a
-           * lot.
-           */
+          continue;
+        }
 
-          delta = tfo->tfo_alloc - newsize;
+      if (i < tfo->tfo_nlinear || tfo->tfo_nmaps > 0)
+        {
+          memset(page, 0, TMPFS_PAGESIZE);
+        }
+      else
+        {
+          fs_heap_free(page);
+          tfo->tfo_pages[i] = NULL;
+          tfo->tfo_alloc   -= TMPFS_PAGESIZE;
+        }
+    }
+}
 
-          /* We should make sure the shrunked memory be zero */
+/****************************************************************************
+ * Name: tmpfs_free_data
+ *
+ * Description:
+ *   Release all memory holding the data of a file that is being freed.
+ *
+ ****************************************************************************/
 
-          memset(tfo->tfo_data + newsize, 0, delta);
-          if (delta <= CONFIG_FS_TMPFS_FILE_FREEGUARD)
-            {
-              /* Hasn't shrunk enough.. Return doing nothing for now */
+static void tmpfs_free_data(FAR struct tmpfs_file_s *tfo)
+{
+  size_t i;
 
-              tfo->tfo_size = newsize;
-              return OK;
+  for (i = tfo->tfo_nlinear; i < tfo->tfo_npages; i++)
+    {
+      fs_heap_free(tfo->tfo_pages[i]);
+    }
+
+  fs_heap_free(tfo->tfo_pages);
+  fs_heap_free(tfo->tfo_linear);
+
+  tfo->tfo_pages   = NULL;
+  tfo->tfo_npages  = 0;
+  tfo->tfo_linear  = NULL;
+  tfo->tfo_nlinear = 0;
+  tfo->tfo_alloc   = 0;
+}
+
+/****************************************************************************
+ * Name: tmpfs_resize_file
+ *
+ * Description:
+ *   Change the size of a file.  Growing is free: the new range reads as
+ *   zeroes until it is written.  Shrinking releases the pages past the new
+ *   end and zeroes the tail of the last page, so that growing again also
+ *   reads back zeroes.
+ *
+ ****************************************************************************/
+
+static void tmpfs_resize_file(FAR struct tmpfs_file_s *tfo, size_t newsize)
+{
+  if (newsize < tfo->tfo_size)
+    {
+      size_t npages = TMPFS_NPAGES(newsize);
+      size_t offset = newsize % TMPFS_PAGESIZE;
+      FAR uint8_t *page;
+
+      tmpfs_free_pages(tfo, npages);
+
+      if (offset != 0)
+        {
+          page = tmpfs_get_page(tfo, npages - 1, false);
+          if (page != NULL)
+            {
+              memset(page + offset, 0, TMPFS_PAGESIZE - offset);
             }
         }
+
+      if (newsize == 0 && tfo->tfo_nmaps == 0)
+        {
+          tmpfs_free_data(tfo);
+        }
     }
 
-  /* Added some additional amount to the new size to account frequent
-   * reallocations.
-   */
+  tfo->tfo_size = newsize;
+}
+
+/****************************************************************************
+ * Name: tmpfs_linearize_file
+ *
+ * Description:
+ *   Gather the whole file into one contiguous allocation, for mmap() and
+ *   XIP users that need the data at consecutive addresses.  The pages of
+ *   the file then point into that allocation, so later writes are seen
+ *   through the mapping.
+ *
+ *   The contiguous copy cannot move once it exists, since it may be in
+ *   use; -EBUSY is returned if the file has grown beyond it since.
+ *
+ ****************************************************************************/
 
-  allocsize = newsize + CONFIG_FS_TMPFS_FILE_ALLOCGUARD;
-  if (allocsize < newsize)
+static int tmpfs_linearize_file(FAR struct tmpfs_file_s *tfo)
+{
+  FAR uint8_t *linear;
+  size_t npages;
+  size_t i;
+  int ret;
+
+  npages = TMPFS_NPAGES(tfo->tfo_size);
+  if (npages <= tfo->tfo_nlinear)
     {
-      /* There must have been an integer overflow */
+      return OK;
+    }
 
-      return -ENOMEM;
+  /* Existing mappings may refer to individual pages, too */
+
+  if (tfo->tfo_linear != NULL || tfo->tfo_nmaps > 0)
+    {
+      return -EBUSY;
     }
 
-  /* Realloc the file object */
+  ret = tmpfs_grow_pagetable(tfo, npages);
+  if (ret < 0)
+    {
+      return ret;
+    }
 
-  newdata = fs_heap_realloc(tfo->tfo_data, allocsize);
-  if (newdata == NULL)
+  linear = fs_heap_malloc(npages * TMPFS_PAGESIZE);
+  if (linear == NULL)
     {
       return -ENOMEM;
     }
 
-  /* Return the new address of the reallocated file object */
+  for (i = 0; i < npages; i++)
+    {
+      FAR uint8_t *page = tfo->tfo_pages[i];
+
+      if (page != NULL)
+        {
+          memcpy(linear + i * TMPFS_PAGESIZE, page, TMPFS_PAGESIZE);
+          fs_heap_free(page);
+          tfo->tfo_alloc -= TMPFS_PAGESIZE;
+        }
+      else
+        {
+          memset(linear + i * TMPFS_PAGESIZE, 0, TMPFS_PAGESIZE);
+        }
 
-  tfo->tfo_alloc = allocsize;
-  tfo->tfo_size  = newsize;
-  tfo->tfo_data  = newdata;
+      tfo->tfo_pages[i] = linear + i * TMPFS_PAGESIZE;
+    }
+
+  tfo->tfo_linear  = linear;
+  tfo->tfo_nlinear = npages;
+  tfo->tfo_alloc  += npages * TMPFS_PAGESIZE;
   return OK;
 }
 
@@ -383,7 +551,7 @@ static void tmpfs_release_lockedfile(FAR struct tmpfs_file_s *tfo)
     {
       tmpfs_unlock_file(tfo);
       nxrmutex_destroy(&tfo->tfo_lock);
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_data(tfo);
       fs_heap_free(tfo);
     }
 
@@ -582,7 +750,7 @@ tmpfs_alloc_file(FAR struct tmpfs_directory_s *parent)
   tfo->tfo_parent = parent;
   tfo->tfo_flags  = 0;
   tfo->tfo_size   = 0;
-  tfo->tfo_data   = NULL;
+  tfo->tfo_pages  = NULL;
 
   nxrmutex_init(&tfo->tfo_lock);
   tmpfs_lock_file(tfo);
@@ -1188,8 +1356,13 @@ static int tmpfs_statfs_callout(FAR struct tmpfs_directory_s *tdo,
        */
 
       tmptfo             = (FAR struct tmpfs_file_s *)to;
-      tmpbuf->tsf_alloc += sizeof(struct tmpfs_file_s);
-      tmpbuf->tsf_avail += to->to_alloc - tmptfo->tfo_size;
+      tmpbuf->tsf_alloc += sizeof(struct tmpfs_file_s) +
+                           tmptfo->tfo_npages * sizeof(FAR uint8_t *);
+      if (to->to_alloc > tmptfo->tfo_size)
+        {
+          tmpbuf->tsf_avail += to->to_alloc - tmptfo->tfo_size;
+        }
+
       tmpbuf->tsf_files++;
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
@@ -1265,7 +1438,7 @@ static int tmpfs_free_callout(FAR struct tmpfs_directory_s *tdo,
           return TMPFS_UNLINKED;
         }
 
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_data(tfo);
     }
   else /* if (to->to_type == TMPFS_DIRECTORY) */
     {
@@ -1438,11 +1611,7 @@ static int tmpfs_open(FAR struct file *filep, FAR const char *relpath,
 
           if (tfo->tfo_size > 0)
             {
-              ret = tmpfs_realloc_file(tfo, 0);
-              if (ret < 0)
-                {
-                  goto errout_with_filelock;
-                }
+              tmpfs_resize_file(tfo, 0);
             }
         }
     }
@@ -1545,6 +1714,7 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
 {
   FAR struct tmpfs_file_s *tfo;
   ssize_t nread;
+  ssize_t ncopied;
   off_t startpos;
   off_t endpos;
   int ret;
@@ -1584,18 +1754,31 @@ static ssize_t tmpfs_read(FAR struct file *filep, FAR char *buffer,
       nread  = endpos - startpos;
     }
 
-  /* Copy data from the memory object to the user buffer */
+  /* Copy data from the file pages to the user buffer.  Pages that were
+   * never written read as zeroes.
+   */
 
-  if (tfo->tfo_data != NULL)
+  for (ncopied = 0; ncopied < nread; )
     {
-      memcpy(buffer, &tfo->tfo_data[startpos], nread);
-      filep->f_pos += nread;
-    }
-  else
-    {
-      DEBUGASSERT(tfo->tfo_size == 0 && nread == 0);
+      off_t pos = startpos + ncopied;
+      size_t offset = pos % TMPFS_PAGESIZE;
+      size_t n = MIN(TMPFS_PAGESIZE - offset, (size_t)(nread - ncopied));
+      FAR uint8_t *page = tmpfs_get_page(tfo, pos / TMPFS_PAGESIZE, false);
+
+      if (page != NULL)
+        {
+          memcpy(buffer + ncopied, page + offset, n);
+        }
+      else
+        {
+          memset(buffer + ncopied, 0, n);
+        }
+
+      ncopied += n;
     }
 
+  filep->f_pos += nread;
+
   /* Release the lock on the file */
 
   tmpfs_unlock_file(tfo);
@@ -1642,29 +1825,49 @@ static ssize_t tmpfs_write(FAR struct file *filep, FAR const char *buffer,
       startpos = filep->f_pos;
     }
 
-  nwritten = buflen;
-  endpos   = startpos + buflen;
+  /* Make room in the page table for the whole write up front */
 
-  if (endpos > tfo->tfo_size)
+  endpos = startpos + buflen;
+  ret    = tmpfs_grow_pagetable(tfo, TMPFS_NPAGES((size_t)endpos));
+  if (ret < 0)
     {
-      /* Reallocate the file to handle the write past the end of the file. */
-
-      ret = tmpfs_realloc_file(tfo, (size_t)endpos);
-      if (ret < 0)
-        {
-          goto errout_with_lock;
-        }
+      goto errout_with_lock;
     }
 
-  /* Copy data from the memory object to the user buffer */
+  /* Copy data from the user buffer to the file pages, allocating the
+   * pages that were never written.
+   */
 
-  if (tfo->tfo_data != NULL)
+  for (nwritten = 0; (size_t)nwritten < buflen; )
     {
-      memcpy(&tfo->tfo_data[startpos], buffer, nwritten);
+      off_t pos = startpos + nwritten;
+      size_t offset = pos % TMPFS_PAGESIZE;
+      size_t n = MIN(TMPFS_PAGESIZE - offset, buflen - nwritten);
+      FAR uint8_t *page = tmpfs_get_page(tfo, pos / TMPFS_PAGESIZE, true);
+
+      if (page == NULL)
+        {
+          /* Out of memory.  Report a short write if anything was
+           * written.
+           */
+
+          if (nwritten == 0)
+            {
+              ret = -ENOMEM;
+              goto errout_with_lock;
+            }
+
+          break;
+        }
+
+      memcpy(page + offset, buffer + nwritten, n);
+      nwritten += n;
     }
-  else
+
+  endpos = startpos + nwritten;
+  if (endpos > tfo->tfo_size)
     {
-      DEBUGASSERT(tfo->tfo_size == 0 && nwritten == 0);
+      tfo->tfo_size = endpos;
     }
 
   filep->f_pos = endpos;
@@ -1753,6 +1956,9 @@ static int tmpfs_unmap(FAR struct task_group_s *group,
       ret = mm_map_remove(get_group_mm(group), entry);
       if (ret >= 0)
         {
+          tmpfs_lock_file(tfo);
+          tfo->tfo_nmaps--;
+          tmpfs_unlock_file(tfo);
           ret = tmpfs_release_file(tfo);
         }
     }
@@ -1765,8 +1971,9 @@ static int tmpfs_unmap(FAR struct task_group_s *group,
     {
       entry->length = offset;
       tmpfs_lock_file(tfo);
-      ret = tmpfs_realloc_file(tfo, offset);
+      tmpfs_resize_file(tfo, offset);
       tmpfs_unlock_file(tfo);
+      ret = OK;
     }
 
   return ret;
@@ -1775,6 +1982,9 @@ static int tmpfs_unmap(FAR struct task_group_s *group,
 static int tmpfs_mmap(FAR struct file *filep, FAR struct mm_map_entry_s *map)
 {
   FAR struct tmpfs_file_s *tfo;
+  FAR uint8_t *page;
+  size_t first;
+  size_t last;
   int ret = -EINVAL;
 
   DEBUGASSERT(filep->f_priv != NULL);
@@ -1785,22 +1995,59 @@ static int tmpfs_mmap(FAR struct file *filep, FAR struct mm_map_entry_s *map)
 
   DEBUGASSERT(tfo != NULL);
 
+  ret = tmpfs_lock_file(tfo);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = -EINVAL;
   if (map->offset >= 0 && map->offset < tfo->tfo_size &&
       map->length && map->offset + map->length <= tfo->tfo_size)
     {
-      map->vaddr = tfo->tfo_data + map->offset;
+      /* A range within one page is mapped in place.  Anything larger needs
+       * the contiguous copy of the file; if that cannot be made, let the
+       * caller fall back to a private copy of the range.
+       */
+
+      first = map->offset / TMPFS_PAGESIZE;
+      last  = (map->offset + map->length - 1) / TMPFS_PAGESIZE;
+      page  = NULL;
+
+      if (first == last)
+        {
+          page = tmpfs_get_page(tfo, first, true);
+          if (page != NULL)
+            {
+              map->vaddr = page + map->offset % TMPFS_PAGESIZE;
+            }
+        }
+
+      if (page == NULL)
+        {
+          ret = tmpfs_linearize_file(tfo);
+          if (ret < 0)
+            {
+              ret = -ENOTTY;
+              goto errout_with_lock;
+            }
+
+          map->vaddr = tfo->tfo_linear + map->offset;
+        }
+
       map->priv.p = tfo;
       map->munmap = tmpfs_unmap;
       ret = mm_map_add(get_current_mm(), map);
 
       if (ret >= 0)
         {
-          tmpfs_lock_file(tfo);
           tfo->tfo_refs++;
-          tmpfs_unlock_file(tfo);
+          tfo->tfo_nmaps++;
         }
     }
 
+errout_with_lock:
+  tmpfs_unlock_file(tfo);
   return ret;
 }
 
@@ -1842,8 +2089,21 @@ static int tmpfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
     {
       FAR uintptr_t *ptr = (FAR uintptr_t *)arg;
 
-      *ptr = (uintptr_t)tfo->tfo_data;
-      return OK;
+      /* Execute-in-place needs the file data at consecutive addresses */
+
+      ret = tmpfs_lock_file(tfo);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      ret = tmpfs_linearize_file(tfo);
+      if (ret >= 0)
+        {
+          *ptr = (uintptr_t)tfo->tfo_linear;
+        }
+
+      tmpfs_unlock_file(tfo);
     }
 
   return ret;
@@ -1968,31 +2228,17 @@ static int tmpfs_truncate(FAR struct file *filep, off_t length)
   oldsize = tfo->tfo_size;
   if (oldsize != length)
     {
-      /* The size is changing.. up or down.  Reallocate the file memory. */
-
-      ret = tmpfs_realloc_file(tfo, (size_t)length);
-      if (ret < 0)
-        {
-          goto errout_with_lock;
-        }
-
-      /* If the size has increased, then we need to zero the newly added
-       * memory.
+      /* The size is changing.. up or down.  No memory is allocated for a
+       * larger size: the new range reads as zeroes until written.
        */
 
-      if (length > oldsize)
-        {
-          memset(&tfo->tfo_data[oldsize], 0, length - oldsize);
-        }
-
-      ret = OK;
+      tmpfs_resize_file(tfo, (size_t)length);
     }
 
   /* Release the lock on the file */
 
-errout_with_lock:
   tmpfs_unlock_file(tfo);
-  return ret;
+  return OK;
 }
 
 /****************************************************************************
@@ -2426,7 +2672,7 @@ static int tmpfs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
   else
     {
       nxrmutex_destroy(&tfo->tfo_lock);
-      fs_heap_free(tfo->tfo_data);
+      tmpfs_free_data(tfo);
       fs_heap_free(tfo);
     }
 
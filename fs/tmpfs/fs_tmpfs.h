@@ -105,6 +105,11 @@ struct tmpfs_directory_s
 
 #define SIZEOF_TMPFS_DIRECTORY(n) ((n) * sizeof(struct tmpfs_dirent_s))
 
+/* File data is kept in pages of CONFIG_FS_TMPFS_PAGESIZE bytes */
+
+#define TMPFS_PAGESIZE            CONFIG_FS_TMPFS_PAGESIZE
+#define TMPFS_NPAGES(s)           (((s) + TMPFS_PAGESIZE - 1) / TMPFS_PAGESIZE)
+
 /* The form of a regular file memory object
  *
  * NOTE that in this very simplified implementation, there is no per-open
@@ -126,9 +131,13 @@ struct tmpfs_file_s
 
   /* Remaining fields are unique to a directory object */
 
-  uint8_t       tfo_flags; /* See TFO_FLAG_* definitions */
-  size_t        tfo_size;  /* Valid file size */
-  FAR uint8_t  *tfo_data;  /* File data starts here */
+  uint8_t       tfo_flags;   /* See TFO_FLAG_* definitions */
+  uint16_t      tfo_nmaps;   /* Number of mmap() mappings of the file */
+  size_t        tfo_size;    /* Valid file size */
+  size_t        tfo_npages;  /* Number of entries in tfo_pages */
+  FAR uint8_t **tfo_pages;   /* Page table, NULL entries read as zeroes */
+  FAR uint8_t  *tfo_linear;  /* Contiguous copy for mmap()/XIP, or NULL */
+  size_t        tfo_nlinear; /* Number of pages held in tfo_linear */
 };
 
 /* This structure represents one instance of a TMPFS file system */
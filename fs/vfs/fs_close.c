@@ -33,6 +33,7 @@
 #include <fcntl.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "notify/notify.h"
 #include "inode/inode.h"
@@ -111,6 +112,14 @@ int file_close_without_clear(FAR struct file *filep)
     {
       file_closelk(filep);
 
+#ifdef CONFIG_FS_PAGECACHE
+      /* Write back cached data while the file system still has the file
+       * open.
+       */
+
+      pagecache_detach(filep);
+#endif
+
       /* Close the file, driver, or mountpoint. */
 
       if (inode->u.i_ops && inode->u.i_ops->close)
@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/pagecache.h>
 
 #include <unistd.h>
 #include <sched.h>
@@ -124,6 +125,19 @@ int file_dup3(FAR struct file *filep1, FAR struct file *filep2, int flags)
             {
               ret = inode->u.i_mops->dup(filep1, filep2);
             }
+
+#ifdef CONFIG_FS_PAGECACHE
+          /* Share the cached pages with the new file */
+
+          if (ret >= 0 && filep1->f_cache != NULL)
+            {
+              ret = pagecache_dup(filep1, filep2);
+              if (ret < 0 && inode->u.i_mops->close)
+                {
+                  inode->u.i_mops->close(filep2);
+                }
+            }
+#endif
         }
       else
 #endif
@@ -33,6 +33,7 @@
 #include <errno.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/pagecache.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/net/net.h>
 #include "inode/inode.h"
@@ -198,6 +199,15 @@ int file_fstat(FAR struct file *filep, FAR struct stat *buf)
 
           ret = inode->u.i_mops->fstat(filep, buf);
         }
+
+#ifdef CONFIG_FS_PAGECACHE
+      /* The size must account for data not yet written back */
+
+      if (ret >= 0 && filep->f_cache != NULL)
+        {
+          pagecache_fstat(filep, buf);
+        }
+#endif
     }
   else
 #endif
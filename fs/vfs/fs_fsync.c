@@ -35,6 +35,7 @@
 #include <nuttx/cancelpt.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "inode/inode.h"
 
@@ -68,6 +69,19 @@ int file_fsync(FAR struct file *filep)
 #ifndef CONFIG_DISABLE_MOUNTPOINT
       if (INODE_IS_MOUNTPT(inode))
         {
+#ifdef CONFIG_FS_PAGECACHE
+          /* Write back the cached data before syncing the metadata */
+
+          if (filep->f_cache != NULL)
+            {
+              ret = pagecache_sync(filep);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+#endif
+
           if (inode->u.i_mops && inode->u.i_mops->sync)
             {
               /* Yes, then tell the mountpoint to sync this file */
@@ -32,6 +32,8 @@
 #include <errno.h>
 #include <assert.h>
 
+#include <nuttx/fs/pagecache.h>
+
 #include "inode/inode.h"
 
 /****************************************************************************
@@ -64,6 +66,15 @@ off_t file_seek(FAR struct file *filep, off_t offset, int whence)
   DEBUGASSERT(filep);
   inode =  filep->f_inode;
 
+#ifdef CONFIG_FS_PAGECACHE
+  /* The page cache keeps the position of the files attached to it */
+
+  if (filep->f_cache != NULL)
+    {
+      return pagecache_seek(filep, offset, whence);
+    }
+#endif
+
   /* Invoke the file seek method if available */
 
   if (inode && inode->u.i_ops && inode->u.i_ops->seek)
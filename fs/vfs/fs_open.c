@@ -323,10 +323,19 @@ static int nx_vopen(FAR struct tcb_s *tcb,
       return ret;
     }
 
-  /* Allocate a new file descriptor for the inode */
+  /* Allocate a new file descriptor for the inode.  The descriptor takes
+   * over the page cache state attached by the open; if none can be
+   * allocated, file_close() detaches it again.
+   */
 
+#ifdef CONFIG_FS_PAGECACHE
+  fd = file_allocate_from_tcb(tcb, filep.f_inode, filep.f_oflags,
+                              filep.f_pos, filep.f_priv, filep.f_cache,
+                              0, false);
+#else
   fd = file_allocate_from_tcb(tcb, filep.f_inode, filep.f_oflags,
-                              filep.f_pos, filep.f_priv, 0, false);
+                              filep.f_pos, filep.f_priv, NULL, 0, false);
+#endif
   if (fd < 0)
     {
       file_close(&filep);
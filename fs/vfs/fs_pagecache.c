@@ -0,0 +1,1695 @@
+/****************************************************************************
+ * fs/vfs/fs_pagecache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/list.h>
+#include <nuttx/mutex.h>
+#include <nuttx/kthread.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/uio.h>
+#include <nuttx/fs/pagecache.h>
+#include <nuttx/mm/shrinker.h>
+
+#include "fs_heap.h"
+
+#ifdef CONFIG_FS_PAGECACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PAGECACHE_PAGESIZE   CONFIG_FS_PAGECACHE_PAGESIZE
+#define PAGECACHE_NHASH      64
+
+/* The maximum number of pages transferred by one call into the file
+ * system, which bounds both the read-ahead window and the write-back
+ * batches.
+ */
+
+#define PAGECACHE_MAXBATCH   MAX(CONFIG_FS_PAGECACHE_READAHEAD, 1)
+
+/* Number of dirty pages at which the flush thread is woken up early */
+
+#define PAGECACHE_DIRTYMAX   \
+  MAX(CONFIG_FS_PAGECACHE_NPAGES * CONFIG_FS_PAGECACHE_DIRTY_RATIO / 100, 1)
+
+#ifdef CONFIG_FS_LARGEFILE
+#  define PAGECACHE_MAXINDEX INT64_MAX
+#else
+#  define PAGECACHE_MAXINDEX INT32_MAX
+#endif
+
+#define PAGECACHE_PAGEPOS(i) ((off_t)(i) * PAGECACHE_PAGESIZE)
+#define PAGECACHE_DIRTY(p)   ((p)->dend > (p)->dstart)
+
+/* Heap footprint of one page */
+
+#define PAGECACHE_PAGEBYTES  \
+  (sizeof(struct pagecache_page_s) + PAGECACHE_PAGESIZE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached page of file data */
+
+struct pagecache_obj_s;
+struct pagecache_page_s
+{
+  struct list_node hnode;            /* Link in the hash bucket */
+  struct list_node lnode;            /* Link in the LRU list */
+  struct list_node onode;            /* Link in the object, sorted by index */
+  FAR struct pagecache_obj_s *obj;   /* The file this page belongs to */
+  off_t    index;                    /* Page number within the file */
+  uint16_t valid;                    /* Number of valid bytes in data[] */
+  uint16_t dstart;                   /* Start of the dirty byte range */
+  uint16_t dend;                     /* End of the dirty byte range */
+  FAR uint8_t *data;                 /* Page contents */
+};
+
+/* One cached file.  Shared by all open files with the same identity and
+ * retained after the last close for as long as it has pages cached.
+ */
+
+struct pagecache_obj_s
+{
+  struct list_node node;             /* Link in g_pagecache.objects */
+  struct list_node pages;            /* Cached pages, sorted by index */
+  mutex_t          lock;             /* Serializes I/O on the file */
+  FAR struct inode *mountpt;         /* Mountpoint holding the file */
+  uint64_t         key;              /* File system provided identity */
+  FAR struct file *writer;           /* Open file used for write-back */
+  off_t            size;             /* File size including cached writes */
+  off_t            fsize;            /* File size known to the file system */
+  unsigned int     refs;             /* Number of attached files */
+  unsigned int     npages;           /* Number of pages cached */
+  unsigned int     ndirty;           /* Number of those that are dirty */
+  unsigned int     flushgen;         /* Last write-back pass visiting us */
+  bool             detached;         /* Invalidated, no longer looked up */
+  FAR char        *name;             /* Relative path identity, or NULL */
+};
+
+/* Per open file state, hung off struct file::f_cache */
+
+struct pagecache_file_s
+{
+  FAR struct pagecache_obj_s *obj;   /* The shared cached file */
+  off_t            fspos;            /* Position left by the file system */
+  off_t            ranext;           /* Offset of the next sequential read */
+  unsigned int     rapages;          /* Current read-ahead window */
+};
+
+/* The global page cache state */
+
+struct pagecache_s
+{
+  mutex_t          lock;             /* Protects everything below */
+  sem_t            flushsem;         /* Wakes up the flush thread */
+  pid_t            flusher;          /* Flush thread, 0 if not started */
+  unsigned int     flushgen;         /* Write-back pass counter */
+  struct list_node objects;          /* All objects that can be looked up */
+  struct list_node lru;              /* All pages, most recently used first */
+  struct list_node hash[PAGECACHE_NHASH];
+  struct pagecache_stats_s stats;
+#ifdef CONFIG_MM_SHRINKER
+  struct shrinker_s shrinker;        /* Releases clean pages on demand */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct pagecache_s g_pagecache =
+{
+  NXMUTEX_INITIALIZER,
+  SEM_INITIALIZER(0),
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pagecache_bucket
+ ****************************************************************************/
+
+static FAR struct list_node *
+pagecache_bucket(FAR struct pagecache_obj_s *obj, off_t index)
+{
+  uintptr_t hash = ((uintptr_t)obj >> 4) ^ (uintptr_t)index;
+
+  return &g_pagecache.hash[hash % PAGECACHE_NHASH];
+}
+
+/****************************************************************************
+ * Name: pagecache_find
+ *
+ * Description:
+ *   Look up a cached page.  The caller holds g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static FAR struct pagecache_page_s *
+pagecache_find(FAR struct pagecache_obj_s *obj, off_t index)
+{
+  FAR struct list_node *bucket = pagecache_bucket(obj, index);
+  FAR struct pagecache_page_s *page;
+
+  list_for_every_entry(bucket, page, struct pagecache_page_s, hnode)
+    {
+      if (page->obj == obj && page->index == index)
+        {
+          /* Move the page to the head of the LRU list */
+
+          list_delete(&page->lnode);
+          list_add_head(&g_pagecache.lru, &page->lnode);
+          return page;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: pagecache_insert
+ *
+ * Description:
+ *   Make a freshly filled page visible.  The caller holds
+ *   g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static void pagecache_insert(FAR struct pagecache_obj_s *obj,
+                             FAR struct pagecache_page_s *page)
+{
+  FAR struct pagecache_page_s *next;
+
+  page->obj = obj;
+  list_add_head(pagecache_bucket(obj, page->index), &page->hnode);
+  list_add_head(&g_pagecache.lru, &page->lnode);
+
+  /* Keep the per-object list sorted so that write-back can batch
+   * contiguous pages.
+   */
+
+  list_for_every_entry(&obj->pages, next, struct pagecache_page_s, onode)
+    {
+      if (next->index > page->index)
+        {
+          break;
+        }
+    }
+
+  list_add_before(&next->onode, &page->onode);
+  obj->npages++;
+}
+
+/****************************************************************************
+ * Name: pagecache_free
+ *
+ * Description:
+ *   Unlink (if linked) and free a page.  The caller holds
+ *   g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static void pagecache_free(FAR struct pagecache_page_s *page)
+{
+  FAR struct pagecache_obj_s *obj = page->obj;
+
+  if (obj != NULL)
+    {
+      list_delete(&page->hnode);
+      list_delete(&page->lnode);
+      list_delete(&page->onode);
+      obj->npages--;
+
+      if (PAGECACHE_DIRTY(page))
+        {
+          obj->ndirty--;
+          g_pagecache.stats.ndirty--;
+        }
+    }
+
+  g_pagecache.stats.npages--;
+  fs_heap_free(page);
+}
+
+/****************************************************************************
+ * Name: pagecache_release
+ *
+ * Description:
+ *   Free an object once nothing refers to it any more.  The caller holds
+ *   g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static void pagecache_release(FAR struct pagecache_obj_s *obj)
+{
+  if (obj->refs == 0 && obj->npages == 0)
+    {
+      if (!obj->detached)
+        {
+          list_delete(&obj->node);
+        }
+
+      nxmutex_destroy(&obj->lock);
+      fs_heap_free(obj);
+    }
+}
+
+/****************************************************************************
+ * Name: pagecache_drop
+ *
+ * Description:
+ *   Drop the cached pages of an object in the range [first, last].  Dirty
+ *   pages are only dropped if 'dirty' is true.  The caller holds
+ *   g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static void pagecache_drop(FAR struct pagecache_obj_s *obj, off_t first,
+                           off_t last, bool dirty)
+{
+  FAR struct pagecache_page_s *page;
+  FAR struct pagecache_page_s *tmp;
+
+  list_for_every_entry_safe(&obj->pages, page, tmp,
+                            struct pagecache_page_s, onode)
+    {
+      if (page->index >= first && page->index <= last &&
+          (dirty || !PAGECACHE_DIRTY(page)))
+        {
+          pagecache_free(page);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: pagecache_alloc
+ *
+ * Description:
+ *   Allocate a page, reclaiming the least recently used clean page once
+ *   the cache is full.  Returns NULL if every page is dirty.  The caller
+ *   holds g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static FAR struct pagecache_page_s *pagecache_alloc(void)
+{
+  FAR struct pagecache_page_s *page;
+  FAR struct pagecache_obj_s *obj;
+
+  if (g_pagecache.stats.npages < CONFIG_FS_PAGECACHE_NPAGES)
+    {
+      page = fs_heap_malloc(PAGECACHE_PAGEBYTES);
+      if (page != NULL)
+        {
+          g_pagecache.stats.npages++;
+          goto out;
+        }
+    }
+
+  list_for_every_entry_reverse(&g_pagecache.lru, page,
+                               struct pagecache_page_s, lnode)
+    {
+      if (!PAGECACHE_DIRTY(page))
+        {
+          obj = page->obj;
+          list_delete(&page->hnode);
+          list_delete(&page->lnode);
+          list_delete(&page->onode);
+          obj->npages--;
+          pagecache_release(obj);
+          g_pagecache.stats.evictions++;
+          goto out;
+        }
+    }
+
+  return NULL;
+
+out:
+  memset(page, 0, sizeof(struct pagecache_page_s));
+  page->data = (FAR uint8_t *)(page + 1);
+  return page;
+}
+
+#ifdef CONFIG_MM_SHRINKER
+/****************************************************************************
+ * Name: pagecache_shrink_count
+ ****************************************************************************/
+
+static size_t pagecache_shrink_count(FAR struct shrinker_s *shrinker)
+{
+  return (g_pagecache.stats.npages - g_pagecache.stats.ndirty) *
+         PAGECACHE_PAGEBYTES;
+}
+
+/****************************************************************************
+ * Name: pagecache_shrink_scan
+ *
+ * Description:
+ *   Free clean pages, least recently used first.  Nothing is freed if the
+ *   cache is busy, e.g. when it is the cache itself running out of memory.
+ *
+ ****************************************************************************/
+
+static size_t pagecache_shrink_scan(FAR struct shrinker_s *shrinker,
+                                    size_t size)
+{
+  FAR struct pagecache_page_s *page;
+  FAR struct pagecache_obj_s *obj;
+  FAR struct list_node *node;
+  FAR struct list_node *prev;
+  size_t freed = 0;
+
+  if (nxmutex_trylock(&g_pagecache.lock) < 0)
+    {
+      return 0;
+    }
+
+  for (node = list_peek_tail(&g_pagecache.lru);
+       node != NULL && freed < size; node = prev)
+    {
+      prev = list_prev(&g_pagecache.lru, node);
+      page = list_entry(node, struct pagecache_page_s, lnode);
+      if (!PAGECACHE_DIRTY(page))
+        {
+          obj = page->obj;
+          pagecache_free(page);
+          pagecache_release(obj);
+          freed += PAGECACHE_PAGEBYTES;
+        }
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+  return freed;
+}
+#endif
+
+/****************************************************************************
+ * Name: pagecache_fsio
+ *
+ * Description:
+ *   Transfer data between the file system and a vector of buffers at a
+ *   given file offset, without disturbing the cached file position.
+ *
+ *   File systems may keep internal state that follows f_pos (e.g. the
+ *   current cluster in FAT), so f_pos is set back to where the file
+ *   system itself left it before seeking.  The caller holds the object
+ *   lock, but not g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static ssize_t pagecache_fsio(FAR struct file *filep, off_t pos,
+                              FAR const struct iovec *iov, int iovcnt,
+                              bool write)
+{
+  FAR struct pagecache_file_s *pf = filep->f_cache;
+  FAR struct inode *inode = filep->f_inode;
+  off_t savepos = filep->f_pos;
+  ssize_t ntotal = 0;
+  ssize_t nxfer;
+  int i;
+
+  filep->f_pos = pf->fspos;
+  if (inode->u.i_mops->seek != NULL)
+    {
+      ntotal = inode->u.i_mops->seek(filep, pos, SEEK_SET);
+      if (ntotal < 0)
+        {
+          goto out;
+        }
+
+      ntotal = 0;
+    }
+  else
+    {
+      filep->f_pos = pos;
+    }
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      if (write)
+        {
+          nxfer = inode->u.i_mops->write(filep, iov[i].iov_base,
+                                         iov[i].iov_len);
+        }
+      else
+        {
+          nxfer = inode->u.i_mops->read(filep, iov[i].iov_base,
+                                        iov[i].iov_len);
+        }
+
+      if (nxfer < 0)
+        {
+          if (ntotal == 0)
+            {
+              ntotal = nxfer;
+            }
+
+          break;
+        }
+
+      ntotal += nxfer;
+      if ((size_t)nxfer < iov[i].iov_len)
+        {
+          break;
+        }
+    }
+
+out:
+  pf->fspos = filep->f_pos;
+  filep->f_pos = savepos;
+  return ntotal;
+}
+
+/****************************************************************************
+ * Name: pagecache_writethrough
+ *
+ * Description:
+ *   Write directly to the file system, bypassing the cache, and drop any
+ *   stale cached copy of the range written.  Used for O_APPEND/O_DIRECT
+ *   and when no page can be allocated.  The caller holds the object lock
+ *   and has written back any dirty pages overlapping the range.
+ *
+ ****************************************************************************/
+
+static ssize_t pagecache_writethrough(FAR struct file *filep, off_t pos,
+                                      FAR const struct iovec *iov,
+                                      int iovcnt)
+{
+  FAR struct pagecache_file_s *pf = filep->f_cache;
+  FAR struct pagecache_obj_s *obj = pf->obj;
+  ssize_t ret;
+  off_t end;
+
+  ret = pagecache_fsio(filep, pos, iov, iovcnt, true);
+  if (ret > 0)
+    {
+      /* With O_APPEND the file system decides where the data lands, so
+       * take the range from the position it left behind.
+       */
+
+      end = pf->fspos;
+
+      nxmutex_lock(&g_pagecache.lock);
+      pagecache_drop(obj, (end - ret) / PAGECACHE_PAGESIZE,
+                     (end - 1) / PAGECACHE_PAGESIZE, false);
+      obj->fsize = MAX(obj->fsize, end);
+      obj->size  = MAX(obj->size, end);
+      nxmutex_unlock(&g_pagecache.lock);
+
+      filep->f_pos = end;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pagecache_flush
+ *
+ * Description:
+ *   Write back all dirty pages of an object through the open file 'filep',
+ *   batching runs of contiguous pages into a single transfer.  The caller
+ *   holds the object lock.
+ *
+ ****************************************************************************/
+
+static int pagecache_flush(FAR struct pagecache_obj_s *obj,
+                           FAR struct file *filep)
+{
+  FAR struct pagecache_page_s *batch[PAGECACHE_MAXBATCH];
+  struct iovec iov[PAGECACHE_MAXBATCH];
+  FAR struct pagecache_page_s *page;
+  FAR struct pagecache_page_s *prev;
+  off_t cursor = 0;
+  ssize_t nwritten;
+  size_t total;
+  off_t pos;
+  int n;
+  int i;
+
+  for (; ; )
+    {
+      /* Gather the next run of contiguous dirty pages.  Dirty pages are
+       * never reclaimed and only change under the object lock, so they
+       * can be used after g_pagecache.lock is dropped.
+       */
+
+      nxmutex_lock(&g_pagecache.lock);
+
+      n    = 0;
+      prev = NULL;
+      list_for_every_entry(&obj->pages, page, struct pagecache_page_s,
+                           onode)
+        {
+          if (page->index < cursor || !PAGECACHE_DIRTY(page))
+            {
+              if (n > 0)
+                {
+                  break;
+                }
+
+              continue;
+            }
+
+          if (n > 0 && (page->index != prev->index + 1 ||
+                        prev->dend != PAGECACHE_PAGESIZE ||
+                        page->dstart != 0))
+            {
+              break;
+            }
+
+          batch[n] = page;
+          iov[n].iov_base = page->data + page->dstart;
+          iov[n].iov_len  = page->dend - page->dstart;
+          prev = page;
+
+          if (++n >= PAGECACHE_MAXBATCH)
+            {
+              break;
+            }
+        }
+
+      nxmutex_unlock(&g_pagecache.lock);
+
+      if (n == 0)
+        {
+          break;
+        }
+
+      pos = PAGECACHE_PAGEPOS(batch[0]->index) + batch[0]->dstart;
+      for (i = 0, total = 0; i < n; i++)
+        {
+          total += iov[i].iov_len;
+        }
+
+      nwritten = pagecache_fsio(filep, pos, iov, n, true);
+      if (nwritten < 0)
+        {
+          return nwritten;
+        }
+      else if ((size_t)nwritten < total)
+        {
+          return -ENOSPC;
+        }
+
+      nxmutex_lock(&g_pagecache.lock);
+      for (i = 0; i < n; i++)
+        {
+          batch[i]->dstart = 0;
+          batch[i]->dend   = 0;
+        }
+
+      obj->ndirty -= n;
+      g_pagecache.stats.ndirty -= n;
+      g_pagecache.stats.writebacks += n;
+      obj->fsize = MAX(obj->fsize, pos + (off_t)total);
+      nxmutex_unlock(&g_pagecache.lock);
+
+      cursor = batch[n - 1]->index + 1;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pagecache_writeback_obj
+ *
+ * Description:
+ *   Write back the dirty pages of an object through the file that last
+ *   dirtied it, which is known to be writable.  The caller holds the
+ *   object lock.
+ *
+ ****************************************************************************/
+
+static int pagecache_writeback_obj(FAR struct pagecache_obj_s *obj)
+{
+  return obj->writer != NULL ? pagecache_flush(obj, obj->writer) : OK;
+}
+
+/****************************************************************************
+ * Name: pagecache_fill
+ *
+ * Description:
+ *   Bring page 'index' and up to 'count - 1' following pages into the
+ *   cache with a single file system transfer.  Read-ahead stops at the
+ *   first page that is already cached or lies beyond the media size.
+ *   The caller holds the object lock.
+ *
+ ****************************************************************************/
+
+static int pagecache_fill(FAR struct file *filep, off_t index,
+                          unsigned int count)
+{
+  FAR struct pagecache_obj_s *obj = filep->f_cache->obj;
+  FAR struct pagecache_page_s *batch[PAGECACHE_MAXBATCH];
+  struct iovec iov[PAGECACHE_MAXBATCH];
+  ssize_t nread;
+  size_t valid;
+  unsigned int n;
+  unsigned int i;
+
+  count = MIN(MAX(count, 1), PAGECACHE_MAXBATCH);
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  for (n = 0; n < count; n++)
+    {
+      if (n > 0 && (PAGECACHE_PAGEPOS(index + n) >= obj->fsize ||
+                    pagecache_find(obj, index + n) != NULL))
+        {
+          break;
+        }
+
+      batch[n] = pagecache_alloc();
+      if (batch[n] == NULL)
+        {
+          break;
+        }
+
+      batch[n]->index = index + n;
+      iov[n].iov_base = batch[n]->data;
+      iov[n].iov_len  = PAGECACHE_PAGESIZE;
+    }
+
+  if (n == 0)
+    {
+      nxmutex_unlock(&g_pagecache.lock);
+      return -ENOMEM;
+    }
+
+  g_pagecache.stats.misses++;
+
+  /* A page beyond the media size is a hole left by seeking past the end
+   * of file before writing, and reads back as zeros.
+   */
+
+  if (PAGECACHE_PAGEPOS(index) >= obj->fsize)
+    {
+      memset(batch[0]->data, 0, PAGECACHE_PAGESIZE);
+      batch[0]->valid = PAGECACHE_PAGESIZE;
+      pagecache_insert(obj, batch[0]);
+      nxmutex_unlock(&g_pagecache.lock);
+      return OK;
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+
+  nread = pagecache_fsio(filep, PAGECACHE_PAGEPOS(index), iov, n, false);
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  for (i = 0; i < n; i++)
+    {
+      valid = nread > (ssize_t)PAGECACHE_PAGEPOS(i) ?
+              nread - PAGECACHE_PAGEPOS(i) : 0;
+
+      /* Keep the demanded page even when empty, it records the EOF */
+
+      if (nread < 0 || (i > 0 && valid == 0))
+        {
+          pagecache_free(batch[i]);
+          continue;
+        }
+
+      batch[i]->valid = MIN(valid, PAGECACHE_PAGESIZE);
+      pagecache_insert(obj, batch[i]);
+      if (i > 0)
+        {
+          g_pagecache.stats.readahead++;
+        }
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+  return nread < 0 ? nread : OK;
+}
+
+/****************************************************************************
+ * Name: pagecache_copyout
+ *
+ * Description:
+ *   Copy cached data at 'pos' to the user buffer, up to the end of the
+ *   page.  Returns the number of bytes copied, or -ENOENT if the page is
+ *   not cached.  'hit' tells whether to account the lookup as a cache hit
+ *   (it is not when the page was just filled).  The caller holds the
+ *   object lock.
+ *
+ ****************************************************************************/
+
+static ssize_t pagecache_copyout(FAR struct pagecache_obj_s *obj,
+                                 off_t pos, FAR uint8_t *buf, size_t len,
+                                 bool hit)
+{
+  FAR struct pagecache_page_s *page;
+  size_t offset = pos % PAGECACHE_PAGESIZE;
+  size_t avail;
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  page = pagecache_find(obj, pos / PAGECACHE_PAGESIZE);
+  if (page == NULL)
+    {
+      nxmutex_unlock(&g_pagecache.lock);
+      return -ENOENT;
+    }
+
+  if (hit)
+    {
+      g_pagecache.stats.hits++;
+    }
+
+  len = MIN(len, PAGECACHE_PAGESIZE - offset);
+  len = MIN(len, (size_t)(obj->size - pos));
+
+  /* Bytes between the end of the valid data and the file size belong to
+   * a hole created by a later extension of the file.
+   */
+
+  avail = page->valid > offset ? page->valid - offset : 0;
+  if (avail > 0)
+    {
+      len = MIN(len, avail);
+      memcpy(buf, page->data + offset, len);
+    }
+  else
+    {
+      memset(buf, 0, len);
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+  return len;
+}
+
+/****************************************************************************
+ * Name: pagecache_copyin
+ *
+ * Description:
+ *   Copy user data into the cached page at 'pos', up to the end of the
+ *   page, and mark it dirty.  If the page is not cached and 'create' is
+ *   true, a new page is allocated without reading it from the media.
+ *   Returns the number of bytes copied, -ENOENT if the page is not cached
+ *   or -ENOMEM if no page could be allocated.  The caller holds the
+ *   object lock.
+ *
+ ****************************************************************************/
+
+static ssize_t pagecache_copyin(FAR struct pagecache_obj_s *obj, off_t pos,
+                                FAR const uint8_t *buf, size_t len,
+                                bool create)
+{
+  FAR struct pagecache_page_s *page;
+  size_t offset = pos % PAGECACHE_PAGESIZE;
+
+  len = MIN(len, PAGECACHE_PAGESIZE - offset);
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  page = pagecache_find(obj, pos / PAGECACHE_PAGESIZE);
+  if (page == NULL)
+    {
+      if (!create)
+        {
+          nxmutex_unlock(&g_pagecache.lock);
+          return -ENOENT;
+        }
+
+      page = pagecache_alloc();
+      if (page == NULL)
+        {
+          nxmutex_unlock(&g_pagecache.lock);
+          return -ENOMEM;
+        }
+
+      page->index = pos / PAGECACHE_PAGESIZE;
+      pagecache_insert(obj, page);
+    }
+
+  if (offset > page->valid)
+    {
+      memset(page->data + page->valid, 0, offset - page->valid);
+    }
+
+  memcpy(page->data + offset, buf, len);
+  page->valid = MAX(page->valid, offset + len);
+
+  if (PAGECACHE_DIRTY(page))
+    {
+      page->dstart = MIN(page->dstart, offset);
+      page->dend   = MAX(page->dend, offset + len);
+    }
+  else
+    {
+      page->dstart = offset;
+      page->dend   = offset + len;
+      obj->ndirty++;
+      g_pagecache.stats.ndirty++;
+    }
+
+  obj->size = MAX(obj->size, pos + (off_t)len);
+  nxmutex_unlock(&g_pagecache.lock);
+  return len;
+}
+
+/****************************************************************************
+ * Name: pagecache_writeback
+ *
+ * Description:
+ *   Write back every object with dirty pages.  Called from the flush
+ *   thread.
+ *
+ ****************************************************************************/
+
+static void pagecache_writeback(void)
+{
+  FAR struct pagecache_obj_s *obj;
+  unsigned int gen;
+  bool found;
+  int ret;
+
+  nxmutex_lock(&g_pagecache.lock);
+  gen = ++g_pagecache.flushgen;
+
+  for (; ; )
+    {
+      /* Objects may come and go while the lock is dropped, so restart
+       * the scan each time and mark the objects already visited.
+       */
+
+      found = false;
+      list_for_every_entry(&g_pagecache.objects, obj,
+                           struct pagecache_obj_s, node)
+        {
+          if (obj->ndirty > 0 && obj->flushgen != gen)
+            {
+              found = true;
+              break;
+            }
+        }
+
+      if (!found)
+        {
+          break;
+        }
+
+      obj->flushgen = gen;
+      obj->refs++;
+      nxmutex_unlock(&g_pagecache.lock);
+
+      nxmutex_lock(&obj->lock);
+      ret = pagecache_writeback_obj(obj);
+      if (ret < 0)
+        {
+          ferr("ERROR: Write-back failed: %d\n", ret);
+        }
+
+      nxmutex_unlock(&obj->lock);
+
+      nxmutex_lock(&g_pagecache.lock);
+      obj->refs--;
+      pagecache_release(obj);
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+}
+
+/****************************************************************************
+ * Name: pagecache_flush_thread
+ ****************************************************************************/
+
+#if CONFIG_FS_PAGECACHE_FLUSH_INTERVAL > 0
+static int pagecache_flush_thread(int argc, FAR char *argv[])
+{
+  for (; ; )
+    {
+      nxsem_tickwait(&g_pagecache.flushsem,
+                     MSEC2TICK(CONFIG_FS_PAGECACHE_FLUSH_INTERVAL));
+      pagecache_writeback();
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: pagecache_dirtied
+ *
+ * Description:
+ *   Called after a write left dirty pages behind.  Starts the flush
+ *   thread on first use and wakes it up early once too much of the cache
+ *   is dirty.  With a zero flush interval the cache is write-through and
+ *   the pages are written back immediately.  The caller holds the object
+ *   lock.
+ *
+ ****************************************************************************/
+
+static int pagecache_dirtied(FAR struct file *filep)
+{
+#if CONFIG_FS_PAGECACHE_FLUSH_INTERVAL > 0
+  int semcount;
+  int ret;
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  if (g_pagecache.flusher <= 0)
+    {
+      ret = kthread_create("pgflush", CONFIG_FS_PAGECACHE_FLUSH_PRIORITY,
+                           CONFIG_FS_PAGECACHE_FLUSH_STACKSIZE,
+                           pagecache_flush_thread, NULL);
+      if (ret < 0)
+        {
+          nxmutex_unlock(&g_pagecache.lock);
+          ferr("ERROR: Failed to start the flush thread: %d\n", ret);
+          return pagecache_writeback_obj(filep->f_cache->obj);
+        }
+
+      g_pagecache.flusher = ret;
+    }
+
+  if (g_pagecache.stats.ndirty >= PAGECACHE_DIRTYMAX &&
+      nxsem_get_value(&g_pagecache.flushsem, &semcount) >= 0 &&
+      semcount < 1)
+    {
+      nxsem_post(&g_pagecache.flushsem);
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+  return OK;
+#else
+  return pagecache_writeback_obj(filep->f_cache->obj);
+#endif
+}
+
+/****************************************************************************
+ * Name: pagecache_namematch
+ *
+ * Description:
+ *   Return true if 'path' is 'name' or lies below directory 'name'.
+ *
+ ****************************************************************************/
+
+static bool pagecache_namematch(FAR const char *path, FAR const char *name)
+{
+  size_t len = strlen(name);
+
+  return strncmp(path, name, len) == 0 &&
+         (path[len] == '\0' || path[len] == '/' || len == 0);
+}
+
+/****************************************************************************
+ * Name: pagecache_detach_obj
+ *
+ * Description:
+ *   Make an object unreachable for new opens and drop its clean pages.
+ *   The caller holds g_pagecache.lock.
+ *
+ ****************************************************************************/
+
+static void pagecache_detach_obj(FAR struct pagecache_obj_s *obj)
+{
+  list_delete(&obj->node);
+  obj->detached = true;
+  pagecache_drop(obj, 0, PAGECACHE_MAXINDEX, false);
+  pagecache_release(obj);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pagecache_initialize
+ ****************************************************************************/
+
+void pagecache_initialize(void)
+{
+  int i;
+
+  list_initialize(&g_pagecache.objects);
+  list_initialize(&g_pagecache.lru);
+
+  for (i = 0; i < PAGECACHE_NHASH; i++)
+    {
+      list_initialize(&g_pagecache.hash[i]);
+    }
+
+#ifdef CONFIG_MM_SHRINKER
+  g_pagecache.shrinker.name  = "pagecache";
+  g_pagecache.shrinker.count = pagecache_shrink_count;
+  g_pagecache.shrinker.scan  = pagecache_shrink_scan;
+  mm_register_shrinker(&g_pagecache.shrinker);
+#endif
+}
+
+/****************************************************************************
+ * Name: pagecache_attach
+ ****************************************************************************/
+
+int pagecache_attach(FAR struct file *filep, uint64_t key,
+                     FAR const char *name, off_t size)
+{
+  FAR struct pagecache_file_s *pf;
+  FAR struct pagecache_obj_s *obj;
+  size_t namelen = name != NULL ? strlen(name) + 1 : 0;
+  bool found = false;
+
+  pf = fs_heap_zalloc(sizeof(struct pagecache_file_s));
+  if (pf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  list_for_every_entry(&g_pagecache.objects, obj,
+                       struct pagecache_obj_s, node)
+    {
+      if (obj->mountpt == filep->f_inode && obj->key == key &&
+          (name == NULL ? obj->name == NULL :
+           obj->name != NULL && strcmp(obj->name, name) == 0))
+        {
+          found = true;
+          break;
+        }
+    }
+
+  if (!found)
+    {
+      obj = fs_heap_zalloc(sizeof(struct pagecache_obj_s) + namelen);
+      if (obj == NULL)
+        {
+          nxmutex_unlock(&g_pagecache.lock);
+          fs_heap_free(pf);
+          return -ENOMEM;
+        }
+
+      list_initialize(&obj->pages);
+      nxmutex_init(&obj->lock);
+      obj->mountpt = filep->f_inode;
+      obj->key     = key;
+      obj->size    = size;
+      obj->fsize   = size;
+
+      if (name != NULL)
+        {
+          obj->name = (FAR char *)(obj + 1);
+          memcpy(obj->name, name, namelen);
+        }
+
+      list_add_tail(&g_pagecache.objects, &obj->node);
+    }
+  else if (obj->refs == 0 && obj->fsize != size)
+    {
+      /* The file changed behind our back while nobody had it open */
+
+      pagecache_drop(obj, 0, PAGECACHE_MAXINDEX, true);
+      obj->size  = size;
+      obj->fsize = size;
+    }
+
+  obj->refs++;
+  nxmutex_unlock(&g_pagecache.lock);
+
+  if (found && (filep->f_oflags & O_TRUNC) != 0)
+    {
+      /* The open just truncated the file under the other users */
+
+      nxmutex_lock(&obj->lock);
+      nxmutex_lock(&g_pagecache.lock);
+      pagecache_drop(obj, 0, PAGECACHE_MAXINDEX, true);
+      obj->size  = size;
+      obj->fsize = size;
+      nxmutex_unlock(&g_pagecache.lock);
+      nxmutex_unlock(&obj->lock);
+    }
+
+  pf->obj     = obj;
+  pf->fspos   = filep->f_pos;
+  pf->ranext  = -1;
+  filep->f_cache = pf;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pagecache_detach
+ *
+ * Description:
+ *   Called on close() before the file system close method.  If this file
+ *   is the one used for write-back, the dirty pages are written back
+ *   while its file system state is still around.
+ *
+ ****************************************************************************/
+
+void pagecache_detach(FAR struct file *filep)
+{
+  FAR struct pagecache_file_s *pf = filep->f_cache;
+  FAR struct pagecache_obj_s *obj;
+  int ret;
+
+  if (pf == NULL)
+    {
+      return;
+    }
+
+  obj = pf->obj;
+
+  nxmutex_lock(&obj->lock);
+  if (obj->writer == filep)
+    {
+      ret = pagecache_flush(obj, filep);
+      if (ret < 0)
+        {
+          ferr("ERROR: Write-back on close failed, data lost: %d\n", ret);
+
+          nxmutex_lock(&g_pagecache.lock);
+          pagecache_drop(obj, 0, PAGECACHE_MAXINDEX, true);
+          obj->size = obj->fsize;
+          nxmutex_unlock(&g_pagecache.lock);
+        }
+
+      obj->writer = NULL;
+    }
+
+  nxmutex_unlock(&obj->lock);
+
+  nxmutex_lock(&g_pagecache.lock);
+  obj->refs--;
+  if (obj->refs == 0 && obj->detached)
+    {
+      pagecache_drop(obj, 0, PAGECACHE_MAXINDEX, true);
+    }
+
+  pagecache_release(obj);
+  nxmutex_unlock(&g_pagecache.lock);
+
+  fs_heap_free(pf);
+  filep->f_cache = NULL;
+}
+
+/****************************************************************************
+ * Name: pagecache_dup
+ ****************************************************************************/
+
+int pagecache_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct pagecache_file_s *pf;
+
+  pf = fs_heap_malloc(sizeof(struct pagecache_file_s));
+  if (pf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(pf, oldp->f_cache, sizeof(struct pagecache_file_s));
+
+  nxmutex_lock(&g_pagecache.lock);
+  pf->obj->refs++;
+  nxmutex_unlock(&g_pagecache.lock);
+
+  newp->f_cache = pf;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pagecache_readv
+ ****************************************************************************/
+
+ssize_t pagecache_readv(FAR struct file *filep,
+                        FAR const struct iovec *iov, int iovcnt)
+{
+  FAR struct pagecache_file_s *pf = filep->f_cache;
+  FAR struct pagecache_obj_s *obj = pf->obj;
+  struct iovec rest;
+  FAR uint8_t *buf;
+  ssize_t ntotal = 0;
+  ssize_t ret;
+  size_t len;
+  bool hit = true;
+  off_t pos;
+  int i;
+
+  ret = nxmutex_lock(&obj->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  pos = filep->f_pos;
+
+  if ((filep->f_oflags & O_DIRECT) != 0)
+    {
+      ret = pagecache_writeback_obj(obj);
+      if (ret >= 0)
+        {
+          ret = pagecache_fsio(filep, pos, iov, iovcnt, false);
+        }
+
+      if (ret > 0)
+        {
+          filep->f_pos = pos + ret;
+        }
+
+      nxmutex_unlock(&obj->lock);
+      return ret;
+    }
+
+  /* Sequential access grows the read-ahead window, anything else
+   * collapses it.
+   */
+
+  if (pos == 0 || pos == pf->ranext)
+    {
+      pf->rapages = MIN(MAX(pf->rapages * 2, 2),
+                        CONFIG_FS_PAGECACHE_READAHEAD);
+    }
+  else
+    {
+      pf->rapages = 1;
+    }
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      buf = iov[i].iov_base;
+      len = iov[i].iov_len;
+
+      while (len > 0 && pos < obj->size)
+        {
+          ret = pagecache_copyout(obj, pos, buf, len, hit);
+          hit = true;
+
+          if (ret == -ENOENT)
+            {
+              ret = pagecache_fill(filep, pos / PAGECACHE_PAGESIZE,
+                                   pf->rapages);
+              if (ret == -ENOMEM)
+                {
+                  /* The cache is full of dirty pages, read around it */
+
+                  ret = pagecache_writeback_obj(obj);
+                  if (ret >= 0)
+                    {
+                      rest.iov_base = buf;
+                      rest.iov_len  = MIN(len, (size_t)(obj->size - pos));
+                      ret = pagecache_fsio(filep, pos, &rest, 1, false);
+                    }
+
+                  if (ret <= 0)
+                    {
+                      goto out;
+                    }
+                }
+              else if (ret < 0)
+                {
+                  goto out;
+                }
+              else
+                {
+                  hit = false;
+                  continue;
+                }
+            }
+
+          if (ret == 0)
+            {
+              goto out;
+            }
+
+          ntotal += ret;
+          pos    += ret;
+          buf    += ret;
+          len    -= ret;
+        }
+
+      if (len > 0)
+        {
+          break;
+        }
+    }
+
+out:
+  filep->f_pos = pos;
+  pf->ranext   = pos;
+  nxmutex_unlock(&obj->lock);
+  return ntotal > 0 ? ntotal : ret;
+}
+
+/****************************************************************************
+ * Name: pagecache_writev
+ ****************************************************************************/
+
+ssize_t pagecache_writev(FAR struct file *filep,
+                         FAR const struct iovec *iov, int iovcnt)
+{
+  FAR struct pagecache_file_s *pf = filep->f_cache;
+  FAR struct pagecache_obj_s *obj = pf->obj;
+  FAR const uint8_t *buf;
+  struct iovec rest;
+  ssize_t ntotal = 0;
+  ssize_t ret;
+  size_t offset;
+  size_t len;
+  off_t pos;
+  bool create;
+  int err;
+  int i;
+
+  ret = nxmutex_lock(&obj->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  pos = filep->f_pos;
+
+  /* Appends are positioned by the file system and direct I/O must reach
+   * the media, so write those through.
+   */
+
+  if ((filep->f_oflags & (O_APPEND | O_DIRECT)) != 0)
+    {
+      ret = pagecache_writeback_obj(obj);
+      if (ret >= 0)
+        {
+          ret = pagecache_writethrough(filep, pos, iov, iovcnt);
+        }
+
+      nxmutex_unlock(&obj->lock);
+      return ret;
+    }
+
+  for (i = 0; i < iovcnt; i++)
+    {
+      buf = iov[i].iov_base;
+      len = iov[i].iov_len;
+
+      while (len > 0)
+        {
+          /* A page that is fully overwritten, or that lies beyond the
+           * data on the media, needs not be read first.
+           */
+
+          offset = pos % PAGECACHE_PAGESIZE;
+          create = (offset == 0 && len >= PAGECACHE_PAGESIZE) ||
+                   pos - (off_t)offset >= obj->fsize;
+
+          ret = pagecache_copyin(obj, pos, buf, len, create);
+          if (ret == -ENOENT && (filep->f_oflags & O_RDOK) != 0)
+            {
+              ret = pagecache_fill(filep, pos / PAGECACHE_PAGESIZE, 1);
+              if (ret >= 0)
+                {
+                  continue;
+                }
+            }
+
+          if (ret == -ENOMEM)
+            {
+              /* Make room by writing back our own dirty pages */
+
+              ret = pagecache_writeback_obj(obj);
+              if (ret >= 0)
+                {
+                  ret = pagecache_copyin(obj, pos, buf, len, create);
+                }
+            }
+
+          if (ret == -ENOENT || ret == -ENOMEM)
+            {
+              /* The page cannot be read from a write-only file, or there
+               * is no memory left: write this part through.
+               */
+
+              rest.iov_base = (FAR void *)buf;
+              rest.iov_len  = MIN(len, PAGECACHE_PAGESIZE - offset);
+              ret = pagecache_writethrough(filep, pos, &rest, 1);
+            }
+
+          if (ret <= 0)
+            {
+              goto out;
+            }
+
+          ntotal += ret;
+          pos    += ret;
+          buf    += ret;
+          len    -= ret;
+        }
+    }
+
+out:
+  filep->f_pos = pos;
+
+  if (obj->ndirty > 0)
+    {
+      obj->writer = filep;
+      err = pagecache_dirtied(filep);
+      if (err < 0 && ntotal == 0)
+        {
+          ret = err;
+        }
+    }
+
+  nxmutex_unlock(&obj->lock);
+  return ntotal > 0 ? ntotal : ret;
+}
+
+/****************************************************************************
+ * Name: pagecache_seek
+ *
+ * Description:
+ *   Seeking only moves the cached file position, the file system is
+ *   repositioned on the next transfer.
+ *
+ ****************************************************************************/
+
+off_t pagecache_seek(FAR struct file *filep, off_t offset, int whence)
+{
+  FAR struct pagecache_obj_s *obj = filep->f_cache->obj;
+
+  switch (whence)
+    {
+      case SEEK_SET:
+        break;
+
+      case SEEK_CUR:
+        offset += filep->f_pos;
+        break;
+
+      case SEEK_END:
+        nxmutex_lock(&g_pagecache.lock);
+        offset += obj->size;
+        nxmutex_unlock(&g_pagecache.lock);
+        break;
+
+      default:
+        return -EINVAL;
+    }
+
+  if (offset < 0)
+    {
+      return -EINVAL;
+    }
+
+  filep->f_pos = offset;
+  return offset;
+}
+
+/****************************************************************************
+ * Name: pagecache_truncate
+ ****************************************************************************/
+
+int pagecache_truncate(FAR struct file *filep, off_t length)
+{
+  FAR struct pagecache_file_s *pf = filep->f_cache;
+  FAR struct pagecache_obj_s *obj = pf->obj;
+  FAR struct pagecache_page_s *page;
+  size_t offset = length % PAGECACHE_PAGESIZE;
+  off_t savepos;
+  int ret;
+
+  ret = nxmutex_lock(&obj->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  savepos = filep->f_pos;
+  filep->f_pos = pf->fspos;
+  ret = filep->f_inode->u.i_mops->truncate(filep, length);
+  pf->fspos = filep->f_pos;
+  filep->f_pos = savepos;
+
+  if (ret >= 0)
+    {
+      /* Discard everything past the new end of file, dirty or not */
+
+      nxmutex_lock(&g_pagecache.lock);
+      pagecache_drop(obj, (length + PAGECACHE_PAGESIZE - 1) /
+                     PAGECACHE_PAGESIZE, PAGECACHE_MAXINDEX, true);
+
+      page = offset > 0 ? pagecache_find(obj, length / PAGECACHE_PAGESIZE) :
+             NULL;
+      if (page != NULL)
+        {
+          page->valid = MIN(page->valid, offset);
+          if (PAGECACHE_DIRTY(page))
+            {
+              page->dend = MIN(page->dend, offset);
+              if (page->dend <= page->dstart)
+                {
+                  page->dstart = 0;
+                  page->dend   = 0;
+                  obj->ndirty--;
+                  g_pagecache.stats.ndirty--;
+                }
+            }
+        }
+
+      obj->size  = length;
+      obj->fsize = length;
+      nxmutex_unlock(&g_pagecache.lock);
+    }
+
+  nxmutex_unlock(&obj->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pagecache_sync
+ ****************************************************************************/
+
+int pagecache_sync(FAR struct file *filep)
+{
+  FAR struct pagecache_obj_s *obj = filep->f_cache->obj;
+  int ret;
+
+  ret = nxmutex_lock(&obj->lock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* The dirty pages may have been written through another open file */
+
+  ret = pagecache_writeback_obj(obj);
+
+  nxmutex_unlock(&obj->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pagecache_fstat
+ *
+ * Description:
+ *   Report the size including data still in the cache.
+ *
+ ****************************************************************************/
+
+void pagecache_fstat(FAR const struct file *filep, FAR struct stat *buf)
+{
+  nxmutex_lock(&g_pagecache.lock);
+  buf->st_size = filep->f_cache->obj->size;
+  nxmutex_unlock(&g_pagecache.lock);
+}
+
+/****************************************************************************
+ * Name: pagecache_invalidate
+ ****************************************************************************/
+
+void pagecache_invalidate(FAR struct inode *mountpt, uint64_t key,
+                          FAR const char *name)
+{
+  FAR struct pagecache_obj_s *obj;
+  FAR struct pagecache_obj_s *tmp;
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  list_for_every_entry_safe(&g_pagecache.objects, obj, tmp,
+                            struct pagecache_obj_s, node)
+    {
+      if (obj->mountpt != mountpt)
+        {
+          continue;
+        }
+
+      if (name != NULL ? obj->name != NULL &&
+                         pagecache_namematch(obj->name, name) :
+                         obj->name == NULL && obj->key == key)
+        {
+          pagecache_detach_obj(obj);
+        }
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+}
+
+/****************************************************************************
+ * Name: pagecache_umount
+ ****************************************************************************/
+
+void pagecache_umount(FAR struct inode *mountpt)
+{
+  FAR struct pagecache_obj_s *obj;
+  FAR struct pagecache_obj_s *tmp;
+
+  nxmutex_lock(&g_pagecache.lock);
+
+  list_for_every_entry_safe(&g_pagecache.objects, obj, tmp,
+                            struct pagecache_obj_s, node)
+    {
+      if (obj->mountpt == mountpt)
+        {
+          pagecache_detach_obj(obj);
+        }
+    }
+
+  nxmutex_unlock(&g_pagecache.lock);
+}
+
+/****************************************************************************
+ * Name: pagecache_stats
+ ****************************************************************************/
+
+void pagecache_stats(FAR struct pagecache_stats_s *stats)
+{
+  nxmutex_lock(&g_pagecache.lock);
+  memcpy(stats, &g_pagecache.stats, sizeof(struct pagecache_stats_s));
+  nxmutex_unlock(&g_pagecache.lock);
+}
+
+#endif /* CONFIG_FS_PAGECACHE */
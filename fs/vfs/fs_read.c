@@ -34,6 +34,7 @@
 #include <errno.h>
 
 #include <nuttx/cancelpt.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "notify/notify.h"
 #include "inode/inode.h"
@@ -173,6 +174,15 @@ ssize_t file_readv(FAR struct file *filep,
       ret = -EACCES;
     }
 
+#ifdef CONFIG_FS_PAGECACHE
+  /* Serve files attached to the page cache from the cache */
+
+  else if (filep->f_cache != NULL)
+    {
+      ret = pagecache_readv(filep, iov, iovcnt);
+    }
+#endif
+
   /* Is a driver or mountpoint registered? If so, does it support the read
    * method?
    * If yes, then let it perform the read.  NOTE that for the case of the
@@ -33,6 +33,7 @@
 #include <debug.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "notify/notify.h"
 #include "inode/inode.h"
@@ -100,6 +101,15 @@ int file_truncate(FAR struct file *filep, off_t length)
       return -ENOSYS;
     }
 
+#ifdef CONFIG_FS_PAGECACHE
+  /* The page cache must drop the truncated pages */
+
+  if (filep->f_cache != NULL)
+    {
+      return pagecache_truncate(filep, length);
+    }
+#endif
+
   /* Yes, then tell the file system to truncate this file */
 
   return inode->u.i_ops->truncate(filep, length);
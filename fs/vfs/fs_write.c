@@ -34,6 +34,7 @@
 #include <assert.h>
 
 #include <nuttx/cancelpt.h>
+#include <nuttx/fs/pagecache.h>
 
 #include "notify/notify.h"
 #include "inode/inode.h"
@@ -158,6 +159,16 @@ ssize_t file_writev(FAR struct file *filep,
    */
 
   inode = filep->f_inode;
+
+#ifdef CONFIG_FS_PAGECACHE
+  /* Collect writes to files attached to the page cache in the cache */
+
+  if (filep->f_cache != NULL)
+    {
+      ret = pagecache_writev(filep, iov, iovcnt);
+    }
+  else
+#endif
   if (inode != NULL && inode->u.i_ops)
     {
       if (inode->u.i_ops->writev)
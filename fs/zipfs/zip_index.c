@@ -0,0 +1,562 @@
+/****************************************************************************
+ * fs/zipfs/zip_index.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Random access to deflated entries.
+ *
+ * Inflating can only proceed forward from the start of an entry, so while
+ * an entry is read, the state of the decompressor is recorded every
+ * 'span' bytes of output at a deflate block boundary: the position in the
+ * compressed data, the bits of the last byte not yet consumed, and the
+ * 32 KiB of output preceding that point, which is the dictionary the
+ * following data may refer to.  Inflation can later restart from any of
+ * these checkpoints, so reaching any offset costs at most 'span' bytes of
+ * decompression once the checkpoints have been built.
+ *
+ * Checkpoints are built lazily, as far as the entry has been read.  When
+ * the memory budget is exhausted, every other checkpoint is dropped and
+ * the span doubled, so they stay evenly spread over the entry.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include <nuttx/fs/fs.h>
+
+#include <zlib.h>
+#include <unzip.h>
+
+#include "zip_index.h"
+#include "fs_heap.h"
+
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define ZIPFS_WINSIZE    32768  /* Deflate dictionary size */
+#define ZIPFS_INBUFSIZE  1024   /* Compressed input buffer size */
+
+/* Number of checkpoints the memory budget allows */
+
+#define ZIPFS_MAXPOINTS \
+  (CONFIG_ZIPFS_CHECKPOINT_BUDGET / \
+   (ZIPFS_WINSIZE + sizeof(struct zipfs_point_s)))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct zipfs_point_s
+{
+  off_t out;                 /* Uncompressed offset */
+  off_t in;                  /* Archive offset of the next compressed byte */
+  uint8_t bits;              /* Bits of the byte before 'in' still unused */
+  FAR uint8_t *window;       /* Output preceding 'out' */
+};
+
+struct zipfs_index_s
+{
+  struct file file;          /* The archive */
+  off_t base;                /* Archive offset of the entry data */
+  off_t csize;               /* Compressed size of the entry */
+  off_t usize;               /* Uncompressed size of the entry */
+  bool deflated;             /* False if the entry is stored */
+
+  /* Decompressor state */
+
+  z_stream strm;             /* Raw inflate stream */
+  off_t in;                  /* Archive offset of the next byte to read */
+  off_t out;                 /* Uncompressed offset of the stream */
+
+  /* Checkpoints, in increasing order of 'out' */
+
+  off_t span;                /* Minimum output between checkpoints */
+  int npoints;
+  FAR struct zipfs_point_s points[ZIPFS_MAXPOINTS + 1];
+
+  uint8_t inbuf[ZIPFS_INBUFSIZE];
+  uint8_t window[ZIPFS_WINSIZE]; /* The last output, circularly */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zipfs_index_window
+ *
+ * Description:
+ *   Copy the 'len' bytes of output preceding the current position between
+ *   the circular window and a linear buffer.
+ *
+ ****************************************************************************/
+
+static void zipfs_index_window(FAR struct zipfs_index_s *index,
+                               FAR uint8_t *buf, size_t len, bool save)
+{
+  size_t start = (index->out - len) % ZIPFS_WINSIZE;
+  size_t first = MIN(len, ZIPFS_WINSIZE - start);
+
+  if (save)
+    {
+      memcpy(buf, index->window + start, first);
+      memcpy(buf + first, index->window, len - first);
+    }
+  else
+    {
+      memcpy(index->window + start, buf, first);
+      memcpy(index->window, buf + first, len - first);
+    }
+}
+
+/****************************************************************************
+ * Name: zipfs_index_checkpoint
+ *
+ * Description:
+ *   Record a checkpoint at the current position, which is at a deflate
+ *   block boundary, if it is far enough from the last one.
+ *
+ ****************************************************************************/
+
+static void zipfs_index_checkpoint(FAR struct zipfs_index_s *index)
+{
+  FAR struct zipfs_point_s *point;
+  off_t last = 0;
+  int i;
+
+  if (ZIPFS_MAXPOINTS == 0)
+    {
+      return;
+    }
+
+  if (index->npoints > 0)
+    {
+      last = index->points[index->npoints - 1].out;
+    }
+
+  if (index->out - last < index->span)
+    {
+      return;
+    }
+
+  /* Out of budget: keep every other checkpoint and double the span */
+
+  if (index->npoints >= (int)ZIPFS_MAXPOINTS)
+    {
+      for (i = 0; i < index->npoints; i++)
+        {
+          if (i % 2 == 0)
+            {
+              fs_heap_free(index->points[i].window);
+            }
+          else
+            {
+              index->points[i / 2] = index->points[i];
+            }
+        }
+
+      index->npoints /= 2;
+      index->span    *= 2;
+
+      last = index->npoints > 0 ? index->points[index->npoints - 1].out : 0;
+      if (index->out - last < index->span)
+        {
+          return;
+        }
+    }
+
+  point = &index->points[index->npoints];
+  point->window = fs_heap_malloc(ZIPFS_WINSIZE);
+  if (point->window == NULL)
+    {
+      return;
+    }
+
+  point->out  = index->out;
+  point->in   = index->in - index->strm.avail_in;
+  point->bits = index->strm.data_type & 7;
+  zipfs_index_window(index, point->window,
+                     MIN(index->out, ZIPFS_WINSIZE), true);
+  index->npoints++;
+}
+
+/****************************************************************************
+ * Name: zipfs_index_restart
+ *
+ * Description:
+ *   Restart inflation at a checkpoint, or at the start of the entry if
+ *   'point' is NULL.
+ *
+ ****************************************************************************/
+
+static int zipfs_index_restart(FAR struct zipfs_index_s *index,
+                               FAR struct zipfs_point_s *point)
+{
+  uint8_t byte;
+  ssize_t nread;
+  int ret;
+
+  ret = inflateReset(&index->strm);
+  if (ret != Z_OK)
+    {
+      return -EIO;
+    }
+
+  index->strm.avail_in = 0;
+  if (point == NULL)
+    {
+      index->in  = index->base;
+      index->out = 0;
+      return OK;
+    }
+
+  index->in  = point->in;
+  index->out = point->out;
+
+  /* Feed the bits of the partially consumed byte */
+
+  if (point->bits != 0)
+    {
+      nread = file_pread(&index->file, &byte, 1, point->in - 1);
+      if (nread != 1)
+        {
+          return nread < 0 ? nread : -EIO;
+        }
+
+      ret = inflatePrime(&index->strm, point->bits,
+                         byte >> (8 - point->bits));
+      if (ret != Z_OK)
+        {
+          return -EIO;
+        }
+    }
+
+  ret = inflateSetDictionary(&index->strm, point->window,
+                             MIN(point->out, ZIPFS_WINSIZE));
+  if (ret != Z_OK)
+    {
+      return -EIO;
+    }
+
+  zipfs_index_window(index, point->window,
+                     MIN(point->out, ZIPFS_WINSIZE), false);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: zipfs_index_inflate
+ *
+ * Description:
+ *   Inflate the next 'len' bytes of the entry into 'buffer', or discard
+ *   them if 'buffer' is NULL, recording checkpoints on the way.
+ *
+ * Returned Value:
+ *   The number of bytes inflated, or a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static ssize_t zipfs_index_inflate(FAR struct zipfs_index_s *index,
+                                   FAR char *buffer, size_t len)
+{
+  ssize_t total = 0;
+  size_t offset;
+  size_t chunk;
+  ssize_t nread;
+  int ret;
+
+  len = MIN(len, index->usize - index->out);
+  while (total < (ssize_t)len)
+    {
+      if (index->strm.avail_in == 0)
+        {
+          nread = MIN(ZIPFS_INBUFSIZE,
+                      index->base + index->csize - index->in);
+          if (nread > 0)
+            {
+              nread = file_pread(&index->file, index->inbuf, nread,
+                                 index->in);
+            }
+
+          if (nread <= 0)
+            {
+              return total > 0 ? total : nread < 0 ? nread : -EIO;
+            }
+
+          index->in           += nread;
+          index->strm.next_in  = index->inbuf;
+          index->strm.avail_in = nread;
+        }
+
+      /* Inflate into the circular window, stopping at block boundaries
+       * to look for checkpoints.
+       */
+
+      offset = index->out % ZIPFS_WINSIZE;
+      chunk  = MIN(len - total, ZIPFS_WINSIZE - offset);
+
+      index->strm.next_out  = index->window + offset;
+      index->strm.avail_out = chunk;
+
+      ret = inflate(&index->strm, Z_BLOCK);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+        {
+          return total > 0 ? total : -EIO;
+        }
+
+      chunk -= index->strm.avail_out;
+      if (buffer != NULL)
+        {
+          memcpy(buffer + total, index->window + offset, chunk);
+        }
+
+      index->out += chunk;
+      total      += chunk;
+
+      if (ret == Z_STREAM_END)
+        {
+          break;
+        }
+
+      if ((index->strm.data_type & 128) != 0 &&
+          (index->strm.data_type & 64) == 0)
+        {
+          zipfs_index_checkpoint(index);
+        }
+    }
+
+  return total;
+}
+
+/****************************************************************************
+ * Name: zipfs_index_seek
+ *
+ * Description:
+ *   Bring the stream to uncompressed offset 'pos'.
+ *
+ ****************************************************************************/
+
+static int zipfs_index_seek(FAR struct zipfs_index_s *index, off_t pos)
+{
+  FAR struct zipfs_point_s *point = NULL;
+  ssize_t nskip;
+  int ret;
+  int i;
+
+  if (pos == index->out)
+    {
+      return OK;
+    }
+
+  /* Find the last checkpoint at or before pos */
+
+  for (i = index->npoints - 1; i >= 0; i--)
+    {
+      if (index->points[i].out <= pos)
+        {
+          point = &index->points[i];
+          break;
+        }
+    }
+
+  /* Restart from it if going backward or if it is ahead of the stream */
+
+  if (pos < index->out || (point != NULL && point->out > index->out))
+    {
+      ret = zipfs_index_restart(index, point);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  while (index->out < pos)
+    {
+      nskip = zipfs_index_inflate(index, NULL, pos - index->out);
+      if (nskip <= 0)
+        {
+          return nskip < 0 ? nskip : -EIO;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zipfs_index_open
+ *
+ * Description:
+ *   Set up random access to the current entry of 'uf', which must have
+ *   been opened with unzOpenCurrentFile().  The entry data is then read
+ *   directly from the archive 'abspath' rather than through 'uf'.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOTSUP if the entry is encrypted or uses a
+ *   compression method other than store or deflate; another negated errno
+ *   value on failure.
+ *
+ ****************************************************************************/
+
+int zipfs_index_open(FAR const char *abspath, unzFile uf,
+                     FAR struct zipfs_index_s **index)
+{
+  FAR struct zipfs_index_s *zi;
+  unz_file_info64 info;
+  int ret;
+
+  ret = unzGetCurrentFileInfo64(uf, &info, NULL, 0, NULL, 0, NULL, 0);
+  if (ret != UNZ_OK)
+    {
+      return -EINVAL;
+    }
+
+  if ((info.flag & 1) != 0 ||
+      (info.compression_method != 0 &&
+       info.compression_method != Z_DEFLATED))
+    {
+      return -ENOTSUP;
+    }
+
+  zi = fs_heap_zalloc(sizeof(*zi));
+  if (zi == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = file_open(&zi->file, abspath, O_RDONLY);
+  if (ret < 0)
+    {
+      goto errout_with_index;
+    }
+
+  zi->base     = unzGetCurrentFileZStreamPos64(uf);
+  zi->csize    = info.compressed_size;
+  zi->usize    = info.uncompressed_size;
+  zi->deflated = info.compression_method == Z_DEFLATED;
+  zi->in       = zi->base;
+  zi->span     = CONFIG_ZIPFS_CHECKPOINT_SPAN;
+
+  if (zi->deflated && inflateInit2(&zi->strm, -MAX_WBITS) != Z_OK)
+    {
+      ret = -ENOMEM;
+      goto errout_with_file;
+    }
+
+  *index = zi;
+  return OK;
+
+errout_with_file:
+  file_close(&zi->file);
+errout_with_index:
+  fs_heap_free(zi);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: zipfs_index_close
+ ****************************************************************************/
+
+void zipfs_index_close(FAR struct zipfs_index_s *index)
+{
+  int i;
+
+  for (i = 0; i < index->npoints; i++)
+    {
+      fs_heap_free(index->points[i].window);
+    }
+
+  if (index->deflated)
+    {
+      inflateEnd(&index->strm);
+    }
+
+  file_close(&index->file);
+  fs_heap_free(index);
+}
+
+/****************************************************************************
+ * Name: zipfs_index_read
+ *
+ * Description:
+ *   Read up to 'buflen' bytes at uncompressed offset 'pos' of the entry.
+ *
+ * Returned Value:
+ *   The number of bytes read, 0 at the end of the entry, or a negated
+ *   errno value on failure.
+ *
+ ****************************************************************************/
+
+ssize_t zipfs_index_read(FAR struct zipfs_index_s *index, off_t pos,
+                         FAR char *buffer, size_t buflen)
+{
+  int ret;
+
+  if (pos >= index->usize)
+    {
+      return 0;
+    }
+
+  buflen = MIN(buflen, index->usize - pos);
+
+  /* Stored entries are read in place */
+
+  if (!index->deflated)
+    {
+      return file_pread(&index->file, buffer, buflen, index->base + pos);
+    }
+
+  ret = zipfs_index_seek(index, pos);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return zipfs_index_inflate(index, buffer, buflen);
+}
+
+/****************************************************************************
+ * Name: zipfs_index_size
+ *
+ * Description:
+ *   Return the uncompressed size of the entry.
+ *
+ ****************************************************************************/
+
+off_t zipfs_index_size(FAR struct zipfs_index_s *index)
+{
+  return index->usize;
+}
+
+#endif /* CONFIG_ZIPFS_CHECKPOINT */
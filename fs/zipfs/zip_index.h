@@ -0,0 +1,98 @@
+/****************************************************************************
+ * fs/zipfs/zip_index.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __FS_ZIPFS_ZIP_INDEX_H
+#define __FS_ZIPFS_ZIP_INDEX_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+
+#include <unzip.h>
+
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct zipfs_index_s;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: zipfs_index_open
+ *
+ * Description:
+ *   Set up random access to the current entry of 'uf', which must have
+ *   been opened with unzOpenCurrentFile().  The entry data is then read
+ *   directly from the archive 'abspath' rather than through 'uf'.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOTSUP if the entry is encrypted or uses a
+ *   compression method other than store or deflate; another negated errno
+ *   value on failure.
+ *
+ ****************************************************************************/
+
+int zipfs_index_open(FAR const char *abspath, unzFile uf,
+                     FAR struct zipfs_index_s **index);
+
+/****************************************************************************
+ * Name: zipfs_index_close
+ ****************************************************************************/
+
+void zipfs_index_close(FAR struct zipfs_index_s *index);
+
+/****************************************************************************
+ * Name: zipfs_index_read
+ *
+ * Description:
+ *   Read up to 'buflen' bytes at uncompressed offset 'pos' of the entry.
+ *
+ * Returned Value:
+ *   The number of bytes read, 0 at the end of the entry, or a negated
+ *   errno value on failure.
+ *
+ ****************************************************************************/
+
+ssize_t zipfs_index_read(FAR struct zipfs_index_s *index, off_t pos,
+                         FAR char *buffer, size_t buflen);
+
+/****************************************************************************
+ * Name: zipfs_index_size
+ *
+ * Description:
+ *   Return the uncompressed size of the entry.
+ *
+ ****************************************************************************/
+
+off_t zipfs_index_size(FAR struct zipfs_index_s *index);
+
+#endif /* CONFIG_ZIPFS_CHECKPOINT */
+#endif /* __FS_ZIPFS_ZIP_INDEX_H */
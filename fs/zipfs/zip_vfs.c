@@ -37,6 +37,7 @@
 
 #include <unzip.h>
 
+#include "zip_index.h"
 #include "fs_heap.h"
 
 /****************************************************************************
@@ -61,6 +62,9 @@ struct zipfs_file_s
   unzFile uf;
   mutex_t lock;
   FAR char *seekbuf;
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+  FAR struct zipfs_index_s *index; /* Random access, NULL if unsupported */
+#endif
   char relpath[1];
 };
 
@@ -286,6 +290,13 @@ static int zipfs_open(FAR struct file *filep, FAR const char *relpath,
   if (ret == OK)
     {
       fp->seekbuf = NULL;
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+      if (zipfs_index_open(fs->abspath, fp->uf, &fp->index) < 0)
+        {
+          fp->index = NULL;
+        }
+#endif
+
       strcpy(fp->relpath, relpath);
       filep->f_priv = fp;
     }
@@ -307,6 +318,13 @@ static int zipfs_close(FAR struct file *filep)
   FAR struct zipfs_file_s *fp = filep->f_priv;
   int ret;
 
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+  if (fp->index != NULL)
+    {
+      zipfs_index_close(fp->index);
+    }
+#endif
+
   ret = zipfs_convert_result(unzClose(fp->uf));
   nxmutex_destroy(&fp->lock);
   fs_heap_free(fp->seekbuf);
@@ -321,7 +339,18 @@ static ssize_t zipfs_read(FAR struct file *filep, FAR char *buffer,
   ssize_t ret;
 
   nxmutex_lock(&fp->lock);
-  ret = zipfs_convert_result(unzReadCurrentFile(fp->uf, buffer, buflen));
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+  if (fp->index != NULL)
+    {
+      ret = zipfs_index_read(fp->index, filep->f_pos, buffer, buflen);
+    }
+  else
+#endif
+    {
+      ret = zipfs_convert_result(unzReadCurrentFile(fp->uf, buffer,
+                                                    buflen));
+    }
+
   if (ret > 0)
     {
       filep->f_pos += ret;
@@ -375,6 +404,37 @@ static off_t zipfs_seek(FAR struct file *filep, off_t offset,
   off_t ret = 0;
 
   nxmutex_lock(&fp->lock);
+#ifdef CONFIG_ZIPFS_CHECKPOINT
+  if (fp->index != NULL)
+    {
+      /* Reads go through the index from any position: only record it */
+
+      switch (whence)
+        {
+          case SEEK_SET:
+            break;
+          case SEEK_CUR:
+            offset += filep->f_pos;
+            break;
+          case SEEK_END:
+            offset += zipfs_index_size(fp->index);
+            break;
+          default:
+            ret = -EINVAL;
+            goto err_with_lock;
+        }
+
+      if (offset < 0)
+        {
+          ret = -EINVAL;
+          goto err_with_lock;
+        }
+
+      filep->f_pos = offset;
+      goto err_with_lock;
+    }
+#endif
+
   switch (whence)
     {
       case SEEK_SET:
@@ -30,8 +30,10 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <semaphore.h>
 #include <time.h>
 
+#include <nuttx/atomic.h>
 #include <nuttx/signal.h>
 #include <nuttx/wqueue.h>
 
@@ -99,6 +101,15 @@
 #define LIO_NOWAIT      0
 #define LIO_WAIT        1
 
+/* Non-standard notification method for aio_sigevent.sigev_notify:  the
+ * completed control block is posted to the struct aio_ring_s pointed to by
+ * aio_sigevent.sigev_value.sival_ptr instead of raising a signal.
+ */
+
+#ifdef CONFIG_FS_AIO_RING
+#  define SIGEV_AIORING 8
+#endif
+
 #if defined(CONFIG_FS_LARGEFILE)
 #  define aiocb64       aiocb
 #  define aio_read64    aio_read
@@ -133,8 +144,26 @@ struct aiocb
 
   struct sigwork_s aio_sigwork;  /* Signal work */
   volatile ssize_t aio_result;   /* Support for aio_error() and aio_return() */
-  FAR void *aio_priv;            /* Used by signal handlers */
+  FAR void *aio_priv;            /* Used by lio_listio() and signal handlers */
+};
+
+#ifdef CONFIG_FS_AIO_RING
+/* Non-standard completion ring.  The kernel posts the control blocks of
+ * completed requests that selected SIGEV_AIORING; a single thread of the
+ * application reaps them with aio_ring_reap().  The structure lives in
+ * application memory and is set up with aio_ring_init().
+ */
+
+struct aio_ring_s
+{
+  atomic_t head;                /* Completions posted by the kernel */
+  atomic_t tail;                /* Completions reaped by the application */
+  atomic_t overflow;            /* Completions signalled as ring was full */
+  unsigned int nentries;        /* Size of entries[], a power of two */
+  sem_t avail;                  /* Counts the entries ready to be reaped */
+  FAR struct aiocb **entries;   /* The ring itself */
 };
+#endif
 
 /****************************************************************************
  * Public Data
@@ -163,6 +192,13 @@ int aio_write(FAR struct aiocb *aiocbp);
 int lio_listio(int mode, FAR struct aiocb * const list[], int nent,
                FAR struct sigevent *sig);
 
+#ifdef CONFIG_FS_AIO_RING
+int aio_ring_init(FAR struct aio_ring_s *ring,
+                  FAR struct aiocb **entries, unsigned int nentries);
+int aio_ring_reap(FAR struct aio_ring_s *ring, FAR struct aiocb **list,
+                  int nent, FAR const struct timespec *timeout);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -37,6 +37,20 @@
 /* Append full suffix to avoid the penitential symbol collision */
 
 #define crc32   crc32full
+#define crc32c  crc32cfull
+
+/* CRC32C_CHECK is the CRC-32C (Castagnoli) of the string "123456789"
+ * without the null byte:
+ *
+ *   assert(crc32c(checkbuf, sizeof(checkbuf)) == CRC32C_CHECK);
+ *
+ * crc32cpart() works on the raw CRC register, like crc32part(): the
+ * caller applies CRC32C_INIT and CRC32C_XOROUT, crc32c() does both.
+ */
+
+#define CRC32C_INIT   0xffffffff
+#define CRC32C_XOROUT 0xffffffff
+#define CRC32C_CHECK  0xe3069283
 
 /****************************************************************************
  * Public Function Prototypes
@@ -70,6 +84,27 @@ uint32_t crc32part(FAR const uint8_t *src, size_t len, uint32_t crc32val);
 
 uint32_t crc32(FAR const uint8_t *src, size_t len);
 
+/****************************************************************************
+ * Name: crc32cpart
+ *
+ * Description:
+ *   Continue CRC-32C (Castagnoli) calculation on a part of the buffer.
+ *
+ ****************************************************************************/
+
+uint32_t crc32cpart(FAR const uint8_t *src, size_t len, uint32_t crc32val);
+
+/****************************************************************************
+ * Name: crc32c
+ *
+ * Description:
+ *   Return the CRC-32C (Castagnoli) of the contents of the 'src' buffer,
+ *   length 'len'.
+ *
+ ****************************************************************************/
+
+uint32_t crc32c(FAR const uint8_t *src, size_t len);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -190,6 +190,7 @@ struct pollfd;
 struct mtd_dev_s;
 struct tcb_s;
 struct uio;
+struct pagecache_file_s;
 
 /* The internal representation of type DIR is just a container for an inode
  * reference, and the path of directory.
@@ -275,6 +276,20 @@ struct block_operations
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   CODE int     (*unlink)(FAR struct inode *inode);
 #endif
+
+  /* Optional scatter-gather transfers: a run of sectors starting at
+   * start_sector, spread over several buffers, each a whole number of
+   * sectors.  They return the number of sectors transferred.  Use
+   * block_readv()/block_writev() to fall back on read/write when these
+   * are not provided.
+   */
+
+  CODE ssize_t (*readv)(FAR struct inode *inode,
+                        FAR const struct iovec *iov, int iovcnt,
+                        blkcnt_t start_sector);
+  CODE ssize_t (*writev)(FAR struct inode *inode,
+                         FAR const struct iovec *iov, int iovcnt,
+                         blkcnt_t start_sector);
 };
 
 /* This structure is provided by a filesystem to describe a mount point.
@@ -466,6 +481,9 @@ struct file
   off_t             f_pos;      /* File position */
   FAR struct inode *f_inode;    /* Driver or file system interface */
   FAR void         *f_priv;     /* Per file driver private data */
+#ifdef CONFIG_FS_PAGECACHE
+  FAR struct pagecache_file_s *f_cache; /* Page cache state, if attached */
+#endif
 #ifdef CONFIG_FDSAN
   uint64_t          f_tag_fdsan; /* File owner fdsan tag, init to 0 */
 #endif
@@ -488,13 +506,18 @@ struct file
  * You can get file instance in filelist by the follow methods:
  * (file descriptor / CONFIG_NFILE_DESCRIPTORS_PER_BLOCK) as row index and
  * (file descriptor % CONFIG_NFILE_DESCRIPTORS_PER_BLOCK) as column index.
+ *
+ * Descriptor lookups do not take fl_lock: rows never move once allocated,
+ * fl_rows is published after fl_files, and the row tables replaced when
+ * the list grows are kept on fl_retired until the list is released.
  */
 
 struct filelist
 {
-  spinlock_t        fl_lock;    /* Manage access to the file list */
-  uint8_t           fl_rows;    /* The number of rows of fl_files array */
+  spinlock_t        fl_lock;    /* Serialize descriptor install and growth */
+  atomic_t          fl_rows;    /* The number of rows of fl_files array */
   FAR struct file **fl_files;   /* The pointer of two layer file descriptors array */
+  FAR void         *fl_retired; /* Row tables replaced by a larger one */
 
   /* Pre-allocated files to avoid allocator access during thread creation
    * phase, For functional safety requirements, increase
@@ -682,6 +705,57 @@ int register_blockdriver(FAR const char *path,
 int register_merge_blockdriver(FAR const char *merge, ...);
 #endif
 
+/****************************************************************************
+ * Name: block_readv/block_writev
+ *
+ * Description:
+ *   Transfer a run of sectors between a block driver and several buffers,
+ *   each a whole number of sectors long.  The driver readv/writev methods
+ *   are used when provided, otherwise each buffer is transferred with
+ *   read/write.
+ *
+ * Input Parameters:
+ *   inode        - The block driver inode
+ *   iov          - The buffers
+ *   iovcnt       - The number of buffers
+ *   start_sector - The first sector of the run
+ *   sectorsize   - The sector size of the device
+ *
+ * Returned Value:
+ *   The number of sectors transferred; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+ssize_t block_readv(FAR struct inode *inode, FAR const struct iovec *iov,
+                    int iovcnt, blkcnt_t start_sector, size_t sectorsize);
+ssize_t block_writev(FAR struct inode *inode, FAR const struct iovec *iov,
+                     int iovcnt, blkcnt_t start_sector, size_t sectorsize);
+#endif
+
+/****************************************************************************
+ * Name: register_blockelevator
+ *
+ * Description:
+ *   Register a block driver at 'path' that forwards to the block driver
+ *   'parent', merging requests to adjacent sectors issued concurrently by
+ *   different threads into single scatter-gather requests.
+ *
+ * Input Parameters:
+ *   path   - The path to the new block driver
+ *   mode   - Access permissions of the new block driver
+ *   parent - The path to the underlying block driver
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_BLOCK_ELEVATOR
+int register_blockelevator(FAR const char *path, mode_t mode,
+                           FAR const char *parent);
+#endif
+
 /****************************************************************************
  * Name: register_blockpartition
  *
@@ -966,7 +1040,8 @@ FAR struct file *files_fget(FAR struct filelist *list, int fd);
  *
  * Description:
  *   Allocate a struct files instance and associate it with an inode
- *   instance.
+ *   instance.  cache is the page cache state attached to the file by the
+ *   open, if any; the new descriptor takes it over.
  *
  * Returned Value:
  *     Returns the file descriptor == index into the files array on success;
@@ -975,7 +1050,8 @@ FAR struct file *files_fget(FAR struct filelist *list, int fd);
  ****************************************************************************/
 
 int file_allocate_from_tcb(FAR struct tcb_s *tcb, FAR struct inode *inode,
-                           int oflags, off_t pos, FAR void *priv, int minfd,
+                           int oflags, off_t pos, FAR void *priv,
+                           FAR struct pagecache_file_s *cache, int minfd,
                            bool addref);
 
 /****************************************************************************
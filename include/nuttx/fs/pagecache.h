@@ -0,0 +1,175 @@
+/****************************************************************************
+ * include/nuttx/fs/pagecache.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_FS_PAGECACHE_H
+#define __INCLUDE_NUTTX_FS_PAGECACHE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <stdint.h>
+
+#ifdef CONFIG_FS_PAGECACHE
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* Page cache statistics, as reported by /proc/fs/pagecache */
+
+struct pagecache_stats_s
+{
+  unsigned long hits;        /* Page lookups satisfied from the cache */
+  unsigned long misses;      /* Page lookups that required media access */
+  unsigned long readahead;   /* Pages brought in ahead of the reader */
+  unsigned long evictions;   /* Clean pages reclaimed for reuse */
+  unsigned long writebacks;  /* Dirty pages written back to the media */
+  unsigned int  npages;      /* Pages currently allocated */
+  unsigned int  ndirty;      /* Pages currently dirty */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+struct file;
+struct inode;
+
+/****************************************************************************
+ * Name: pagecache_initialize
+ *
+ * Description:
+ *   Initialize the page cache.  Called once from fs_initialize().
+ *
+ ****************************************************************************/
+
+void pagecache_initialize(void);
+
+/****************************************************************************
+ * Name: pagecache_attach
+ *
+ * Description:
+ *   Opt an open file into the page cache.  This is called by a file
+ *   system at the end of a successful open().  From then on the VFS
+ *   serves read(), write(), lseek(), ftruncate() and fsync() on that file
+ *   through the cache, calling back into the file system only to fill
+ *   and write back pages.
+ *
+ *   All open files with the same mountpoint, key and name share their
+ *   cached pages.  The file system chooses a key that uniquely identifies
+ *   the file contents on the volume for as long as the file exists (such
+ *   as the location of its directory entry) or, if it has no such stable
+ *   identity, passes its relative path as name instead.
+ *
+ *   The file system lock must not be held: the page cache calls back into
+ *   the file system with its own per-file lock held.
+ *
+ * Input Parameters:
+ *   filep - The file just opened by the file system
+ *   key   - File identity on the mounted volume
+ *   name  - Relative path used as identity instead of key, or NULL
+ *   size  - Current size of the file on the media
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.  The file
+ *   system should fail the open() if the file cannot be attached, since
+ *   an uncached writer would leave the cached pages stale.
+ *
+ ****************************************************************************/
+
+int pagecache_attach(FAR struct file *filep, uint64_t key,
+                     FAR const char *name, off_t size);
+
+/****************************************************************************
+ * Name: pagecache_invalidate
+ *
+ * Description:
+ *   Drop every cached page of a file whose identity is about to be reused,
+ *   e.g. on unlink() or rename().  Files that are still open keep their
+ *   pages but are no longer found by subsequent opens.  When name is not
+ *   NULL, files below name (if it is a directory) are dropped as well.
+ *
+ *   This may be called with the file system lock held.
+ *
+ ****************************************************************************/
+
+void pagecache_invalidate(FAR struct inode *mountpt, uint64_t key,
+                          FAR const char *name);
+
+/****************************************************************************
+ * Name: pagecache_umount
+ *
+ * Description:
+ *   Drop all cached pages belonging to a mountpoint being unmounted.
+ *
+ ****************************************************************************/
+
+void pagecache_umount(FAR struct inode *mountpt);
+
+/****************************************************************************
+ * Name: pagecache_stats
+ *
+ * Description:
+ *   Return a snapshot of the page cache statistics.
+ *
+ ****************************************************************************/
+
+void pagecache_stats(FAR struct pagecache_stats_s *stats);
+
+/* The following are the VFS side hooks, invoked on files that have been
+ * attached by their file system.  They follow the conventions of the
+ * file_xxx() interfaces they replace.
+ */
+
+void pagecache_detach(FAR struct file *filep);
+int pagecache_dup(FAR const struct file *oldp, FAR struct file *newp);
+ssize_t pagecache_readv(FAR struct file *filep,
+                        FAR const struct iovec *iov, int iovcnt);
+ssize_t pagecache_writev(FAR struct file *filep,
+                         FAR const struct iovec *iov, int iovcnt);
+off_t pagecache_seek(FAR struct file *filep, off_t offset, int whence);
+int pagecache_truncate(FAR struct file *filep, off_t length);
+int pagecache_sync(FAR struct file *filep);
+void pagecache_fstat(FAR const struct file *filep, FAR struct stat *buf);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONFIG_FS_PAGECACHE */
+#endif /* __INCLUDE_NUTTX_FS_PAGECACHE_H */
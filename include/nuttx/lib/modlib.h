@@ -33,6 +33,7 @@
 #include <elf.h>
 
 #include <nuttx/addrenv.h>
+#include <nuttx/symtab.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -158,6 +159,9 @@ struct module_s
   char modname[MODLIB_NAMEMAX];        /* Module name */
 #endif
   struct mod_info_s modinfo;           /* Module information */
+#ifdef CONFIG_SYMTAB_HASH
+  struct symtab_hash_s exphash;        /* Index of modinfo.exports */
+#endif
   FAR void *textalloc;                 /* Allocated kernel text memory */
   FAR void *dataalloc;                 /* Allocated kernel memory */
   uintptr_t xipbase;                   /* if elf is position independent, and use
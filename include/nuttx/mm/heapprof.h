@@ -0,0 +1,178 @@
+/****************************************************************************
+ * include/nuttx/mm/heapprof.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_HEAPPROF_H
+#define __INCLUDE_NUTTX_MM_HEAPPROF_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The profile is exported through procfs, so only the heaps living in the
+ * kernel address space are sampled.
+ */
+
+#if !defined(CONFIG_MM_HEAPPROF) || \
+    (!defined(CONFIG_BUILD_FLAT) && !defined(__KERNEL__))
+#  undef CONFIG_MM_HEAPPROF
+#  define heapprof_alloc(heap, mem, size)
+#  define heapprof_free(heap, mem)
+#  define heapprof_purge(heap)
+#else
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct mm_heap_s;
+
+/* One call stack seen by the sampler.  The counts cover sampled
+ * allocations only; scaling them back to the whole heap is left to the
+ * consumer of the profile, which knows the sampling rate.
+ */
+
+struct heapprof_stack_s
+{
+  unsigned long inuse_objs;             /* Sampled allocations still live */
+  size_t inuse_bytes;                   /* Bytes of those allocations */
+  unsigned long alloc_objs;             /* Sampled allocations ever made */
+  uint64_t alloc_bytes;                 /* Bytes of those allocations */
+  int depth;                            /* Valid entries in pc[] */
+  FAR void *pc[CONFIG_MM_HEAPPROF_DEPTH];
+};
+
+/* Global state of the sampler */
+
+struct heapprof_info_s
+{
+  size_t rate;                          /* Mean bytes between samples */
+  unsigned int nstacks;                 /* Call stacks recorded */
+  unsigned int nlive;                   /* Sampled allocations still live */
+  unsigned long dropped;                /* Samples lost to full tables */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: heapprof_alloc
+ *
+ * Description:
+ *   Account an allocation to the sampler.  Called by the heap with every
+ *   block it hands out.  Only allocations picked by the sampler pay for a
+ *   backtrace; all others only decrement a per-CPU byte counter.
+ *
+ * Input Parameters:
+ *   heap - The heap the block belongs to
+ *   mem  - The address returned to the caller
+ *   size - The size requested by the caller
+ *
+ ****************************************************************************/
+
+void heapprof_alloc(FAR struct mm_heap_s *heap, FAR void *mem, size_t size);
+
+/****************************************************************************
+ * Name: heapprof_free
+ *
+ * Description:
+ *   Account the release of a block previously passed to heapprof_alloc().
+ *   Safe to call from interrupt context.
+ *
+ ****************************************************************************/
+
+void heapprof_free(FAR struct mm_heap_s *heap, FAR void *mem);
+
+/****************************************************************************
+ * Name: heapprof_purge
+ *
+ * Description:
+ *   Forget all live samples of a heap being destroyed.
+ *
+ ****************************************************************************/
+
+void heapprof_purge(FAR struct mm_heap_s *heap);
+
+/****************************************************************************
+ * Name: heapprof_setrate
+ *
+ * Description:
+ *   Set the mean number of bytes allocated between two samples.  Zero
+ *   stops sampling; samples already taken are kept.
+ *
+ ****************************************************************************/
+
+void heapprof_setrate(size_t rate);
+
+/****************************************************************************
+ * Name: heapprof_reset
+ *
+ * Description:
+ *   Discard all call stacks and samples collected so far.
+ *
+ ****************************************************************************/
+
+void heapprof_reset(void);
+
+/****************************************************************************
+ * Name: heapprof_snapshot
+ *
+ * Description:
+ *   Copy a consistent view of the profile.
+ *
+ * Input Parameters:
+ *   info    - Receives the global state of the sampler
+ *   stacks  - Receives up to nstacks call stacks
+ *   nstacks - The capacity of stacks
+ *
+ * Returned Value:
+ *   The number of call stacks copied.
+ *
+ ****************************************************************************/
+
+int heapprof_snapshot(FAR struct heapprof_info_s *info,
+                      FAR struct heapprof_stack_s *stacks, int nstacks);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_HEAPPROF */
+#endif /* __INCLUDE_NUTTX_MM_HEAPPROF_H */
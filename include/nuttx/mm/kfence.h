@@ -0,0 +1,158 @@
+/****************************************************************************
+ * include/nuttx/mm/kfence.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_KFENCE_H
+#define __INCLUDE_NUTTX_MM_KFENCE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <nuttx/sched.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Only the heaps living in the kernel address space are sampled */
+
+#if !defined(CONFIG_MM_KFENCE) || \
+    (!defined(CONFIG_BUILD_FLAT) && !defined(__KERNEL__))
+#  undef CONFIG_MM_KFENCE
+#  define kfence_sample()                 false
+#  define kfence_alloc(heap, size, align) NULL
+#  define kfence_free(mem)
+#  define kfence_is_object(mem)           false
+#  define kfence_heap(mem)                NULL
+#  define kfence_size(mem)                0
+#else
+
+/* The pool is made of CONFIG_MM_KFENCE_NOBJECTS slots, each preceded and
+ * followed by a guard area.
+ */
+
+#define KFENCE_STRIDE \
+  (CONFIG_MM_KFENCE_SLOTSIZE + CONFIG_MM_KFENCE_GUARDSIZE)
+#define KFENCE_POOL_SIZE \
+  (CONFIG_MM_KFENCE_NOBJECTS * KFENCE_STRIDE + CONFIG_MM_KFENCE_GUARDSIZE)
+
+/* Return true if mem was allocated by kfence_alloc() */
+
+#define kfence_is_object(mem) \
+  ((uintptr_t)(mem) - (uintptr_t)g_kfence_pool < KFENCE_POOL_SIZE)
+
+/* Count an allocation and return true if it should be tried with
+ * kfence_alloc().  This is all the cost of the detector for allocations
+ * that are not sampled.  A thread migrating in the middle may lose a count
+ * of another CPU, which only delays the next sample.
+ */
+
+#define kfence_sample() (--g_kfence_countdown[this_cpu()] <= 0)
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+struct mm_heap_s;
+
+EXTERN uint8_t g_kfence_pool[KFENCE_POOL_SIZE];
+EXTERN int g_kfence_countdown[CONFIG_SMP_NCPUS];
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: kfence_alloc
+ *
+ * Description:
+ *   Serve a sampled allocation from the guarded pool and restart the
+ *   sample countdown of this CPU.
+ *
+ * Input Parameters:
+ *   heap  - The heap the allocation is charged to
+ *   size  - The size of the allocation
+ *   align - The required alignment, a power of two
+ *
+ * Returned Value:
+ *   The object, or NULL if the allocation cannot be served from the pool,
+ *   in which case it must be served by the heap as usual.
+ *
+ ****************************************************************************/
+
+FAR void *kfence_alloc(FAR struct mm_heap_s *heap, size_t size,
+                       size_t align);
+
+/****************************************************************************
+ * Name: kfence_free
+ *
+ * Description:
+ *   Release an object of the pool, checking its redzones first.  The slot
+ *   is kept out of use for as long as possible to catch late accesses.
+ *
+ ****************************************************************************/
+
+void kfence_free(FAR void *mem);
+
+/****************************************************************************
+ * Name: kfence_heap
+ *
+ * Description:
+ *   Return the heap an object of the pool was last allocated from, NULL
+ *   if its slot was never used.  A freed object still reports its heap so
+ *   that a double free reaches kfence_free() and gets diagnosed there.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *kfence_heap(FAR const void *mem);
+
+/****************************************************************************
+ * Name: kfence_size
+ *
+ * Description:
+ *   Return the usable size of an object of the pool.
+ *
+ ****************************************************************************/
+
+size_t kfence_size(FAR const void *mem);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_KFENCE */
+#endif /* __INCLUDE_NUTTX_MM_KFENCE_H */
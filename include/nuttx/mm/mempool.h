@@ -41,6 +41,10 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_MM_MEMPOOL_PERCPU_CACHE
+#  define CONFIG_MM_MEMPOOL_PERCPU_CACHE 0
+#endif
+
 #if CONFIG_MM_BACKTRACE >= 0
 #  define MEMPOOL_REALBLOCKSIZE(pool) (ALIGN_UP((pool)->blocksize + \
                                        sizeof(struct mempool_backtrace_s), \
@@ -87,6 +91,19 @@ struct mempool_procfs_entry_s
 };
 #endif
 
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+
+/* The free blocks a CPU keeps aside from the shared queue of a pool.  It is
+ * only accessed by its CPU with the local interrupts disabled.
+ */
+
+struct mempool_cache_s
+{
+  unsigned int count;       /* The number of blocks in blk[] */
+  FAR void    *blk[CONFIG_MM_MEMPOOL_PERCPU_CACHE];
+};
+#endif
+
 /* This structure describes memory buffer pool */
 
 struct mempool_s
@@ -100,6 +117,12 @@ struct mempool_s
   mempool_alloc_t alloc;    /* The alloc function for mempool */
   mempool_free_t  free;     /* The free function for mempool */
   mempool_check_t check;    /* The check function for mempool */
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  FAR struct mempool_cache_s *cache; /* CONFIG_SMP_NCPUS zeroed caches, or
+                                      * NULL to always use the queue.  Set
+                                      * to NULL by mempool_init()
+                                      */
+#endif
 
   /* Private data for memory pool */
 
@@ -108,6 +108,21 @@
 
 #define mm_memdump_s malltask
 
+/* Memory tiers, from the fastest to the slowest memory.  Each region of a
+ * heap belongs to one tier, MM_TIER_NORMAL unless set by mm_regiontier().
+ */
+
+#define MM_TIER_FAST     0   /* On-chip or tightly-coupled SRAM */
+#define MM_TIER_NORMAL   1   /* The default of regions and allocations */
+#define MM_TIER_SLOW     2   /* External PSRAM/SDRAM */
+#define MM_NTIERS        3
+
+/* Or-ed with the tier given to mm_threadtier() to fail the allocations
+ * that do not fit in that tier instead of falling back on the others.
+ */
+
+#define MM_TIER_STRICT   0x80
+
 #if defined(CONFIG_ARCH_ADDRENV) && defined(CONFIG_BUILD_KERNEL)
 /* In the kernel build, there are multiple user heaps; one for each task
  * group.  In this build configuration, the user heap structure lies
@@ -182,6 +197,15 @@ struct mempool_init_s
   size_t            dict_expendsize;
 };
 
+/* The work moved off the allocation path by the idle workers */
+
+struct mm_idleinfo_s
+{
+  size_t nfreed;                 /* Delayed frees released */
+  size_t scrubbed;               /* Bytes of free memory cleared */
+  size_t nzeroed;                /* Zeroed allocations that skipped memset */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -454,6 +478,39 @@ FAR void kmm_checkcorruption(void);
 
 #endif /* CONFIG_DEBUG_MM */
 
+/* Functions contained in mm_tier.c *****************************************/
+
+#ifdef CONFIG_MM_TIER
+int mm_regiontier(FAR struct mm_heap_s *heap, FAR void *mem, int tier);
+struct mallinfo mm_mallinfo_tier(FAR struct mm_heap_s *heap, int tier);
+
+#  define umm_regiontier(mem, tier) mm_regiontier(USR_HEAP, mem, tier)
+#  define umm_mallinfo_tier(tier)   mm_mallinfo_tier(USR_HEAP, tier)
+#  ifdef CONFIG_MM_KERNEL_HEAP
+#    define kmm_regiontier(mem, tier) mm_regiontier(g_kmmheap, mem, tier)
+#    define kmm_mallinfo_tier(tier)   mm_mallinfo_tier(g_kmmheap, tier)
+#  else
+#    define kmm_regiontier(mem, tier) umm_regiontier(mem, tier)
+#    define kmm_mallinfo_tier(tier)   umm_mallinfo_tier(tier)
+#  endif
+
+#  if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+int mm_threadtier(int tier);
+#  endif
+#endif
+
+/* Functions contained in mm_idle.c *****************************************/
+
+#ifdef CONFIG_MM_IDLE_WORKER
+void mm_idleinfo(FAR struct mm_heap_s *heap,
+                 FAR struct mm_idleinfo_s *info);
+
+#  if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+void mm_idle_initialize(void);
+void mm_idle(void);
+#  endif
+#endif
+
 /* Functions contained in fs_procfspressure.c *******************************/
 
 #ifdef CONFIG_FS_PROCFS_INCLUDE_PRESSURE
@@ -0,0 +1,152 @@
+/****************************************************************************
+ * include/nuttx/mm/shrinker.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_SHRINKER_H
+#define __INCLUDE_NUTTX_MM_SHRINKER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+#include <nuttx/queue.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The kernel caches live in the kernel address space, so only the heaps
+ * there ask them for memory.
+ */
+
+#if !defined(CONFIG_MM_SHRINKER) || \
+    (!defined(CONFIG_BUILD_FLAT) && !defined(__KERNEL__))
+#  undef CONFIG_MM_SHRINKER
+#  define mm_shrink(size) 0
+#else
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* A cache able to give memory back to the heap on request.  The owner
+ * fills in name, count and scan, and leaves the rest zeroed.
+ */
+
+struct shrinker_s
+{
+  dq_entry_t node;                     /* Link in the list of shrinkers */
+  FAR const char *name;                /* Name shown in /proc/shrinker */
+
+  /* Return the number of bytes the cache could release right now */
+
+  CODE size_t (*count)(FAR struct shrinker_s *shrinker);
+
+  /* Release about size bytes and return the number of bytes released.
+   * scan() is called from the allocation slow path of whatever thread ran
+   * out of memory, possibly with the locks of the cache already held by
+   * that thread.  It must not block: use nxmutex_trylock() and return 0
+   * if the cache is busy.
+   */
+
+  CODE size_t (*scan)(FAR struct shrinker_s *shrinker, size_t size);
+
+  /* Statistics, maintained by mm_shrink() */
+
+  unsigned long nscan;                 /* Number of calls to scan() */
+  size_t scanned;                      /* Bytes requested from scan() */
+  size_t freed;                        /* Bytes released by scan() */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: mm_register_shrinker
+ *
+ * Description:
+ *   Make a cache eligible for reclaim.  The structure must remain valid
+ *   until mm_unregister_shrinker() returns.
+ *
+ ****************************************************************************/
+
+void mm_register_shrinker(FAR struct shrinker_s *shrinker);
+
+/****************************************************************************
+ * Name: mm_unregister_shrinker
+ *
+ * Description:
+ *   Remove a cache from reclaim, waiting for a scan in progress to end.
+ *
+ ****************************************************************************/
+
+void mm_unregister_shrinker(FAR struct shrinker_s *shrinker);
+
+/****************************************************************************
+ * Name: mm_shrink
+ *
+ * Description:
+ *   Ask the registered caches, in registration order, to release memory
+ *   until at least size bytes have been released or all of them have been
+ *   asked.  Nothing is done from interrupt context or from within a
+ *   scan(), and a thread arriving during another reclaim waits for it.
+ *
+ * Input Parameters:
+ *   size - The number of bytes wanted
+ *
+ * Returned Value:
+ *   The number of bytes released.
+ *
+ ****************************************************************************/
+
+size_t mm_shrink(size_t size);
+
+/****************************************************************************
+ * Name: mm_shrinker_foreach
+ *
+ * Description:
+ *   Call handler for every registered shrinker, with reclaim held off.
+ *
+ ****************************************************************************/
+
+void mm_shrinker_foreach(CODE void (*handler)(FAR struct shrinker_s *,
+                                              FAR void *),
+                         FAR void *arg);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_SHRINKER */
+#endif /* __INCLUDE_NUTTX_MM_SHRINKER_H */
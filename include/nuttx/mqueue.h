@@ -94,6 +94,10 @@
 #  define MQ_WNELIST(cmn)             (&((cmn).waitfornotempty))
 #  define MQ_WNFLIST(cmn)             (&((cmn).waitfornotfull))
 
+/* Flags accepted by file_mq_zc_setup() */
+
+#define MQ_ZC_SPSC                    0x01 /* Single producer and consumer */
+
 /****************************************************************************
  * Public Type Declarations
  ****************************************************************************/
@@ -126,6 +130,9 @@ struct mqueue_inode_s
   pid_t ntpid;                /* Notification: Receiving Task's PID */
   struct sigevent ntevent;    /* Notification description */
   struct sigwork_s ntwork;    /* Notification work */
+#endif
+#ifdef CONFIG_MQ_ZEROCOPY
+  FAR struct mqueue_zc_s *zc; /* Zero-copy message ring (if attached) */
 #endif
   FAR struct pollfd *fds[CONFIG_FS_MQUEUE_NPOLLWAITERS];
 };
@@ -147,6 +154,7 @@ extern "C"
 #endif
 
 struct tcb_s;         /* Forward reference */
+struct mqueue_zc_s;   /* Forward reference */
 struct mq_attr;       /* Forward reference */
 struct timespec;      /* Forward reference */
 struct task_group_s;  /* Forward reference */
@@ -793,6 +801,153 @@ int file_mq_setattr(FAR struct file *mq, FAR const struct mq_attr *mq_stat,
 
 int file_mq_getattr(FAR struct file *mq, FAR struct mq_attr *mq_stat);
 
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Name: file_mq_zc_setup
+ *
+ * Description:
+ *   Attach a pre-allocated zero-copy message ring to the message queue.
+ *   The ring holds at least mq_maxmsg slots of mq_msgsize bytes.  Once
+ *   attached, messages are exchanged in FIFO order through the ring:
+ *   producers reserve a slot, fill it in place and commit it; consumers
+ *   borrow the oldest committed slot and release it when done.  The
+ *   normal send and receive interfaces remain usable and copy through the
+ *   same ring.
+ *
+ *   The ring is lock-free for any number of producers and consumers.  If
+ *   MQ_ZC_SPSC is set in flags, the caller guarantees that there is only
+ *   a single producer and a single consumer and the slot claim does not
+ *   need an atomic compare-and-exchange.
+ *
+ * Input Parameters:
+ *   mq    - Message queue descriptor
+ *   flags - Zero or MQ_ZC_SPSC
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success.  A negated errno value is returned
+ *   on failure:
+ *
+ *   EBUSY   The ring is already attached, messages are queued or tasks
+ *           wait in mq_send() or mq_receive().
+ *   ENOMEM  The ring could not be allocated.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_setup(FAR struct file *mq, int flags);
+
+/****************************************************************************
+ * Name: file_mq_zc_reserve
+ *
+ * Description:
+ *   Reserve one free slot in the zero-copy ring of the message queue.  If
+ *   the ring is full and O_NONBLOCK is not set, the caller blocks until a
+ *   slot is released or until abstime (if not NULL) expires.
+ *
+ * Input Parameters:
+ *   mq      - Message queue descriptor
+ *   buf     - Location to return the address of the slot payload.  At
+ *             most mq_msgsize bytes may be written there.
+ *   abstime - The absolute time to wait until a timeout is declared
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success.  A negated errno value is returned
+ *   on failure (see file_mq_timedsend()).
+ *
+ ****************************************************************************/
+
+int file_mq_zc_reserve(FAR struct file *mq, FAR void **buf,
+                       FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: file_mq_zc_commit
+ *
+ * Description:
+ *   Publish a slot obtained from file_mq_zc_reserve() to the consumers.
+ *
+ * Input Parameters:
+ *   mq     - Message queue descriptor
+ *   buf    - The payload address returned by file_mq_zc_reserve()
+ *   msglen - The length of the message in bytes
+ *   prio   - The priority of the message
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success.  A negated errno value is returned
+ *   on failure, in which case the slot remains reserved:
+ *
+ *   EINVAL   buf does not refer to a reserved slot or prio is invalid.
+ *   EMSGSIZE msglen is greater than mq_msgsize.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_commit(FAR struct file *mq, FAR void *buf, size_t msglen,
+                      unsigned int prio);
+
+/****************************************************************************
+ * Name: file_mq_zc_borrow
+ *
+ * Description:
+ *   Borrow the oldest committed message from the zero-copy ring of the
+ *   message queue without copying it.  If the ring is empty and
+ *   O_NONBLOCK is not set, the caller blocks until a message is committed
+ *   or until abstime (if not NULL) expires.  The slot must be handed back
+ *   with file_mq_zc_release().
+ *
+ * Input Parameters:
+ *   mq      - Message queue descriptor
+ *   buf     - Location to return the address of the message payload
+ *   prio    - If not NULL, the location to store message priority
+ *   abstime - The absolute time to wait until a timeout is declared
+ *
+ * Returned Value:
+ *   The length of the message is returned on success.  A negated errno
+ *   value is returned on failure (see file_mq_timedreceive()).
+ *
+ ****************************************************************************/
+
+ssize_t file_mq_zc_borrow(FAR struct file *mq, FAR void **buf,
+                          FAR unsigned int *prio,
+                          FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: file_mq_zc_release
+ *
+ * Description:
+ *   Return a slot obtained from file_mq_zc_borrow() to the producers.
+ *
+ * Input Parameters:
+ *   mq  - Message queue descriptor
+ *   buf - The payload address returned by file_mq_zc_borrow()
+ *
+ * Returned Value:
+ *   Zero (OK) is returned on success.  -EINVAL is returned if buf does not
+ *   refer to a borrowed slot of the ring, e.g. if it was already released.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_release(FAR struct file *mq, FAR void *buf);
+
+/****************************************************************************
+ * Name: nxmq_zc_setup, nxmq_zc_reserve, nxmq_zc_commit, nxmq_zc_borrow,
+ *       nxmq_zc_release
+ *
+ * Description:
+ *   The same as the file_mq_zc_* interfaces above, but operating on a
+ *   message queue descriptor.
+ *
+ ****************************************************************************/
+
+int nxmq_zc_setup(mqd_t mqdes, int flags);
+int nxmq_zc_reserve(mqd_t mqdes, FAR void **buf,
+                    FAR const struct timespec *abstime);
+int nxmq_zc_commit(mqd_t mqdes, FAR void *buf, size_t msglen,
+                   unsigned int prio);
+ssize_t nxmq_zc_borrow(mqd_t mqdes, FAR void **buf, FAR unsigned int *prio,
+                       FAR const struct timespec *abstime);
+int nxmq_zc_release(mqd_t mqdes, FAR void *buf);
+
+#endif /* CONFIG_MQ_ZEROCOPY */
+
 #undef EXTERN
 #ifdef __cplusplus
 }
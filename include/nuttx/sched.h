@@ -619,6 +619,9 @@ struct tcb_s
   int16_t  irqcount;                     /* 0=Not in critical section       */
 #endif
   int16_t  errcode;                      /* Used to pass error information  */
+#ifdef CONFIG_MM_TIER
+  uint8_t  mm_tier;                      /* Heap tier hint + 1, 0 if none   */
+#endif
 
 #if CONFIG_RR_INTERVAL > 0 || defined(CONFIG_SCHED_SPORADIC)
   int32_t  timeslice;                    /* RR timeslice OR Sporadic budget */
@@ -651,6 +654,12 @@ struct tcb_s
 
   FAR void *waitobj;                     /* Object thread waiting on        */
 
+  /* Timer slack support ****************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  clock_t timer_slack;                   /* Allowed delay of timeouts       */
+#endif
+
   /* POSIX Signal Control Fields ********************************************/
 
   sigset_t   sigprocmask;                /* Signals that are blocked        */
@@ -679,6 +688,13 @@ struct tcb_s
   clock_t run_time;                      /* Total time thread run           */
 #endif
 
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  clock_t ready_start;                   /* Time when thread became ready   */
+  clock_t wait_max;                      /* Max time waiting for the CPU    */
+  clock_t wait_time;                     /* Total time waiting for the CPU  */
+  uint32_t wait_hist[CONFIG_SCHED_CRITMONITOR_LATENCY_NBUCKETS];
+#endif
+
 #if CONFIG_SCHED_CRITMONITOR_MAXTIME_PREEMPTION >= 0
   clock_t preemp_start;                  /* Time when preemption disabled   */
   clock_t preemp_max;                    /* Max time preemption disabled    */
@@ -480,6 +480,14 @@
 
 #define SNIOC_LPF                     _SNIOC(0x00A0)
 
+/* Command:      SNIOC_GET_CURSOR
+ * Description:  Get the index of the ring cursor owned by this subscriber
+ *               after the topic has been mapped with mmap().
+ * Argument:     The index pointer, (unsigned int *)
+ */
+
+#define SNIOC_GET_CURSOR              _SNIOC(0x00A1)
+
 /****************************************************************************
  * Public types
  ****************************************************************************/
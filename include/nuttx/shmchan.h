@@ -0,0 +1,208 @@
+/****************************************************************************
+ * include/nuttx/shmchan.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_SHMCHAN_H
+#define __INCLUDE_NUTTX_SHMCHAN_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <semaphore.h>
+#include <time.h>
+
+#ifdef CONFIG_LIBC_SHMCHAN
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The ring shared by all the ends of a channel, private to lib_shmchan.c */
+
+struct shmchan_ring_s;
+
+/* One end of a channel, local to the process which opened it.  Any number
+ * of senders and receivers may share the channel.
+ */
+
+struct shmchan_s
+{
+  FAR struct shmchan_ring_s *ring; /* The mapping of the shared ring */
+  size_t mapsize;                  /* The size of the mapping */
+  size_t msgsize;                  /* The maximum size of a message */
+  size_t nslots;                   /* The number of slots of the ring */
+  size_t slotsize;                 /* The distance between two slots */
+  FAR sem_t *data;                 /* Posted for receivers waiting for data */
+  FAR sem_t *space;                /* Posted for senders waiting for space */
+  int oflags;                      /* O_NONBLOCK */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: shmchan_create
+ *
+ * Description:
+ *   Create a new channel and open one end of it.  The ring is placed in a
+ *   shared memory object named name, and the two named semaphores used to
+ *   block are derived from that name.
+ *
+ * Input Parameters:
+ *   chan    - The end of the channel to initialize
+ *   name    - The name of the channel, as given to shm_open()
+ *   oflags  - O_NONBLOCK, or 0 for an end which blocks
+ *   mode    - The permissions of the shared memory object
+ *   msgsize - The maximum size of a message
+ *   nmsgs   - The number of messages the ring can hold, rounded up to a
+ *             power of two
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure: -EEXIST if a
+ *   channel with that name already exists.
+ *
+ ****************************************************************************/
+
+int shmchan_create(FAR struct shmchan_s *chan, FAR const char *name,
+                   int oflags, mode_t mode, size_t msgsize, size_t nmsgs);
+
+/****************************************************************************
+ * Name: shmchan_open
+ *
+ * Description:
+ *   Open one end of an existing channel.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure: -ENOENT if there is
+ *   no such channel, -EAGAIN if its creator has not finished setting it
+ *   up yet, -EINVAL if the shared memory object does not hold a valid
+ *   ring.
+ *
+ ****************************************************************************/
+
+int shmchan_open(FAR struct shmchan_s *chan, FAR const char *name,
+                 int oflags);
+
+/****************************************************************************
+ * Name: shmchan_close
+ *
+ * Description:
+ *   Close one end of a channel.  The channel lives on until it is unlinked
+ *   and all of its ends are closed.
+ *
+ ****************************************************************************/
+
+void shmchan_close(FAR struct shmchan_s *chan);
+
+/****************************************************************************
+ * Name: shmchan_unlink
+ *
+ * Description:
+ *   Remove the name of a channel.  The ends already open keep working.
+ *
+ ****************************************************************************/
+
+int shmchan_unlink(FAR const char *name);
+
+/****************************************************************************
+ * Name: shmchan_send
+ *
+ * Description:
+ *   Copy a message into the ring.  No system call is made unless the ring
+ *   is full or a receiver waits for data.  If the ring is full, the caller
+ *   waits for space, unless the end was opened with O_NONBLOCK.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure: -EMSGSIZE if len
+ *   exceeds the message size of the channel, -EAGAIN if the ring is full
+ *   and the end does not block.
+ *
+ ****************************************************************************/
+
+int shmchan_send(FAR struct shmchan_s *chan, FAR const void *buf,
+                 size_t len);
+
+/****************************************************************************
+ * Name: shmchan_timedsend
+ *
+ * Description:
+ *   Like shmchan_send(), but give up with -ETIMEDOUT once the absolute
+ *   CLOCK_REALTIME time abstime has passed.
+ *
+ ****************************************************************************/
+
+int shmchan_timedsend(FAR struct shmchan_s *chan, FAR const void *buf,
+                      size_t len, FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: shmchan_recv
+ *
+ * Description:
+ *   Copy the oldest message out of the ring.  No system call is made
+ *   unless the ring is empty or a sender waits for space.  If the ring is
+ *   empty, the caller waits for data, unless the end was opened with
+ *   O_NONBLOCK.
+ *
+ * Returned Value:
+ *   The length of the message on success; a negated errno value on
+ *   failure: -EMSGSIZE if buflen is less than the message size of the
+ *   channel, -EAGAIN if the ring is empty and the end does not block,
+ *   -EBADMSG if a peer corrupted the length of the message, which is
+ *   dropped.
+ *
+ ****************************************************************************/
+
+ssize_t shmchan_recv(FAR struct shmchan_s *chan, FAR void *buf,
+                     size_t buflen);
+
+/****************************************************************************
+ * Name: shmchan_timedrecv
+ *
+ * Description:
+ *   Like shmchan_recv(), but give up with -ETIMEDOUT once the absolute
+ *   CLOCK_REALTIME time abstime has passed.
+ *
+ ****************************************************************************/
+
+ssize_t shmchan_timedrecv(FAR struct shmchan_s *chan, FAR void *buf,
+                          size_t buflen, FAR const struct timespec *abstime);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONFIG_LIBC_SHMCHAN */
+#endif /* __INCLUDE_NUTTX_SHMCHAN_H */
@@ -29,6 +29,8 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -57,6 +59,28 @@ struct symtab_s
   FAR const void *sym_value; /* The value associated with the string */
 };
 
+#ifdef CONFIG_SYMTAB_HASH
+/* struct symtab_hash_s is a GNU hash style index over a symbol table, built
+ * once by symtab_hashinit() for tables searched many times.  A Bloom filter
+ * rejects most of the names absent from the table without touching the
+ * buckets.  The entries of a bucket are contiguous in chain[], holding
+ * their hash with bit 0 set on the last one, and index[] maps them back to
+ * the symbol table.
+ */
+
+struct symtab_hash_s
+{
+  FAR const struct symtab_s *symtab; /* The indexed symbol table */
+  int nsyms;                         /* Number of symbols in symtab */
+  uint32_t nbuckets;                 /* Number of hash buckets */
+  uint32_t nbloom;                   /* Number of Bloom words, power of 2 */
+  FAR uintptr_t *bloom;              /* Bloom filter words */
+  FAR uint32_t *buckets;             /* First chain[] entry of each bucket */
+  FAR uint32_t *chain;               /* Hash values, bit 0 ends a bucket */
+  FAR uint32_t *index;               /* symtab index of each chain[] entry */
+};
+#endif
+
 /****************************************************************************
  * Public Functions Definitions
  ****************************************************************************/
@@ -121,6 +145,51 @@ symtab_findbyvalue(FAR const struct symtab_s *symtab,
 
 void symtab_sortbyname(FAR struct symtab_s *symtab, int nsyms);
 
+#ifdef CONFIG_SYMTAB_HASH
+/****************************************************************************
+ * Name: symtab_hashinit
+ *
+ * Description:
+ *   Build the hash index of a symbol table.  The table must not change
+ *   while the index is in use.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOMEM if the index could not be allocated, in
+ *   which case the index is left empty, not describing symtab.
+ *
+ ****************************************************************************/
+
+int symtab_hashinit(FAR struct symtab_hash_s *hash,
+                    FAR const struct symtab_s *symtab, int nsyms);
+
+/****************************************************************************
+ * Name: symtab_hashfree
+ *
+ * Description:
+ *   Release the memory of a hash index built by symtab_hashinit().
+ *
+ ****************************************************************************/
+
+void symtab_hashfree(FAR struct symtab_hash_s *hash);
+
+/****************************************************************************
+ * Name: symtab_hashfind
+ *
+ * Description:
+ *   Find the symbol with the matching name through a hash index.  When the
+ *   table holds the name several times, the first entry is returned, as
+ *   symtab_findbyname() does on an unordered table.
+ *
+ * Returned Value:
+ *   A reference to the symbol table entry if an entry with the matching
+ *   name is found; NULL is returned if the entry is not found.
+ *
+ ****************************************************************************/
+
+FAR const struct symtab_s *
+symtab_hashfind(FAR const struct symtab_hash_s *hash, FAR const char *name);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
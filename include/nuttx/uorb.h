@@ -36,6 +36,10 @@
 
 #include <nuttx/sensors/ioctl.h>
 
+#ifdef CONFIG_SENSORS_ZEROCOPY
+#  include <nuttx/atomic.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -1182,6 +1186,25 @@ struct sensor_ustate_s
   uint64_t generation;         /* The recent generation of circular buffer */
 };
 
+/* This structure describes the head of the sample ring shared with the
+ * zero-copy subscribers through mmap().  The producer is the only writer
+ * of head and reserve, every mapping subscriber owns one entry of cursor[]
+ * (see SNIOC_GET_CURSOR) and advances it after consuming samples so that
+ * poll() reports POLLIN only for samples it has not seen yet.
+ */
+
+#ifdef CONFIG_SENSORS_ZEROCOPY
+struct sensor_ring_s
+{
+  atomic_t head;               /* Number of samples published */
+  atomic_t reserve;            /* Number of samples published or being written */
+  uint32_t esize;              /* The element size of the ring */
+  uint32_t nbuffer;            /* The number of elements, power of two */
+  uint32_t offset;             /* Offset of the first element from the head */
+  atomic_t cursor[CONFIG_SENSORS_ZEROCOPY_NCURSORS];
+};
+#endif
+
 /* This structure describes the register info for the user sensor */
 
 #ifdef CONFIG_USENSOR
@@ -1273,4 +1296,67 @@ struct sensor_device_info_s
   char          vendor[SENSOR_INFO_NAME_SIZE];
 };
 
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_SENSORS_ZEROCOPY
+
+/****************************************************************************
+ * Name: sensor_ring_avail
+ *
+ * Description:
+ *   Return the number of samples ready to be consumed from position *pos.
+ *   If the producer has already overwritten some of them, *pos is moved
+ *   forward to the oldest sample still held by the ring.
+ *
+ ****************************************************************************/
+
+static inline uint32_t sensor_ring_avail(FAR struct sensor_ring_s *ring,
+                                         FAR uint32_t *pos)
+{
+  uint32_t head = atomic_read_acquire(&ring->head);
+
+  if (head - *pos > ring->nbuffer)
+    {
+      *pos = head - ring->nbuffer;
+    }
+
+  return head - *pos;
+}
+
+/****************************************************************************
+ * Name: sensor_ring_peek
+ *
+ * Description:
+ *   Return the address of the sample at position pos inside the ring.
+ *
+ ****************************************************************************/
+
+static inline FAR const void *
+sensor_ring_peek(FAR struct sensor_ring_s *ring, uint32_t pos)
+{
+  return (FAR const char *)ring + ring->offset +
+         (pos & (ring->nbuffer - 1)) * ring->esize;
+}
+
+/****************************************************************************
+ * Name: sensor_ring_valid
+ *
+ * Description:
+ *   Check, after the sample at position pos has been used in place,
+ *   whether the producer might have overwritten it meanwhile.  The sample
+ *   must be discarded if false is returned.
+ *
+ ****************************************************************************/
+
+static inline bool sensor_ring_valid(FAR struct sensor_ring_s *ring,
+                                     uint32_t pos)
+{
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (uint32_t)atomic_read(&ring->reserve) - pos <= ring->nbuffer;
+}
+
+#endif /* CONFIG_SENSORS_ZEROCOPY */
+
 #endif /* __INCLUDE_NUTTX_SENSORS_SENSOR_H */
@@ -88,6 +88,9 @@ struct wdog_s
   FAR void          *picbase;    /* PIC base address */
 #endif
   clock_t            expired;    /* Timer associated with the absoulute time */
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  clock_t            slack;      /* Allowed delay of the expiration */
+#endif
 };
 
 /****************************************************************************
@@ -102,6 +105,15 @@ extern "C"
 #define EXTERN extern
 #endif
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+/* The number of watchdog expirations that were deferred by their timer
+ * slack and handled by a later timer interrupt, i.e. the number of timer
+ * interrupts avoided.
+ */
+
+EXTERN unsigned long g_wdcoalesced;
+#endif
+
 /****************************************************************************
  * Name: wd_start
  *
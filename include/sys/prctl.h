@@ -69,6 +69,18 @@
  *
  *      char myname[CONFIG_TASK_NAME_SIZE];
  *      prctl(PR_GET_NAME_EXT, myname, pid);
+ *
+ *  PR_SET_TIMERSLACK
+ *    Set the timer slack of the calling thread to arg2 (unsigned long)
+ *    nanoseconds.  The timeouts of the thread may then expire that much
+ *    later than requested so that they can be coalesced with other timer
+ *    events.  A value of 0 disables the slack.  Only supported with
+ *    CONFIG_SCHED_TICKLESS_COALESCE.  As an example:
+ *
+ *      prctl(PR_SET_TIMERSLACK, 1000000);
+ *
+ *  PR_GET_TIMERSLACK
+ *    Return the timer slack of the calling thread in nanoseconds.
  */
 
 #define PR_SET_NAME     1
@@ -79,6 +91,9 @@
 #define PR_SET_DUMPABLE 5
 #define PR_GET_DUMPABLE 6
 
+#define PR_SET_TIMERSLACK 29
+#define PR_GET_TIMERSLACK 30
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
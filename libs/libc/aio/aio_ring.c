@@ -0,0 +1,149 @@
+/****************************************************************************
+ * libs/libc/aio/aio_ring.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <aio.h>
+#include <assert.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <string.h>
+#include <time.h>
+
+#include <nuttx/clock.h>
+
+#ifdef CONFIG_FS_AIO_RING
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_ring_init
+ *
+ * Description:
+ *   Prepare a completion ring.  Requests whose aio_sigevent.sigev_notify is
+ *   SIGEV_AIORING and whose aio_sigevent.sigev_value.sival_ptr points to
+ *   the ring are not signalled on completion; their control blocks are
+ *   posted to the ring instead, to be collected with aio_ring_reap().
+ *
+ *   If the ring is full, the completion is signalled with SIGPOLL as usual
+ *   and the overflow count of the ring is incremented.
+ *
+ * Input Parameters:
+ *   ring     - The ring to initialize
+ *   entries  - Storage for the ring, nentries pointers
+ *   nentries - Number of entries, a power of two
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -1 (ERROR) with errno set to EINVAL if nentries
+ *   is not a power of two.
+ *
+ ****************************************************************************/
+
+int aio_ring_init(FAR struct aio_ring_s *ring,
+                  FAR struct aiocb **entries, unsigned int nentries)
+{
+  if (nentries == 0 || (nentries & (nentries - 1)) != 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  memset(ring, 0, sizeof(*ring));
+  ring->nentries = nentries;
+  ring->entries  = entries;
+  return sem_init(&ring->avail, 0, 0);
+}
+
+/****************************************************************************
+ * Name: aio_ring_reap
+ *
+ * Description:
+ *   Collect the control blocks of completed requests from a completion
+ *   ring, waiting for the first one if the ring is empty.  Only one thread
+ *   may reap from a ring.
+ *
+ * Input Parameters:
+ *   ring    - The ring to reap from
+ *   list    - Receives the completed control blocks, in completion order
+ *   nent    - The maximum number of control blocks to return
+ *   timeout - Longest time to wait if the ring is empty, NULL to wait
+ *             indefinitely
+ *
+ * Returned Value:
+ *   The number of control blocks returned in list[], at least one.  On
+ *   failure -1 (ERROR) is returned with errno set: EAGAIN if the timeout
+ *   expired, EINTR if the wait was interrupted by a signal.
+ *
+ ****************************************************************************/
+
+int aio_ring_reap(FAR struct aio_ring_s *ring, FAR struct aiocb **list,
+                  int nent, FAR const struct timespec *timeout)
+{
+  struct timespec abstime;
+  unsigned int tail;
+  int ret;
+  int n;
+
+  DEBUGASSERT(ring != NULL && list != NULL && nent > 0);
+
+  if (timeout == NULL)
+    {
+      ret = sem_wait(&ring->avail);
+    }
+  else
+    {
+      clock_gettime(CLOCK_MONOTONIC, &abstime);
+      clock_timespec_add(&abstime, timeout, &abstime);
+      ret = sem_clockwait(&ring->avail, CLOCK_MONOTONIC, &abstime);
+    }
+
+  if (ret < 0)
+    {
+      if (get_errno() == ETIMEDOUT)
+        {
+          set_errno(EAGAIN);
+        }
+
+      return ERROR;
+    }
+
+  /* Every count taken from the semaphore is one entry in the ring */
+
+  n = 0;
+  do
+    {
+      tail      = atomic_read(&ring->tail);
+      list[n++] = ring->entries[tail & (ring->nentries - 1)];
+      atomic_set_release(&ring->tail, tail + 1);
+    }
+  while (n < nent && sem_trywait(&ring->avail) == 0);
+
+  return n;
+}
+
+#endif /* CONFIG_FS_AIO_RING */
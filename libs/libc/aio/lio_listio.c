@@ -510,6 +510,7 @@ int lio_listio(int mode, FAR struct aiocb * const list[], int nent,
   int errcode;
   int retcode;
   int status;
+  int last;
   int ret;
   int i;
 
@@ -531,6 +532,20 @@ int lio_listio(int mode, FAR struct aiocb * const list[], int nent,
 
   sched_lock();
 
+  /* Find the last transfer of the list.  The ones before it are held until
+   * it is submitted, so that the list is queued as a unit.
+   */
+
+  for (last = nent - 1; last >= 0; last--)
+    {
+      aiocbp = list[last];
+      if (aiocbp && (aiocbp->aio_lio_opcode == LIO_READ ||
+                     aiocbp->aio_lio_opcode == LIO_WRITE))
+        {
+          break;
+        }
+    }
+
   /* Submit each asynchronous I/O operation in the list, skipping over NULL
    * entries.
    */
@@ -558,6 +573,10 @@ int lio_listio(int mode, FAR struct aiocb * const list[], int nent,
             case LIO_READ:
             case LIO_WRITE:
               {
+                /* Mark the transfers which are not the last one */
+
+                aiocbp->aio_priv = i < last ? aiocbp : NULL;
+
                 if (aiocbp->aio_lio_opcode == LIO_READ)
                   {
                     /* Submit the asynchronous read operation */
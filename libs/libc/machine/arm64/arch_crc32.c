@@ -0,0 +1,106 @@
+/****************************************************************************
+ * libs/libc/machine/arm64/arch_crc32.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#include <nuttx/crc32.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The CRC32 instructions are optional in ARMv8.0-A and mandatory from
+ * ARMv8.1-A on.  Enable them for the assembler regardless of -march.
+ */
+
+#define ARM64_CRC32(insn, crc, val, reg) \
+  __asm__ (".arch_extension crc\n\t" insn " %w0, %w0, %" reg "1" \
+           : "+r" (crc) : "r" (val))
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: crc32part
+ *
+ * Description:
+ *   Continue CRC calculation on a part of the buffer using the ARMv8 CRC32
+ *   instructions.
+ *
+ ****************************************************************************/
+
+uint32_t crc32part(FAR const uint8_t *src, size_t len, uint32_t crc32val)
+{
+  for (; len > 0 && ((uintptr_t)src & 7) != 0; len--)
+    {
+      ARM64_CRC32("crc32b", crc32val, *src++, "w");
+    }
+
+  for (; len >= 8; len -= 8, src += 8)
+    {
+      ARM64_CRC32("crc32x", crc32val, *(FAR const uint64_t *)src, "x");
+    }
+
+  for (; len > 0; len--)
+    {
+      ARM64_CRC32("crc32b", crc32val, *src++, "w");
+    }
+
+  return crc32val;
+}
+
+/****************************************************************************
+ * Name: crc32cpart
+ *
+ * Description:
+ *   Continue CRC-32C calculation on a part of the buffer using the ARMv8
+ *   CRC32C instructions.
+ *
+ ****************************************************************************/
+
+uint32_t crc32cpart(FAR const uint8_t *src, size_t len, uint32_t crc32val)
+{
+  for (; len > 0 && ((uintptr_t)src & 7) != 0; len--)
+    {
+      ARM64_CRC32("crc32cb", crc32val, *src++, "w");
+    }
+
+  for (; len >= 8; len -= 8, src += 8)
+    {
+      ARM64_CRC32("crc32cx", crc32val, *(FAR const uint64_t *)src, "x");
+    }
+
+  for (; len > 0; len--)
+    {
+      ARM64_CRC32("crc32cb", crc32val, *src++, "w");
+    }
+
+  return crc32val;
+}
@@ -0,0 +1,69 @@
+/****************************************************************************
+ * libs/libc/machine/sim/arch_crc32c.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#include <nuttx/crc32.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: crc32cpart
+ *
+ * Description:
+ *   Continue CRC-32C calculation on a part of the buffer using the SSE4.2
+ *   crc32 instruction of the host CPU.  SSE4.2 implements the Castagnoli
+ *   polynomial only, so crc32part() keeps using the table.
+ *
+ ****************************************************************************/
+
+uint32_t crc32cpart(FAR const uint8_t *src, size_t len, uint32_t crc32val)
+{
+  uint64_t crc = crc32val;
+
+  for (; len > 0 && ((uintptr_t)src & 7) != 0; len--)
+    {
+      __asm__ ("crc32b %1, %k0" : "+r" (crc) : "rm" (*src++));
+    }
+
+  for (; len >= 8; len -= 8, src += 8)
+    {
+      __asm__ ("crc32q %1, %0" : "+r" (crc)
+               : "rm" (*(FAR const uint64_t *)src));
+    }
+
+  for (; len > 0; len--)
+    {
+      __asm__ ("crc32b %1, %k0" : "+r" (crc) : "rm" (*src++));
+    }
+
+  return (uint32_t)crc;
+}
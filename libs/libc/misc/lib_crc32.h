@@ -0,0 +1,148 @@
+/****************************************************************************
+ * libs/libc/misc/lib_crc32.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __LIBS_LIBC_MISC_LIB_CRC32_H
+#define __LIBS_LIBC_MISC_LIB_CRC32_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The number of 256-entry tables of a reflected 32-bit CRC: slice-by-N
+ * folds N input bytes into the CRC with N independent lookups.
+ */
+
+#if defined(CONFIG_LIBC_CRC32_SLICE_BY_16)
+#  define CRC32_NTABS 16
+#elif defined(CONFIG_LIBC_CRC32_SLICE_BY_8)
+#  define CRC32_NTABS 8
+#else
+#  define CRC32_NTABS 1
+#endif
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+#if CRC32_NTABS > 1 && !defined(CONFIG_LIBC_CRC32_SLOW)
+/****************************************************************************
+ * Name: crc32_word
+ *
+ * Description:
+ *   Load 32 bits in little-endian order from a possibly unaligned buffer.
+ *
+ ****************************************************************************/
+
+static inline uint32_t crc32_word(FAR const uint8_t *src)
+{
+  return (uint32_t)src[0] | ((uint32_t)src[1] << 8) |
+         ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+#endif
+
+/****************************************************************************
+ * Name: crc32_update
+ *
+ * Description:
+ *   Continue a reflected 32-bit CRC on a part of the buffer, bit by bit
+ *   with the polynomial 'poly' for CONFIG_LIBC_CRC32_SLOW, otherwise with
+ *   the CRC32_NTABS tables 'tab' generated from it.  Row k of the tables
+ *   holds the CRC of each byte value followed by k zero bytes.
+ *
+ ****************************************************************************/
+
+static inline uint32_t crc32_update(FAR const uint32_t (*tab)[256],
+                                    uint32_t poly, FAR const uint8_t *src,
+                                    size_t len, uint32_t crc)
+{
+  size_t i;
+
+#ifdef CONFIG_LIBC_CRC32_SLOW
+  for (i = 0; i < len; i++)
+    {
+      size_t j;
+
+      crc ^= src[i];
+      for (j = 0; j < 8; j++)
+        {
+          if (crc & 1)
+            {
+              crc = (crc >> 1) ^ poly;
+            }
+          else
+            {
+              crc = crc >> 1;
+            }
+        }
+    }
+#else
+#if CRC32_NTABS > 8
+  for (; len >= 16; len -= 16, src += 16)
+    {
+      uint32_t w0 = crc32_word(src) ^ crc;
+      uint32_t w1 = crc32_word(src + 4);
+      uint32_t w2 = crc32_word(src + 8);
+      uint32_t w3 = crc32_word(src + 12);
+
+      crc = tab[15][w0 & 0xff] ^ tab[14][(w0 >> 8) & 0xff] ^
+            tab[13][(w0 >> 16) & 0xff] ^ tab[12][w0 >> 24] ^
+            tab[11][w1 & 0xff] ^ tab[10][(w1 >> 8) & 0xff] ^
+            tab[9][(w1 >> 16) & 0xff] ^ tab[8][w1 >> 24] ^
+            tab[7][w2 & 0xff] ^ tab[6][(w2 >> 8) & 0xff] ^
+            tab[5][(w2 >> 16) & 0xff] ^ tab[4][w2 >> 24] ^
+            tab[3][w3 & 0xff] ^ tab[2][(w3 >> 8) & 0xff] ^
+            tab[1][(w3 >> 16) & 0xff] ^ tab[0][w3 >> 24];
+    }
+#endif
+
+#if CRC32_NTABS > 1
+  for (; len >= 8; len -= 8, src += 8)
+    {
+      uint32_t w0 = crc32_word(src) ^ crc;
+      uint32_t w1 = crc32_word(src + 4);
+
+      crc = tab[7][w0 & 0xff] ^ tab[6][(w0 >> 8) & 0xff] ^
+            tab[5][(w0 >> 16) & 0xff] ^ tab[4][w0 >> 24] ^
+            tab[3][w1 & 0xff] ^ tab[2][(w1 >> 8) & 0xff] ^
+            tab[1][(w1 >> 16) & 0xff] ^ tab[0][w1 >> 24];
+    }
+#endif
+
+  for (i = 0; i < len; i++)
+    {
+      crc = tab[0][(crc & 0xff) ^ src[i]] ^ (crc >> 8);
+    }
+#endif
+
+  return crc;
+}
+
+#endif /* __LIBS_LIBC_MISC_LIB_CRC32_H */
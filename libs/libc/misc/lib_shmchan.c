@@ -0,0 +1,710 @@
+/****************************************************************************
+ * libs/libc/misc/lib_shmchan.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <nuttx/atomic.h>
+#include <nuttx/compiler.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/shmchan.h>
+
+#ifdef CONFIG_LIBC_SHMCHAN
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SHMCHAN_MAGIC     0x4e584348  /* "NXCH" */
+
+/* The counters written by the senders and by the receivers are kept in
+ * different cache lines.
+ */
+
+#define SHMCHAN_LINESIZE  64
+
+#define SHMCHAN_SLOTHDR   offsetof(struct shmchan_slot_s, data)
+#define SHMCHAN_SLOT(c, i) \
+  ((FAR struct shmchan_slot_s *)((FAR char *)((c)->ring + 1) + \
+                                 (size_t)(i) * (c)->slotsize))
+
+/* Positions wrap around, so they are compared through their difference */
+
+#define SHMCHAN_ADD(a, b) ((int32_t)((uint32_t)(a) + (uint32_t)(b)))
+#define SHMCHAN_DIFF(a, b) ((int32_t)((uint32_t)(a) - (uint32_t)(b)))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The ring, at the start of the shared memory object and mapped at a
+ * different address in each process, so it holds no pointer.  Any process
+ * with the object open may write it: each end works from its own copy of
+ * the geometry, checked when the end is opened.
+ *
+ * The ring is the bounded queue of Dmitry Vyukov: each slot carries a
+ * sequence number telling whether it is free for the sender at a given
+ * position, or holds the message for the receiver at that position.  A
+ * sender or receiver claims a position with a compare and exchange on
+ * head or tail, and then owns the slot without any lock.
+ */
+
+struct shmchan_ring_s
+{
+  atomic_t magic;                     /* SHMCHAN_MAGIC once set up */
+  uint32_t nslots;                    /* Number of slots, a power of two */
+  uint32_t slotsize;                  /* Distance between two slots */
+  uint32_t msgsize;                   /* Maximum size of a message */
+
+  /* Next position to send to, and number of receivers waiting */
+
+  atomic_t head aligned_data(SHMCHAN_LINESIZE);
+  atomic_t nrwait;
+
+  /* Next position to receive from, and number of senders waiting */
+
+  atomic_t tail aligned_data(SHMCHAN_LINESIZE);
+  atomic_t nswait;
+};
+
+struct shmchan_slot_s
+{
+  atomic_t seq;                       /* Position the slot is ready for */
+  uint32_t len;                       /* Length of the message */
+  uint8_t data[1];                    /* The message */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: shmchan_semopen
+ *
+ * Description:
+ *   Open one of the two semaphores of a channel, "<name>.data" or
+ *   "<name>.space".
+ *
+ ****************************************************************************/
+
+static FAR sem_t *shmchan_semopen(FAR const char *name,
+                                  FAR const char *suffix, int oflags,
+                                  mode_t mode)
+{
+  char semname[NAME_MAX + 1];
+
+  while (*name == '/')
+    {
+      name++;
+    }
+
+  if (snprintf(semname, sizeof(semname), "%s.%s", name, suffix) >=
+      (int)sizeof(semname))
+    {
+      set_errno(ENAMETOOLONG);
+      return SEM_FAILED;
+    }
+
+  if ((oflags & O_CREAT) != 0)
+    {
+      /* A semaphore left behind by a channel which was never unlinked */
+
+      sem_unlink(semname);
+      return sem_open(semname, oflags, mode, 0);
+    }
+
+  return sem_open(semname, oflags);
+}
+
+/****************************************************************************
+ * Name: shmchan_semunlink
+ ****************************************************************************/
+
+static void shmchan_semunlink(FAR const char *name, FAR const char *suffix)
+{
+  char semname[NAME_MAX + 1];
+
+  while (*name == '/')
+    {
+      name++;
+    }
+
+  if (snprintf(semname, sizeof(semname), "%s.%s", name, suffix) <
+      (int)sizeof(semname))
+    {
+      sem_unlink(semname);
+    }
+}
+
+/****************************************************************************
+ * Name: shmchan_map
+ *
+ * Description:
+ *   Map the shared memory object of a channel.
+ *
+ ****************************************************************************/
+
+static int shmchan_map(FAR struct shmchan_s *chan, int fd, size_t mapsize,
+                       int oflags)
+{
+  memset(chan, 0, sizeof(*chan));
+  chan->oflags  = oflags & O_NONBLOCK;
+  chan->mapsize = mapsize;
+
+  chan->ring = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+  if (chan->ring == MAP_FAILED)
+    {
+      chan->ring = NULL;
+      return -get_errno();
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: shmchan_sems
+ *
+ * Description:
+ *   Open the semaphores of a channel, or create them with O_CREAT.
+ *
+ ****************************************************************************/
+
+static int shmchan_sems(FAR struct shmchan_s *chan, FAR const char *name,
+                        int oflags, mode_t mode)
+{
+  int ret;
+
+  chan->data = shmchan_semopen(name, "data", oflags, mode);
+  if (chan->data == SEM_FAILED)
+    {
+      return -get_errno();
+    }
+
+  chan->space = shmchan_semopen(name, "space", oflags, mode);
+  if (chan->space == SEM_FAILED)
+    {
+      ret = -get_errno();
+      sem_close(chan->data);
+      if ((oflags & O_CREAT) != 0)
+        {
+          shmchan_semunlink(name, "data");
+        }
+
+      return ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: shmchan_wake
+ *
+ * Description:
+ *   Post the semaphore if a peer waits on it.  The counter is read with a
+ *   read-modify-write ordered after the update of the ring, against the
+ *   increment done by a peer before it checks the ring one last time: at
+ *   least one of the two sees the other.
+ *
+ ****************************************************************************/
+
+static void shmchan_wake(FAR atomic_t *nwait, FAR sem_t *sem)
+{
+  if (atomic_fetch_add_release(nwait, 0) > 0)
+    {
+      sem_post(sem);
+    }
+}
+
+/****************************************************************************
+ * Name: shmchan_wait
+ ****************************************************************************/
+
+static int shmchan_wait(FAR sem_t *sem, FAR const struct timespec *abstime)
+{
+  int ret;
+
+  if (abstime == NULL)
+    {
+      ret = sem_wait(sem);
+    }
+  else
+    {
+      ret = sem_timedwait(sem, abstime);
+    }
+
+  return ret < 0 ? -get_errno() : OK;
+}
+
+/****************************************************************************
+ * Name: shmchan_trysend
+ ****************************************************************************/
+
+static int shmchan_trysend(FAR struct shmchan_s *chan,
+                           FAR const void *buf, size_t len)
+{
+  FAR struct shmchan_ring_s *ring = chan->ring;
+  FAR struct shmchan_slot_s *slot;
+  int32_t pos = atomic_read(&ring->head);
+  int32_t diff;
+
+  for (; ; )
+    {
+      slot = SHMCHAN_SLOT(chan, pos & (chan->nslots - 1));
+      diff = SHMCHAN_DIFF(atomic_read_acquire(&slot->seq), pos);
+
+      if (diff == 0)
+        {
+          /* The slot is free: claim the position */
+
+          if (atomic_try_cmpxchg_relaxed(&ring->head, &pos,
+                                         SHMCHAN_ADD(pos, 1)))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          /* The slot still holds the message of the previous lap */
+
+          return -EAGAIN;
+        }
+      else
+        {
+          /* Another sender took the position */
+
+          pos = atomic_read(&ring->head);
+        }
+    }
+
+  memcpy(slot->data, buf, len);
+  slot->len = len;
+  atomic_set_release(&slot->seq, SHMCHAN_ADD(pos, 1));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: shmchan_tryrecv
+ *
+ * Description:
+ *   Take the oldest message out of the ring.  A length written by a peer
+ *   beyond the message size of the channel consumes the slot and fails
+ *   with -EBADMSG.
+ *
+ ****************************************************************************/
+
+static ssize_t shmchan_tryrecv(FAR struct shmchan_s *chan, FAR void *buf)
+{
+  FAR struct shmchan_ring_s *ring = chan->ring;
+  FAR struct shmchan_slot_s *slot;
+  int32_t pos = atomic_read(&ring->tail);
+  int32_t diff;
+  ssize_t len;
+
+  for (; ; )
+    {
+      slot = SHMCHAN_SLOT(chan, pos & (chan->nslots - 1));
+      diff = SHMCHAN_DIFF(atomic_read_acquire(&slot->seq),
+                          SHMCHAN_ADD(pos, 1));
+
+      if (diff == 0)
+        {
+          if (atomic_try_cmpxchg_relaxed(&ring->tail, &pos,
+                                         SHMCHAN_ADD(pos, 1)))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          return -EAGAIN;
+        }
+      else
+        {
+          pos = atomic_read(&ring->tail);
+        }
+    }
+
+  len = slot->len;
+  if ((size_t)len <= chan->msgsize)
+    {
+      memcpy(buf, slot->data, len);
+    }
+  else
+    {
+      len = -EBADMSG;
+    }
+
+  /* Give the slot to the sender of the next lap */
+
+  atomic_set_release(&slot->seq, SHMCHAN_ADD(pos, chan->nslots));
+  return len;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: shmchan_create
+ ****************************************************************************/
+
+int shmchan_create(FAR struct shmchan_s *chan, FAR const char *name,
+                   int oflags, mode_t mode, size_t msgsize, size_t nmsgs)
+{
+  FAR struct shmchan_ring_s *ring;
+  size_t slotsize;
+  size_t nslots;
+  size_t size;
+  uint32_t i;
+  int ret;
+  int fd;
+
+  if (msgsize == 0 || msgsize > UINT32_MAX - SHMCHAN_LINESIZE ||
+      nmsgs == 0 || nmsgs > INT32_MAX / 2)
+    {
+      return -EINVAL;
+    }
+
+  /* At least two slots, so that a slot free for the next lap is never
+   * mistaken for one holding a message.
+   */
+
+  nslots = 2;
+  while (nslots < nmsgs)
+    {
+      nslots <<= 1;
+    }
+
+  slotsize = ALIGN_UP(SHMCHAN_SLOTHDR + msgsize, sizeof(atomic_t));
+  if (nslots > (SIZE_MAX - sizeof(*ring)) / slotsize)
+    {
+      return -ENOMEM;
+    }
+
+  size = sizeof(*ring) + nslots * slotsize;
+
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, mode);
+  if (fd < 0)
+    {
+      return -get_errno();
+    }
+
+  if (ftruncate(fd, size) < 0)
+    {
+      ret = -get_errno();
+      goto errout_with_shm;
+    }
+
+  ret = shmchan_map(chan, fd, size, oflags);
+  if (ret < 0)
+    {
+      goto errout_with_shm;
+    }
+
+  /* The semaphores exist before the magic is set, so that an opener which
+   * sees the magic never finds stale ones.
+   */
+
+  ret = shmchan_sems(chan, name, O_CREAT | O_EXCL, mode);
+  if (ret < 0)
+    {
+      munmap(chan->ring, size);
+      goto errout_with_shm;
+    }
+
+  close(fd);
+  chan->msgsize  = msgsize;
+  chan->nslots   = nslots;
+  chan->slotsize = slotsize;
+
+  ring = chan->ring;
+  ring->nslots   = nslots;
+  ring->slotsize = slotsize;
+  ring->msgsize  = msgsize;
+  atomic_set(&ring->head, 0);
+  atomic_set(&ring->tail, 0);
+  atomic_set(&ring->nrwait, 0);
+  atomic_set(&ring->nswait, 0);
+
+  for (i = 0; i < nslots; i++)
+    {
+      atomic_set(&SHMCHAN_SLOT(chan, i)->seq, i);
+    }
+
+  /* The channel can be used by whoever sees the magic */
+
+  atomic_set_release(&ring->magic, SHMCHAN_MAGIC);
+  return OK;
+
+errout_with_shm:
+  close(fd);
+  shm_unlink(name);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: shmchan_open
+ ****************************************************************************/
+
+int shmchan_open(FAR struct shmchan_s *chan, FAR const char *name,
+                 int oflags)
+{
+  FAR struct shmchan_ring_s *ring;
+  struct stat st;
+  size_t slotsize;
+  size_t msgsize;
+  size_t nslots;
+  int ret;
+  int fd;
+
+  fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0)
+    {
+      return -get_errno();
+    }
+
+  /* The object has no size until the creator truncated it */
+
+  if (fstat(fd, &st) < 0)
+    {
+      ret = -get_errno();
+      close(fd);
+      return ret;
+    }
+
+  if (st.st_size < (off_t)sizeof(struct shmchan_ring_s))
+    {
+      close(fd);
+      return -EAGAIN;
+    }
+
+  ret = shmchan_map(chan, fd, st.st_size, oflags);
+  close(fd);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Nothing else in the ring, the semaphores included, may be trusted
+   * before the creator set the magic.
+   */
+
+  ring = chan->ring;
+  if (atomic_read_acquire(&ring->magic) != SHMCHAN_MAGIC)
+    {
+      ret = -EAGAIN;
+      goto errout_with_map;
+    }
+
+  /* Check the geometry once and keep it, as any peer may overwrite it */
+
+  nslots   = ring->nslots;
+  slotsize = ring->slotsize;
+  msgsize  = ring->msgsize;
+
+  if (nslots < 2 || nslots > INT32_MAX / 2 ||
+      (nslots & (nslots - 1)) != 0 ||
+      slotsize % sizeof(atomic_t) != 0 ||
+      slotsize <= SHMCHAN_SLOTHDR || msgsize == 0 ||
+      msgsize > slotsize - SHMCHAN_SLOTHDR ||
+      nslots > (chan->mapsize - sizeof(*ring)) / slotsize)
+    {
+      ret = -EINVAL;
+      goto errout_with_map;
+    }
+
+  ret = shmchan_sems(chan, name, 0, 0);
+  if (ret < 0)
+    {
+      goto errout_with_map;
+    }
+
+  chan->msgsize  = msgsize;
+  chan->nslots   = nslots;
+  chan->slotsize = slotsize;
+  return OK;
+
+errout_with_map:
+  munmap(chan->ring, chan->mapsize);
+  chan->ring = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: shmchan_close
+ ****************************************************************************/
+
+void shmchan_close(FAR struct shmchan_s *chan)
+{
+  sem_close(chan->space);
+  sem_close(chan->data);
+  munmap(chan->ring, chan->mapsize);
+  chan->ring = NULL;
+}
+
+/****************************************************************************
+ * Name: shmchan_unlink
+ ****************************************************************************/
+
+int shmchan_unlink(FAR const char *name)
+{
+  shmchan_semunlink(name, "space");
+  shmchan_semunlink(name, "data");
+  return shm_unlink(name) < 0 ? -get_errno() : OK;
+}
+
+/****************************************************************************
+ * Name: shmchan_send
+ ****************************************************************************/
+
+int shmchan_send(FAR struct shmchan_s *chan, FAR const void *buf,
+                 size_t len)
+{
+  return shmchan_timedsend(chan, buf, len, NULL);
+}
+
+/****************************************************************************
+ * Name: shmchan_timedsend
+ ****************************************************************************/
+
+int shmchan_timedsend(FAR struct shmchan_s *chan, FAR const void *buf,
+                      size_t len, FAR const struct timespec *abstime)
+{
+  FAR struct shmchan_ring_s *ring = chan->ring;
+  int ret;
+
+  if (len > chan->msgsize)
+    {
+      return -EMSGSIZE;
+    }
+
+  ret = shmchan_trysend(chan, buf, len);
+  while (ret == -EAGAIN && (chan->oflags & O_NONBLOCK) == 0)
+    {
+      /* Announce the wait before looking at the ring again, so that a
+       * receiver freeing a slot in between posts the semaphore.
+       */
+
+      atomic_fetch_add_acquire(&ring->nswait, 1);
+
+      ret = shmchan_trysend(chan, buf, len);
+      if (ret == -EAGAIN)
+        {
+          ret = shmchan_wait(chan->space, abstime);
+          if (ret >= 0)
+            {
+              ret = -EAGAIN;
+            }
+        }
+
+      atomic_fetch_sub_relaxed(&ring->nswait, 1);
+
+      if (ret == -EAGAIN)
+        {
+          ret = shmchan_trysend(chan, buf, len);
+        }
+    }
+
+  if (ret >= 0)
+    {
+      shmchan_wake(&ring->nrwait, chan->data);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: shmchan_recv
+ ****************************************************************************/
+
+ssize_t shmchan_recv(FAR struct shmchan_s *chan, FAR void *buf,
+                     size_t buflen)
+{
+  return shmchan_timedrecv(chan, buf, buflen, NULL);
+}
+
+/****************************************************************************
+ * Name: shmchan_timedrecv
+ ****************************************************************************/
+
+ssize_t shmchan_timedrecv(FAR struct shmchan_s *chan, FAR void *buf,
+                          size_t buflen, FAR const struct timespec *abstime)
+{
+  FAR struct shmchan_ring_s *ring = chan->ring;
+  ssize_t ret;
+
+  if (buflen < chan->msgsize)
+    {
+      return -EMSGSIZE;
+    }
+
+  ret = shmchan_tryrecv(chan, buf);
+  while (ret == -EAGAIN && (chan->oflags & O_NONBLOCK) == 0)
+    {
+      atomic_fetch_add_acquire(&ring->nrwait, 1);
+
+      ret = shmchan_tryrecv(chan, buf);
+      if (ret == -EAGAIN)
+        {
+          ret = shmchan_wait(chan->data, abstime);
+          if (ret >= 0)
+            {
+              ret = -EAGAIN;
+            }
+        }
+
+      atomic_fetch_sub_relaxed(&ring->nrwait, 1);
+
+      if (ret == -EAGAIN)
+        {
+          ret = shmchan_tryrecv(chan, buf);
+        }
+    }
+
+  /* A dropped message freed its slot as well */
+
+  if (ret >= 0 || ret == -EBADMSG)
+    {
+      shmchan_wake(&ring->nswait, chan->space);
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_LIBC_SHMCHAN */
@@ -782,18 +782,24 @@ static int modlib_relocatedyn(FAR struct module_s *modp,
 
           if (!(i % CONFIG_MODLIB_RELOCATION_BUFFERCOUNT))
             {
-              size_t relsize = (sizeof(Elf_Rela) *
-                               CONFIG_MODLIB_RELOCATION_BUFFERCOUNT);
+              /* Read the next batch of entries, of the size matching the
+               * table being walked, without going past its end.
+               */
+
+              size_t relentsz = reldata.relrela[idx_rel] == 0 ?
+                                sizeof(Elf_Rel) : sizeof(Elf_Rela);
+              size_t relsize = relentsz *
+                               CONFIG_MODLIB_RELOCATION_BUFFERCOUNT;
 
-              if (reldata.relsz[idx_rel] < relsize)
+              if (reldata.relsz[idx_rel] - i * relentsz < relsize)
                 {
-                  relsize = reldata.relsz[idx_rel];
+                  relsize = reldata.relsz[idx_rel] - i * relentsz;
                 }
 
               ret = modlib_read(loadinfo, (FAR uint8_t *)rels,
                                 relsize,
                                 reldata.reloff[idx_rel] +
-                                i * sizeof(Elf_Rel));
+                                i * relentsz);
 
               if (ret < 0)
                 {
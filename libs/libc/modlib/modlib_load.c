@@ -376,6 +376,7 @@ static inline int modlib_loadfile(FAR struct mod_loadinfo_s *loadinfo)
         {
           FAR Elf_Shdr *shdr = &loadinfo->shdr[i];
           FAR uint8_t **pptr = NULL;
+          FAR uint8_t *xipaddr;
 
           /* SHF_ALLOC indicates that the section requires memory during
            * execution
@@ -429,6 +430,13 @@ static inline int modlib_loadfile(FAR struct mod_loadinfo_s *loadinfo)
 
           if ((shdr->sh_flags & SHF_WRITE) == 0 && loadinfo->xipbase != 0)
             {
+              /* Execute in place: use the section where the file is mapped,
+               * without moving the text or data allocation pointers.
+               */
+
+              xipaddr = (FAR uint8_t *)(loadinfo->xipbase +
+                                        shdr->sh_offset);
+              pptr    = &xipaddr;
               goto skipload;
             }
 
@@ -525,6 +533,109 @@ skipload:
   return OK;
 }
 
+/****************************************************************************
+ * Name: modlib_loadxip
+ *
+ * Description:
+ *   Decide whether the read-only sections can be used in place, from the
+ *   memory the file system maps the file to, instead of being copied to
+ *   RAM.  This requires that nothing relocates them at load time: either
+ *   the module is position independent and goes through its GOT, or it was
+ *   prelinked by tools/prelink.py, which resolves the relocations of the
+ *   read-only sections for the address they will be mapped at and records
+ *   that address in their sh_addr.
+ *
+ * Returned Value:
+ *   0 (OK) is returned on success, whether the sections are used in place
+ *   or not, and a negated errno is returned if a prelinked module is not
+ *   mapped at the address it was prelinked for.
+ *
+ ****************************************************************************/
+
+static int modlib_loadxip(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR Elf_Shdr *shdr;
+  bool prelinked = false;
+  int i;
+
+  loadinfo->gotindex = modlib_findsection(loadinfo, ".got");
+  if (loadinfo->gotindex >= 0)
+    {
+      binfo("GOT section found! index %d\n", loadinfo->gotindex);
+    }
+
+  /* A relocatable object is linked at address zero, so an address in one
+   * of its read-only sections can only come from the prelinker.
+   */
+
+  if (loadinfo->ehdr.e_type == ET_REL)
+    {
+      for (i = 0; i < loadinfo->ehdr.e_shnum; i++)
+        {
+          shdr = &loadinfo->shdr[i];
+          if ((shdr->sh_flags & (SHF_ALLOC | SHF_WRITE)) == SHF_ALLOC &&
+              shdr->sh_addr != 0)
+            {
+              prelinked = true;
+              break;
+            }
+        }
+    }
+
+  if (loadinfo->gotindex < 0 && !prelinked)
+    {
+      return OK;
+    }
+
+  if (ioctl(loadinfo->filfd, FIOC_XIPBASE,
+            (unsigned long)&loadinfo->xipbase) < 0)
+    {
+      loadinfo->xipbase = 0;
+    }
+
+  if (prelinked)
+    {
+      /* The read-only sections hold final addresses, so they must be used
+       * at exactly the address they were prelinked for.
+       */
+
+      for (i = 0; i < loadinfo->ehdr.e_shnum; i++)
+        {
+          shdr = &loadinfo->shdr[i];
+          if ((shdr->sh_flags & (SHF_ALLOC | SHF_WRITE)) == SHF_ALLOC &&
+              shdr->sh_size != 0 &&
+              shdr->sh_addr != loadinfo->xipbase + shdr->sh_offset)
+            {
+              berr("ERROR: Section %d prelinked at %08lx, mapped at "
+                   "%08lx\n", i, (unsigned long)shdr->sh_addr,
+                   (unsigned long)(loadinfo->xipbase + shdr->sh_offset));
+              loadinfo->xipbase = 0;
+              return -ENOEXEC;
+            }
+
+          /* And the prelinker leaves no relocation to apply to them */
+
+          if ((shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA) &&
+              shdr->sh_info < loadinfo->ehdr.e_shnum &&
+              (loadinfo->shdr[shdr->sh_info].sh_flags &
+               (SHF_ALLOC | SHF_WRITE)) == SHF_ALLOC)
+            {
+              berr("ERROR: Section %d relocates read-only section %d\n",
+                   i, (int)shdr->sh_info);
+              loadinfo->xipbase = 0;
+              return -ENOEXEC;
+            }
+        }
+    }
+
+  if (loadinfo->xipbase != 0)
+    {
+      binfo("can use xipbase %zu\n", loadinfo->xipbase);
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -558,15 +669,13 @@ int modlib_load(FAR struct mod_loadinfo_s *loadinfo)
       goto errout_with_buffers;
     }
 
-  loadinfo->gotindex = modlib_findsection(loadinfo, ".got");
-  if (loadinfo->gotindex >= 0)
+  /* Use the read-only sections in place if possible */
+
+  ret = modlib_loadxip(loadinfo);
+  if (ret < 0)
     {
-      binfo("GOT section found! index %d\n", loadinfo->gotindex);
-      if (ioctl(loadinfo->filfd, FIOC_XIPBASE,
-                (unsigned long)&loadinfo->xipbase) >= 0)
-        {
-          binfo("can use xipbase %zu\n", loadinfo->xipbase);
-        }
+      berr("ERROR: modlib_loadxip failed: %d\n", ret);
+      goto errout_with_buffers;
     }
 
   /* Determine total size to allocate */
@@ -714,15 +823,13 @@ int modlib_load_with_addrenv(FAR struct mod_loadinfo_s *loadinfo)
       goto errout_with_buffers;
     }
 
-  loadinfo->gotindex = modlib_findsection(loadinfo, ".got");
-  if (loadinfo->gotindex >= 0)
+  /* Use the read-only sections in place if possible */
+
+  ret = modlib_loadxip(loadinfo);
+  if (ret < 0)
     {
-      binfo("GOT section found! index %d\n", loadinfo->gotindex);
-      if (ioctl(loadinfo->filfd, FIOC_XIPBASE,
-                (unsigned long)&loadinfo->xipbase) >= 0)
-        {
-          binfo("can use xipbase %zu\n", loadinfo->xipbase);
-        }
+      berr("ERROR: modlib_loadxip failed: %d\n", ret);
+      goto errout_with_buffers;
     }
 
   /* Determine total size to allocate */
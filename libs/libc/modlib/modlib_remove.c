@@ -161,6 +161,10 @@ int modlib_uninit(FAR struct module_s *modp)
 #endif
     }
 
+#ifdef CONFIG_SYMTAB_HASH
+  symtab_hashfree(&modp->exphash);
+#endif
+
 #if CONFIG_MODLIB_MAXDEPEND > 0
   /* Eliminate any dependencies that this module has on other modules */
 
@@ -72,6 +72,18 @@ struct eptable_s
 extern struct eptable_s global_table[];
 extern int nglobals;
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_SYMTAB_HASH
+/* Index of the symbols exported by the base code, protected by the module
+ * registry lock.
+ */
+
+static struct symtab_hash_s g_modlib_exphash;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -182,6 +194,49 @@ static int modlib_symname(FAR struct mod_loadinfo_s *loadinfo,
   return OK;
 }
 
+/****************************************************************************
+ * Name: modlib_findexport
+ *
+ * Description:
+ *   Find an exported symbol through the hash index of the export table,
+ *   (re)building the index first if it does not describe that table.  The
+ *   linear search is kept as a fallback when the index cannot be built.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYMTAB_HASH
+static FAR const struct symtab_s *
+modlib_findexport(FAR struct symtab_hash_s *hash,
+                  FAR const struct symtab_s *symtab,
+                  FAR const char *name, int nsyms)
+{
+  FAR const struct symtab_s *symbol;
+
+  modlib_registry_lock();
+
+  if (hash->symtab != symtab || hash->nsyms != nsyms)
+    {
+      symtab_hashfree(hash);
+      symtab_hashinit(hash, symtab, nsyms);
+    }
+
+  if (hash->symtab == symtab)
+    {
+      symbol = symtab_hashfind(hash, name);
+    }
+  else
+    {
+      symbol = symtab_findbyname(symtab, name, nsyms);
+    }
+
+  modlib_registry_unlock();
+  return symbol;
+}
+#else
+#  define modlib_findexport(hash, symtab, name, nsyms) \
+     symtab_findbyname(symtab, name, nsyms)
+#endif
+
 /****************************************************************************
  * Name: modlib_symcallback
  *
@@ -203,7 +258,8 @@ static int modlib_symcallback(FAR struct module_s *modp, FAR void *arg)
 
   /* Check if this module exports a symbol of that name */
 
-  exportinfo->symbol = symtab_findbyname(modp->modinfo.exports,
+  exportinfo->symbol = modlib_findexport(&modp->exphash,
+                                         modp->modinfo.exports,
                                          exportinfo->name,
                                          modp->modinfo.nexports);
 
@@ -408,8 +464,8 @@ int modlib_symvalue(FAR struct module_s *modp,
 
         if (symbol == NULL)
           {
-            symbol = symtab_findbyname(exports, exportinfo.name,
-                                       nexports);
+            symbol = modlib_findexport(&g_modlib_exphash, exports,
+                                       exportinfo.name, nexports);
           }
 
         /* Was the symbol found from any exporter? */
@@ -630,6 +686,10 @@ void modlib_freesymtab(FAR struct module_s *modp)
   FAR const struct symtab_s *symbol;
   int i;
 
+#ifdef CONFIG_SYMTAB_HASH
+  symtab_hashfree(&modp->exphash);
+#endif
+
   if ((symbol = modp->modinfo.exports) != NULL)
     {
       for (i = 0; i < modp->modinfo.nexports; i++)
@@ -0,0 +1,272 @@
+/****************************************************************************
+ * libs/libc/symtab/symtab_hash.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/symtab.h>
+
+#include "libc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Each symbol sets two bits of one Bloom word, taken from its hash at
+ * these two shifts.  About eight filter bits per symbol keep the false
+ * positive rate near 5%.
+ */
+
+#define BLOOM_BITS        (sizeof(uintptr_t) * 8)
+#define BLOOM_SHIFT       6
+#define BLOOM_BITSPERSYM  8
+
+#define BLOOM_WORD(h, n)  (((h) / BLOOM_BITS) & ((n) - 1))
+#define BLOOM_MASK(h)     (((uintptr_t)1 << ((h) % BLOOM_BITS)) | \
+                           ((uintptr_t)1 << (((h) >> BLOOM_SHIFT) % \
+                                             BLOOM_BITS)))
+
+/* Bucket of an empty chain */
+
+#define BUCKET_EMPTY      UINT32_MAX
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: symtab_hashname
+ *
+ * Description:
+ *   The GNU symbol hash, h = h * 33 + c.
+ *
+ ****************************************************************************/
+
+static uint32_t symtab_hashname(FAR const char *name)
+{
+  uint32_t h = 5381;
+
+  while (*name != '\0')
+    {
+      h = (h << 5) + h + (unsigned char)*name++;
+    }
+
+  return h;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: symtab_hashinit
+ *
+ * Description:
+ *   Build the hash index of a symbol table.  The table must not change
+ *   while the index is in use.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -ENOMEM if the index could not be allocated, in
+ *   which case the index is left empty, not describing symtab.
+ *
+ ****************************************************************************/
+
+int symtab_hashinit(FAR struct symtab_hash_s *hash,
+                    FAR const struct symtab_s *symtab, int nsyms)
+{
+  FAR uint32_t *buckets;
+  uint32_t nbuckets;
+  uint32_t nbloom;
+  uint32_t end;
+  uint32_t pos;
+  uint32_t h;
+  int i;
+
+  DEBUGASSERT(hash != NULL && nsyms >= 0);
+  DEBUGASSERT(symtab != NULL || nsyms == 0);
+
+  memset(hash, 0, sizeof(*hash));
+  hash->symtab = symtab;
+  hash->nsyms  = nsyms;
+
+  if (nsyms == 0)
+    {
+      return OK;
+    }
+
+  /* Two symbols per bucket on average, and a power of two of Bloom words */
+
+  nbuckets = nsyms / 2 + 1;
+  for (nbloom = 1; nbloom * BLOOM_BITS < (size_t)nsyms * BLOOM_BITSPERSYM; )
+    {
+      nbloom <<= 1;
+    }
+
+  /* The Bloom words come first to be naturally aligned */
+
+  hash->bloom = lib_zalloc(nbloom * sizeof(uintptr_t) +
+                           (nbuckets + 2 * nsyms) * sizeof(uint32_t));
+  if (hash->bloom == NULL)
+    {
+      memset(hash, 0, sizeof(*hash));
+      return -ENOMEM;
+    }
+
+  buckets        = (FAR uint32_t *)&hash->bloom[nbloom];
+  hash->nbuckets = nbuckets;
+  hash->nbloom   = nbloom;
+  hash->buckets  = buckets;
+  hash->chain    = &buckets[nbuckets];
+  hash->index    = &hash->chain[nsyms];
+
+  /* Count the symbols of each bucket and fill the Bloom filter */
+
+  for (i = 0; i < nsyms; i++)
+    {
+      h = symtab_hashname(symtab[i].sym_name);
+      hash->bloom[BLOOM_WORD(h, nbloom)] |= BLOOM_MASK(h);
+      buckets[h % nbuckets]++;
+    }
+
+  /* Turn the counts into the end of each bucket in chain[] */
+
+  for (pos = 0, end = 0; pos < nbuckets; pos++)
+    {
+      end += buckets[pos];
+      buckets[pos] = end;
+    }
+
+  /* Place the symbols backwards so that each bucket keeps the order of the
+   * table, leaving buckets[] at the start of each bucket.
+   */
+
+  for (i = nsyms - 1; i >= 0; i--)
+    {
+      h   = symtab_hashname(symtab[i].sym_name);
+      pos = --buckets[h % nbuckets];
+      hash->chain[pos] = h & ~1;
+      hash->index[pos] = i;
+    }
+
+  /* Mark the last entry of each bucket */
+
+  for (pos = 0; pos < nbuckets; pos++)
+    {
+      end = pos + 1 < nbuckets ? buckets[pos + 1] : (uint32_t)nsyms;
+      if (end > buckets[pos])
+        {
+          hash->chain[end - 1] |= 1;
+        }
+      else
+        {
+          buckets[pos] = BUCKET_EMPTY;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: symtab_hashfree
+ *
+ * Description:
+ *   Release the memory of a hash index built by symtab_hashinit().
+ *
+ ****************************************************************************/
+
+void symtab_hashfree(FAR struct symtab_hash_s *hash)
+{
+  lib_free(hash->bloom);
+  memset(hash, 0, sizeof(*hash));
+}
+
+/****************************************************************************
+ * Name: symtab_hashfind
+ *
+ * Description:
+ *   Find the symbol with the matching name through a hash index.  When the
+ *   table holds the name several times, the first entry is returned, as
+ *   symtab_findbyname() does on an unordered table.
+ *
+ * Returned Value:
+ *   A reference to the symbol table entry if an entry with the matching
+ *   name is found; NULL is returned if the entry is not found.
+ *
+ ****************************************************************************/
+
+FAR const struct symtab_s *
+symtab_hashfind(FAR const struct symtab_hash_s *hash, FAR const char *name)
+{
+  FAR const struct symtab_s *symbol;
+  uint32_t pos;
+  uint32_t h;
+
+  DEBUGASSERT(hash != NULL && name != NULL);
+
+  if (hash->nsyms == 0)
+    {
+      return NULL;
+    }
+
+#ifdef CONFIG_SYMTAB_DECORATED
+  if (name[0] == '_')
+    {
+      name++;
+    }
+#endif
+
+  h = symtab_hashname(name);
+  if ((hash->bloom[BLOOM_WORD(h, hash->nbloom)] & BLOOM_MASK(h)) !=
+      BLOOM_MASK(h))
+    {
+      return NULL;
+    }
+
+  pos = hash->buckets[h % hash->nbuckets];
+  if (pos == BUCKET_EMPTY)
+    {
+      return NULL;
+    }
+
+  do
+    {
+      if (((hash->chain[pos] ^ h) >> 1) == 0)
+        {
+          symbol = &hash->symtab[hash->index[pos]];
+          if (strcmp(name, symbol->sym_name) == 0)
+            {
+              return symbol;
+            }
+        }
+    }
+  while ((hash->chain[pos++] & 1) == 0);
+
+  return NULL;
+}
@@ -0,0 +1,604 @@
+/****************************************************************************
+ * mm/kfence/kfence.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <assert.h>
+#include <debug.h>
+#include <execinfo.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/kfence.h>
+
+#ifdef CONFIG_MM_KFENCE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define KFENCE_NOBJECTS    CONFIG_MM_KFENCE_NOBJECTS
+#define KFENCE_SLOTSIZE    CONFIG_MM_KFENCE_SLOTSIZE
+#define KFENCE_GUARDSIZE   CONFIG_MM_KFENCE_GUARDSIZE
+#define KFENCE_BACKTRACE   CONFIG_MM_KFENCE_BACKTRACE
+
+#if (KFENCE_GUARDSIZE & (KFENCE_GUARDSIZE - 1)) != 0
+#  error CONFIG_MM_KFENCE_GUARDSIZE must be a power of two
+#endif
+
+#if (KFENCE_SLOTSIZE % KFENCE_GUARDSIZE) != 0
+#  error CONFIG_MM_KFENCE_SLOTSIZE must be a multiple of the guard size
+#endif
+
+#ifdef CONFIG_MM_KFENCE_WATCHPOINT
+#  define KFENCE_WATCHPOINT CONFIG_MM_KFENCE_WATCHPOINT
+#else
+#  define KFENCE_WATCHPOINT 0
+#endif
+
+/* Everything in the pool but the live objects holds this pattern, which
+ * depends on the address so that a shifted copy does not pass the check.
+ */
+
+#define KFENCE_CANARY(addr) ((uint8_t)(0xaa ^ ((uintptr_t)(addr) & 0x7)))
+
+/* The start of the slot of an object */
+
+#define KFENCE_SLOT(index) \
+  ((uintptr_t)g_kfence_pool + (index) * KFENCE_STRIDE + KFENCE_GUARDSIZE)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum kfence_state_e
+{
+  KFENCE_UNUSED = 0,                    /* Never allocated */
+  KFENCE_ALLOCATED,                     /* Holds a live object */
+  KFENCE_FREED                          /* Holds a freed object */
+};
+
+/* The metadata of one slot, kept outside the pool so that the object
+ * overflowing its redzones cannot corrupt it.
+ */
+
+struct kfence_meta_s
+{
+  FAR struct mm_heap_s *heap;           /* Heap charged for the object */
+  uintptr_t addr;                       /* Start of the object */
+  size_t size;                          /* Size of the object */
+  uint8_t state;                        /* See enum kfence_state_e */
+  pid_t alloc_pid;                      /* Thread that allocated it */
+  pid_t free_pid;                       /* Thread that freed it */
+#if KFENCE_BACKTRACE > 0
+  FAR void *alloc_stack[KFENCE_BACKTRACE];
+  FAR void *free_stack[KFENCE_BACKTRACE];
+#endif
+};
+
+#if KFENCE_WATCHPOINT > 0
+struct kfence_watch_s
+{
+  FAR struct kfence_meta_s *meta;       /* Object watched, NULL if unused */
+  uintptr_t addr;                       /* Start of the watched area */
+};
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+uint8_t g_kfence_pool[KFENCE_POOL_SIZE] aligned_data(KFENCE_GUARDSIZE);
+int g_kfence_countdown[CONFIG_SMP_NCPUS];
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct kfence_meta_s g_kfence_meta[KFENCE_NOBJECTS];
+
+/* The free slots in the order they were freed.  Reusing the least recently
+ * freed slot first keeps freed objects guarded for as long as possible.
+ */
+
+static uint16_t g_kfence_freeq[KFENCE_NOBJECTS];
+static unsigned int g_kfence_freehead;
+static unsigned int g_kfence_nfree;
+
+static unsigned long g_kfence_nalloc;
+static bool g_kfence_initialized;
+static spinlock_t g_kfence_lock = SP_UNLOCKED;
+
+#if KFENCE_WATCHPOINT > 0
+static struct kfence_watch_s g_kfence_watch[KFENCE_WATCHPOINT];
+static unsigned int g_kfence_nextwatch;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: kfence_fill
+ ****************************************************************************/
+
+static void kfence_fill(uintptr_t start, uintptr_t end)
+{
+  for (; start < end; start++)
+    {
+      *(FAR uint8_t *)start = KFENCE_CANARY(start);
+    }
+}
+
+/****************************************************************************
+ * Name: kfence_verify
+ *
+ * Description:
+ *   Return the first address of [start, end) whose canary was overwritten,
+ *   or zero.
+ *
+ ****************************************************************************/
+
+static uintptr_t kfence_verify(uintptr_t start, uintptr_t end)
+{
+  for (; start < end; start++)
+    {
+      if (*(FAR uint8_t *)start != KFENCE_CANARY(start))
+        {
+          return start;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: kfence_index
+ *
+ * Description:
+ *   Return the slot an address of the pool belongs to.  Each guard belongs
+ *   to the slot after it, except the trailing guard of the pool, which
+ *   belongs to the last slot.
+ *
+ ****************************************************************************/
+
+static inline int kfence_index(FAR const void *mem)
+{
+  int index = ((uintptr_t)mem - (uintptr_t)g_kfence_pool) / KFENCE_STRIDE;
+
+  return MIN(index, KFENCE_NOBJECTS - 1);
+}
+
+/****************************************************************************
+ * Name: kfence_dumpstack
+ ****************************************************************************/
+
+#if KFENCE_BACKTRACE > 0
+static void kfence_dumpstack(FAR void **stack)
+{
+  int i;
+
+  for (i = 0; i < KFENCE_BACKTRACE && stack[i] != NULL; i++)
+    {
+      _alert("  #%d %p\n", i, stack[i]);
+    }
+}
+#else
+#  define kfence_dumpstack(stack)
+#endif
+
+/****************************************************************************
+ * Name: kfence_report
+ *
+ * Description:
+ *   Report an error found at 'addr' in or around the object of 'meta',
+ *   then panic unless CONFIG_MM_KFENCE_DISABLE_PANIC is set.
+ *
+ ****************************************************************************/
+
+static void kfence_report(FAR struct kfence_meta_s *meta, uintptr_t addr,
+                          FAR const char *what)
+{
+  _alert("kfence: %s at %p\n", what, (FAR void *)addr);
+
+  if (meta->state != KFENCE_UNUSED)
+    {
+      if (addr < meta->addr)
+        {
+          _alert("%zu bytes before", meta->addr - addr);
+        }
+      else if (addr >= meta->addr + meta->size)
+        {
+          _alert("%zu bytes after", addr - meta->addr - meta->size + 1);
+        }
+      else
+        {
+          _alert("%zu bytes inside", addr - meta->addr);
+        }
+
+      _alert(" the %s object %p of %zu bytes\n",
+             meta->state == KFENCE_FREED ? "freed" : "live",
+             (FAR void *)meta->addr, meta->size);
+
+      _alert("allocated by pid %d:\n", meta->alloc_pid);
+      kfence_dumpstack(meta->alloc_stack);
+
+      if (meta->state == KFENCE_FREED)
+        {
+          _alert("freed by pid %d:\n", meta->free_pid);
+          kfence_dumpstack(meta->free_stack);
+        }
+    }
+
+#ifdef CONFIG_MM_KFENCE_DISABLE_PANIC
+  dump_stack();
+#else
+  PANIC();
+#endif
+}
+
+/****************************************************************************
+ * Name: kfence_watch
+ *
+ * Description:
+ *   Move the hardware watchpoint of an object, if any, to the area at
+ *   'addr', reusing the oldest watchpoint when all of them are taken.
+ *   An 'addr' of zero just drops the watchpoint of the object.
+ *
+ * Assumptions:
+ *   The caller holds g_kfence_lock.
+ *
+ ****************************************************************************/
+
+#if KFENCE_WATCHPOINT > 0
+static void kfence_watch_callback(int type, FAR void *addr, size_t size,
+                                  FAR void *arg)
+{
+  FAR struct kfence_meta_s *meta = arg;
+
+  kfence_report(meta, (uintptr_t)addr,
+                meta->state == KFENCE_FREED ? "use-after-free access" :
+                                              "out-of-bounds access");
+}
+
+static void kfence_watch(FAR struct kfence_meta_s *meta, uintptr_t addr)
+{
+  FAR struct kfence_watch_s *watch;
+  int i;
+
+  for (i = 0; i < KFENCE_WATCHPOINT; i++)
+    {
+      watch = &g_kfence_watch[i];
+      if (watch->meta == meta)
+        {
+          up_debugpoint_remove(DEBUGPOINT_WATCHPOINT_RW,
+                               (FAR void *)watch->addr, KFENCE_GUARDSIZE);
+          watch->meta = NULL;
+        }
+    }
+
+  if (addr == 0)
+    {
+      return;
+    }
+
+  watch = &g_kfence_watch[g_kfence_nextwatch];
+  g_kfence_nextwatch = (g_kfence_nextwatch + 1) % KFENCE_WATCHPOINT;
+
+  if (watch->meta != NULL)
+    {
+      up_debugpoint_remove(DEBUGPOINT_WATCHPOINT_RW,
+                           (FAR void *)watch->addr, KFENCE_GUARDSIZE);
+      watch->meta = NULL;
+    }
+
+  if (up_debugpoint_add(DEBUGPOINT_WATCHPOINT_RW, (FAR void *)addr,
+                        KFENCE_GUARDSIZE, kfence_watch_callback, meta) >= 0)
+    {
+      watch->meta = meta;
+      watch->addr = addr;
+    }
+}
+
+/****************************************************************************
+ * Name: kfence_arm
+ *
+ * Description:
+ *   Disarm the watchpoints on any part of [start, end), so that kfence
+ *   itself can check and fill it, or arm them again.  A watchpoint which
+ *   cannot be armed again is dropped.
+ *
+ * Assumptions:
+ *   The caller holds g_kfence_lock.
+ *
+ ****************************************************************************/
+
+static void kfence_arm(uintptr_t start, uintptr_t end, bool arm)
+{
+  FAR struct kfence_watch_s *watch;
+  int i;
+
+  for (i = 0; i < KFENCE_WATCHPOINT; i++)
+    {
+      watch = &g_kfence_watch[i];
+      if (watch->meta == NULL || watch->addr >= end ||
+          watch->addr + KFENCE_GUARDSIZE <= start)
+        {
+          continue;
+        }
+
+      if (!arm)
+        {
+          up_debugpoint_remove(DEBUGPOINT_WATCHPOINT_RW,
+                               (FAR void *)watch->addr, KFENCE_GUARDSIZE);
+        }
+      else if (up_debugpoint_add(DEBUGPOINT_WATCHPOINT_RW,
+                                 (FAR void *)watch->addr, KFENCE_GUARDSIZE,
+                                 kfence_watch_callback, watch->meta) < 0)
+        {
+          watch->meta = NULL;
+        }
+    }
+}
+#else
+#  define kfence_watch(meta, addr)
+#  define kfence_arm(start, end, arm)
+#endif
+
+/****************************************************************************
+ * Name: kfence_initialize
+ ****************************************************************************/
+
+static void kfence_initialize(void)
+{
+  int i;
+
+  kfence_fill((uintptr_t)g_kfence_pool,
+              (uintptr_t)g_kfence_pool + KFENCE_POOL_SIZE);
+
+  for (i = 0; i < KFENCE_NOBJECTS; i++)
+    {
+      g_kfence_freeq[i] = i;
+    }
+
+  g_kfence_nfree       = KFENCE_NOBJECTS;
+  g_kfence_initialized = true;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: kfence_alloc
+ ****************************************************************************/
+
+FAR void *kfence_alloc(FAR struct mm_heap_s *heap, size_t size,
+                       size_t align)
+{
+  FAR struct kfence_meta_s *meta;
+#if KFENCE_BACKTRACE > 0
+  FAR void *stack[KFENCE_BACKTRACE];
+#endif
+  irqstate_t flags;
+  uintptr_t slot;
+  uintptr_t addr;
+  uintptr_t bad;
+  int index;
+
+  size = MAX(size, 1);
+  if (size > KFENCE_SLOTSIZE || align > KFENCE_GUARDSIZE)
+    {
+      /* Does not fit, sample the next allocation instead */
+
+      g_kfence_countdown[this_cpu()] = 1;
+      return NULL;
+    }
+
+  g_kfence_countdown[this_cpu()] = CONFIG_MM_KFENCE_SAMPLE_INTERVAL;
+
+#if KFENCE_BACKTRACE > 0
+  memset(stack, 0, sizeof(stack));
+  if (!up_interrupt_context())
+    {
+      sched_backtrace(_SCHED_GETTID(), stack, KFENCE_BACKTRACE,
+                      CONFIG_MM_KFENCE_BACKTRACE_SKIP);
+    }
+#endif
+
+  flags = spin_lock_irqsave(&g_kfence_lock);
+
+  if (!g_kfence_initialized)
+    {
+      kfence_initialize();
+    }
+
+  if (g_kfence_nfree == 0)
+    {
+      spin_unlock_irqrestore(&g_kfence_lock, flags);
+      return NULL;
+    }
+
+  index = g_kfence_freeq[g_kfence_freehead];
+  g_kfence_freehead = (g_kfence_freehead + 1) % KFENCE_NOBJECTS;
+  g_kfence_nfree--;
+
+  meta = &g_kfence_meta[index];
+  slot = KFENCE_SLOT(index);
+
+  /* Nothing may have written to the slot since its object was freed.  The
+   * watchpoint on the freed object would take the check for an access.
+   */
+
+  if (meta->state == KFENCE_FREED)
+    {
+      kfence_watch(meta, 0);
+      bad = kfence_verify(slot, slot + KFENCE_SLOTSIZE);
+      if (bad != 0)
+        {
+          kfence_report(meta, bad, "use-after-free write");
+          kfence_fill(slot, slot + KFENCE_SLOTSIZE);
+        }
+    }
+
+  /* Place the objects alternately against the guard after and before
+   * the slot to catch both overflows and underflows.
+   */
+
+  if ((g_kfence_nalloc++ & 1) == 0)
+    {
+      addr = (slot + KFENCE_SLOTSIZE - size) & ~(align - 1);
+      kfence_watch(meta, slot + KFENCE_SLOTSIZE);
+    }
+  else
+    {
+      addr = slot;
+      kfence_watch(meta, slot - KFENCE_GUARDSIZE);
+    }
+
+  meta->heap      = heap;
+  meta->addr      = addr;
+  meta->size      = size;
+  meta->state     = KFENCE_ALLOCATED;
+  meta->alloc_pid = up_interrupt_context() ? -1 : _SCHED_GETTID();
+#if KFENCE_BACKTRACE > 0
+  memcpy(meta->alloc_stack, stack, sizeof(stack));
+#endif
+
+  spin_unlock_irqrestore(&g_kfence_lock, flags);
+  return (FAR void *)addr;
+}
+
+/****************************************************************************
+ * Name: kfence_free
+ ****************************************************************************/
+
+void kfence_free(FAR void *mem)
+{
+  FAR struct kfence_meta_s *meta;
+#if KFENCE_BACKTRACE > 0
+  FAR void *stack[KFENCE_BACKTRACE];
+#endif
+  irqstate_t flags;
+  uintptr_t slot;
+  uintptr_t bad;
+  int index;
+
+  index = kfence_index(mem);
+  meta  = &g_kfence_meta[index];
+  slot  = KFENCE_SLOT(index);
+
+#if KFENCE_BACKTRACE > 0
+  memset(stack, 0, sizeof(stack));
+  if (!up_interrupt_context())
+    {
+      sched_backtrace(_SCHED_GETTID(), stack, KFENCE_BACKTRACE,
+                      CONFIG_MM_KFENCE_BACKTRACE_SKIP);
+    }
+#endif
+
+  flags = spin_lock_irqsave(&g_kfence_lock);
+
+  if (meta->state != KFENCE_ALLOCATED || meta->addr != (uintptr_t)mem)
+    {
+      kfence_report(meta, (uintptr_t)mem,
+                    meta->state == KFENCE_FREED &&
+                    meta->addr == (uintptr_t)mem ?
+                    "double free" : "invalid free");
+      spin_unlock_irqrestore(&g_kfence_lock, flags);
+      return;
+    }
+
+  /* Check the redzones around the object, including the guards.  These
+   * may be watched for this object or, as the guards are shared, for the
+   * objects next to it.
+   */
+
+  kfence_watch(meta, 0);
+  kfence_arm(slot - KFENCE_GUARDSIZE, slot + KFENCE_SLOTSIZE +
+             KFENCE_GUARDSIZE, false);
+
+  bad = kfence_verify(slot - KFENCE_GUARDSIZE, meta->addr);
+  if (bad == 0)
+    {
+      bad = kfence_verify(meta->addr + meta->size,
+                          slot + KFENCE_SLOTSIZE + KFENCE_GUARDSIZE);
+    }
+
+  if (bad != 0)
+    {
+      kfence_report(meta, bad, "out-of-bounds write");
+      kfence_fill(slot - KFENCE_GUARDSIZE, meta->addr);
+      kfence_fill(meta->addr + meta->size,
+                  slot + KFENCE_SLOTSIZE + KFENCE_GUARDSIZE);
+    }
+
+  /* Poison the object and watch it until the slot is reused */
+
+  kfence_fill(meta->addr, meta->addr + meta->size);
+  kfence_arm(slot - KFENCE_GUARDSIZE, slot + KFENCE_SLOTSIZE +
+             KFENCE_GUARDSIZE, true);
+  kfence_watch(meta, meta->addr & ~(KFENCE_GUARDSIZE - 1));
+
+  meta->state    = KFENCE_FREED;
+  meta->free_pid = up_interrupt_context() ? -1 : _SCHED_GETTID();
+#if KFENCE_BACKTRACE > 0
+  memcpy(meta->free_stack, stack, sizeof(stack));
+#endif
+
+  g_kfence_freeq[(g_kfence_freehead + g_kfence_nfree) % KFENCE_NOBJECTS] =
+    index;
+  g_kfence_nfree++;
+
+  spin_unlock_irqrestore(&g_kfence_lock, flags);
+}
+
+/****************************************************************************
+ * Name: kfence_heap
+ ****************************************************************************/
+
+FAR struct mm_heap_s *kfence_heap(FAR const void *mem)
+{
+  return g_kfence_meta[kfence_index(mem)].heap;
+}
+
+/****************************************************************************
+ * Name: kfence_size
+ ****************************************************************************/
+
+size_t kfence_size(FAR const void *mem)
+{
+  return g_kfence_meta[kfence_index(mem)].size;
+}
+
+#endif /* CONFIG_MM_KFENCE */
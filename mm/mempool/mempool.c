@@ -40,6 +40,12 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The number of blocks moved between a per-CPU cache and its pool at once */
+
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+#  define MEMPOOL_CACHE_BATCH ((CONFIG_MM_MEMPOOL_PERCPU_CACHE + 1) / 2)
+#endif
+
 #if CONFIG_MM_BACKTRACE >= 0
 #define MEMPOOL_MAGIC_FREE  0xAAAAAAAA
 #define MEMPOOL_MAGIC_ALLOC 0x55555555
@@ -98,6 +104,123 @@ static inline void mempool_add_queue(FAR struct mempool_s *pool,
     }
 }
 
+static inline void mempool_add_free(FAR struct mempool_s *pool,
+                                    FAR void *blk)
+{
+  size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+
+  if (pool->interruptsize > blocksize &&
+      (FAR char *)blk >= pool->ibase &&
+      (FAR char *)blk < pool->ibase + pool->interruptsize - blocksize)
+    {
+      sq_addlast(blk, &pool->iqueue);
+    }
+  else
+    {
+      sq_addlast(blk, &pool->queue);
+    }
+}
+
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+
+/****************************************************************************
+ * Name: mempool_cache_alloc
+ *
+ * Description:
+ *   Take a free block from the cache of this CPU, refilling the cache from
+ *   the queue first if it is empty.  The blocks in the caches are counted
+ *   in pool->nalloc, like the allocated ones.
+ *
+ ****************************************************************************/
+
+static FAR void *mempool_cache_alloc(FAR struct mempool_s *pool)
+{
+  FAR struct mempool_cache_s *cache;
+  FAR sq_entry_t *blk;
+  irqstate_t flags;
+
+  flags = up_irq_save();
+  cache = &pool->cache[this_cpu()];
+  if (cache->count == 0)
+    {
+      irqstate_t lflags = raw_spin_lock_irqsave(&pool->lock);
+
+      while (cache->count < MEMPOOL_CACHE_BATCH &&
+             (blk = mempool_remove_queue(pool, &pool->queue)) != NULL)
+        {
+          cache->blk[cache->count++] = blk;
+          pool->nalloc++;
+        }
+
+      raw_spin_unlock_irqrestore(&pool->lock, lflags);
+    }
+
+  blk = cache->count > 0 ? cache->blk[--cache->count] : NULL;
+  up_irq_restore(flags);
+  return blk;
+}
+
+/****************************************************************************
+ * Name: mempool_cache_release
+ *
+ * Description:
+ *   Put a free block in the cache of this CPU, giving a batch of blocks
+ *   back to the queue first if the cache is full.
+ *
+ ****************************************************************************/
+
+static void mempool_cache_release(FAR struct mempool_s *pool, FAR void *blk)
+{
+  FAR struct mempool_cache_s *cache;
+  irqstate_t flags;
+
+  flags = up_irq_save();
+  cache = &pool->cache[this_cpu()];
+  if (cache->count == CONFIG_MM_MEMPOOL_PERCPU_CACHE)
+    {
+      irqstate_t lflags = raw_spin_lock_irqsave(&pool->lock);
+
+      while (cache->count >
+             CONFIG_MM_MEMPOOL_PERCPU_CACHE - MEMPOOL_CACHE_BATCH)
+        {
+          mempool_add_free(pool, cache->blk[--cache->count]);
+          pool->nalloc--;
+        }
+
+      raw_spin_unlock_irqrestore(&pool->lock, lflags);
+    }
+
+  cache->blk[cache->count++] = blk;
+  up_irq_restore(flags);
+}
+
+/****************************************************************************
+ * Name: mempool_cache_count
+ *
+ * Description:
+ *   Return the number of free blocks held by the caches of all CPUs.
+ *
+ ****************************************************************************/
+
+static size_t mempool_cache_count(FAR struct mempool_s *pool)
+{
+  size_t count = 0;
+  int cpu;
+
+  if (pool->cache != NULL)
+    {
+      for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+        {
+          count += pool->cache[cpu].count;
+        }
+    }
+
+  return count;
+}
+#else
+#  define mempool_cache_count(pool) 0
+#endif
+
 #if CONFIG_MM_BACKTRACE >= 0
 static inline void mempool_add_backtrace(FAR struct mempool_s *pool,
                                          FAR struct mempool_backtrace_s *buf)
@@ -260,6 +383,10 @@ int mempool_init(FAR struct mempool_s *pool, FAR const char *name)
   sq_init(&pool->iqueue);
   sq_init(&pool->equeue);
   pool->nalloc = 0;
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  pool->cache = NULL;
+#endif
+
   if (pool->interruptsize >= blocksize)
     {
       size_t ninterrupt = pool->interruptsize / blocksize;
@@ -344,6 +471,17 @@ FAR void *mempool_allocate(FAR struct mempool_s *pool)
   FAR sq_entry_t *blk;
   irqstate_t flags;
 
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  if (pool->cache != NULL)
+    {
+      blk = mempool_cache_alloc(pool);
+      if (blk != NULL)
+        {
+          goto out;
+        }
+    }
+#endif
+
 retry:
   flags = spin_lock_irqsave(&pool->lock);
   blk = mempool_remove_queue(pool, &pool->queue);
@@ -398,6 +536,9 @@ retry:
   pool->nalloc++;
   spin_unlock_irqrestore(&pool->lock, flags);
 
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+out:
+#endif
 #if CONFIG_MM_BACKTRACE >= 0
   mempool_add_backtrace(pool, (FAR struct mempool_backtrace_s *)
                               ((FAR char *)blk + pool->blocksize));
@@ -424,8 +565,7 @@ retry:
 
 void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
 {
-  irqstate_t flags = spin_lock_irqsave(&pool->lock);
-  size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  irqstate_t flags;
 #if CONFIG_MM_BACKTRACE >= 0
   FAR struct mempool_backtrace_s *buf =
     (FAR struct mempool_backtrace_s *)((FAR char *)blk + pool->blocksize);
@@ -437,29 +577,22 @@ void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
 
 #endif
 
-  pool->nalloc--;
-
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
   memset(blk, MM_FREE_MAGIC, pool->blocksize);
 #endif
 
-  if (pool->interruptsize > blocksize)
-    {
-      if ((FAR char *)blk >= pool->ibase &&
-          (FAR char *)blk < pool->ibase + pool->interruptsize - blocksize)
-        {
-          sq_addlast(blk, &pool->iqueue);
-        }
-      else
-        {
-          sq_addlast(blk, &pool->queue);
-        }
-    }
-  else
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  if (pool->cache != NULL)
     {
-      sq_addlast(blk, &pool->queue);
+      kasan_poison(blk, pool->blocksize);
+      mempool_cache_release(pool, blk);
+      return;
     }
+#endif
 
+  flags = spin_lock_irqsave(&pool->lock);
+  pool->nalloc--;
+  mempool_add_free(pool, blk);
   kasan_poison(blk, pool->blocksize);
   spin_unlock_irqrestore(&pool->lock, flags);
   if (pool->wait && pool->expandsize == 0)
@@ -491,14 +624,16 @@ void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
 int mempool_info(FAR struct mempool_s *pool, FAR struct mempoolinfo_s *info)
 {
   size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  size_t cached;
   irqstate_t flags;
 
   DEBUGASSERT(pool != NULL && info != NULL);
 
   flags = spin_lock_irqsave(&pool->lock);
-  info->ordblks = sq_count(&pool->queue);
+  cached = mempool_cache_count(pool);
+  info->ordblks = sq_count(&pool->queue) + cached;
   info->iordblks = sq_count(&pool->iqueue);
-  info->aordblks = pool->nalloc;
+  info->aordblks = pool->nalloc - cached;
   info->arena = sq_count(&pool->equeue) * sizeof(sq_entry_t) +
     (info->aordblks + info->ordblks + info->iordblks) * blocksize;
   spin_unlock_irqrestore(&pool->lock, flags);
@@ -536,7 +671,8 @@ mempool_info_task(FAR struct mempool_s *pool,
     {
       irqstate_t flags = spin_lock_irqsave(&pool->lock);
       size_t count = sq_count(&pool->queue) +
-                     sq_count(&pool->iqueue);
+                     sq_count(&pool->iqueue) +
+                     mempool_cache_count(pool);
 
       spin_unlock_irqrestore(&pool->lock, flags);
       info.aordblks += count;
@@ -544,8 +680,10 @@ mempool_info_task(FAR struct mempool_s *pool,
     }
   else if (task->pid == PID_MM_ALLOC)
     {
-      info.aordblks += pool->nalloc;
-      info.uordblks += pool->nalloc * blocksize;
+      size_t count = pool->nalloc - mempool_cache_count(pool);
+
+      info.aordblks += count;
+      info.uordblks += count * blocksize;
     }
 #if CONFIG_MM_BACKTRACE >= 0
   else
@@ -614,6 +752,22 @@ int mempool_deinit(FAR struct mempool_s *pool)
   size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
   FAR sq_entry_t *blk;
   size_t count = 0;
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  int cpu;
+
+  /* Give the blocks of all the caches back to the queue */
+
+  for (cpu = 0; pool->cache != NULL && cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      FAR struct mempool_cache_s *cache = &pool->cache[cpu];
+
+      while (cache->count > 0)
+        {
+          mempool_add_free(pool, cache->blk[--cache->count]);
+          pool->nalloc--;
+        }
+    }
+#endif
 
   if (pool->nalloc != 0)
     {
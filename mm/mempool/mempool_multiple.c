@@ -35,6 +35,14 @@
 #include <nuttx/mm/mempool.h>
 #include <nuttx/mm/kasan.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The largest size class lookup table built, in entries */
+
+#define MEMPOOL_MULTIPLE_LUT_MAX 1024
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -82,6 +90,14 @@ struct mempool_multiple_s
 
   size_t                        delta;
 
+  /* The index of the smallest pool fitting each size rounded up to a
+   * multiple of (1 << lut_shift), or NULL if the table would be too large.
+   */
+
+  FAR uint8_t                  *lut;
+  size_t                        lut_size;
+  unsigned int                  lut_shift;
+
   /* It is used to record the information recorded by the mempool during
    * expansion, and find the mempool by adding an index
    */
@@ -111,6 +127,13 @@ mempool_multiple_find(FAR struct mempool_multiple_s *mpool, size_t size)
       return NULL;
     }
 
+  if (mpool->lut != NULL)
+    {
+      mid = (size >> mpool->lut_shift) +
+            ((size & (((size_t)1 << mpool->lut_shift) - 1)) != 0);
+      return mid < mpool->lut_size ? &mpool->pools[mpool->lut[mid]] : NULL;
+    }
+
   right = mpool->npools;
   if (mpool->delta != 0)
     {
@@ -405,8 +428,12 @@ mempool_multiple_init(FAR const char *name,
   FAR struct mempool_s *pools;
   size_t maxpoolszie;
   size_t minpoolsize;
+  size_t cachesize = 0;
+  size_t lutsize = 0;
+  size_t granule = 0;
   int ret;
   int i;
+  int j;
 
   if (expandsize & (expandsize - 1))
     {
@@ -426,11 +453,28 @@ mempool_multiple_init(FAR const char *name,
         {
           minpoolsize = poolsize[i];
         }
+
+      granule |= poolsize[i];
+    }
+
+  /* All the pool sizes are multiples of the granule, so the pool of any
+   * size is that of the size rounded up to the granule.
+   */
+
+  granule &= -granule;
+  if (npools <= UINT8_MAX + 1 &&
+      maxpoolszie / granule < MEMPOOL_MULTIPLE_LUT_MAX)
+    {
+      lutsize = maxpoolszie / granule + 1;
     }
 
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  cachesize = npools * CONFIG_SMP_NCPUS * sizeof(struct mempool_cache_s);
+#endif
+
   mpool = alloc(arg, sizeof(uintptr_t),
                 sizeof(struct mempool_multiple_s) +
-                npools * sizeof(struct mempool_s));
+                npools * sizeof(struct mempool_s) + cachesize + lutsize);
 
   if (mpool == NULL)
     {
@@ -440,6 +484,30 @@ mempool_multiple_init(FAR const char *name,
   pools = (FAR struct mempool_s *)
           ((uintptr_t)mpool + sizeof(struct mempool_multiple_s));
 
+  if (lutsize > 0)
+    {
+      mpool->lut = (FAR uint8_t *)(pools + npools) + cachesize;
+      mpool->lut_size = lutsize;
+      mpool->lut_shift = ffsl(granule) - 1;
+      for (i = 0, j = 0; i < lutsize; i++)
+        {
+          while (j + 1 < npools && poolsize[j] < i * granule)
+            {
+              j++;
+            }
+
+          mpool->lut[i] = j;
+        }
+    }
+  else
+    {
+      mpool->lut = NULL;
+    }
+
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+  memset(pools + npools, 0, cachesize);
+#endif
+
   mpool->alloc_size = alloc_size;
   mpool->expandsize = expandsize;
   mpool->chunk_size = chunksize;
@@ -459,6 +527,7 @@ mempool_multiple_init(FAR const char *name,
       pools[i].expandsize = expandsize - mpool->minpoolsize;
       pools[i].initialsize = 0;
       pools[i].interruptsize = 0;
+      pools[i].wait = false;
       pools[i].priv = mpool;
       pools[i].alloc = mempool_multiple_alloc_callback;
       pools[i].free = mempool_multiple_free_callback;
@@ -470,6 +539,15 @@ mempool_multiple_init(FAR const char *name,
           goto err_with_pools;
         }
 
+#if CONFIG_MM_MEMPOOL_PERCPU_CACHE > 0
+      /* These pools never wait for a block, so they may keep free blocks
+       * aside from the queue.
+       */
+
+      pools[i].cache = (FAR struct mempool_cache_s *)(pools + npools) +
+                       i * CONFIG_SMP_NCPUS;
+#endif
+
       if (i + 1 != npools)
         {
           size_t delta = poolsize[i + 1] - poolsize[i];
@@ -44,8 +44,16 @@
 
 #define SIZEOF_GAT(n) \
   ((n + 31) >> 5)
+#define SIZEOF_MAP(n) \
+  SIZEOF_GAT(SIZEOF_GAT(n))
 #define SIZEOF_GRAN_S(n) \
-  (sizeof(struct gran_s) + sizeof(uint32_t) * (SIZEOF_GAT(n) - 1))
+  (sizeof(struct gran_s) + sizeof(uint32_t) * \
+   (SIZEOF_GAT(n) - 1 + 2 * SIZEOF_MAP(n)))
+
+/* Words of the second level summaries, enough for UINT16_MAX granules */
+
+#define GRAN_NGRPWORDS \
+  SIZEOF_GAT(SIZEOF_MAP(UINT16_MAX))
 
 /* Debug */
 
@@ -77,6 +85,17 @@ struct gran_s
   mutex_t    lock;       /* For exclusive access to the GAT */
 #endif
   uintptr_t  heapstart; /* The aligned start of the granule heap */
+
+  /* Summaries of the GAT, one bit per GAT cell in freemap and usedmap, one
+   * bit per word of these in freegrp and usedgrp, so that the searches
+   * skip over full and empty areas with a few find-first-set.  The maps
+   * follow the GAT in memory.
+   */
+
+  FAR uint32_t *freemap;  /* Cells with at least one free granule */
+  FAR uint32_t *usedmap;  /* Cells with at least one used granule */
+  uint32_t   freegrp[GRAN_NGRPWORDS];
+  uint32_t   usedgrp[GRAN_NGRPWORDS];
   uint32_t   gat[1];    /* Start of the granule allocation table */
 };
 
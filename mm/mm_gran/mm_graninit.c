@@ -33,6 +33,7 @@
 #include <nuttx/kmalloc.h>
 
 #include "mm_gran/mm_gran.h"
+#include "mm_gran/mm_grantable.h"
 
 #ifdef CONFIG_GRAN
 
@@ -137,6 +138,15 @@ GRAN_HANDLE gran_initialize(FAR void *heapstart, size_t heapsize,
       priv->log2align = log2align;
       priv->ngranules = ngranules;
       priv->heapstart = alignedstart;
+      priv->freemap   = &priv->gat[SIZEOF_GAT(ngranules)];
+      priv->usedmap   = priv->freemap + SIZEOF_MAP(ngranules);
+
+      /* Clearing the empty GAT marks all of its cells free in the maps */
+
+      if (ngranules > 0)
+        {
+          gran_clear(priv, 0, ngranules);
+        }
 
       /* Initialize mutual exclusion support */
 
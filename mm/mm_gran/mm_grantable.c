@@ -26,8 +26,10 @@
 
 #include <nuttx/config.h>
 
+#include <sys/param.h>
 #include <assert.h>
 #include <errno.h>
+#include <stdint.h>
 #include <strings.h>
 #include <debug.h>
 
@@ -90,10 +92,128 @@ uint32_t lsb_mask(uint32_t n)
   return (-n & n) & GATCFULL;
 }
 
-/* set or clear a GAT cell with given bit mask */
+/* set or clear the bit of a GAT cell in a summary map */
+
+static void map_set(uint32_t *map, uint32_t *grp, uint32_t cell, bool val)
+{
+  uint32_t word = cell >> 5;
+
+  if (val)
+    {
+      map[word] |= BIT(cell & 31);
+      grp[word >> 5] |= BIT(word & 31);
+    }
+  else
+    {
+      map[word] &= ~BIT(cell & 31);
+      if (map[word] == 0)
+        {
+          grp[word >> 5] &= ~BIT(word & 31);
+        }
+    }
+}
+
+/* return the first cell at or after the given one with its bit set in a
+ * summary map, or UINT32_MAX if there is none
+ */
+
+static uint32_t map_next(const gran_t *gran, const uint32_t *map,
+                         const uint32_t *grp, uint32_t cell)
+{
+  uint32_t nword = SIZEOF_MAP(gran->ngranules);
+  uint32_t word = cell >> 5;
+  uint32_t v;
+
+  if (word >= nword)
+    {
+      return UINT32_MAX;
+    }
+
+  v = map[word] & ~(BIT(cell & 31) - 1);
+  if (v == 0)
+    {
+      /* skip the empty words of the map with the second level */
+
+      for (word++; word < nword; word = (word | 31) + 1)
+        {
+          v = grp[word >> 5] & ~(BIT(word & 31) - 1);
+          if (v != 0)
+            {
+              word = (word & ~31) + ffs(v) - 1;
+              break;
+            }
+        }
+
+      if (v == 0 || word >= nword)
+        {
+          return UINT32_MAX;
+        }
+
+      v = map[word];
+    }
+
+  return (word << 5) + ffs(v) - 1;
+}
+
+/* return the index of the most significant bit set in v */
+
+static uint32_t bit_msb(uint32_t v)
+{
+#ifdef CONFIG_HAVE_BUILTIN_CLZ
+  return 31 - __builtin_clz(v);
+#else
+  return DEBRUJIN_LUT[(uint32_t)(msb_mask(v) * DEBRUJIN_NUM) >> 27];
+#endif
+}
+
+/* return the bits of v starting a run of at least n set bits that ends
+ * below the top of v
+ */
+
+static uint32_t run_mask(uint32_t v, size_t n)
+{
+  size_t step;
+  size_t k;
+
+  for (k = 1; k < n && v != 0; k += step)
+    {
+      step = MIN(k, n - k);
+      v &= v >> step;
+    }
+
+  return v;
+}
+
+/* account a free run to the search, return true when it is over */
+
+static bool gran_fit(size_t size, size_t start, size_t len,
+                     size_t *best, int *ret)
+{
+  if (len < size)
+    {
+      return false;
+    }
+
+#ifdef CONFIG_GRAN_BESTFIT
+  if (len < *best)
+    {
+      *best = len;
+      *ret  = start;
+    }
+
+  return len == size;
+#else
+  *ret = start;
+  return true;
+#endif
+}
+
+/* set or clear a GAT cell with given bit mask, keeping the maps in sync */
 
 static void cell_set(gran_t *gran, uint32_t cell, uint32_t mask, bool val)
 {
+  uint32_t v;
+
   if (val)
     {
       gran->gat[cell] |= mask;
@@ -102,6 +222,10 @@ static void cell_set(gran_t *gran, uint32_t cell, uint32_t mask, bool val)
     {
       gran->gat[cell] &= ~mask;
     }
+
+  v = gran->gat[cell];
+  map_set(gran->freemap, gran->freegrp, cell, v != GATCFULL);
+  map_set(gran->usedmap, gran->usedgrp, cell, v != 0);
 }
 
 /* set or clear a range of GAT bits */
@@ -255,10 +379,28 @@ failure:
   return false;
 }
 
-/* returns granule number of free range or negative error */
+/* returns granule number of free range or negative error.  The GAT is
+ * walked cell by cell, the full cells and the runs of empty cells being
+ * skipped over with the maps.  Each cell costs a few bit operations, so
+ * that the search time depends on the number of partially used cells and
+ * not on the number of granules or free runs.  The first free run large
+ * enough is taken, or the smallest one with CONFIG_GRAN_BESTFIT.
+ */
 
 int gran_search(const gran_t *gran, size_t size)
 {
+  uint32_t ncell;
+  uint32_t cell;
+  uint32_t next;
+  uint32_t v;
+  uint32_t w;
+  size_t runstart = 0;
+  size_t run = 0;
+  size_t best = SIZE_MAX;
+  size_t head;
+  size_t tail;
+  size_t len;
+  size_t p;
   int ret = -EINVAL;
 
   if (gran == NULL || gran->ngranules < size)
@@ -266,14 +408,87 @@ int gran_search(const gran_t *gran, size_t size)
       return ret;
     }
 
-  ret = -ENOMEM;
-  for (size_t i = 0; i <= gran->ngranules - size; i++)
+  ret   = -ENOMEM;
+  ncell = SIZEOF_GAT(gran->ngranules);
+  cell  = map_next(gran, gran->freemap, gran->freegrp, 0);
+
+  while (cell < ncell)
     {
-      if (gran_match(gran, i, size, 0, &i))
+      v = gran->gat[cell];
+      if (v == 0)
         {
-          ret = i;
-          break;
+          /* the free run goes on through all the empty cells */
+
+          next = map_next(gran, gran->usedmap, gran->usedgrp, cell + 1);
+          next = MIN(next, ncell);
+
+          if (run == 0)
+            {
+              runstart = (size_t)cell << 5;
+            }
+
+          run += (size_t)(next - cell) << 5;
+          cell = next;
+          continue;
         }
+
+      /* the low free bits end the current run */
+
+      head = ffs(v) - 1;
+      if (run == 0)
+        {
+          runstart = (size_t)cell << 5;
+        }
+
+      if (gran_fit(size, runstart, run + head, &best, &ret))
+        {
+          return ret;
+        }
+
+      /* the runs inside the cell, only looked at if one is large enough */
+
+      tail = 31 - bit_msb(v);
+      if (head + tail + size <= 32)
+        {
+          w = ~v & ~(BIT(head) - 1) & (GATCFULL >> tail);
+          if (run_mask(w, size) != 0)
+            {
+              while (w != 0)
+                {
+                  p   = ffs(w) - 1;
+                  len = ffs(~(w >> p)) - 1;
+                  if (gran_fit(size, ((size_t)cell << 5) + p, len,
+                               &best, &ret))
+                    {
+                      return ret;
+                    }
+
+                  w &= ~((BIT(len) - 1) << p);
+                }
+            }
+        }
+
+      /* the high free bits start the next run */
+
+      if (tail > 0)
+        {
+          run      = tail;
+          runstart = ((size_t)cell << 5) + 32 - tail;
+          cell++;
+        }
+      else
+        {
+          run  = 0;
+          cell = map_next(gran, gran->freemap, gran->freegrp, cell + 1);
+        }
+    }
+
+  /* the last run may cover the unused bits of the last cell */
+
+  if (run > 0 && runstart < gran->ngranules)
+    {
+      gran_fit(size, runstart, MIN(run, gran->ngranules - runstart),
+               &best, &ret);
     }
 
   return ret;
@@ -33,6 +33,8 @@
 #include <nuttx/sched.h>
 #include <nuttx/fs/procfs.h>
 #include <nuttx/lib/math32.h>
+#include <nuttx/mm/heapprof.h>
+#include <nuttx/mm/kfence.h>
 #include <nuttx/mm/mempool.h>
 #include <nuttx/mm/mm.h>
 
@@ -128,6 +130,18 @@
 #define MM_ALLOC_BIT     0x1
 #define MM_PREVFREE_BIT  0x2
 #define MM_MASK_BIT      (MM_ALLOC_BIT | MM_PREVFREE_BIT)
+
+/* Bit 2 marks the free chunks cleared by the idle workers.  It is not part
+ * of MM_MASK_BIT, so that it is lost when chunks are merged; mm_malloc()
+ * passes it on to the remainder of a split chunk.
+ */
+
+#ifdef CONFIG_MM_IDLE_SCRUB
+#  define MM_ZEROED_BIT  0x4
+#else
+#  define MM_ZEROED_BIT  0
+#endif
+
 #ifdef CONFIG_MM_SMALL
 #  define MMSIZE_MAX     UINT16_MAX
 #else
@@ -147,7 +161,7 @@
 
 /* Get the node size */
 
-#define MM_SIZEOF_NODE(node) ((node)->size & (~MM_MASK_BIT))
+#define MM_SIZEOF_NODE(node) ((node)->size & ~(MM_MASK_BIT | MM_ZEROED_BIT))
 
 /* Check if node/prenode is free */
 
@@ -208,6 +222,10 @@ static_assert(MM_ALIGN >= sizeof(uintptr_t) &&
               (MM_ALIGN & MM_GRAN_MASK) == 0,
               "Error memory alignment\n");
 
+#ifdef CONFIG_MM_IDLE_SCRUB
+static_assert(MM_ALIGN > MM_ZEROED_BIT, "No room for MM_ZEROED_BIT\n");
+#endif
+
 struct mm_delaynode_s
 {
   FAR struct mm_delaynode_s *flink;
@@ -242,6 +260,13 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TIER
+  /* The tier of each region, and the set of the tiers of all regions */
+
+  uint8_t mm_regiontier[CONFIG_MM_REGIONS];
+  uint8_t mm_tiers;
+#endif
+
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed up searching of free nodes.
@@ -257,6 +282,22 @@ struct mm_heap_s
   size_t mm_delaycount[CONFIG_SMP_NCPUS];
 #endif
 
+#ifdef CONFIG_MM_IDLE_WORKER
+  /* The work done by the idle workers, see mm_idle.c */
+
+  size_t mm_idlefreed;                      /* Delayed frees released */
+#  ifdef CONFIG_MM_IDLE_SCRUB
+  FAR struct mm_freenode_s *mm_scrubnode;   /* Free chunk being cleared */
+  FAR struct mm_freenode_s *mm_scrubprev;   /* Last free chunk visited */
+  size_t mm_scrubofs;                       /* Next byte to clear in it */
+  unsigned int mm_scrubgen;                 /* Chunks to clear added */
+  unsigned int mm_scrubpass;                /* mm_scrubgen at pass start */
+  bool mm_scrubpending;                     /* Some chunk is not cleared */
+  size_t mm_scrubbed;                       /* Bytes cleared */
+  size_t mm_nzeroed;                        /* Zeroed allocations served */
+#  endif
+#endif
+
   /* The is a multiple mempool of the heap */
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
@@ -295,10 +336,30 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap,
 void mm_foreach(FAR struct mm_heap_s *heap, mm_node_handler_t handler,
                 FAR void *arg);
 
+/* Functions contained in mm_malloc.c ***************************************/
+
+FAR void *mm_malloc_node(FAR struct mm_heap_s *heap, size_t size,
+                         FAR bool *zeroed);
+FAR void *mm_malloc_zeroed(FAR struct mm_heap_s *heap, size_t size,
+                           FAR bool *zeroed);
+size_t mm_drain_delaylist(FAR struct mm_heap_s *heap);
+
+/* Functions contained in mm_memalign.c *************************************/
+
+FAR void *mm_memalign_node(FAR struct mm_heap_s *heap, size_t alignment,
+                           size_t size);
+
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay);
 
+/* Functions contained in mm_tier.c *****************************************/
+
+#ifdef CONFIG_MM_TIER
+FAR struct mm_freenode_s *mm_tier_findchunk(FAR struct mm_heap_s *heap,
+                                            int ndx, size_t size);
+#endif
+
 /****************************************************************************
  * Inline Functions
  ****************************************************************************/
@@ -326,6 +387,14 @@ static inline_function void mm_addfreechunk(FAR struct mm_heap_s *heap,
   DEBUGASSERT(nodesize >= MM_MIN_CHUNK);
   DEBUGASSERT(MM_NODE_IS_FREE(node));
 
+#ifdef CONFIG_MM_IDLE_SCRUB
+  if ((node->size & MM_ZEROED_BIT) == 0)
+    {
+      heap->mm_scrubpending = true;
+      heap->mm_scrubgen++;
+    }
+#endif
+
   /* Convert the size to a nodelist index */
 
   ndx = mm_size2ndx(nodesize);
@@ -351,4 +420,33 @@ static inline_function void mm_addfreechunk(FAR struct mm_heap_s *heap,
     }
 }
 
+static inline_function void mm_delfreechunk(FAR struct mm_heap_s *heap,
+                                            FAR struct mm_freenode_s *node)
+{
+  /* There must be a predecessor, but there may not be a successor node */
+
+  DEBUGASSERT(node->blink);
+  node->blink->flink = node->flink;
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+
+#ifdef CONFIG_MM_IDLE_SCRUB
+  /* Stop clearing a chunk that is going to change, and resume the search
+   * from the chunk before it, which stays in the list.
+   */
+
+  if (heap->mm_scrubnode == node)
+    {
+      heap->mm_scrubnode = NULL;
+    }
+
+  if (heap->mm_scrubprev == node)
+    {
+      heap->mm_scrubprev = node->blink;
+    }
+#endif
+}
+
 #endif /* __MM_MM_HEAP_MM_H */
@@ -0,0 +1,571 @@
+/****************************************************************************
+ * mm/mm_heap/mm_heapprof.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <sys/types.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/kasan.h>
+#include <nuttx/mm/heapprof.h>
+
+#ifdef CONFIG_MM_HEAPPROF
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HEAPPROF_NSTACKS   CONFIG_MM_HEAPPROF_NSTACKS
+#define HEAPPROF_NSAMPLES  CONFIG_MM_HEAPPROF_NSAMPLES
+
+#if (HEAPPROF_NSTACKS & (HEAPPROF_NSTACKS - 1)) != 0
+#  error CONFIG_MM_HEAPPROF_NSTACKS must be a power of two
+#endif
+
+#if (HEAPPROF_NSAMPLES & (HEAPPROF_NSAMPLES - 1)) != 0
+#  error CONFIG_MM_HEAPPROF_NSAMPLES must be a power of two
+#endif
+
+/* A sampled address lives in one of the HEAPPROF_PROBE slots following its
+ * hash.  Samples that find all of them taken are dropped.
+ */
+
+#define HEAPPROF_PROBE     8
+
+/* The largest accepted sampling rate, which keeps the fixed point
+ * arithmetic of heapprof_interval() within 64 bits.
+ */
+
+#define HEAPPROF_MAXRATE   (1ul << 30)
+
+/* ln(2) in Q16 */
+
+#define HEAPPROF_LN2       45426
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One entry of the call stack hash table */
+
+struct heapprof_entry_s
+{
+  uint32_t hash;                        /* Hash of pc[], 0 if unused */
+  struct heapprof_stack_s stack;
+};
+
+/* One live sampled allocation.  Its address is kept in g_heapprof_addrs[]
+ * at the same index.
+ */
+
+struct heapprof_sample_s
+{
+  FAR struct mm_heap_s *heap;           /* Heap of the allocation */
+  size_t size;                          /* Bytes accounted to the stack */
+  uint16_t stack;                       /* Index into g_heapprof_stacks[] */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct heapprof_entry_s g_heapprof_stacks[HEAPPROF_NSTACKS];
+static struct heapprof_sample_s g_heapprof_samples[HEAPPROF_NSAMPLES];
+
+/* The addresses are kept apart from the samples so that heapprof_free()
+ * can search a probe window with a couple of cache line reads and without
+ * taking the lock.
+ */
+
+static FAR void *volatile g_heapprof_addrs[HEAPPROF_NSAMPLES];
+
+/* Bytes left to allocate on each CPU before the next sample is taken */
+
+static ssize_t g_heapprof_countdown[CONFIG_SMP_NCPUS];
+
+static size_t g_heapprof_rate = CONFIG_MM_HEAPPROF_RATE;
+static uint64_t g_heapprof_seed = 0x2545f4914f6cdd1dull;
+static unsigned int g_heapprof_nstacks;
+static volatile unsigned int g_heapprof_nlive;
+static unsigned long g_heapprof_dropped;
+static spinlock_t g_heapprof_lock = SP_UNLOCKED;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_neglog2
+ *
+ * Description:
+ *   Return -log2(x / 2^32) in Q16 for x in [1, 2^32), computing the
+ *   fractional bits by repeated squaring of the mantissa.
+ *
+ ****************************************************************************/
+
+static uint32_t heapprof_neglog2(uint32_t x)
+{
+  uint32_t frac = 0;
+  uint64_t m;
+  int exp;
+  int i;
+
+  exp = flsl(x) - 1;
+  m   = (uint64_t)x << (31 - exp);
+
+  for (i = 15; i >= 0; i--)
+    {
+      m = (m * m) >> 31;
+      if (m >= ((uint64_t)1 << 32))
+        {
+          m >>= 1;
+          frac |= 1u << i;
+        }
+    }
+
+  return ((uint32_t)(32 - exp) << 16) - frac;
+}
+
+/****************************************************************************
+ * Name: heapprof_interval
+ *
+ * Description:
+ *   Draw the number of bytes until the next sample from an exponential
+ *   distribution of mean 'rate', so that every allocated byte has the same
+ *   chance of being sampled (a Poisson process over the allocated bytes).
+ *
+ * Assumptions:
+ *   The caller holds g_heapprof_lock.
+ *
+ ****************************************************************************/
+
+static ssize_t heapprof_interval(size_t rate)
+{
+  uint64_t seed = g_heapprof_seed;
+  uint64_t interval;
+  uint32_t u;
+
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  g_heapprof_seed = seed;
+
+  u = (uint32_t)(seed >> 32);
+  if (u == 0)
+    {
+      u = 1;
+    }
+
+  /* -ln(u) = -log2(u) * ln(2) */
+
+  interval = ((uint64_t)rate * heapprof_neglog2(u)) >> 16;
+  interval = (interval * HEAPPROF_LN2) >> 16;
+  return (ssize_t)MIN(interval, SSIZE_MAX - 1) + 1;
+}
+
+/****************************************************************************
+ * Name: heapprof_addrhash
+ ****************************************************************************/
+
+static inline uint32_t heapprof_addrhash(FAR void *mem)
+{
+  uint32_t key = (uint32_t)((uintptr_t)mem >> 3);
+
+  key *= 2654435761u;
+  return key ^ (key >> 16);
+}
+
+/****************************************************************************
+ * Name: heapprof_find
+ *
+ * Description:
+ *   Return the slot holding the sampled address 'mem', or -1.  An address
+ *   never moves once it is stored, so the window can be searched without
+ *   the lock: if 'mem' is sampled, it was stored before its owner could
+ *   pass it to free().
+ *
+ ****************************************************************************/
+
+static int heapprof_find(FAR void *mem)
+{
+  uint32_t hash = heapprof_addrhash(mem);
+  int slot;
+  int i;
+
+  for (i = 0; i < HEAPPROF_PROBE; i++)
+    {
+      slot = (hash + i) & (HEAPPROF_NSAMPLES - 1);
+      if (g_heapprof_addrs[slot] == mem)
+        {
+          return slot;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: heapprof_stackhash
+ ****************************************************************************/
+
+static uint32_t heapprof_stackhash(FAR void **pc, int depth)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  for (i = 0; i < depth; i++)
+    {
+      hash = (hash ^ (uint32_t)(uintptr_t)pc[i]) * 16777619u;
+    }
+
+  return hash != 0 ? hash : 1;
+}
+
+/****************************************************************************
+ * Name: heapprof_stack
+ *
+ * Description:
+ *   Return the index of the entry of a call stack, adding it if needed, or
+ *   -1 if the table is full.
+ *
+ * Assumptions:
+ *   The caller holds g_heapprof_lock.
+ *
+ ****************************************************************************/
+
+static int heapprof_stack(FAR void **pc, int depth)
+{
+  FAR struct heapprof_entry_s *entry;
+  uint32_t hash = heapprof_stackhash(pc, depth);
+  int index;
+  int i;
+
+  for (i = 0; i < HEAPPROF_NSTACKS; i++)
+    {
+      index = (hash + i) & (HEAPPROF_NSTACKS - 1);
+      entry = &g_heapprof_stacks[index];
+
+      if (entry->hash == 0)
+        {
+          entry->hash        = hash;
+          entry->stack.depth = depth;
+          memcpy(entry->stack.pc, pc, depth * sizeof(FAR void *));
+          g_heapprof_nstacks++;
+          return index;
+        }
+
+      if (entry->hash == hash && entry->stack.depth == depth &&
+          memcmp(entry->stack.pc, pc, depth * sizeof(FAR void *)) == 0)
+        {
+          return index;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: heapprof_record
+ *
+ * Description:
+ *   Account a sampled allocation to its call stack and remember its
+ *   address until it is freed.
+ *
+ * Assumptions:
+ *   The caller holds g_heapprof_lock.
+ *
+ ****************************************************************************/
+
+static void heapprof_record(FAR struct mm_heap_s *heap, FAR void *mem,
+                            size_t size, FAR void **pc, int depth)
+{
+  FAR struct heapprof_stack_s *stack;
+  uint32_t hash = heapprof_addrhash(mem);
+  int index;
+  int slot;
+  int i;
+
+  for (i = 0; i < HEAPPROF_PROBE; i++)
+    {
+      slot = (hash + i) & (HEAPPROF_NSAMPLES - 1);
+      if (g_heapprof_addrs[slot] == NULL)
+        {
+          break;
+        }
+    }
+
+  index = i < HEAPPROF_PROBE ? heapprof_stack(pc, depth) : -1;
+  if (index < 0)
+    {
+      g_heapprof_dropped++;
+      return;
+    }
+
+  stack = &g_heapprof_stacks[index].stack;
+  stack->inuse_objs++;
+  stack->inuse_bytes += size;
+  stack->alloc_objs++;
+  stack->alloc_bytes += size;
+
+  g_heapprof_samples[slot].heap  = heap;
+  g_heapprof_samples[slot].size  = size;
+  g_heapprof_samples[slot].stack = index;
+  g_heapprof_addrs[slot]         = mem;
+  g_heapprof_nlive++;
+}
+
+/****************************************************************************
+ * Name: heapprof_release
+ *
+ * Assumptions:
+ *   The caller holds g_heapprof_lock.
+ *
+ ****************************************************************************/
+
+static void heapprof_release(int slot)
+{
+  FAR struct heapprof_sample_s *sample = &g_heapprof_samples[slot];
+  FAR struct heapprof_stack_s *stack;
+
+  stack = &g_heapprof_stacks[sample->stack].stack;
+  stack->inuse_objs--;
+  stack->inuse_bytes -= sample->size;
+
+  g_heapprof_addrs[slot] = NULL;
+  g_heapprof_nlive--;
+}
+
+/****************************************************************************
+ * Name: heapprof_sample
+ *
+ * Description:
+ *   The slow path of heapprof_alloc(), taken when the byte counter of this
+ *   CPU runs out.
+ *
+ ****************************************************************************/
+
+static noinline_function void
+heapprof_sample(FAR struct mm_heap_s *heap, FAR void *mem, size_t size,
+                FAR ssize_t *countdown)
+{
+  FAR void *pc[CONFIG_MM_HEAPPROF_DEPTH];
+  irqstate_t flags;
+  size_t rate = g_heapprof_rate;
+  int depth = -1;
+
+  /* Unwind before taking the lock, it is by far the slowest part */
+
+  if (rate != 0 && !up_interrupt_context())
+    {
+      depth = sched_backtrace(_SCHED_GETTID(), pc,
+                              CONFIG_MM_HEAPPROF_DEPTH,
+                              CONFIG_MM_HEAPPROF_SKIP);
+      depth = MAX(depth, 0);
+    }
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  *countdown = rate != 0 ? heapprof_interval(rate) : SSIZE_MAX;
+  if (depth >= 0)
+    {
+      heapprof_record(heap, mem, size, pc, depth);
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_alloc
+ ****************************************************************************/
+
+void heapprof_alloc(FAR struct mm_heap_s *heap, FAR void *mem, size_t size)
+{
+  FAR ssize_t *countdown;
+
+  if (mem == NULL)
+    {
+      return;
+    }
+
+  /* The counter is not protected: a thread migrating between the load and
+   * the store below may lose a decrement of another CPU.  That only shifts
+   * the next sampling point, which is random anyway.
+   */
+
+  countdown   = &g_heapprof_countdown[this_cpu()];
+  *countdown -= (ssize_t)size;
+  if (*countdown < 0)
+    {
+      heapprof_sample(heap, kasan_reset_tag(mem), size, countdown);
+    }
+}
+
+/****************************************************************************
+ * Name: heapprof_free
+ ****************************************************************************/
+
+void heapprof_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  irqstate_t flags;
+  int slot;
+
+  if (mem == NULL || g_heapprof_nlive == 0)
+    {
+      return;
+    }
+
+  mem  = kasan_reset_tag(mem);
+  slot = heapprof_find(mem);
+  if (slot < 0)
+    {
+      return;
+    }
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  /* heapprof_reset() may have run since the search */
+
+  if (g_heapprof_addrs[slot] == mem)
+    {
+      heapprof_release(slot);
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: heapprof_purge
+ ****************************************************************************/
+
+void heapprof_purge(FAR struct mm_heap_s *heap)
+{
+  irqstate_t flags;
+  int slot;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  for (slot = 0; slot < HEAPPROF_NSAMPLES; slot++)
+    {
+      if (g_heapprof_addrs[slot] != NULL &&
+          g_heapprof_samples[slot].heap == heap)
+        {
+          heapprof_release(slot);
+        }
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: heapprof_setrate
+ ****************************************************************************/
+
+void heapprof_setrate(size_t rate)
+{
+  irqstate_t flags;
+  int cpu;
+
+  rate  = MIN(rate, HEAPPROF_MAXRATE);
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  g_heapprof_rate = rate;
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      g_heapprof_countdown[cpu] = rate != 0 ?
+                                  heapprof_interval(rate) : SSIZE_MAX;
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: heapprof_reset
+ ****************************************************************************/
+
+void heapprof_reset(void)
+{
+  irqstate_t flags;
+  int slot;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  for (slot = 0; slot < HEAPPROF_NSAMPLES; slot++)
+    {
+      g_heapprof_addrs[slot] = NULL;
+    }
+
+  memset(g_heapprof_stacks, 0, sizeof(g_heapprof_stacks));
+  g_heapprof_nstacks = 0;
+  g_heapprof_nlive   = 0;
+  g_heapprof_dropped = 0;
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: heapprof_snapshot
+ ****************************************************************************/
+
+int heapprof_snapshot(FAR struct heapprof_info_s *info,
+                      FAR struct heapprof_stack_s *stacks, int nstacks)
+{
+  irqstate_t flags;
+  int count = 0;
+  int i;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  info->rate    = g_heapprof_rate;
+  info->nstacks = g_heapprof_nstacks;
+  info->nlive   = g_heapprof_nlive;
+  info->dropped = g_heapprof_dropped;
+
+  for (i = 0; i < HEAPPROF_NSTACKS && count < nstacks; i++)
+    {
+      if (g_heapprof_stacks[i].hash != 0)
+        {
+          stacks[count++] = g_heapprof_stacks[i].stack;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+  return count;
+}
+
+#endif /* CONFIG_MM_HEAPPROF */
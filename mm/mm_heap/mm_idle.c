@@ -0,0 +1,369 @@
+/****************************************************************************
+ * mm/mm_heap/mm_idle.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kthread.h>
+#include <nuttx/sched.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/mm/mm.h>
+
+#include "mm_heap/mm.h"
+
+#ifdef CONFIG_MM_IDLE_WORKER
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The heaps in the kernel address space */
+
+#if defined(CONFIG_MM_KERNEL_HEAP) && defined(CONFIG_BUILD_FLAT)
+#  define MM_IDLE_NHEAPS 2
+#else
+#  define MM_IDLE_NHEAPS 1
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/* The idle worker of one CPU.  The idle task cannot wait for the heap
+ * mutex, so it only wakes up a thread of the lowest priority to do the
+ * work, which then runs until a real thread is ready.
+ */
+
+struct mm_idle_s
+{
+  sem_t sem;                     /* Posted by the idle task of the CPU */
+  pid_t pid;                     /* The worker, 0 until it is started */
+  volatile bool posted;          /* The worker was woken up for some work */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct mm_idle_s g_mm_idle[CONFIG_SMP_NCPUS];
+static FAR struct mm_heap_s *g_mm_idleheap[MM_IDLE_NHEAPS];
+static int g_mm_nidleheaps;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_idle_pending
+ *
+ * Description:
+ *   Tell whether there is some work for the worker of a CPU.  The heap is
+ *   not locked, so this is only a hint.
+ *
+ ****************************************************************************/
+
+static bool mm_idle_pending(FAR struct mm_heap_s *heap, int cpu)
+{
+  /* Idle time is spent on any delayed free, however few */
+
+  if (heap->mm_delaylist[cpu] != NULL)
+    {
+      return true;
+    }
+
+#ifdef CONFIG_MM_IDLE_SCRUB
+  return heap->mm_scrubpending;
+#else
+  return false;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_scrub
+ *
+ * Description:
+ *   Clear up to budget bytes of the free chunks not cleared yet, with the
+ *   heap locked.  The links at the beginning of a chunk are not cleared:
+ *   mm_malloc_zeroed() does it when the chunk is allocated.
+ *
+ *   The free lists are walked from where the previous call stopped, and
+ *   each chunk passed over is charged to the budget, so that a long run of
+ *   chunks already cleared does not hold the heap for long either.
+ *
+ * Returned Value:
+ *   true if some free chunk is still to be cleared.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_IDLE_SCRUB
+static bool mm_scrub(FAR struct mm_heap_s *heap, size_t budget)
+{
+  FAR struct mm_freenode_s *node = heap->mm_scrubnode;
+  size_t nodesize;
+  size_t nbytes;
+
+  while (budget > 0)
+    {
+      if (node == NULL)
+        {
+          /* Look at the chunk after the last one visited.  All the free
+           * lists are chained, with a zero sized mm_nodelist[] entry at
+           * the head of each.
+           */
+
+          node = heap->mm_scrubprev->flink;
+          if (node == NULL)
+            {
+              /* End of a pass.  Unless a chunk to clear was added since it
+               * began, possibly behind the cursor, everything is cleared.
+               */
+
+              heap->mm_scrubprev = &heap->mm_nodelist[0];
+              if (heap->mm_scrubgen == heap->mm_scrubpass)
+                {
+                  heap->mm_scrubpending = false;
+                  break;
+                }
+
+              heap->mm_scrubpass = heap->mm_scrubgen;
+              continue;
+            }
+
+          if (MM_SIZEOF_NODE(node) == 0 ||
+              (node->size & MM_ZEROED_BIT) != 0)
+            {
+              heap->mm_scrubprev = node;
+              node = NULL;
+              budget -= MIN(budget, sizeof(struct mm_freenode_s));
+              continue;
+            }
+
+          heap->mm_scrubofs = sizeof(struct mm_freenode_s);
+        }
+
+      nodesize = MM_SIZEOF_NODE(node);
+      nbytes = MIN(budget, nodesize - heap->mm_scrubofs);
+      memset((FAR char *)node + heap->mm_scrubofs, 0, nbytes);
+
+      heap->mm_scrubofs += nbytes;
+      heap->mm_scrubbed += nbytes;
+      budget -= nbytes;
+
+      if (heap->mm_scrubofs == nodesize)
+        {
+          node->size |= MM_ZEROED_BIT;
+          heap->mm_scrubprev = node;
+          node = NULL;
+        }
+    }
+
+  heap->mm_scrubnode = node;
+  return heap->mm_scrubpending;
+}
+#endif
+
+/****************************************************************************
+ * Name: mm_idle_work
+ *
+ * Description:
+ *   Do a bounded amount of work on one heap and return true if there is
+ *   more to do.
+ *
+ ****************************************************************************/
+
+static bool mm_idle_work(FAR struct mm_heap_s *heap)
+{
+  size_t nfreed;
+  bool more = false;
+
+  /* The delayed frees are taken from the list of this CPU */
+
+  nfreed = mm_drain_delaylist(heap);
+
+  if (nfreed > 0 || mm_idle_pending(heap, this_cpu()))
+    {
+      DEBUGVERIFY(mm_lock(heap));
+
+      heap->mm_idlefreed += nfreed;
+#ifdef CONFIG_MM_IDLE_SCRUB
+      more = mm_scrub(heap, CONFIG_MM_IDLE_SCRUB_BUDGET);
+#endif
+
+      mm_unlock(heap);
+    }
+
+  return more;
+}
+
+/****************************************************************************
+ * Name: mm_idle_worker
+ ****************************************************************************/
+
+static int mm_idle_worker(int argc, FAR char *argv[])
+{
+  FAR struct mm_idle_s *idle;
+  bool more;
+  int i;
+
+  DEBUGASSERT(argc == 2);
+  idle = &g_mm_idle[atoi(argv[1])];
+
+  for (; ; )
+    {
+      nxsem_wait_uninterruptible(&idle->sem);
+      idle->posted = false;
+
+      do
+        {
+          more = false;
+          for (i = 0; i < g_mm_nidleheaps; i++)
+            {
+              more |= mm_idle_work(g_mm_idleheap[i]);
+            }
+        }
+      while (more);
+    }
+
+  return OK;
+}
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_idleinfo
+ *
+ * Description:
+ *   Return the counters of the work done on a heap by the idle workers.
+ *
+ ****************************************************************************/
+
+void mm_idleinfo(FAR struct mm_heap_s *heap,
+                 FAR struct mm_idleinfo_s *info)
+{
+  memset(info, 0, sizeof(*info));
+  info->nfreed = heap->mm_idlefreed;
+#ifdef CONFIG_MM_IDLE_SCRUB
+  info->scrubbed = heap->mm_scrubbed;
+  info->nzeroed = heap->mm_nzeroed;
+#endif
+}
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/****************************************************************************
+ * Name: mm_idle_initialize
+ *
+ * Description:
+ *   Start the idle worker of each CPU, once the heaps are initialized.
+ *
+ ****************************************************************************/
+
+void mm_idle_initialize(void)
+{
+  FAR char *argv[2];
+  char arg[12];
+  pid_t pid;
+  int cpu;
+#ifdef CONFIG_SMP
+  cpu_set_t cpuset;
+#endif
+
+#ifdef CONFIG_MM_KERNEL_HEAP
+  g_mm_idleheap[g_mm_nidleheaps++] = g_kmmheap;
+#endif
+#ifdef CONFIG_BUILD_FLAT
+  g_mm_idleheap[g_mm_nidleheaps++] = USR_HEAP;
+#endif
+
+  for (cpu = 0; cpu < CONFIG_SMP_NCPUS; cpu++)
+    {
+      nxsem_init(&g_mm_idle[cpu].sem, 0, 0);
+
+      snprintf(arg, sizeof(arg), "%d", cpu);
+      argv[0] = arg;
+      argv[1] = NULL;
+
+      pid = kthread_create("mm_idle", SCHED_PRIORITY_MIN,
+                           CONFIG_MM_IDLE_STACKSIZE, mm_idle_worker, argv);
+      DEBUGASSERT(pid > 0);
+
+#ifdef CONFIG_SMP
+      /* The delay list of a CPU can only be taken on that CPU */
+
+      CPU_ZERO(&cpuset);
+      CPU_SET(cpu, &cpuset);
+      DEBUGVERIFY(nxsched_set_affinity(pid, sizeof(cpuset), &cpuset));
+#endif
+
+      g_mm_idle[cpu].pid = pid;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_idle
+ *
+ * Description:
+ *   Called from the idle loop of each CPU.  Wake the worker of the CPU up
+ *   if there is work for it.  This must not block.
+ *
+ ****************************************************************************/
+
+void mm_idle(void)
+{
+  int cpu = this_cpu();
+  FAR struct mm_idle_s *idle = &g_mm_idle[cpu];
+  int i;
+
+  if (idle->pid <= 0 || idle->posted)
+    {
+      return;
+    }
+
+  for (i = 0; i < g_mm_nidleheaps; i++)
+    {
+      if (mm_idle_pending(g_mm_idleheap[i], cpu))
+        {
+          idle->posted = true;
+          nxsem_post(&idle->sem);
+          break;
+        }
+    }
+}
+
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
+#endif /* CONFIG_MM_IDLE_WORKER */
@@ -48,34 +48,51 @@
  * Private Functions
  ****************************************************************************/
 
-#if defined(CONFIG_MM_HEAP_MEMPOOL) && CONFIG_MM_BACKTRACE >= 0
+#if defined(CONFIG_MM_HEAP_MEMPOOL) && \
+    (CONFIG_MM_BACKTRACE >= 0 || defined(CONFIG_MM_TIER))
+
+#if defined(CONFIG_MM_TIER) && \
+    (defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__))
+#  define MEMPOOL_TIER
+#endif
 
 /****************************************************************************
  * Name: mempool_memalign
  *
  * Description:
- *   This function call mm_memalign and set mm_backtrace pid to free pid
- *   avoid repeated calculation.
+ *   This function call mm_memalign_node and set mm_backtrace pid to free
+ *   pid avoid repeated calculation.  It is placed in the tier of
+ *   CONFIG_MM_TIER_MEMPOOL whatever the tier of the calling thread.
  ****************************************************************************/
 
 static FAR void *mempool_memalign(FAR void *arg, size_t alignment,
                                   size_t size)
 {
+#if CONFIG_MM_BACKTRACE >= 0
   FAR struct mm_allocnode_s *node;
+#endif
+#ifdef MEMPOOL_TIER
+  int tier = mm_threadtier(CONFIG_MM_TIER_MEMPOOL);
+#endif
   FAR void *ret;
 
-  ret = mm_memalign(arg, alignment, size);
+  ret = mm_memalign_node(arg, alignment, size);
+#ifdef MEMPOOL_TIER
+  mm_threadtier(tier);
+#endif
+#if CONFIG_MM_BACKTRACE >= 0
   if (ret)
     {
       node = (FAR struct mm_allocnode_s *)
       ((uintptr_t)ret - MM_SIZEOF_ALLOCNODE);
       node->pid = PID_MM_MEMPOOL;
     }
+#endif
 
   return ret;
 }
 #else
-#  define mempool_memalign mm_memalign
+#  define mempool_memalign mm_memalign_node
 #endif
 
 /****************************************************************************
@@ -196,6 +213,11 @@ void mm_addregion(FAR struct mm_heap_s *heap, FAR void *heapstart,
   heap->mm_heapend[idx]->preceding = node->size;
   MM_ADD_BACKTRACE(heap, heap->mm_heapend[idx]);
 
+#ifdef CONFIG_MM_TIER
+  heap->mm_regiontier[idx] = MM_TIER_NORMAL;
+  heap->mm_tiers |= 1 << MM_TIER_NORMAL;
+#endif
+
 #undef idx
 
 #if CONFIG_MM_REGIONS > 1
@@ -265,6 +287,10 @@ FAR struct mm_heap_s *mm_initialize(FAR const char *name,
       heap->mm_nodelist[i].blink     = &heap->mm_nodelist[i - 1];
     }
 
+#ifdef CONFIG_MM_IDLE_SCRUB
+  heap->mm_scrubprev = &heap->mm_nodelist[0];
+#endif
+
   /* Initialize the malloc mutex to one (to support one-at-
    * a-time access to private data sets).
    */
@@ -375,6 +401,8 @@ void mm_uninitialize(FAR struct mm_heap_s *heap)
   mempool_multiple_deinit(heap->mm_mpool);
 #endif
 
+  heapprof_purge(heap);
+
   for (i = 0; i < CONFIG_MM_REGIONS; i++)
     {
       kasan_unregister(heap->mm_heapstart[i]);
@@ -79,7 +79,7 @@ static void mallinfo_handler(FAR struct mm_allocnode_s *node, FAR void *arg)
 
       info->ordblks++;
       info->fordblks += nodesize;
-      if (node->size > (size_t)info->mxordblk)
+      if (nodesize > (size_t)info->mxordblk)
         {
           info->mxordblk = nodesize;
         }
@@ -33,6 +33,7 @@
 #include <nuttx/arch.h>
 #include <nuttx/mm/mm.h>
 #include <nuttx/mm/kasan.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/sched.h>
 #include <nuttx/sched_note.h>
 
@@ -52,13 +53,13 @@
  *  to false will only free delaylist when time is up if
  *  CONFIG_MM_FREE_DELAYCOUNT_MAX is enabled.
  *
- *  Return true if there is memory freed.
+ *  Return the number of memory nodes freed.
  *
  ****************************************************************************/
 
-static bool free_delaylist(FAR struct mm_heap_s *heap, bool force)
+static size_t free_delaylist(FAR struct mm_heap_s *heap, bool force)
 {
-  bool ret = false;
+  size_t ret = 0;
 #if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
   FAR struct mm_delaynode_s *tmp;
   irqstate_t flags;
@@ -75,7 +76,7 @@ static bool free_delaylist(FAR struct mm_heap_s *heap, bool force)
         heap->mm_delaycount[this_cpu()] < CONFIG_MM_FREE_DELAYCOUNT_MAX))
     {
       mm_unlock_irq(heap, flags);
-      return false;
+      return 0;
     }
 
   heap->mm_delaycount[this_cpu()] = 0;
@@ -85,10 +86,6 @@ static bool free_delaylist(FAR struct mm_heap_s *heap, bool force)
 
   mm_unlock_irq(heap, flags);
 
-  /* Test if the delayed is empty */
-
-  ret = tmp != NULL;
-
   while (tmp)
     {
       FAR void *address;
@@ -103,6 +100,7 @@ static bool free_delaylist(FAR struct mm_heap_s *heap, bool force)
        */
 
       mm_delayfree(heap, address, false);
+      ret++;
     }
 
 #endif
@@ -157,39 +155,42 @@ void mm_free_delaylist(FAR struct mm_heap_s *heap)
 }
 
 /****************************************************************************
- * Name: mm_malloc
+ * Name: mm_drain_delaylist
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
+ *   Free the whole delay list of this CPU, even below
+ *   CONFIG_MM_FREE_DELAYCOUNT_MAX, and return the number of memory nodes
+ *   freed.
  *
- *  8-byte alignment of the allocated data is assured.
+ ****************************************************************************/
+
+size_t mm_drain_delaylist(FAR struct mm_heap_s *heap)
+{
+  return free_delaylist(heap, true);
+}
+
+/****************************************************************************
+ * Name: mm_malloc_node
+ *
+ * Description:
+ *   Carve the allocation out of the free nodes of the heap.  Unlike
+ *   mm_malloc(), this never takes an object of the guarded pool or of the
+ *   memory pools, and does not account the allocation to the profiler.
+ *   *zeroed, if not NULL, is set when the chunk was cleared by the idle
+ *   workers and is left alone otherwise.
  *
  ****************************************************************************/
 
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+FAR void *mm_malloc_node(FAR struct mm_heap_s *heap, size_t size,
+                         FAR bool *zeroed)
 {
   FAR struct mm_freenode_s *node;
   size_t alignsize;
   size_t nodesize;
   FAR void *ret = NULL;
+  bool clean = false;
   int ndx;
 
-  /* Free the delay list first */
-
-  free_delaylist(heap, false);
-
-#ifdef CONFIG_MM_HEAP_MEMPOOL
-  if (heap->mm_mpool)
-    {
-      ret = mempool_multiple_alloc(heap->mm_mpool, size);
-      if (ret != NULL)
-        {
-          return ret;
-        }
-    }
-#endif
-
   /* Adjust the size to account for (1) the size of the allocated node and
    * (2) to make sure that it is aligned with MM_ALIGN and its size is at
    * least MM_MIN_CHUNK.
@@ -223,6 +224,13 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
    * other mm_nodelist[] entries.
    */
 
+#ifdef CONFIG_MM_TIER
+  node = mm_tier_findchunk(heap, ndx, alignsize);
+  if (node)
+    {
+      nodesize = MM_SIZEOF_NODE(node);
+    }
+#else
   for (node = heap->mm_nodelist[ndx].flink; node; node = node->flink)
     {
       DEBUGASSERT(node->blink->flink == node);
@@ -232,6 +240,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
           break;
         }
     }
+#endif
 
   /* If we found a node with non-zero size, then this is one to use. Since
    * the list is ordered, we know that it must be the best fitting chunk
@@ -244,16 +253,10 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      mm_delfreechunk(heap, node);
+      clean = (node->size & MM_ZEROED_BIT) != 0;
 
       /* Get a pointer to the next node in physical memory */
 
@@ -282,7 +285,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
           remainder = (FAR struct mm_freenode_s *)
             (((FAR char *)node) + alignsize);
 
-          remainder->size = remaining;
+          remainder->size = remaining | (node->size & MM_ZEROED_BIT);
 
           /* Adjust the size of the node under consideration */
 
@@ -316,8 +319,15 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
       /* Handle the case of an exact size match */
 
-      node->size |= MM_ALLOC_BIT;
+      node->size = (node->size & ~MM_ZEROED_BIT) | MM_ALLOC_BIT;
       ret = (FAR void *)((FAR char *)node + MM_SIZEOF_ALLOCNODE);
+
+#ifdef CONFIG_MM_IDLE_SCRUB
+      if (clean && zeroed != NULL)
+        {
+          heap->mm_nzeroed++;
+        }
+#endif
     }
 
   DEBUGASSERT(ret == NULL || mm_heapmember(heap, ret));
@@ -340,6 +350,17 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 #ifdef CONFIG_DEBUG_MM
       minfo("Allocated %p, size %zu\n", ret, alignsize);
 #endif
+
+      /* Only the links of the free node and the preceding size of the next
+       * node were written in a cleared chunk.
+       */
+
+      if (clean && zeroed != NULL)
+        {
+          memset(ret, 0, sizeof(struct mm_freenode_s) - MM_SIZEOF_ALLOCNODE);
+          *(FAR mmsize_t *)((FAR char *)node + nodesize) = 0;
+          *zeroed = true;
+        }
     }
 
 #if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
@@ -347,7 +368,16 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   else if (free_delaylist(heap, true))
     {
-      return mm_malloc(heap, size);
+      return mm_malloc_node(heap, size, zeroed);
+    }
+#endif
+
+#ifdef CONFIG_MM_SHRINKER
+  /* Try again after the kernel caches gave memory back */
+
+  else if (mm_shrink(alignsize) > 0)
+    {
+      return mm_malloc_node(heap, size, zeroed);
     }
 #endif
 
@@ -411,3 +441,68 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   DEBUGASSERT(ret == NULL || ((uintptr_t)ret) % MM_ALIGN == 0);
   return ret;
 }
+
+/****************************************************************************
+ * Name: mm_malloc_zeroed
+ *
+ * Description:
+ *   mm_malloc() that also sets *zeroed, if not NULL, to tell whether the
+ *   chunk was cleared by the idle workers.  The whole allocation then
+ *   reads as zero.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc_zeroed(FAR struct mm_heap_s *heap, size_t size,
+                           FAR bool *zeroed)
+{
+  FAR void *ret = NULL;
+
+  if (zeroed != NULL)
+    {
+      *zeroed = false;
+    }
+
+  /* Free the delay list first */
+
+  free_delaylist(heap, false);
+
+  if (kfence_sample())
+    {
+      ret = kfence_alloc(heap, size, MM_ALIGN);
+    }
+
+#ifdef CONFIG_MM_HEAP_MEMPOOL
+  if (ret == NULL && heap->mm_mpool)
+    {
+      ret = mempool_multiple_alloc(heap->mm_mpool, size);
+    }
+#endif
+
+  if (ret == NULL)
+    {
+      ret = mm_malloc_node(heap, size, zeroed);
+    }
+
+  if (ret != NULL)
+    {
+      heapprof_alloc(heap, ret, size);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  return mm_malloc_zeroed(heap, size, NULL);
+}
@@ -26,6 +26,8 @@
 
 #include <nuttx/config.h>
 
+#include <sys/param.h>
+
 #include <assert.h>
 #include <debug.h>
 
@@ -40,20 +42,21 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: mm_memalign
+ * Name: mm_memalign_node
  *
  * Description:
  *   memalign requests more than enough space from malloc, finds a region
  *   within that chunk that meets the alignment request and then frees any
  *   leading or trailing space.
  *
- *   The alignment argument must be a power of two. 16-byte alignment is
- *   guaranteed by normal malloc calls.
+ *   Like mm_malloc_node(), this only ever carves heap nodes and does not
+ *   account the allocation to the profiler.  The alignment argument must
+ *   be a power of two.
  *
  ****************************************************************************/
 
-FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
-                      size_t size)
+FAR void *mm_memalign_node(FAR struct mm_heap_s *heap, size_t alignment,
+                           size_t size)
 {
   FAR struct mm_allocnode_s *node;
   uintptr_t rawchunk;
@@ -62,38 +65,13 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
   size_t allocsize;
   size_t newsize;
 
-  /* Make sure that alignment is less than half max size_t */
-
-  if (alignment >= (SIZE_MAX / 2))
-    {
-      return NULL;
-    }
-
-  /* Make sure that alignment is a power of 2 */
-
-  if ((alignment & -alignment) != alignment)
-    {
-      return NULL;
-    }
-
-#ifdef CONFIG_MM_HEAP_MEMPOOL
-  if (heap->mm_mpool)
-    {
-      node = mempool_multiple_memalign(heap->mm_mpool, alignment, size);
-      if (node != NULL)
-        {
-          return node;
-        }
-    }
-#endif
-
   /* If this requested alinement's less than or equal to the natural
    * alignment of malloc, then just let malloc do the work.
    */
 
   if (alignment <= MM_ALIGN)
     {
-      FAR void *ptr = mm_malloc(heap, size);
+      FAR void *ptr = mm_malloc_node(heap, size, NULL);
       DEBUGASSERT(ptr == NULL || ((uintptr_t)ptr) % alignment == 0);
       return ptr;
     }
@@ -131,14 +109,18 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       return NULL;
     }
 
-  /* Then malloc that size */
+  /* Then malloc that size.  The chunk must be a heap node, so neither the
+   * guarded pool nor the memory pools may serve it.
+   */
 
-  rawchunk = (uintptr_t)mm_malloc(heap, allocsize);
+  rawchunk = (uintptr_t)mm_malloc_node(heap, allocsize, NULL);
   if (rawchunk == 0)
     {
       return NULL;
     }
 
+  DEBUGASSERT(!kfence_is_object((FAR void *)rawchunk));
+
   kasan_poison((FAR void *)rawchunk,
                mm_malloc_size(heap, (FAR void *)rawchunk));
 
@@ -209,16 +191,9 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
           FAR struct mm_freenode_s *prev =
             (FAR struct mm_freenode_s *)((FAR char *)node - node->preceding);
 
-          /* Remove the node.  There must be a predecessor, but there may
-           * not be a successor node.
-           */
+          /* Remove the node */
 
-          DEBUGASSERT(prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          mm_delfreechunk(heap, prev);
 
           precedingsize += MM_SIZEOF_NODE(prev);
           node = (FAR struct mm_allocnode_s *)prev;
@@ -292,3 +267,56 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
         rawchunk, alignedchunk, size);
   return (FAR void *)alignedchunk;
 }
+
+/****************************************************************************
+ * Name: mm_memalign
+ *
+ * Description:
+ *   Allocate size bytes aligned to alignment, which must be a power of
+ *   two.  16-byte alignment is guaranteed by normal malloc calls.
+ *
+ ****************************************************************************/
+
+FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
+                      size_t size)
+{
+  FAR void *ret = NULL;
+
+  /* Make sure that alignment is less than half max size_t */
+
+  if (alignment >= (SIZE_MAX / 2))
+    {
+      return NULL;
+    }
+
+  /* Make sure that alignment is a power of 2 */
+
+  if ((alignment & -alignment) != alignment)
+    {
+      return NULL;
+    }
+
+  if (kfence_sample())
+    {
+      ret = kfence_alloc(heap, size, MAX(alignment, MM_ALIGN));
+    }
+
+#ifdef CONFIG_MM_HEAP_MEMPOOL
+  if (ret == NULL && heap->mm_mpool)
+    {
+      ret = mempool_multiple_memalign(heap->mm_mpool, alignment, size);
+    }
+#endif
+
+  if (ret == NULL)
+    {
+      ret = mm_memalign_node(heap, alignment, size);
+    }
+
+  if (ret != NULL)
+    {
+      heapprof_alloc(heap, ret, size);
+    }
+
+  return ret;
+}
@@ -86,12 +86,34 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
   DEBUGASSERT(mm_heapmember(heap, oldmem));
 
+  /* A reallocation is profiled as a new allocation.  The sample of the old
+   * one is dropped first, before its memory can be handed out again, even
+   * if the reallocation fails below.
+   */
+
+  heapprof_free(heap, oldmem);
+
+  /* Objects of the guarded pool are always moved back to the heap */
+
+  if (kfence_is_object(oldmem))
+    {
+      newmem = mm_malloc(heap, size);
+      if (newmem != NULL)
+        {
+          memcpy(newmem, oldmem, MIN(size, kfence_size(oldmem)));
+          mm_free(heap, oldmem);
+        }
+
+      return newmem;
+    }
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
       newmem = mempool_multiple_realloc(heap->mm_mpool, oldmem, size);
       if (newmem != NULL)
         {
+          heapprof_alloc(heap, newmem, size);
           return newmem;
         }
       else if (size <= heap->mm_threshold ||
@@ -115,12 +137,8 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
    * least MM_MIN_CHUNK.
    */
 
-  if (size < MM_MIN_CHUNK - MM_ALLOCNODE_OVERHEAD)
-    {
-      size = MM_MIN_CHUNK - MM_ALLOCNODE_OVERHEAD;
-    }
-
-  newsize = MM_ALIGN_UP(size + MM_ALLOCNODE_OVERHEAD);
+  newsize = MM_ALIGN_UP(MAX(size, MM_MIN_CHUNK - MM_ALLOCNODE_OVERHEAD) +
+                        MM_ALLOCNODE_OVERHEAD);
   if (newsize < size)
     {
       /* There must have been an integer overflow */
@@ -160,6 +178,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
       mm_unlock(heap);
       MM_ADD_BACKTRACE(heap, oldnode);
+      heapprof_alloc(heap, oldmem, size);
 
       return oldmem;
     }
@@ -252,16 +271,10 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
         {
           FAR struct mm_allocnode_s *newnode;
 
-          /* Remove the previous node.  There must be a predecessor, but
-           * there may not be a successor node.
-           */
+          /* Remove the previous node */
 
-          DEBUGASSERT(prev && prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          DEBUGASSERT(prev);
+          mm_delfreechunk(heap, prev);
 
           /* Make sure the new previous node has enough space */
 
@@ -326,16 +339,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
           andbeyond = (FAR struct mm_allocnode_s *)
                       ((FAR char *)next + nextsize);
 
-          /* Remove the next node.  There must be a predecessor, but there
-           * may not be a successor node.
-           */
+          /* Remove the next node */
 
-          DEBUGASSERT(next->blink);
-          next->blink->flink = next->flink;
-          if (next->flink)
-            {
-              next->flink->blink = next->blink;
-            }
+          mm_delfreechunk(heap, next);
 
           /* Make sure the new next node has enough space */
 
@@ -392,6 +398,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
       newmem = kasan_unpoison(newmem, MM_SIZEOF_NODE(oldnode) -
                               MM_ALLOCNODE_OVERHEAD);
+      heapprof_alloc(heap, newmem, size);
       if (kasan_reset_tag(newmem) != kasan_reset_tag(oldmem))
         {
           /* Now we have to move the user contents 'down' in memory.  memcpy
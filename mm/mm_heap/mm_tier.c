@@ -0,0 +1,324 @@
+/****************************************************************************
+ * mm/mm_heap/mm_tier.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/mm.h>
+
+#include "mm_heap/mm.h"
+
+#ifdef CONFIG_MM_TIER
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mm_tierinfo_s
+{
+  FAR struct mm_heap_s *heap;
+  struct mallinfo info;
+  int tier;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tierof
+ *
+ * Description:
+ *   Return the tier of the region holding a node, -1 if none does.
+ *
+ ****************************************************************************/
+
+static int mm_tierof(FAR struct mm_heap_s *heap, FAR void *node)
+{
+  int i;
+
+  for (i = 0; i < heap->mm_nregions; i++)
+    {
+      if (node >= (FAR void *)heap->mm_heapstart[i] &&
+          node <= (FAR void *)heap->mm_heapend[i])
+        {
+          return heap->mm_regiontier[i];
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: mm_tier_search
+ *
+ * Description:
+ *   Return the smallest free node of at least size bytes in the given tier,
+ *   or in any tier if tier is negative.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_freenode_s *
+mm_tier_search(FAR struct mm_heap_s *heap, int ndx, size_t size, int tier)
+{
+  FAR struct mm_freenode_s *node;
+
+  for (node = heap->mm_nodelist[ndx].flink; node; node = node->flink)
+    {
+      DEBUGASSERT(node->blink->flink == node);
+      if (MM_SIZEOF_NODE(node) >= size &&
+          (tier < 0 || mm_tierof(heap, node) == tier))
+        {
+          break;
+        }
+    }
+
+  return node;
+}
+
+static void mm_tier_handler(FAR struct mm_allocnode_s *node, FAR void *arg)
+{
+  FAR struct mm_tierinfo_s *tierinfo = arg;
+  FAR struct mallinfo *info = &tierinfo->info;
+  size_t nodesize = MM_SIZEOF_NODE(node);
+
+  if (mm_tierof(tierinfo->heap, node) != tierinfo->tier)
+    {
+      return;
+    }
+
+  if (MM_NODE_IS_ALLOC(node))
+    {
+      info->aordblks++;
+      info->uordblks += nodesize;
+    }
+  else
+    {
+      info->ordblks++;
+      info->fordblks += nodesize;
+      if (nodesize > (size_t)info->mxordblk)
+        {
+          info->mxordblk = nodesize;
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tier_findchunk
+ *
+ * Description:
+ *   Find the free node an allocation of size bytes is carved from.  The
+ *   tier asked by the calling thread, MM_TIER_NORMAL by default, is tried
+ *   first, then the slower tiers from the fastest, then the faster ones
+ *   from the slowest, so that fast memory is used by other allocations
+ *   only when nothing else is left.
+ *
+ * Assumptions:
+ *   The caller holds the heap lock.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_tier_findchunk(FAR struct mm_heap_s *heap,
+                                            int ndx, size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  int hint = MM_TIER_NORMAL;
+  int ntiers = MM_NTIERS;
+  int tier;
+  int i;
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+  if (!up_interrupt_context() && nxsched_self()->mm_tier != 0)
+    {
+      hint = nxsched_self()->mm_tier - 1;
+    }
+#endif
+
+  if ((hint & MM_TIER_STRICT) != 0)
+    {
+      hint &= ~MM_TIER_STRICT;
+      ntiers = 1;
+    }
+
+  for (i = 0; i < ntiers; i++)
+    {
+      tier = i < MM_NTIERS - hint ? hint + i : MM_NTIERS - 1 - i;
+      if ((heap->mm_tiers & (1 << tier)) == 0)
+        {
+          continue;
+        }
+
+      /* Nothing to filter out if the heap only has this tier */
+
+      node = mm_tier_search(heap, ndx, size,
+                            heap->mm_tiers == (1 << tier) ? -1 : tier);
+      if (node != NULL)
+        {
+          return node;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mm_regiontier
+ *
+ * Description:
+ *   Set the tier of the heap region holding an address.
+ *
+ * Input Parameters:
+ *   heap - The heap
+ *   mem  - Any address in the region, or the start given to
+ *          mm_initialize() or mm_addregion() when it was added
+ *   tier - MM_TIER_FAST, MM_TIER_NORMAL or MM_TIER_SLOW
+ *
+ * Returned Value:
+ *   Zero on success; -EINVAL if the tier is invalid, -ENOENT if no region
+ *   holds mem.
+ *
+ ****************************************************************************/
+
+int mm_regiontier(FAR struct mm_heap_s *heap, FAR void *mem, int tier)
+{
+  FAR char *start;
+  FAR char *end;
+  int region = -1;
+  int i;
+
+  if (tier < 0 || tier >= MM_NTIERS)
+    {
+      return -EINVAL;
+    }
+
+  DEBUGVERIFY(mm_lock(heap));
+
+  for (i = 0; i < heap->mm_nregions; i++)
+    {
+      start = (FAR char *)heap->mm_heapstart[i];
+      end   = (FAR char *)heap->mm_heapend[i] + MM_SIZEOF_ALLOCNODE;
+      if ((FAR char *)mem >= start && (FAR char *)mem < end)
+        {
+          region = i;
+          break;
+        }
+
+      /* The start given to mm_initialize() or mm_addregion() precedes the
+       * region by the alignment and, for the first one, the heap itself.
+       */
+
+      if ((FAR char *)mem < start &&
+          start - (FAR char *)mem < sizeof(struct mm_heap_s) + 2 * MM_ALIGN)
+        {
+          region = i;
+        }
+    }
+
+  if (region >= 0)
+    {
+      heap->mm_regiontier[region] = tier;
+      heap->mm_tiers = 0;
+      for (i = 0; i < heap->mm_nregions; i++)
+        {
+          heap->mm_tiers |= 1 << heap->mm_regiontier[i];
+        }
+    }
+
+  mm_unlock(heap);
+  return region >= 0 ? OK : -ENOENT;
+}
+
+/****************************************************************************
+ * Name: mm_threadtier
+ *
+ * Description:
+ *   Set the tier the calling thread allocates from, until changed again.
+ *   The allocations served by the heap mempool are placed according to
+ *   CONFIG_MM_TIER_MEMPOOL instead.
+ *
+ * Input Parameters:
+ *   tier - MM_TIER_FAST, MM_TIER_NORMAL or MM_TIER_SLOW, optionally or-ed
+ *          with MM_TIER_STRICT, or a negative value for the default.
+ *
+ * Returned Value:
+ *   The previous tier of the thread, to be given back to restore it.
+ *
+ ****************************************************************************/
+
+int mm_threadtier(int tier)
+{
+  FAR struct tcb_s *tcb = nxsched_self();
+  int prev = tcb->mm_tier - 1;
+
+  DEBUGASSERT(tier < 0 || (tier & ~MM_TIER_STRICT) < MM_NTIERS);
+
+  tcb->mm_tier = tier < 0 ? 0 : tier + 1;
+  return prev;
+}
+
+/****************************************************************************
+ * Name: mm_mallinfo_tier
+ *
+ * Description:
+ *   Return the usage of the regions of a tier, like mm_mallinfo() does for
+ *   the whole heap.  The blocks of the heap mempool are all accounted as
+ *   used here.
+ *
+ ****************************************************************************/
+
+struct mallinfo mm_mallinfo_tier(FAR struct mm_heap_s *heap, int tier)
+{
+  struct mm_tierinfo_s tierinfo;
+  int i;
+
+  memset(&tierinfo, 0, sizeof(tierinfo));
+  tierinfo.heap = heap;
+  tierinfo.tier = tier;
+  mm_foreach(heap, mm_tier_handler, &tierinfo);
+
+  for (i = 0; i < heap->mm_nregions; i++)
+    {
+      if (heap->mm_regiontier[i] == tier)
+        {
+          tierinfo.info.arena += (uintptr_t)heap->mm_heapend[i] -
+                                 (uintptr_t)heap->mm_heapstart[i] +
+                                 MM_SIZEOF_ALLOCNODE;
+        }
+    }
+
+  return tierinfo.info;
+}
+
+#endif /* CONFIG_MM_TIER */
@@ -30,6 +30,8 @@
 
 #include <nuttx/mm/mm.h>
 
+#include "mm_heap/mm.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -38,14 +40,16 @@
  * Name: mm_zalloc
  *
  * Description:
- *   mm_zalloc calls mm_malloc, then zeroes out the allocated chunk.
+ *   mm_zalloc calls mm_malloc, then zeroes out the allocated chunk unless
+ *   it was already cleared by the idle workers.
  *
  ****************************************************************************/
 
 FAR void *mm_zalloc(FAR struct mm_heap_s *heap, size_t size)
 {
-  FAR void *alloc = mm_malloc(heap, size);
-  if (alloc)
+  bool zeroed;
+  FAR void *alloc = mm_malloc_zeroed(heap, size, &zeroed);
+  if (alloc && !zeroed)
     {
        memset(alloc, 0, size);
     }
@@ -0,0 +1,168 @@
+/****************************************************************************
+ * mm/shrinker/shrinker.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+#include <assert.h>
+#include <debug.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/init.h>
+#include <nuttx/mutex.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/shrinker.h>
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The list of shrinkers.  The lock is held for the whole of a reclaim, so
+ * that a shrinker is never unregistered while being scanned.
+ */
+
+static dq_queue_t g_shrinkers;
+static mutex_t g_shrinker_lock = NXMUTEX_INITIALIZER;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_register_shrinker
+ ****************************************************************************/
+
+void mm_register_shrinker(FAR struct shrinker_s *shrinker)
+{
+  DEBUGASSERT(shrinker->count != NULL && shrinker->scan != NULL);
+
+  nxmutex_lock(&g_shrinker_lock);
+  dq_addlast(&shrinker->node, &g_shrinkers);
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_unregister_shrinker
+ ****************************************************************************/
+
+void mm_unregister_shrinker(FAR struct shrinker_s *shrinker)
+{
+  nxmutex_lock(&g_shrinker_lock);
+  dq_rem(&shrinker->node, &g_shrinkers);
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_shrink
+ ****************************************************************************/
+
+size_t mm_shrink(size_t size)
+{
+  FAR struct shrinker_s *shrinker;
+  FAR dq_entry_t *entry;
+  size_t freed = 0;
+  size_t nbytes;
+
+  /* Nothing is registered until the OS is up, which also keeps the early
+   * boot allocations away from the mutex below.
+   */
+
+  if (dq_empty(&g_shrinkers) || up_interrupt_context() ||
+      _SCHED_GETTID() < 0)
+    {
+      return 0;
+    }
+
+  /* A scan() running out of memory must not reclaim recursively */
+
+  if (nxmutex_is_hold(&g_shrinker_lock))
+    {
+      return 0;
+    }
+
+  /* The idle task must never wait for the lock, and may not even try it
+   * once it runs the idle loop.
+   */
+
+  if (sched_idletask())
+    {
+      if (OSINIT_IDLELOOP() || nxmutex_trylock(&g_shrinker_lock) < 0)
+        {
+          return 0;
+        }
+    }
+  else if (nxmutex_lock(&g_shrinker_lock) < 0)
+    {
+      return 0;
+    }
+
+  for (entry = dq_peek(&g_shrinkers); entry != NULL && freed < size;
+       entry = dq_next(entry))
+    {
+      shrinker = (FAR struct shrinker_s *)entry;
+
+      nbytes = shrinker->count(shrinker);
+      if (nbytes == 0)
+        {
+          continue;
+        }
+
+      nbytes = MIN(nbytes, size - freed);
+      shrinker->nscan++;
+      shrinker->scanned += nbytes;
+
+      nbytes = shrinker->scan(shrinker, nbytes);
+      shrinker->freed += nbytes;
+      freed += nbytes;
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+
+  minfo("Wanted %zu bytes, released %zu\n", size, freed);
+  return freed;
+}
+
+/****************************************************************************
+ * Name: mm_shrinker_foreach
+ ****************************************************************************/
+
+void mm_shrinker_foreach(CODE void (*handler)(FAR struct shrinker_s *,
+                                              FAR void *),
+                         FAR void *arg)
+{
+  FAR dq_entry_t *entry;
+
+  nxmutex_lock(&g_shrinker_lock);
+
+  for (entry = dq_peek(&g_shrinkers); entry != NULL;
+       entry = dq_next(entry))
+    {
+      handler((FAR struct shrinker_s *)entry, arg);
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+}
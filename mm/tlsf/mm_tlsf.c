@@ -42,6 +42,7 @@
 #include <nuttx/mm/mm.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/mm/mempool.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/sched_note.h>
 
 #include "tlsf/tlsf.h"
@@ -1403,6 +1404,15 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Try again after the kernel caches gave memory back */
+
+  else if (mm_shrink(size) > 0)
+    {
+      return mm_malloc(heap, size);
+    }
+#endif
+
   return ret;
 }
 
@@ -37,6 +37,7 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/init.h>
 #include <nuttx/macro.h>
+#include <nuttx/mm/mm.h>
 #include <nuttx/symtab.h>
 #include <nuttx/trace.h>
 #include <nuttx/wqueue.h>
@@ -521,6 +522,12 @@ int nx_bringup(void)
 
   nx_workqueues();
 
+#ifdef CONFIG_MM_IDLE_WORKER
+  /* Start the threads that do the heap maintenance in idle time */
+
+  mm_idle_initialize();
+#endif
+
   /* Once the operating system has been initialized, the system must be
    * started by spawning the user initialization thread of execution.  This
    * will be the first user-mode thread.
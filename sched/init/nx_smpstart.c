@@ -33,6 +33,7 @@
 
 #include <nuttx/arch.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/mm/mm.h>
 #include <nuttx/sched.h>
 #include <nuttx/sched_note.h>
 #include <nuttx/init.h>
@@ -87,6 +88,12 @@ void nx_idle_trampoline(void)
 
   for (; ; )
     {
+#ifdef CONFIG_MM_IDLE_WORKER
+      /* Let the heap maintenance run before going to sleep */
+
+      mm_idle();
+#endif
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
@@ -404,6 +404,12 @@ static void idle_task_initialize(void)
       tcb->flags = TCB_FLAG_TTYPE_KERNEL;
 #endif
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+      /* All tasks inherit the timer slack of the IDLE task */
+
+      tcb->timer_slack = USEC2TICK(CONFIG_SCHED_TICKLESS_SLACK);
+#endif
+
 #if CONFIG_TASK_NAME_SIZE > 0
       /* Set the IDLE task name */
 
@@ -777,6 +783,12 @@ void nx_start(void)
 #ifndef CONFIG_DISABLE_IDLE_LOOP
   for (; ; )
     {
+#ifdef CONFIG_MM_IDLE_WORKER
+      /* Let the heap maintenance run before going to sleep */
+
+      mm_idle();
+#endif
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
@@ -32,6 +32,8 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/mqueue.h>
 
+#include "mqueue/mqueue.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -79,6 +81,13 @@ int file_mq_getattr(FAR struct file *mq, FAR struct mq_attr *mq_stat)
   mq_stat->mq_flags   = mq->f_oflags;
   mq_stat->mq_curmsgs = msgq->nmsgs;
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  if (msgq->zc != NULL)
+    {
+      mq_stat->mq_curmsgs = nxmq_zc_count(msgq->zc);
+    }
+#endif
+
   return 0;
 }
 
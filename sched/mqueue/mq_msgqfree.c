@@ -68,6 +68,15 @@ void nxmq_free_msgq(FAR struct mqueue_inode_s *msgq)
       nxmq_free_msg(entry);
     }
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* Release the zero-copy ring together with any message left in it */
+
+  if (msgq->zc != NULL)
+    {
+      kmm_free(msgq->zc);
+    }
+#endif
+
   /* Then deallocate the message queue itself */
 
   kmm_free(msgq);
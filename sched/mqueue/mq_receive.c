@@ -173,6 +173,15 @@ ssize_t file_mq_timedreceive_internal(FAR struct file *mq, FAR char *msg,
 
   msgq = mq->f_inode->i_private;
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* Messages go through the zero-copy ring once it is attached */
+
+  if (msgq->zc != NULL)
+    {
+      return nxmq_zc_receive(mq, msg, msglen, prio, abstime, ticks);
+    }
+#endif
+
   /* Furthermore, nxmq_wait_receive() expects to have interrupts disabled
    * because messages can be sent from interrupt level.
    */
@@ -306,6 +306,15 @@ int file_mq_timedsend_internal(FAR struct file *mq, FAR const char *msg,
 
   msgq = mq->f_inode->i_private;
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* Messages go through the zero-copy ring once it is attached */
+
+  if (msgq->zc != NULL)
+    {
+      return nxmq_zc_send(mq, msg, msglen, prio, abstime, ticks);
+    }
+#endif
+
   /* Pre-allocate a message structure */
 
   mqmsg = nxmq_alloc_msg(msglen);
@@ -0,0 +1,841 @@
+/****************************************************************************
+ * sched/mqueue/mq_zerocopy.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/param.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/atomic.h>
+#include <nuttx/cancelpt.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mqueue.h>
+
+#include "sched/sched.h"
+#include "mqueue/mqueue.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmq_zc_msgq
+ *
+ * Description:
+ *   Return the message queue of the descriptor if it has a zero-copy ring
+ *   attached.
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_inode_s *nxmq_zc_msgq(FAR struct file *mq)
+{
+  FAR struct mqueue_inode_s *msgq;
+
+  if (mq == NULL || mq->f_inode == NULL)
+    {
+      return NULL;
+    }
+
+  msgq = mq->f_inode->i_private;
+  if (msgq == NULL || msgq->zc == NULL)
+    {
+      return NULL;
+    }
+
+  return msgq;
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_slot
+ *
+ * Description:
+ *   Return the slot that backs the ring position pos.
+ *
+ ****************************************************************************/
+
+static inline_function FAR struct mqueue_zcslot_s *
+nxmq_zc_slot(FAR struct mqueue_zc_s *zc, uint32_t pos)
+{
+  return (FAR struct mqueue_zcslot_s *)
+    (zc->slots + (pos & zc->mask) * zc->slotsize);
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_buf2slot
+ *
+ * Description:
+ *   Map a payload address handed out by the ring back to its slot,
+ *   rejecting addresses that do not belong to the ring.
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_zcslot_s *
+nxmq_zc_buf2slot(FAR struct mqueue_zc_s *zc, FAR void *buf)
+{
+  FAR uint8_t *hdr = (FAR uint8_t *)buf - MQ_ZC_HDRSIZE;
+  size_t offset;
+
+  if (buf == NULL || hdr < zc->slots)
+    {
+      return NULL;
+    }
+
+  offset = hdr - zc->slots;
+  if (offset % zc->slotsize != 0 || offset / zc->slotsize > zc->mask)
+    {
+      return NULL;
+    }
+
+  return (FAR struct mqueue_zcslot_s *)hdr;
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_tryget
+ *
+ * Description:
+ *   Try to claim a slot without blocking.  A producer claims the slot at
+ *   enqpos once it has been released by the consumers, a consumer claims
+ *   the slot at deqpos once it has been committed by the producers.
+ *
+ * Input Parameters:
+ *   zc       - The zero-copy ring
+ *   consumer - True to claim a committed slot, false to claim a free slot
+ *
+ * Returned Value:
+ *   The claimed slot, or NULL if the ring is full (producer) or empty
+ *   (consumer).
+ *
+ ****************************************************************************/
+
+static FAR struct mqueue_zcslot_s *
+nxmq_zc_tryget(FAR struct mqueue_zc_s *zc, bool consumer)
+{
+  FAR struct mqueue_zcslot_s *slot;
+  FAR atomic_t *claim = consumer ? &zc->deqpos : &zc->enqpos;
+  int32_t pos = atomic_read(claim);
+  int32_t dif;
+
+  for (; ; )
+    {
+      slot = nxmq_zc_slot(zc, pos);
+      dif  = (int32_t)((uint32_t)atomic_read_acquire(&slot->seq) -
+                       (uint32_t)pos - (consumer ? 1 : 0));
+      if (dif == 0)
+        {
+          /* The slot is ready for us.  With a single producer and a single
+           * consumer nobody else can race for it.
+           */
+
+          if ((zc->flags & MQ_ZC_SPSC) != 0)
+            {
+              atomic_set(claim, pos + 1);
+              break;
+            }
+
+          /* On failure pos is reloaded with the current claim position */
+
+          if (atomic_cmpxchg_relaxed(claim, &pos, pos + 1))
+            {
+              break;
+            }
+        }
+      else if (dif < 0)
+        {
+          return NULL;
+        }
+      else
+        {
+          pos = atomic_read(claim);
+        }
+    }
+
+  slot->pos = pos;
+  return slot;
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_timeout
+ *
+ * Description:
+ *   This function is called if the timeout elapses before a slot becomes
+ *   available.
+ *
+ ****************************************************************************/
+
+static void nxmq_zc_timeout(wdparm_t arg)
+{
+  FAR struct tcb_s *wtcb = (FAR struct tcb_s *)(uintptr_t)arg;
+  irqstate_t flags;
+
+  flags = enter_critical_section();
+
+  if (wtcb->task_state == TSTATE_WAIT_MQNOTEMPTY ||
+      wtcb->task_state == TSTATE_WAIT_MQNOTFULL)
+    {
+      nxmq_wait_irq(wtcb, ETIMEDOUT);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_get
+ *
+ * Description:
+ *   Claim a slot, blocking on the message queue wait lists if the ring is
+ *   full (producer) or empty (consumer) and the descriptor allows it.
+ *
+ * Input Parameters:
+ *   mq       - Message queue descriptor
+ *   consumer - True to claim a committed slot, false to claim a free slot
+ *   abstime  - If non-NULL, the absolute time to wait until
+ *   ticks    - If non-negative, the relative time to wait in ticks
+ *   pslot    - Location to return the claimed slot
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int nxmq_zc_get(FAR struct file *mq, bool consumer,
+                       FAR const struct timespec *abstime, sclock_t ticks,
+                       FAR struct mqueue_zcslot_s **pslot)
+{
+  FAR struct mqueue_inode_s *msgq = mq->f_inode->i_private;
+  FAR struct mqueue_zc_s *zc = msgq->zc;
+  FAR struct tcb_s *rtcb;
+  irqstate_t flags;
+  int ret = OK;
+
+  /* Fast path: no locks, no system state touched */
+
+  *pslot = nxmq_zc_tryget(zc, consumer);
+  if (*pslot != NULL)
+    {
+      return OK;
+    }
+
+  if (up_interrupt_context() || (mq->f_oflags & O_NONBLOCK) != 0)
+    {
+      return -EAGAIN;
+    }
+
+  flags = enter_critical_section();
+
+#ifdef CONFIG_CANCELLATION_POINTS
+  if (check_cancellation_point())
+    {
+      leave_critical_section(flags);
+      return -ECANCELED;
+    }
+#endif
+
+  /* Announce ourselves before checking the ring again.  This pairs with
+   * the read-modify-write in nxmq_zc_wakeup(): either the peer sees us
+   * waiting, or we see the slot it has just published.
+   */
+
+  atomic_fetch_add_acquire(&zc->nwaiters, 1);
+
+  rtcb = this_task();
+  if (abstime)
+    {
+      wd_start_realtime(&rtcb->waitdog, abstime,
+                        nxmq_zc_timeout, (wdparm_t)rtcb);
+    }
+  else if (ticks >= 0)
+    {
+      wd_start(&rtcb->waitdog, ticks,
+               nxmq_zc_timeout, (wdparm_t)rtcb);
+    }
+
+  while ((*pslot = nxmq_zc_tryget(zc, consumer)) == NULL)
+    {
+      rtcb->waitobj = msgq;
+      rtcb->errcode = OK;
+
+      DEBUGASSERT(!is_idle_task(rtcb));
+
+      nxsched_remove_self(rtcb);
+
+      if (consumer)
+        {
+          msgq->cmn.nwaitnotempty++;
+          rtcb->task_state = TSTATE_WAIT_MQNOTEMPTY;
+          nxsched_add_prioritized(rtcb, MQ_WNELIST(msgq->cmn));
+        }
+      else
+        {
+          msgq->cmn.nwaitnotfull++;
+          rtcb->task_state = TSTATE_WAIT_MQNOTFULL;
+          nxsched_add_prioritized(rtcb, MQ_WNFLIST(msgq->cmn));
+        }
+
+      up_switch_context(this_task(), rtcb);
+
+      /* We were either woken by a peer or interrupted by a signal or by
+       * the timeout.
+       */
+
+      if (rtcb->errcode != OK)
+        {
+          ret = -rtcb->errcode;
+          break;
+        }
+    }
+
+  if (abstime || ticks >= 0)
+    {
+      wd_cancel(&rtcb->waitdog);
+    }
+
+  atomic_fetch_sub_release(&zc->nwaiters, 1);
+  leave_critical_section(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_wakeup
+ *
+ * Description:
+ *   Wake up one task blocked on the ring after a slot was committed
+ *   (notempty true) or released (notempty false).  Nothing but a single
+ *   atomic operation is done when nobody is waiting.
+ *
+ ****************************************************************************/
+
+static void nxmq_zc_wakeup(FAR struct mqueue_inode_s *msgq, bool notempty)
+{
+  int32_t expect = 0;
+  irqstate_t flags;
+
+  /* A task registered with mq_notify() is signalled even though nobody
+   * blocks on the ring: that is the very case notification is for.
+   */
+
+  if (atomic_cmpxchg(&msgq->zc->nwaiters, &expect, 0)
+#ifndef CONFIG_DISABLE_MQUEUE_NOTIFICATION
+      && (!notempty || msgq->ntpid == INVALID_PROCESS_ID)
+#endif
+     )
+    {
+      return;
+    }
+
+  flags = enter_critical_section();
+
+  if (notempty)
+    {
+      nxmq_notify_send(msgq);
+    }
+  else
+    {
+      nxmq_notify_receive(msgq);
+    }
+
+  leave_critical_section(flags);
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_publish
+ *
+ * Description:
+ *   Hand a claimed slot over to the other side of the ring.  The slot must
+ *   have been claimed in the current lap of the ring and not have been
+ *   handed over yet: a producer's slot still has seq equal to its position,
+ *   a consumer's slot position + 1.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -EINVAL if the slot is not in the right state,
+ *   e.g. when it is committed or released twice.
+ *
+ ****************************************************************************/
+
+static int nxmq_zc_publish(FAR struct mqueue_inode_s *msgq,
+                           FAR struct mqueue_zcslot_s *slot,
+                           bool commit)
+{
+  FAR struct mqueue_zc_s *zc = msgq->zc;
+  FAR atomic_t *claim = commit ? &zc->enqpos : &zc->deqpos;
+  uint32_t pos = slot->pos;
+  int32_t expect = pos + (commit ? 0 : 1);
+
+  if ((uint32_t)atomic_read(claim) - pos - 1 > zc->mask ||
+      !atomic_cmpxchg_release(&slot->seq, &expect,
+                              pos + (commit ? 1 : zc->mask + 1)))
+    {
+      return -EINVAL;
+    }
+
+  nxmq_zc_wakeup(msgq, commit);
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmq_zc_count
+ *
+ * Description:
+ *   Return the number of messages reserved or committed but not yet
+ *   released in the ring.
+ *
+ ****************************************************************************/
+
+uint32_t nxmq_zc_count(FAR struct mqueue_zc_s *zc)
+{
+  return (uint32_t)atomic_read(&zc->enqpos) -
+         (uint32_t)atomic_read(&zc->deqpos);
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_send
+ *
+ * Description:
+ *   Copy a message into the zero-copy ring.  This is used by
+ *   file_mq_timedsend() and friends once a ring is attached to the queue.
+ *   The input parameters are verified by the caller.
+ *
+ ****************************************************************************/
+
+int nxmq_zc_send(FAR struct file *mq, FAR const char *msg, size_t msglen,
+                 unsigned int prio, FAR const struct timespec *abstime,
+                 sclock_t ticks)
+{
+  FAR struct mqueue_inode_s *msgq = mq->f_inode->i_private;
+  FAR struct mqueue_zcslot_s *slot;
+  int ret;
+
+  ret = nxmq_zc_get(mq, false, abstime, ticks, &slot);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  memcpy((FAR uint8_t *)slot + MQ_ZC_HDRSIZE, msg, msglen);
+  slot->msglen   = msglen;
+  slot->priority = prio;
+
+  return nxmq_zc_publish(msgq, slot, true);
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_receive
+ *
+ * Description:
+ *   Copy the oldest message out of the zero-copy ring.  This is used by
+ *   file_mq_timedreceive() and friends once a ring is attached to the
+ *   queue.  The input parameters are verified by the caller.
+ *
+ ****************************************************************************/
+
+ssize_t nxmq_zc_receive(FAR struct file *mq, FAR char *msg, size_t msglen,
+                        FAR unsigned int *prio,
+                        FAR const struct timespec *abstime,
+                        sclock_t ticks)
+{
+  FAR struct mqueue_inode_s *msgq = mq->f_inode->i_private;
+  FAR struct mqueue_zcslot_s *slot;
+  ssize_t ret;
+
+  ret = nxmq_zc_get(mq, true, abstime, ticks, &slot);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (prio)
+    {
+      *prio = slot->priority;
+    }
+
+  ret = MIN(msglen, slot->msglen);
+  memcpy(msg, (FAR uint8_t *)slot + MQ_ZC_HDRSIZE, ret);
+
+  nxmq_zc_publish(msgq, slot, false);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: file_mq_zc_setup
+ *
+ * Description:
+ *   Attach a pre-allocated zero-copy message ring to the message queue.
+ *
+ * Input Parameters:
+ *   mq    - Message queue descriptor
+ *   flags - Zero or MQ_ZC_SPSC
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_setup(FAR struct file *mq, int flags)
+{
+  FAR struct mqueue_inode_s *msgq;
+  FAR struct mqueue_zc_s *zc;
+  irqstate_t irqflags;
+  uint32_t nslots = 2;
+  uint32_t i;
+  int ret = OK;
+
+  if (mq == NULL || mq->f_inode == NULL || mq->f_inode->i_private == NULL ||
+      (flags & ~MQ_ZC_SPSC) != 0)
+    {
+      return -EINVAL;
+    }
+
+  msgq = mq->f_inode->i_private;
+
+  /* The ring size must be a power of two so that positions may simply
+   * wrap around, and at least two so that a released slot can be told
+   * from a committed one.
+   */
+
+  while (nslots < msgq->maxmsgs)
+    {
+      nslots <<= 1;
+    }
+
+  zc = kmm_zalloc(sizeof(struct mqueue_zc_s) + nslots *
+                  ALIGN_UP(MQ_ZC_HDRSIZE + msgq->maxmsgsize,
+                           sizeof(uintptr_t)));
+  if (zc == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  zc->mask     = nslots - 1;
+  zc->slotsize = ALIGN_UP(MQ_ZC_HDRSIZE + msgq->maxmsgsize,
+                          sizeof(uintptr_t));
+  zc->flags    = flags;
+  zc->slots    = (FAR uint8_t *)(zc + 1);
+
+  for (i = 0; i < nslots; i++)
+    {
+      atomic_set(&nxmq_zc_slot(zc, i)->seq, i);
+    }
+
+  /* The ring may only be attached to an idle queue: a task blocked in
+   * mq_send() or mq_receive() would wait on the message list for good,
+   * and would share the wait lists with the tasks waiting on the ring.
+   */
+
+  irqflags = enter_critical_section();
+  if (msgq->zc != NULL || msgq->nmsgs > 0 ||
+      msgq->cmn.nwaitnotempty > 0 || msgq->cmn.nwaitnotfull > 0)
+    {
+      ret = -EBUSY;
+    }
+  else
+    {
+      msgq->zc = zc;
+    }
+
+  leave_critical_section(irqflags);
+
+  if (ret < 0)
+    {
+      kmm_free(zc);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: file_mq_zc_reserve
+ *
+ * Description:
+ *   Reserve one free slot in the zero-copy ring of the message queue.
+ *
+ * Input Parameters:
+ *   mq      - Message queue descriptor
+ *   buf     - Location to return the address of the slot payload
+ *   abstime - The absolute time to wait until a timeout is declared
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_reserve(FAR struct file *mq, FAR void **buf,
+                       FAR const struct timespec *abstime)
+{
+  FAR struct mqueue_zcslot_s *slot;
+  int ret;
+
+  if (nxmq_zc_msgq(mq) == NULL || buf == NULL ||
+      (abstime && (abstime->tv_nsec < 0 ||
+                   abstime->tv_nsec >= 1000000000)))
+    {
+      return -EINVAL;
+    }
+
+  if ((mq->f_oflags & O_WROK) == 0)
+    {
+      return -EBADF;
+    }
+
+  ret = nxmq_zc_get(mq, false, abstime, -1, &slot);
+  if (ret >= 0)
+    {
+      *buf = (FAR uint8_t *)slot + MQ_ZC_HDRSIZE;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: file_mq_zc_commit
+ *
+ * Description:
+ *   Publish a slot obtained from file_mq_zc_reserve() to the consumers.
+ *
+ * Input Parameters:
+ *   mq     - Message queue descriptor
+ *   buf    - The payload address returned by file_mq_zc_reserve()
+ *   msglen - The length of the message in bytes
+ *   prio   - The priority of the message
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_commit(FAR struct file *mq, FAR void *buf, size_t msglen,
+                      unsigned int prio)
+{
+  FAR struct mqueue_inode_s *msgq = nxmq_zc_msgq(mq);
+  FAR struct mqueue_zcslot_s *slot;
+
+  if (msgq == NULL || prio >= MQ_PRIO_MAX ||
+      (slot = nxmq_zc_buf2slot(msgq->zc, buf)) == NULL)
+    {
+      return -EINVAL;
+    }
+
+  if (msglen > (size_t)msgq->maxmsgsize)
+    {
+      return -EMSGSIZE;
+    }
+
+  /* Check the state before writing the header of a slot which may
+   * already belong to a consumer.
+   */
+
+  if ((uint32_t)atomic_read_acquire(&slot->seq) != slot->pos)
+    {
+      return -EINVAL;
+    }
+
+  slot->msglen   = msglen;
+  slot->priority = prio;
+
+  return nxmq_zc_publish(msgq, slot, true);
+}
+
+/****************************************************************************
+ * Name: file_mq_zc_borrow
+ *
+ * Description:
+ *   Borrow the oldest committed message from the zero-copy ring.
+ *
+ * Input Parameters:
+ *   mq      - Message queue descriptor
+ *   buf     - Location to return the address of the message payload
+ *   prio    - If not NULL, the location to store message priority
+ *   abstime - The absolute time to wait until a timeout is declared
+ *
+ * Returned Value:
+ *   The length of the message on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+ssize_t file_mq_zc_borrow(FAR struct file *mq, FAR void **buf,
+                          FAR unsigned int *prio,
+                          FAR const struct timespec *abstime)
+{
+  FAR struct mqueue_zcslot_s *slot;
+  int ret;
+
+  if (nxmq_zc_msgq(mq) == NULL || buf == NULL ||
+      (abstime && (abstime->tv_nsec < 0 ||
+                   abstime->tv_nsec >= 1000000000)))
+    {
+      return -EINVAL;
+    }
+
+  if ((mq->f_oflags & O_RDOK) == 0)
+    {
+      return -EBADF;
+    }
+
+  ret = nxmq_zc_get(mq, true, abstime, -1, &slot);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (prio)
+    {
+      *prio = slot->priority;
+    }
+
+  *buf = (FAR uint8_t *)slot + MQ_ZC_HDRSIZE;
+  return slot->msglen;
+}
+
+/****************************************************************************
+ * Name: file_mq_zc_release
+ *
+ * Description:
+ *   Return a slot obtained from file_mq_zc_borrow() to the producers.
+ *
+ * Input Parameters:
+ *   mq  - Message queue descriptor
+ *   buf - The payload address returned by file_mq_zc_borrow()
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int file_mq_zc_release(FAR struct file *mq, FAR void *buf)
+{
+  FAR struct mqueue_inode_s *msgq = nxmq_zc_msgq(mq);
+  FAR struct mqueue_zcslot_s *slot;
+
+  if (msgq == NULL || (slot = nxmq_zc_buf2slot(msgq->zc, buf)) == NULL)
+    {
+      return -EINVAL;
+    }
+
+  return nxmq_zc_publish(msgq, slot, false);
+}
+
+/****************************************************************************
+ * Name: nxmq_zc_setup, nxmq_zc_reserve, nxmq_zc_commit, nxmq_zc_borrow,
+ *       nxmq_zc_release
+ *
+ * Description:
+ *   The descriptor based variants of the file_mq_zc_* interfaces.
+ *
+ ****************************************************************************/
+
+int nxmq_zc_setup(mqd_t mqdes, int flags)
+{
+  FAR struct file *filep;
+  int ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = file_mq_zc_setup(filep, flags);
+  fs_putfilep(filep);
+  return ret;
+}
+
+int nxmq_zc_reserve(mqd_t mqdes, FAR void **buf,
+                    FAR const struct timespec *abstime)
+{
+  FAR struct file *filep;
+  int ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = file_mq_zc_reserve(filep, buf, abstime);
+  fs_putfilep(filep);
+  return ret;
+}
+
+int nxmq_zc_commit(mqd_t mqdes, FAR void *buf, size_t msglen,
+                   unsigned int prio)
+{
+  FAR struct file *filep;
+  int ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = file_mq_zc_commit(filep, buf, msglen, prio);
+  fs_putfilep(filep);
+  return ret;
+}
+
+ssize_t nxmq_zc_borrow(mqd_t mqdes, FAR void **buf, FAR unsigned int *prio,
+                       FAR const struct timespec *abstime)
+{
+  FAR struct file *filep;
+  ssize_t ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = file_mq_zc_borrow(filep, buf, prio, abstime);
+  fs_putfilep(filep);
+  return ret;
+}
+
+int nxmq_zc_release(mqd_t mqdes, FAR void *buf)
+{
+  FAR struct file *filep;
+  int ret;
+
+  ret = fs_getfilep(mqdes, &filep);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ret = file_mq_zc_release(filep, buf);
+  fs_putfilep(filep);
+  return ret;
+}
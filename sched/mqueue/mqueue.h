@@ -37,6 +37,8 @@
 #include <mqueue.h>
 #include <sched.h>
 
+#include <nuttx/atomic.h>
+#include <nuttx/nuttx.h>
 #include <nuttx/spinlock.h>
 #include <nuttx/mqueue.h>
 
@@ -78,6 +80,43 @@ struct mqueue_msg_s
   char mail[1];            /* Message data */
 };
 
+#ifdef CONFIG_MQ_ZEROCOPY
+/* This structure is the header of one slot in a zero-copy message ring.
+ * The message payload follows the header at MQ_ZC_HDRSIZE.
+ */
+
+struct mqueue_zcslot_s
+{
+  atomic_t seq;            /* Slot sequence number */
+  uint32_t pos;            /* Ring position of the current owner */
+#if MQ_MAX_BYTES < 256
+  uint8_t msglen;          /* Message data length */
+#else
+  uint16_t msglen;         /* Message data length */
+#endif
+  uint8_t priority;        /* Priority of message */
+};
+
+/* This structure describes the zero-copy message ring of one queue.  It is
+ * a bounded ring with one sequence number per slot: a producer owns a slot
+ * once seq equals its position, a consumer once seq equals position + 1.
+ */
+
+struct mqueue_zc_s
+{
+  atomic_t enqpos;         /* Next position to reserve */
+  atomic_t deqpos;         /* Next position to borrow */
+  atomic_t nwaiters;       /* Number of tasks blocked on the ring */
+  uint32_t mask;           /* Number of slots - 1 */
+  uint16_t slotsize;       /* Size of one slot including the header */
+  uint8_t flags;           /* See MQ_ZC_* definitions */
+  FAR uint8_t *slots;      /* Slot storage */
+};
+
+#  define MQ_ZC_HDRSIZE \
+     ALIGN_UP(sizeof(struct mqueue_zcslot_s), sizeof(uintptr_t))
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -142,6 +181,19 @@ void nxmq_notify_send(FAR struct mqueue_inode_s *msgq);
 
 void nxmq_recover(FAR struct tcb_s *tcb);
 
+/* mq_zerocopy.c ************************************************************/
+
+#ifdef CONFIG_MQ_ZEROCOPY
+int nxmq_zc_send(FAR struct file *mq, FAR const char *msg, size_t msglen,
+                 unsigned int prio, FAR const struct timespec *abstime,
+                 sclock_t ticks);
+ssize_t nxmq_zc_receive(FAR struct file *mq, FAR char *msg, size_t msglen,
+                        FAR unsigned int *prio,
+                        FAR const struct timespec *abstime,
+                        sclock_t ticks);
+uint32_t nxmq_zc_count(FAR struct mqueue_zc_s *zc);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -412,6 +412,12 @@ void nxsched_suspend_critmon(FAR struct tcb_s *tcb);
 void nxsched_update_critmon(FAR struct tcb_s *tcb);
 #endif
 
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+void nxsched_critmon_ready(FAR struct tcb_s *tcb);
+#else
+#  define nxsched_critmon_ready(t)
+#endif
+
 #if CONFIG_SCHED_CRITMONITOR_MAXTIME_PREEMPTION >= 0
 void nxsched_critmon_preemption(FAR struct tcb_s *tcb, bool state,
                                 FAR void *caller);
@@ -562,4 +568,24 @@ static inline_function int nxsched_select_cpu(cpu_set_t affinity)
   return cpu;
 }
 #  endif
+
+/* Allocate the stack of a new thread in the tier of CONFIG_MM_TIER_STACK,
+ * whatever the tier of the creating thread.
+ */
+
+#ifdef CONFIG_MM_TIER
+static inline_function int nxsched_create_stack(FAR struct tcb_s *tcb,
+                                                size_t stack_size,
+                                                uint8_t ttype)
+{
+  int tier = mm_threadtier(CONFIG_MM_TIER_STACK);
+  int ret = up_create_stack(tcb, stack_size, ttype);
+
+  mm_threadtier(tier);
+  return ret;
+}
+#else
+#  define nxsched_create_stack(tcb, stack_size, ttype) \
+     up_create_stack(tcb, stack_size, ttype)
+#endif
 #endif /* __SCHED_SCHED_SCHED_H */
@@ -31,6 +31,7 @@
 #include <assert.h>
 #include <debug.h>
 #include <time.h>
+#include <strings.h>
 
 #include "sched/sched.h"
 
@@ -261,6 +262,35 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state,
 }
 #endif /* CONFIG_SCHED_CRITMONITOR_MAXTIME_CSECTION >= 0 */
 
+/****************************************************************************
+ * Name: nxsched_critmon_ready
+ *
+ * Description:
+ *   Called when a thread leaves a blocked list, and again when it is made
+ *   ready-to-run.  Records the time from which the thread starts waiting
+ *   for a CPU.
+ *
+ * Assumptions:
+ *   - Called within a critical section.
+ *   - Might be called from an interrupt handler
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+void nxsched_critmon_ready(FAR struct tcb_s *tcb)
+{
+  /* Only a blocked thread starts waiting: a thread already removed from
+   * its blocked list by nxsched_remove_blocked(), or moved between the
+   * pending and ready-to-run lists, keeps the time it was stamped with.
+   */
+
+  if (tcb->task_state >= FIRST_BLOCKED_STATE)
+    {
+      tcb->ready_start = perf_gettime();
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: nxsched_resume_critmon
  *
@@ -277,6 +307,10 @@ void nxsched_critmon_csection(FAR struct tcb_s *tcb, bool state,
 void nxsched_resume_critmon(FAR struct tcb_s *tcb)
 {
   clock_t current = perf_gettime();
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  clock_t elapsed;
+  int bucket = 0;
+#endif
 
   UNUSED(current);
 
@@ -284,6 +318,34 @@ void nxsched_resume_critmon(FAR struct tcb_s *tcb)
   tcb->run_start = current;
 #endif
 
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  /* Account the time the thread was ready but waiting for the CPU */
+
+  elapsed = current - tcb->ready_start;
+  tcb->wait_time += elapsed;
+  if (elapsed > tcb->wait_max)
+    {
+      tcb->wait_max = elapsed;
+    }
+
+  /* Bucket n holds latencies in [2^(n-1), 2^n) ticks */
+
+  if (elapsed > 0)
+    {
+#  ifdef CONFIG_SYSTEM_TIME64
+      bucket = flsll(elapsed);
+#  else
+      bucket = fls(elapsed);
+#  endif
+      if (bucket >= CONFIG_SCHED_CRITMONITOR_LATENCY_NBUCKETS)
+        {
+          bucket = CONFIG_SCHED_CRITMONITOR_LATENCY_NBUCKETS - 1;
+        }
+    }
+
+  tcb->wait_hist[bucket]++;
+#endif
+
 #if CONFIG_SCHED_CRITMONITOR_MAXTIME_PREEMPTION >= 0
   /* Did this task disable pre-emption? */
 
@@ -342,6 +404,14 @@ void nxsched_suspend_critmon(FAR struct tcb_s *tcb)
     }
 #endif
 
+#ifdef CONFIG_SCHED_CRITMONITOR_LATENCY
+  /* If the thread is pre-empted it starts waiting for the CPU right now.
+   * If it blocks instead, the time is overwritten when it is woken up.
+   */
+
+  tcb->ready_start = current;
+#endif
+
 #if CONFIG_SCHED_CRITMONITOR_MAXTIME_PREEMPTION >= 0
   /* Did this task disable preemption? */
 
@@ -70,6 +70,12 @@ void nxsched_remove_blocked(FAR struct tcb_s *btcb)
 
   dq_rem((FAR dq_entry_t *)btcb, TLIST_BLOCKED(btcb));
 
+  /* The wait for a CPU starts here: callers like nxtask_activate() leave
+   * the task in the invalid state before making it ready-to-run.
+   */
+
+  nxsched_critmon_ready(btcb);
+
   /* Indicate that the wait is over. */
 
   btcb->waitobj = NULL;
@@ -202,7 +202,7 @@ FAR struct task_tcb_s *nxtask_setup_fork(start_t retaddr)
   stack_size = (uintptr_t)ptcb->stack_base_ptr -
                (uintptr_t)ptcb->stack_alloc_ptr + ptcb->adj_stack_size;
 
-  ret = up_create_stack(&child->cmn, stack_size, ttype);
+  ret = nxsched_create_stack(&child->cmn, stack_size, ttype);
   if (ret < OK)
     {
       goto errout_with_tcb;
@@ -160,7 +160,7 @@ int nxtask_init(FAR struct task_tcb_s *tcb, const char *name, int priority,
     {
       /* Allocate the stack for the TCB */
 
-      ret = up_create_stack(&tcb->cmn, stack_size, ttype);
+      ret = nxsched_create_stack(&tcb->cmn, stack_size, ttype);
     }
 
   if (ret < OK)
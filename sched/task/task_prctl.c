@@ -27,7 +27,9 @@
 #include <nuttx/config.h>
 
 #include <sys/prctl.h>
+#include <sys/param.h>
 #include <stdarg.h>
+#include <limits.h>
 #include <string.h>
 #include <errno.h>
 #include <debug.h>
@@ -148,17 +150,42 @@ int prctl(int option, ...)
         goto errout;
 #endif
 
+      case PR_SET_TIMERSLACK:
+      case PR_GET_TIMERSLACK:
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+        {
+          FAR struct tcb_s *tcb = this_task();
+
+          if (option == PR_SET_TIMERSLACK)
+            {
+              /* Rounded up, so a non-zero slack never gets lost */
+
+              tcb->timer_slack = NSEC2TICK(va_arg(ap, unsigned long));
+            }
+          else
+            {
+              va_end(ap);
+              return MIN(TICK2NSEC((uint64_t)tcb->timer_slack), INT_MAX);
+            }
+        }
+        break;
+#else
+        serr("ERROR: Option not enabled: %d\n", option);
+        errcode = ENOSYS;
+        goto errout;
+#endif
+
       default:
         serr("ERROR: Unrecognized option: %d\n", option);
         errcode = EINVAL;
         goto errout;
     }
 
-  /* Not reachable unless CONFIG_TASK_NAME_SIZE is > 0.  NOTE: This might
-   * change if additional commands are supported.
+  /* Not reachable unless CONFIG_TASK_NAME_SIZE is > 0 or the timer slack
+   * is supported.
    */
 
-#if CONFIG_TASK_NAME_SIZE > 0
+#if CONFIG_TASK_NAME_SIZE > 0 || defined(CONFIG_SCHED_TICKLESS_COALESCE)
   va_end(ap);
   return OK;
 #endif
@@ -463,6 +463,12 @@ static int nxthread_setup_scheduler(FAR struct tcb_s *tcb, int priority,
 
       tcb->sigprocmask = rtcb->sigprocmask;
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+      /* The timer slack is inherited as well */
+
+      tcb->timer_slack = rtcb->timer_slack;
+#endif
+
       /* Initialize the task state.  It does not get a valid state
        * until it is activated.
        */
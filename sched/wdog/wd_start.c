@@ -90,6 +90,22 @@
 static unsigned int g_wdtimernested;
 #endif
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+/* The deadline returned by the last wd_timer(), which may lie after the
+ * expiration of the head of the list.
+ */
+
+static clock_t g_wddeadline;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+unsigned long g_wdcoalesced;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -115,6 +131,11 @@ static inline_function void wd_expiration(clock_t ticks)
   irqstate_t flags;
   wdentry_t func;
   wdparm_t arg;
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  unsigned int ndeadlines = 0;
+  bool deferred = false;
+  clock_t last = 0;
+#endif
 
   flags = spin_lock_irqsave(&g_wdspinlock);
 
@@ -141,6 +162,18 @@ static inline_function void wd_expiration(clock_t ticks)
           break;
         }
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+      /* Count the distinct deadlines handled by this interrupt */
+
+      if (ndeadlines == 0 || wdog->expired != last)
+        {
+          last = wdog->expired;
+          ndeadlines++;
+        }
+
+      deferred |= wdog->slack > 0;
+#endif
+
       /* Remove the watchdog from the head of the list */
 
       list_delete(&wdog->node);
@@ -167,6 +200,17 @@ static inline_function void wd_expiration(clock_t ticks)
   g_wdtimernested--;
 #endif
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  /* Without the slack every other deadline would have needed its own
+   * timer interrupt.
+   */
+
+  if (deferred && ndeadlines > 1)
+    {
+      g_wdcoalesced += ndeadlines - 1;
+    }
+#endif
+
   spin_unlock_irqrestore(&g_wdspinlock, flags);
 }
 
@@ -310,8 +354,23 @@ int wd_start_abstick(FAR struct wdog_s *wdog, clock_t ticks,
       wdog->func = NULL;
     }
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  /* The timeouts of a thread may be deferred by its timer slack */
+
+  wdog->slack = up_interrupt_context() ? 0 : this_task()->timer_slack;
+#endif
+
   wd_insert(wdog, ticks, wdentry, arg);
 
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  /* The timer may be programmed past the head of the list, for its slack:
+   * a watchdog which cannot wait until then needs it to be reprogrammed,
+   * even if it does not become the head.
+   */
+
+  reassess |= !clock_compare(g_wddeadline, wdog->expired + wdog->slack);
+#endif
+
   if (!g_wdtimernested &&
       (reassess || list_is_head(&g_wdactivelist, &wdog->node)))
     {
@@ -428,6 +487,9 @@ clock_t wd_timer(clock_t ticks, bool noswitches)
   FAR struct wdog_s *wdog;
   irqstate_t flags;
   sclock_t ret;
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  clock_t next;
+#endif
 
   /* Check if the watchdog at the head of the list is ready to run */
 
@@ -451,7 +513,31 @@ clock_t wd_timer(clock_t ticks, bool noswitches)
    */
 
   wdog = list_first_entry(&g_wdactivelist, struct wdog_s, node);
+
+#ifdef CONFIG_SCHED_TICKLESS_COALESCE
+  /* Wake up at the latest time that is still within the slack of every
+   * watchdog due before it, so that they expire with one interrupt.
+   */
+
+  next = wdog->expired + wdog->slack;
+  list_for_every_entry(&g_wdactivelist, wdog, struct wdog_s, node)
+    {
+      if (!clock_compare(wdog->expired, next))
+        {
+          break;
+        }
+
+      if (clock_compare(wdog->expired + wdog->slack, next))
+        {
+          next = wdog->expired + wdog->slack;
+        }
+    }
+
+  g_wddeadline = next;
+  ret = next - ticks;
+#else
   ret = wdog->expired - ticks;
+#endif
 
   spin_unlock_irqrestore(&g_wdspinlock, flags);
 
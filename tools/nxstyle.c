@@ -618,6 +618,16 @@ static const char *g_white_content_list[] =
   "unzGoToNextFile",
   "unzGoToFirstFile",
 
+  /* Ref:
+   * fs/zipfs/zip_index.c
+   */
+
+  "unzGetCurrentFileZStreamPos64",
+  "inflateInit2",
+  "inflateReset",
+  "inflatePrime",
+  "inflateSetDictionary",
+
   /* Ref:
    * apps/netutils/telnetc/telnetc.c
    */
@@ -0,0 +1,405 @@
+#!/usr/bin/env python3
+############################################################################
+# tools/prelink.py
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+############################################################################
+
+"""Prelink a relocatable ELF module so that its read-only sections execute
+in place.
+
+The loader normally copies every section of a module to RAM and relocates
+it there.  When the file lives on memory mapped media (romfs on XIP flash,
+tmpfs), the read-only sections could be used where they are, except that
+their relocations would have to be written to the media.  This tool applies
+those relocations ahead of time, for the address the file will be mapped
+at, removes them and records that address in the sh_addr of the read-only
+sections.  The loader then uses these sections in place and only copies
+and relocates the writable ones, refusing the module if it is mapped at any
+other address.
+
+The read-only sections may only refer to themselves, to absolute symbols
+and to the symbols exported by the firmware, whose addresses are taken from
+its ELF file: the prelinked module is bound to that exact firmware.  A
+reference to a writable section, placed in RAM at load time, cannot be
+resolved here; build the module so that the text reaches its data through
+a GOT, or keep it in RAM.  The file size and layout are unchanged, so the
+file system image can be built once to find the file address, and built
+again with the prelinked file.
+
+Only 32-bit ARM modules are supported.
+"""
+
+import argparse
+import struct
+import sys
+
+# ELF constants
+
+ET_REL = 1
+EM_ARM = 40
+ELFCLASS32 = 1
+ELFDATA2LSB = 1
+
+SHT_NULL = 0
+SHT_SYMTAB = 2
+SHT_RELA = 4
+SHT_NOBITS = 8
+SHT_REL = 9
+
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+
+SHN_UNDEF = 0
+SHN_ABS = 0xFFF1
+
+STB_GLOBAL = 1
+STB_WEAK = 2
+STT_FUNC = 2
+
+# Offsets of sh_type and sh_addr in an Elf32_Shdr
+
+SHDR_TYPE = 4
+SHDR_ADDR = 12
+
+# The ARM relocations the module loader applies to code and constant data
+
+R_ARM_NONE = 0
+R_ARM_PC24 = 1
+R_ARM_ABS32 = 2
+R_ARM_REL32 = 3
+R_ARM_THM_CALL = 10
+R_ARM_CALL = 28
+R_ARM_JUMP24 = 29
+R_ARM_THM_JUMP24 = 30
+R_ARM_TARGET1 = 38
+R_ARM_V4BX = 40
+R_ARM_PREL31 = 42
+
+
+class PrelinkError(Exception):
+    pass
+
+
+def sign_extend(value, bits):
+    value &= (1 << bits) - 1
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+
+class ElfFile(object):
+    """The headers, symbols and relocations of a 32-bit little endian ELF"""
+
+    def __init__(self, image, path):
+        if image[:4] != b"\x7fELF":
+            raise PrelinkError("%s: not an ELF file" % path)
+        if image[4] != ELFCLASS32 or image[5] != ELFDATA2LSB:
+            raise PrelinkError("%s: not a 32-bit little endian ELF" % path)
+
+        (
+            self.e_type,
+            self.e_machine,
+            self.e_shoff,
+            self.e_shentsize,
+            self.e_shnum,
+            self.e_shstrndx,
+        ) = struct.unpack_from("<HH12xI10xHHH", image, 16)
+
+        self.image = image
+        self.sections = []
+        for index in range(self.e_shnum):
+            fields = struct.unpack_from(
+                "<10I", image, self.e_shoff + index * self.e_shentsize
+            )
+            self.sections.append(
+                dict(
+                    zip(
+                        (
+                            "sh_name",
+                            "sh_type",
+                            "sh_flags",
+                            "sh_addr",
+                            "sh_offset",
+                            "sh_size",
+                            "sh_link",
+                            "sh_info",
+                            "sh_addralign",
+                            "sh_entsize",
+                        ),
+                        fields,
+                    )
+                )
+            )
+
+        for section in self.sections:
+            section["name"] = self.string(self.e_shstrndx, section["sh_name"])
+
+    def string(self, index, offset):
+        start = self.sections[index]["sh_offset"] + offset
+        return self.image[start : self.image.index(b"\0", start)].decode()
+
+    def symbols(self, index):
+        section = self.sections[index]
+        symbols = []
+        for offset in range(
+            section["sh_offset"], section["sh_offset"] + section["sh_size"], 16
+        ):
+            name, value, _, info, _, shndx = struct.unpack_from(
+                "<IIIBBH", self.image, offset
+            )
+            symbols.append(
+                {
+                    "name": self.string(section["sh_link"], name),
+                    "st_value": value,
+                    "st_bind": info >> 4,
+                    "st_type": info & 0xF,
+                    "st_shndx": shndx,
+                }
+            )
+
+        return symbols
+
+    def relocations(self, index):
+        section = self.sections[index]
+        for offset in range(
+            section["sh_offset"],
+            section["sh_offset"] + section["sh_size"],
+            section["sh_entsize"] or 8,
+        ):
+            r_offset, r_info = struct.unpack_from("<II", self.image, offset)
+            yield r_offset, r_info >> 8, r_info & 0xFF
+
+
+class Prelinker(object):
+    def __init__(self, module, base, firmware):
+        with open(module, "rb") as file:
+            self.image = bytearray(file.read())
+
+        self.elf = ElfFile(bytes(self.image), module)
+        self.base = base
+
+        if self.elf.e_type != ET_REL:
+            raise PrelinkError("%s: not a relocatable module" % module)
+        if self.elf.e_machine != EM_ARM:
+            raise PrelinkError(
+                "%s: unsupported machine %d" % (module, self.elf.e_machine)
+            )
+
+        self.rosections = set()
+        for index, section in enumerate(self.elf.sections):
+            if (
+                section["sh_flags"] & (SHF_ALLOC | SHF_WRITE) == SHF_ALLOC
+                and section["sh_size"] > 0
+                and section["sh_type"] != SHT_NOBITS
+            ):
+                if section["sh_addr"] != 0:
+                    raise PrelinkError("%s: already prelinked" % module)
+                self.rosections.add(index)
+
+        self.exports = {}
+        if firmware is not None:
+            self.load_exports(firmware)
+
+    def load_exports(self, firmware):
+        with open(firmware, "rb") as file:
+            elf = ElfFile(file.read(), firmware)
+
+        for index, section in enumerate(elf.sections):
+            if section["sh_type"] != SHT_SYMTAB:
+                continue
+            for symbol in elf.symbols(index):
+                if (
+                    symbol["name"]
+                    and symbol["st_shndx"] != SHN_UNDEF
+                    and symbol["st_bind"] in (STB_GLOBAL, STB_WEAK)
+                ):
+                    self.exports.setdefault(symbol["name"], symbol["st_value"])
+
+    def address(self, index):
+        return self.base + self.elf.sections[index]["sh_offset"]
+
+    def symvalue(self, symbol):
+        shndx = symbol["st_shndx"]
+        if shndx == SHN_UNDEF:
+            if symbol["name"] not in self.exports:
+                raise PrelinkError("undefined symbol %s" % symbol["name"])
+            return self.exports[symbol["name"]]
+        if shndx == SHN_ABS:
+            return symbol["st_value"]
+        if shndx in self.rosections:
+            return self.address(shndx) + symbol["st_value"]
+
+        if shndx < len(self.elf.sections):
+            name = self.elf.sections[shndx]["name"]
+        else:
+            name = "section %#x" % shndx
+
+        raise PrelinkError(
+            "reference to %s in %s, which is not read-only"
+            % (symbol["name"] or "section", name)
+        )
+
+    def read32(self, offset):
+        return struct.unpack_from("<I", self.image, offset)[0]
+
+    def write32(self, offset, value):
+        struct.pack_into("<I", self.image, offset, value & 0xFFFFFFFF)
+
+    def relocate(self, reltype, offset, P, S, symbol):
+        """Apply one REL relocation, as up_relocate() of the ARM loaders"""
+
+        if reltype == R_ARM_NONE:
+            return
+
+        if reltype in (R_ARM_ABS32, R_ARM_TARGET1):
+            self.write32(offset, self.read32(offset) + S)
+
+        elif reltype == R_ARM_REL32:
+            self.write32(offset, self.read32(offset) + S - P)
+
+        elif reltype == R_ARM_PREL31:
+            self.write32(offset, (self.read32(offset) + S - P) & 0x7FFFFFFF)
+
+        elif reltype == R_ARM_V4BX:
+            self.write32(offset, (self.read32(offset) & 0xF000000F) | 0x01A0F000)
+
+        elif reltype in (R_ARM_PC24, R_ARM_CALL, R_ARM_JUMP24):
+            insn = self.read32(offset)
+            value = (sign_extend(insn, 24) << 2) + S - P
+            if value & 3 or not -0x02000000 <= value < 0x02000000:
+                raise PrelinkError("branch out of range at %08x" % P)
+            self.write32(offset, (insn & 0xFF000000) | ((value >> 2) & 0x00FFFFFF))
+
+        elif reltype in (R_ARM_THM_CALL, R_ARM_THM_JUMP24):
+            upper, lower = struct.unpack_from("<HH", self.image, offset)
+            sign = (upper >> 10) & 1
+            j1 = (lower >> 13) & 1
+            j2 = (lower >> 11) & 1
+            value = (
+                (sign << 24)
+                | ((~(j1 ^ sign) & 1) << 23)
+                | ((~(j2 ^ sign) & 1) << 22)
+                | ((upper & 0x03FF) << 12)
+                | ((lower & 0x07FF) << 1)
+            )
+            value = sign_extend(value, 25) + S - P
+            if symbol["st_type"] == STT_FUNC and value & 1 == 0:
+                raise PrelinkError("branch to ARM code at %08x" % P)
+            if not -0x01000000 <= value < 0x01000000:
+                raise PrelinkError("branch out of range at %08x" % P)
+            sign = (value >> 24) & 1
+            j1 = sign ^ (~(value >> 23) & 1)
+            j2 = sign ^ (~(value >> 22) & 1)
+            upper = (upper & 0xF800) | (sign << 10) | ((value >> 12) & 0x03FF)
+            lower = (
+                (lower & 0xD000) | (j1 << 13) | (j2 << 11) | ((value >> 1) & 0x07FF)
+            )
+            struct.pack_into("<HH", self.image, offset, upper, lower)
+
+        else:
+            raise PrelinkError("unsupported relocation type %d at %08x" % (reltype, P))
+
+    def write_shdr(self, index, field, value):
+        offset = self.elf.e_shoff + index * self.elf.e_shentsize + field
+        self.write32(offset, value)
+
+    def prelink(self):
+        nrelocs = 0
+
+        for index, section in enumerate(self.elf.sections):
+            if section["sh_type"] not in (SHT_REL, SHT_RELA):
+                continue
+
+            target = section["sh_info"]
+            if target not in self.rosections:
+                continue
+
+            if section["sh_type"] == SHT_RELA:
+                raise PrelinkError(
+                    "%s: RELA relocations are not supported" % section["name"]
+                )
+
+            symbols = self.elf.symbols(section["sh_link"])
+            fileoff = self.elf.sections[target]["sh_offset"]
+
+            for r_offset, r_sym, reltype in self.elf.relocations(index):
+                symbol = symbols[r_sym]
+                P = self.address(target) + r_offset
+
+                try:
+                    S = self.symvalue(symbol) if reltype != R_ARM_V4BX else 0
+                    self.relocate(reltype, fileoff + r_offset, P, S, symbol)
+                except PrelinkError as e:
+                    raise PrelinkError("%s+%#x: %s" % (section["name"], r_offset, e))
+
+                nrelocs += 1
+
+            # Nothing is left for the loader to apply in this section
+
+            self.write_shdr(index, SHDR_TYPE, SHT_NULL)
+
+        for index in sorted(self.rosections):
+            section = self.elf.sections[index]
+            align = max(section["sh_addralign"], 1)
+            if self.address(index) % align != 0:
+                raise PrelinkError(
+                    "%s at %08x is not aligned to %d bytes"
+                    % (section["name"], self.address(index), align)
+                )
+
+            self.write_shdr(index, SHDR_ADDR, self.address(index))
+
+        return nrelocs
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter
+    )
+    parser.add_argument("module", help="Path to the relocatable module.")
+    parser.add_argument(
+        "-b",
+        "--base",
+        required=True,
+        type=lambda x: int(x, 0),
+        help="Address the first byte of the file is mapped at (FIOC_XIPBASE).",
+    )
+    parser.add_argument(
+        "-f",
+        "--firmware",
+        help="Path to the ELF of the firmware providing the undefined symbols.",
+    )
+    parser.add_argument(
+        "-o", "--output", required=True, help="Path of the prelinked module."
+    )
+    args = parser.parse_args()
+
+    try:
+        prelinker = Prelinker(args.module, args.base, args.firmware)
+        nrelocs = prelinker.prelink()
+    except PrelinkError as e:
+        print("prelink: %s" % e, file=sys.stderr)
+        sys.exit(1)
+
+    with open(args.output, "wb") as file:
+        file.write(prelinker.image)
+
+    print(
+        "prelink: %d relocations applied, %d sections at %#x"
+        % (nrelocs, len(prelinker.rosections), args.base)
+    )
@@ -356,6 +356,7 @@ class MMNode(gdb.Value, p.MMFreeNode):
     MM_ALLOC_BIT = 0x1
     MM_PREVFREE_BIT = 0x2
     MM_MASK_BIT = MM_ALLOC_BIT | MM_PREVFREE_BIT
+    MM_ZEROED_BIT = int(utils.get_symbol_value("MM_ZEROED_BIT", locspec="mm_initialize") or 0)
     MM_SIZEOF_ALLOCNODE = utils.sizeof("struct mm_allocnode_s")
     MM_ALLOCNODE_OVERHEAD = MM_SIZEOF_ALLOCNODE - utils.sizeof("mmsize_t")
     MM_MIN_CHUNK = utils.get_symbol_value("MM_MIN_CHUNK", locspec="mm_initialize")
@@ -417,7 +418,7 @@ class MMNode(gdb.Value, p.MMFreeNode):
     def nodesize(self) -> int:
         """Size of this chunk, including overhead"""
         if not self._nodesize:
-            self._nodesize = int(self["size"]) & ~MMNode.MM_MASK_BIT
+            self._nodesize = int(self["size"]) & ~(MMNode.MM_MASK_BIT | MMNode.MM_ZEROED_BIT)
         return self._nodesize
 
     @property